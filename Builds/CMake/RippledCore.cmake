@@ -353,6 +353,7 @@ target_sources (rippled PRIVATE
   src/ripple/app/ledger/impl/LedgerToJson.cpp
   src/ripple/app/ledger/impl/LocalTxs.cpp
   src/ripple/app/ledger/impl/OpenLedger.cpp
+  src/ripple/app/ledger/impl/PeerRequestTracker.cpp
   src/ripple/app/ledger/impl/SkipListAcquire.cpp
   src/ripple/app/ledger/impl/TimeoutCounter.cpp
   src/ripple/app/ledger/impl/TransactionAcquire.cpp
@@ -519,9 +520,11 @@ target_sources (rippled PRIVATE
   src/ripple/nodestore/impl/DummyScheduler.cpp
   src/ripple/nodestore/impl/EncodedBlob.cpp
   src/ripple/nodestore/impl/ManagerImp.cpp
+  src/ripple/nodestore/impl/MappedShard.cpp
   src/ripple/nodestore/impl/NodeObject.cpp
   src/ripple/nodestore/impl/Shard.cpp
   src/ripple/nodestore/impl/TaskQueue.cpp
+  src/ripple/nodestore/impl/ZstdDictionaries.cpp
   #[===============================[
      main sources:
        subdir: overlay
@@ -535,6 +538,7 @@ target_sources (rippled PRIVATE
   src/ripple/overlay/impl/PeerReservationTable.cpp
   src/ripple/overlay/impl/PeerSet.cpp
   src/ripple/overlay/impl/ProtocolVersion.cpp
+  src/ripple/overlay/impl/SendQueue.cpp
   src/ripple/overlay/impl/TrafficCount.cpp
   #[===============================[
      main sources:
@@ -613,6 +617,7 @@ target_sources (rippled PRIVATE
   src/ripple/rpc/handlers/TransactionEntry.cpp
   src/ripple/rpc/handlers/Tx.cpp
   src/ripple/rpc/handlers/TxHistory.cpp
+  src/ripple/rpc/handlers/TxProfile.cpp
   src/ripple/rpc/handlers/UnlList.cpp
   src/ripple/rpc/handlers/Unsubscribe.cpp
   src/ripple/rpc/handlers/ValidationCreate.cpp
@@ -652,6 +657,7 @@ target_sources (rippled PRIVATE
   src/ripple/shamap/impl/SHAMapSync.cpp
   src/ripple/shamap/impl/SHAMapTreeNode.cpp
   src/ripple/shamap/impl/ShardFamily.cpp
+  src/ripple/shamap/impl/TreeNodeCache.cpp
   #[===============================[
      test sources:
        subdir: app
@@ -659,6 +665,7 @@ target_sources (rippled PRIVATE
   src/test/app/AccountDelete_test.cpp
   src/test/app/AccountTxPaging_test.cpp
   src/test/app/AmendmentTable_test.cpp
+  src/test/app/BuildLedger_test.cpp
   src/test/app/Check_test.cpp
   src/test/app/CrossingLimits_test.cpp
   src/test/app/DeliverMin_test.cpp
@@ -670,6 +677,7 @@ target_sources (rippled PRIVATE
   src/test/app/Flow_test.cpp
   src/test/app/Freeze_test.cpp
   src/test/app/HashRouter_test.cpp
+  src/test/app/LedgerFetchPack_test.cpp
   src/test/app/LedgerHistory_test.cpp
   src/test/app/LedgerLoad_test.cpp
   src/test/app/LedgerReplay_test.cpp
@@ -682,6 +690,7 @@ target_sources (rippled PRIVATE
   src/test/app/Path_test.cpp
   src/test/app/PayChan_test.cpp
   src/test/app/PayStrand_test.cpp
+  src/test/app/PeerRequestTracker_test.cpp
   src/test/app/PseudoTx_test.cpp
   src/test/app/RCLCensorshipDetector_test.cpp
   src/test/app/RCLValidations_test.cpp
@@ -754,6 +763,7 @@ target_sources (rippled PRIVATE
   src/test/consensus/LedgerTrie_test.cpp
   src/test/consensus/NegativeUNL_test.cpp
   src/test/consensus/ScaleFreeSim_test.cpp
+  src/test/consensus/TxReduceRelaySim_test.cpp
   src/test/consensus/Validations_test.cpp
   #[===============================[
      test sources:
@@ -837,6 +847,7 @@ target_sources (rippled PRIVATE
   src/test/ledger/Invariants_test.cpp
   src/test/ledger/PaymentSandbox_test.cpp
   src/test/ledger/PendingSaves_test.cpp
+  src/test/ledger/SandboxTiming_test.cpp
   src/test/ledger/SkipList_test.cpp
   src/test/ledger/View_test.cpp
   #[===============================[
@@ -850,16 +861,23 @@ target_sources (rippled PRIVATE
   #]===============================]
   src/test/nodestore/Backend_test.cpp
   src/test/nodestore/Basics_test.cpp
+  src/test/nodestore/BatchWriter_test.cpp
   src/test/nodestore/DatabaseShard_test.cpp
   src/test/nodestore/Database_test.cpp
   src/test/nodestore/Timing_test.cpp
+  src/test/nodestore/codec_test.cpp
   src/test/nodestore/import_test.cpp
   src/test/nodestore/varint_test.cpp
   #[===============================[
      test sources:
        subdir: overlay
   #]===============================]
+  src/test/overlay/IngestQueue_test.cpp
+  src/test/overlay/PeerSnapshot_test.cpp
+  src/test/overlay/ProtocolMessage_test.cpp
   src/test/overlay/ProtocolVersion_test.cpp
+  src/test/overlay/SendQueue_test.cpp
+  src/test/overlay/TrafficCount_test.cpp
   src/test/overlay/cluster_test.cpp
   src/test/overlay/short_read_test.cpp
   src/test/overlay/compression_test.cpp
@@ -940,6 +958,7 @@ target_sources (rippled PRIVATE
   src/test/rpc/TransactionEntry_test.cpp
   src/test/rpc/TransactionHistory_test.cpp
   src/test/rpc/Tx_test.cpp
+  src/test/rpc/TxProfile_test.cpp
   src/test/rpc/ValidatorInfo_test.cpp
   src/test/rpc/ValidatorRPC_test.cpp
   src/test/rpc/Version_test.cpp
@@ -956,6 +975,7 @@ target_sources (rippled PRIVATE
   src/test/shamap/FetchPack_test.cpp
   src/test/shamap/SHAMapSync_test.cpp
   src/test/shamap/SHAMap_test.cpp
+  src/test/shamap/TreeNodeCache_test.cpp
   #[===============================[
      test sources:
        subdir: unit_test
@@ -147,31 +147,37 @@ RCLValidationsAdaptor::acquire(LedgerHash const& hash)
     return RCLValidatedLedger(std::move(ledger), j_);
 }
 
-void
-handleNewValidation(
-    Application& app,
-    std::shared_ptr<STValidation> const& val,
-    std::string const& source)
+// Sets the trust status of a validation and returns the identity of the
+// validator and, if it is trusted or listed, its master key
+static std::pair<NodeID, std::optional<PublicKey>>
+identifyValidator(Application& app, STValidation& val)
 {
-    auto const& signingKey = val->getSignerPublic();
-    auto const& hash = val->getLedgerHash();
-    auto const seq = val->getFieldU32(sfLedgerSequence);
+    auto const& signingKey = val.getSignerPublic();
 
     // Ensure validation is marked as trusted if signer currently trusted
     auto masterKey = app.validators().getTrustedKey(signingKey);
 
-    if (!val->isTrusted() && masterKey)
-        val->setTrusted();
+    if (!val.isTrusted() && masterKey)
+        val.setTrusted();
 
     // If not currently trusted, see if signer is currently listed
     if (!masterKey)
         masterKey = app.validators().getListedKey(signingKey);
 
-    auto& validations = app.getValidations();
-
     // masterKey is seated only if validator is trusted or listed
-    auto const outcome =
-        validations.add(calcNodeID(masterKey.value_or(signingKey)), val);
+    return {calcNodeID(masterKey.value_or(signingKey)), masterKey};
+}
+
+static void
+onValidationAdded(
+    Application& app,
+    std::shared_ptr<STValidation> const& val,
+    std::optional<PublicKey> const& masterKey,
+    ValStatus outcome)
+{
+    auto const& signingKey = val->getSignerPublic();
+    auto const& hash = val->getLedgerHash();
+    auto const seq = val->getFieldU32(sfLedgerSequence);
 
     if (outcome == ValStatus::current)
     {
@@ -180,6 +186,8 @@ handleNewValidation(
         return;
     }
 
+    auto& validations = app.getValidations();
+
     // Ensure that problematic validations from validators we trust are
     // logged at the highest possible level.
     //
@@ -216,4 +224,86 @@ handleNewValidation(
     }
 }
 
+void
+handleNewValidation(
+    Application& app,
+    std::shared_ptr<STValidation> const& val,
+    std::string const& source)
+{
+    auto const [nodeID, masterKey] = identifyValidator(app, *val);
+    auto const outcome = app.getValidations().add(nodeID, val);
+    onValidationAdded(app, val, masterKey, outcome);
+}
+
+std::vector<bool>
+handleNewValidations(
+    Application& app,
+    std::vector<std::shared_ptr<STValidation>> const& vals,
+    std::string const& source)
+{
+    auto j = app.journal("Validations");
+
+    std::vector<bool> handled(vals.size(), false);
+    std::vector<std::size_t> index;
+    std::vector<std::optional<PublicKey>> masterKeys;
+    std::vector<std::pair<NodeID, RCLValidation>> batch;
+    index.reserve(vals.size());
+    masterKeys.reserve(vals.size());
+    batch.reserve(vals.size());
+
+    for (std::size_t i = 0; i < vals.size(); ++i)
+    {
+        try
+        {
+            auto [nodeID, masterKey] = identifyValidator(app, *vals[i]);
+            batch.emplace_back(nodeID, vals[i]);
+            masterKeys.push_back(std::move(masterKey));
+            index.push_back(i);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j.warn()) << "Exception identifying validation from "
+                           << source << ": " << e.what();
+        }
+    }
+
+    // A validation which throws is skipped and the rest of the batch is
+    // added, never adding a validation twice.
+    std::vector<bool> added(batch.size(), true);
+    std::vector<ValStatus> outcomes;
+    while (outcomes.size() < batch.size())
+    {
+        try
+        {
+            app.getValidations().add(batch, outcomes);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j.warn()) << "Exception adding validation from " << source
+                           << ": " << e.what();
+            added[outcomes.size()] = false;
+            outcomes.push_back(ValStatus::stale);
+        }
+    }
+
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+        if (!added[i])
+            continue;
+
+        try
+        {
+            onValidationAdded(app, vals[index[i]], masterKeys[i], outcomes[i]);
+            handled[index[i]] = true;
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j.warn()) << "Exception handling validation from " << source
+                           << ": " << e.what();
+        }
+    }
+
+    return handled;
+}
+
 }  // namespace ripple
@@ -250,6 +250,25 @@ handleNewValidation(
     std::shared_ptr<STValidation> const& val,
     std::string const& source);
 
+/** Handle a batch of new validations
+
+    Equivalent to calling handleNewValidation for each validation in turn,
+    but the validations are added under a single acquisition of the
+    validations lock.
+
+    @param app Application object containing validations and ledgerMaster
+    @param vals The validations to add
+    @param source Name associated with the validations used in logging
+    @return For each validation, in order, whether it was handled without
+            error. A validation which fails does not prevent the others
+            from being handled.
+*/
+std::vector<bool>
+handleNewValidations(
+    Application& app,
+    std::vector<std::shared_ptr<STValidation>> const& vals,
+    std::string const& source);
+
 }  // namespace ripple
 
 #endif
@@ -24,6 +24,7 @@
 #include <ripple/beast/utility/Journal.h>
 #include <ripple/ledger/ApplyView.h>
 #include <chrono>
+#include <cstdint>
 #include <memory>
 
 namespace ripple {
@@ -78,5 +79,21 @@ buildLedger(
     Application& app,
     beast::Journal j);
 
+/** Transactions applied speculatively by buildLedger.
+
+    With [parallel_ledger_build], each transaction is applied speculatively
+    and its result is either kept, or discarded because it conflicts with an
+    earlier transaction and the transaction applied again.
+*/
+struct SpeculativeApplyCounts
+{
+    std::uint64_t kept = 0;
+    std::uint64_t reapplied = 0;
+};
+
+/** Return the totals for all ledgers built by this process. */
+SpeculativeApplyCounts
+getSpeculativeApplyCounts();
+
 }  // namespace ripple
 #endif
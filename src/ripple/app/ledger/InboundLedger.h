@@ -21,6 +21,7 @@
 #define RIPPLE_APP_LEDGER_INBOUNDLEDGER_H_INCLUDED
 
 #include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/impl/PeerRequestTracker.h>
 #include <ripple/app/ledger/impl/TimeoutCounter.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/basics/CountedObject.h>
@@ -133,6 +134,13 @@ private:
     void
     trigger(std::shared_ptr<Peer> const&, TriggerReason);
 
+    bool
+    requestNodes(
+        protocol::TMGetLedger& tmGL,
+        std::vector<std::pair<SHAMapNodeID, uint256>> const& nodes,
+        std::shared_ptr<Peer> const& peer,
+        TriggerReason reason);
+
     std::vector<neededHash_t>
     getNeededHashes();
 
@@ -189,6 +197,9 @@ private:
 
     std::set<uint256> mRecentNodes;
 
+    // Node requests in flight and how fast each peer answers them
+    PeerRequestTracker mRequests;
+
     SHAMapAddNode mStats;
 
     // Data we have received from peers
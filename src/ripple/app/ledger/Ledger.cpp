@@ -760,7 +760,7 @@ Ledger::updateNegativeUNL()
 
 //------------------------------------------------------------------------------
 bool
-Ledger::walkLedger(beast::Journal j) const
+Ledger::walkLedger(beast::Journal j, SHAMapVisitedSet* complete) const
 {
     std::vector<SHAMapMissingNode> missingNodes1;
     std::vector<SHAMapMissingNode> missingNodes2;
@@ -773,7 +773,7 @@ Ledger::walkLedger(beast::Journal j) const
     }
     else
     {
-        stateMap_->walkMap(missingNodes1, 32);
+        stateMap_->walkMap(missingNodes1, 32, complete);
     }
 
     if (!missingNodes1.empty())
@@ -793,7 +793,7 @@ Ledger::walkLedger(beast::Journal j) const
     }
     else
     {
-        txMap_->walkMap(missingNodes2, 32);
+        txMap_->walkMap(missingNodes2, 32, complete);
     }
 
     if (!missingNodes2.empty())
@@ -1121,7 +1121,7 @@ flatFetchTransactions(Application& app, std::vector<uint256>& nodestoreHashes)
         if (obj)
         {
             auto node = SHAMapTreeNode::makeFromPrefix(
-                makeSlice(obj->getData()), SHAMapHash{nodestoreHash});
+                obj->getData(), SHAMapHash{nodestoreHash});
             if (!node)
             {
                 assert(false);
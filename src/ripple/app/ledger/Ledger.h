@@ -336,8 +336,13 @@ public:
     void
     updateSkipList();
 
+    /** Check that every node of the ledger is in the node store.
+
+        @param complete if set, subtrees already known to be complete are
+        skipped, and the subtrees found complete are added to it.
+    */
     bool
-    walkLedger(beast::Journal j) const;
+    walkLedger(beast::Journal j, SHAMapVisitedSet* complete = nullptr) const;
 
     bool
     assertSensible(beast::Journal ledgerJ) const;
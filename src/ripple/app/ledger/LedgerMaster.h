@@ -29,18 +29,21 @@
 #include <ripple/app/ledger/LedgerReplay.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/CanonicalTXSet.h>
+#include <ripple/basics/ByteUtilities.h>
 #include <ripple/basics/RangeSet.h>
 #include <ripple/basics/StringUtilities.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/beast/insight/Collector.h>
 #include <ripple/beast/utility/PropertyStream.h>
 #include <ripple/core/Stoppable.h>
+#include <ripple/overlay/Message.h>
 #include <ripple/protocol/Protocol.h>
 #include <ripple/protocol/RippleLedgerHash.h>
 #include <ripple/protocol/STValidation.h>
 #include <ripple/protocol/messages.h>
 #include <optional>
 
+#include <deque>
 #include <mutex>
 
 namespace ripple {
@@ -72,6 +75,22 @@ public:
 class LedgerMaster : public Stoppable, public AbstractFetchPackContainer
 {
 public:
+    /** Limits on building fetch packs for peers. */
+    struct FetchPackLimits
+    {
+        // Don't add more ledgers to a pack once it has this many objects
+        int objects = 512;
+
+        // Don't add more ledgers to a pack once it is this large
+        std::size_t bytes = megabytes(4);
+
+        // Don't spend longer than this adding ledgers to a pack
+        std::chrono::milliseconds buildTime{500};
+
+        // The most memory the objects cached for each ledger may use
+        std::size_t cacheBytes = megabytes(64);
+    };
+
     // Age for last validated ledger if the process has yet to validate.
     static constexpr std::chrono::seconds NO_VALIDATED_LEDGER_AGE =
         std::chrono::hours{24 * 14};
@@ -297,6 +316,21 @@ public:
     std::size_t
     getFetchPackCacheSize() const;
 
+    /** Change the limits on building fetch packs.
+        Only useful for testing.
+    */
+    void
+    setFetchPackLimits(FetchPackLimits const& limits);
+
+    /** The number of ledgers whose fetch pack objects are cached, and
+        the memory they use in bytes.
+    */
+    std::pair<std::size_t, std::size_t>
+    getFetchPackDeltaCacheSize();
+
+    float
+    getFetchPackDeltaHitRate();
+
     //! Whether we have ever fully validated a ledger.
     bool
     haveValidated()
@@ -320,6 +354,15 @@ private:
     void
     getFetchPack(LedgerIndex missing, InboundLedger::Reason reason);
 
+    // The fetch pack objects for the parent of a ledger, built on first use
+    std::shared_ptr<protocol::TMGetObjectByHash>
+    getFetchPackDelta(Ledger const& want, Ledger const& have);
+
+    // Evict the oldest fetch pack deltas until the cache is within its
+    // budget. The caller holds fetch_pack_deltas_mutex_.
+    void
+    shrinkFetchPackDeltas();
+
     std::optional<LedgerHash>
     getLedgerHashForHistory(LedgerIndex index, InboundLedger::Reason reason);
 
@@ -419,6 +462,23 @@ private:
 
     TaggedCache<uint256, Blob> fetch_packs_;
 
+    FetchPackLimits fetch_pack_limits_;
+
+    // The objects a fetch pack carries for one ledger, keyed by the hash
+    // of the ledger that follows it. Shared by every pack covering it.
+    TaggedCache<uint256, protocol::TMGetObjectByHash> fetch_pack_deltas_;
+
+    // The keys and sizes of the cached fetch pack deltas, oldest first,
+    // which keep the cache within fetch_pack_limits_.cacheBytes
+    std::mutex fetch_pack_deltas_mutex_;
+    std::deque<std::pair<uint256, std::size_t>> fetch_pack_delta_sizes_;
+    std::size_t fetch_pack_delta_bytes_{0};
+
+    // Fetch packs already built, keyed by the hash of the ledger the
+    // requester has. Each is compressed once for all the peers it is
+    // sent to.
+    TaggedCache<uint256, Message> fetch_pack_replies_;
+
     std::uint32_t fetch_seq_{0};
 
     // Try to keep a validator from switching from test to live network
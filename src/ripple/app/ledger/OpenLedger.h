@@ -226,7 +226,9 @@ OpenLedger::apply(
             // throw since it may be transformed.
             auto const tx = *iter;
             auto const txId = tx->getTransactionID();
-            if (check.txExists(txId))
+            // Skip transactions already in the closed ledger, or
+            // already applied to this view as a disputed retry.
+            if (check.txExists(txId) || view.txExists(txId))
                 continue;
             auto const result =
                 apply_one(app, view, tx, true, flags, shouldRecover[txId], j);
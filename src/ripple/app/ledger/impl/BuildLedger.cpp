@@ -24,7 +24,15 @@
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/CanonicalTXSet.h>
 #include <ripple/app/tx/apply.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/protocol/Feature.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <tuple>
+#include <vector>
 
 namespace ripple {
 
@@ -81,6 +89,411 @@ buildLedgerImpl(
     return built;
 }
 
+namespace {
+
+/** Read only view that records what was read from another view.
+
+    The keys that were read, and the key ranges that were searched with
+    succ, are remembered, so that it can later be told whether the
+    outcome of the reads would differ after some entries were changed.
+*/
+class RecordingView final : public ReadView
+{
+    ReadView const& base_;
+    mutable std::vector<key_type> keys_;
+    mutable std::vector<std::pair<key_type, std::optional<key_type>>> ranges_;
+    mutable bool all_ = false;
+
+public:
+    explicit RecordingView(ReadView const& base) : base_(base)
+    {
+    }
+
+    /** Whether any of the recorded reads depends on the given keys. */
+    bool
+    dependsOn(std::set<key_type> const& keys) const
+    {
+        if (all_)
+            return true;
+        if (keys.empty())
+            return false;
+
+        for (auto const& key : keys_)
+        {
+            if (keys.count(key))
+                return true;
+        }
+
+        // A range includes its end, when it has one
+        for (auto const& [from, to] : ranges_)
+        {
+            auto const iter = keys.upper_bound(from);
+            if (iter != keys.end() && (!to || *iter <= *to))
+                return true;
+        }
+        return false;
+    }
+
+    LedgerInfo const&
+    info() const override
+    {
+        return base_.info();
+    }
+
+    bool
+    open() const override
+    {
+        return base_.open();
+    }
+
+    Fees const&
+    fees() const override
+    {
+        return base_.fees();
+    }
+
+    Rules const&
+    rules() const override
+    {
+        return base_.rules();
+    }
+
+    bool
+    exists(Keylet const& k) const override
+    {
+        keys_.push_back(k.key);
+        return base_.exists(k);
+    }
+
+    std::optional<key_type>
+    succ(key_type const& key, std::optional<key_type> const& last)
+        const override
+    {
+        auto const next = base_.succ(key, last);
+        ranges_.emplace_back(key, next ? next : last);
+        return next;
+    }
+
+    std::shared_ptr<SLE const>
+    read(Keylet const& k) const override
+    {
+        keys_.push_back(k.key);
+        return base_.read(k);
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesBegin() const override
+    {
+        all_ = true;
+        return base_.slesBegin();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesEnd() const override
+    {
+        all_ = true;
+        return base_.slesEnd();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesUpperBound(key_type const& key) const override
+    {
+        all_ = true;
+        return base_.slesUpperBound(key);
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsBegin() const override
+    {
+        all_ = true;
+        return base_.txsBegin();
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsEnd() const override
+    {
+        all_ = true;
+        return base_.txsEnd();
+    }
+
+    bool
+    txExists(key_type const& key) const override
+    {
+        keys_.push_back(key);
+        return base_.txExists(key);
+    }
+
+    tx_type
+    txRead(key_type const& key) const override
+    {
+        keys_.push_back(key);
+        return base_.txRead(key);
+    }
+};
+
+/** The changes made to a view, kept to be applied to another view. */
+class Changes final : public TxsRawView
+{
+    enum class Action {
+        erase,
+        insert,
+        replace,
+    };
+
+    XRPAmount dropsDestroyed_{0};
+    std::vector<std::pair<Action, std::shared_ptr<SLE>>> items_;
+    std::vector<std::tuple<
+        uint256,
+        std::shared_ptr<Serializer const>,
+        std::shared_ptr<Serializer const>>>
+        txs_;
+
+public:
+    /** Give the inserted transactions the metadata index `index`.
+
+        A transaction applied speculatively is numbered as if every
+        transaction before it had been applied. When some of them were not,
+        only its index is wrong, so the metadata is rewritten rather than
+        applying the transaction again.
+    */
+    void
+    renumber(std::uint32_t index)
+    {
+        for (auto& [key, txn, meta] : txs_)
+        {
+            if (!meta)
+                continue;
+
+            SerialIter sit(meta->slice());
+            STObject obj(sit, sfTransactionMetaData);
+            if (obj.getFieldU32(sfTransactionIndex) == index)
+                continue;
+
+            obj.setFieldU32(sfTransactionIndex, index);
+            auto s = std::make_shared<Serializer>();
+            obj.add(*s);
+            meta = std::move(s);
+        }
+    }
+
+    /** Add the keys of the changed entries and of the inserted
+        transactions to `keys`.
+    */
+    void
+    keys(std::set<uint256>& keys) const
+    {
+        for (auto const& item : items_)
+            keys.insert(item.second->key());
+        for (auto const& tx : txs_)
+            keys.insert(std::get<0>(tx));
+    }
+
+    void
+    apply(TxsRawView& to) const
+    {
+        to.rawDestroyXRP(dropsDestroyed_);
+        for (auto const& [action, sle] : items_)
+        {
+            switch (action)
+            {
+                case Action::erase:
+                    to.rawErase(sle);
+                    break;
+                case Action::insert:
+                    to.rawInsert(sle);
+                    break;
+                case Action::replace:
+                    to.rawReplace(sle);
+                    break;
+            }
+        }
+        for (auto const& [key, txn, meta] : txs_)
+            to.rawTxInsert(key, txn, meta);
+    }
+
+    void
+    rawErase(std::shared_ptr<SLE> const& sle) override
+    {
+        items_.emplace_back(Action::erase, sle);
+    }
+
+    void
+    rawInsert(std::shared_ptr<SLE> const& sle) override
+    {
+        items_.emplace_back(Action::insert, sle);
+    }
+
+    void
+    rawReplace(std::shared_ptr<SLE> const& sle) override
+    {
+        items_.emplace_back(Action::replace, sle);
+    }
+
+    void
+    rawDestroyXRP(XRPAmount const& fee) override
+    {
+        dropsDestroyed_ += fee;
+    }
+
+    void
+    rawTxInsert(
+        uint256 const& key,
+        std::shared_ptr<Serializer const> const& txn,
+        std::shared_ptr<Serializer const> const& metaData) override
+    {
+        txs_.emplace_back(key, txn, metaData);
+    }
+};
+
+// Totals reported by getSpeculativeApplyCounts
+std::atomic<std::uint64_t> speculativeKept{0};
+std::atomic<std::uint64_t> speculativeReapplied{0};
+
+}  // namespace
+
+SpeculativeApplyCounts
+getSpeculativeApplyCounts()
+{
+    return {speculativeKept.load(), speculativeReapplied.load()};
+}
+
+/** Apply transactions in order, executing them speculatively in parallel.
+
+    Each transaction is first applied on several job queue threads, to
+    its own view on top of `view` as it was before any of them, while
+    recording the entries it read. Then, in order, each result is kept if
+    none of the entries it read was changed by the transactions kept
+    before it, and renumbered if a transaction before it was not applied.
+    Otherwise the transaction is applied again to the current state. Every
+    transaction
+    thus sees the same state as if they had all been applied one after
+    the other, so the ledger is identical to one built serially.
+
+    The calling thread takes part in the speculative work and only waits
+    for transactions that another thread has already started, so it never
+    blocks behind jobs that have not been scheduled yet.
+
+    @param txns The transactions, in the order to apply them.
+    @param apply Callable as `ApplyResult(OpenView&, STTx const&)`, which
+                 applies one transaction to a view.
+    @return The result of applying each transaction.
+*/
+template <class Apply>
+static std::vector<ApplyResult>
+applySpeculatively(
+    Application& app,
+    OpenView& view,
+    std::vector<std::shared_ptr<STTx const>> const& txns,
+    Apply const& apply,
+    beast::Journal j)
+{
+    // Not worth dispatching to other threads for fewer than this many
+    // transactions per thread.
+    std::size_t constexpr minPerThread = 16;
+
+    struct Speculation
+    {
+        std::unique_ptr<RecordingView> reads;
+        Changes changes;
+        // Unset if applying the transaction threw.
+        std::optional<ApplyResult> result;
+    };
+
+    struct State
+    {
+        std::vector<Speculation> specs;
+        std::atomic<std::size_t> next{0};
+        std::size_t done = 0;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+
+    auto const total = txns.size();
+    auto const baseTxCount = view.txCount();
+
+    auto state = std::make_shared<State>();
+    state->specs.resize(total);
+
+    auto work = [&view, &txns, &apply, state, total, baseTxCount]() {
+        std::size_t completed = 0;
+        for (auto i = state->next++; i < total; i = state->next++)
+        {
+            auto& spec = state->specs[i];
+            spec.reads = std::make_unique<RecordingView>(view);
+            try
+            {
+                // Assume every transaction before this one is applied.
+                OpenView batch(batch_view, spec.reads.get(), baseTxCount + i);
+                spec.result = apply(batch, *txns[i]);
+                batch.apply(spec.changes);
+            }
+            catch (std::exception const&)
+            {
+                // Applied again, serially, when the results are committed.
+                spec.result.reset();
+            }
+            ++completed;
+        }
+
+        if (completed != 0)
+        {
+            std::lock_guard lock(state->mutex);
+            state->done += completed;
+            if (state->done == total)
+                state->cv.notify_all();
+        }
+    };
+
+    auto const helpers = std::min<std::size_t>(
+        app.getJobQueue().getThreadCount(), total / minPerThread);
+    for (std::size_t i = 0; i < helpers; ++i)
+        app.getJobQueue().addJob(
+            jtACCEPT_CHECK, "applySpeculatively", [work](Job&) { work(); });
+
+    work();
+
+    {
+        std::unique_lock lock(state->mutex);
+        state->cv.wait(lock, [&] { return state->done == total; });
+    }
+
+    std::vector<ApplyResult> results;
+    results.reserve(total);
+    std::set<uint256> changed;
+    std::size_t reapplied = 0;
+    for (std::size_t i = 0; i < total; ++i)
+    {
+        auto& spec = state->specs[i];
+        Changes* changes = &spec.changes;
+        Changes again;
+        if (!spec.result || spec.reads->dependsOn(changed))
+        {
+            ++reapplied;
+            OpenView batch(batch_view, &view, view.txCount());
+            spec.result = apply(batch, *txns[i]);
+            batch.apply(again);
+            changes = &again;
+        }
+        else if (view.txCount() != baseTxCount + i)
+        {
+            // Fewer transactions than assumed were applied before it
+            spec.changes.renumber(view.txCount());
+        }
+
+        changes->keys(changed);
+        changes->apply(view);
+        results.push_back(*spec.result);
+    }
+
+    speculativeKept += total - reapplied;
+    speculativeReapplied += reapplied;
+
+    JLOG(j.debug()) << "Speculatively applied " << total
+                    << " transactions on " << helpers + 1 << " threads, "
+                    << reapplied << " applied again";
+    return results;
+}
+
 /** Apply a set of consensus transactions to a ledger.
 
   @param app Handle to application
@@ -112,6 +525,52 @@ applyTransactions(
 
         auto it = txns.begin();
 
+        if (pass == 0 && app.config().PARALLEL_LEDGER_BUILD)
+        {
+            std::vector<CanonicalTXSet::const_iterator> iters;
+            std::vector<std::shared_ptr<STTx const>> pending;
+            while (it != txns.end())
+            {
+                if (built->txExists(it->first.getTXID()))
+                {
+                    it = txns.erase(it);
+                    continue;
+                }
+                iters.push_back(it);
+                pending.push_back(it->second);
+                ++it;
+            }
+
+            auto const results = applySpeculatively(
+                app,
+                view,
+                pending,
+                [&](OpenView& batch, STTx const& tx) {
+                    return applyTransaction(
+                        app, batch, tx, certainRetry, tapNONE, j);
+                },
+                j);
+
+            for (std::size_t i = 0; i < results.size(); ++i)
+            {
+                switch (results[i])
+                {
+                    case ApplyResult::Success:
+                        txns.erase(iters[i]);
+                        ++changes;
+                        break;
+
+                    case ApplyResult::Fail:
+                        failed.insert(iters[i]->first.getTXID());
+                        txns.erase(iters[i]);
+                        break;
+
+                    case ApplyResult::Retry:
+                        break;
+                }
+            }
+        }
+
         while (it != txns.end())
         {
             auto const txid = it->first.getTXID();
@@ -229,6 +688,25 @@ buildLedger(
         app,
         j,
         [&](OpenView& accum, std::shared_ptr<Ledger> const& built) {
+            if (app.config().PARALLEL_LEDGER_BUILD)
+            {
+                std::vector<std::shared_ptr<STTx const>> txns;
+                txns.reserve(replayData.orderedTxns().size());
+                for (auto& tx : replayData.orderedTxns())
+                    txns.push_back(tx.second);
+
+                applySpeculatively(
+                    app,
+                    accum,
+                    txns,
+                    [&](OpenView& view, STTx const& tx) {
+                        return applyTransaction(
+                            app, view, tx, false, applyFlags, j);
+                    },
+                    j);
+                return;
+            }
+
             for (auto& tx : replayData.orderedTxns())
                 applyTransaction(app, accum, *tx.second, false, applyFlags, j);
         });
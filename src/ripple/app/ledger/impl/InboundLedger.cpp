@@ -24,6 +24,7 @@
 #include <ripple/app/ledger/TransactionStateSF.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/SHAMapStore.h>
 #include <ripple/basics/Log.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/nodestore/DatabaseShard.h>
@@ -55,9 +56,14 @@ enum {
     ,
     ledgerBecomeAggressiveThreshold = 6
 
-    // Number of nodes to find initially
+    // Number of nodes to find initially, twice as many as we keep in
+    // flight so that there are always some not yet requested
     ,
-    missingNodesFind = 256
+    missingNodesFind = 2048
+
+    // Number of threads looking for missing state nodes
+    ,
+    missingNodesThreads = 4
 
     // Number of nodes to request for a reply
     ,
@@ -71,6 +77,16 @@ enum {
 // millisecond for each ledger timeout
 auto constexpr ledgerAcquireTimeout = 2500ms;
 
+static PeerRequestTracker::Setup
+makeRequestSetup()
+{
+    PeerRequestTracker::Setup setup;
+    setup.minBatch = reqNodes;
+    setup.maxBatch = reqNodesReply;
+    setup.maxInFlightNodes = missingNodesFind / 2;
+    return setup;
+}
+
 InboundLedger::InboundLedger(
     Application& app,
     uint256 const& hash,
@@ -92,6 +108,7 @@ InboundLedger::InboundLedger(
     , mByHash(true)
     , mSeq(seq)
     , mReason(reason)
+    , mRequests(makeRequestSetup())
     , mReceiveDispatched(false)
     , mPeerSet(std::move(peerSet))
 {
@@ -302,10 +319,10 @@ InboundLedger::tryDB(NodeStore::Database& srcDB)
 {
     if (!mHaveHeader)
     {
-        auto makeLedger = [&, this](Blob const& data) {
+        auto makeLedger = [&, this](Slice data) {
             JLOG(journal_.trace()) << "Ledger header found in fetch pack";
             mLedger = std::make_shared<Ledger>(
-                deserializePrefixedHeader(makeSlice(data)),
+                deserializePrefixedHeader(data),
                 app_.config(),
                 mReason == Reason::SHARD ? *app_.getShardFamily()
                                          : app_.getNodeFamily());
@@ -334,7 +351,9 @@ InboundLedger::tryDB(NodeStore::Database& srcDB)
             auto& dstDB{mLedger->stateMap().family().db()};
             if (std::addressof(dstDB) != std::addressof(srcDB))
             {
-                Blob blob{nodeObject->getData()};
+                Blob blob{
+                    nodeObject->getData().begin(),
+                    nodeObject->getData().end()};
                 dstDB.store(
                     hotLEDGER, std::move(blob), hash_, mLedger->info().seq);
             }
@@ -348,7 +367,7 @@ InboundLedger::tryDB(NodeStore::Database& srcDB)
 
             JLOG(journal_.trace()) << "Ledger header found in fetch pack";
 
-            makeLedger(*data);
+            makeLedger(makeSlice(*data));
             if (failed_)
                 return;
 
@@ -424,6 +443,13 @@ InboundLedger::onTimer(bool wasProgress, ScopedLockType&)
 {
     mRecentNodes.clear();
 
+    if (auto const expired =
+            mRequests.expire(m_clock.now(), ledgerAcquireTimeout))
+    {
+        JLOG(journal_.debug())
+            << expired << " node requests timed out for ledger " << hash_;
+    }
+
     if (isDone())
     {
         JLOG(journal_.info()) << "Already done " << hash_;
@@ -511,6 +537,8 @@ InboundLedger::done()
     if (complete_ && !failed_ && mLedger)
     {
         mLedger->setImmutable(app_.config());
+        if (mReason != Reason::SHARD)
+            app_.getSHAMapStore().onLedgerAcquired(mSeq);
         switch (mReason)
         {
             case Reason::SHARD:
@@ -698,8 +726,11 @@ InboundLedger::trigger(std::shared_ptr<Peer> const& peer, TriggerReason reason)
 
             // Release the lock while we process the large state map
             sl.unlock();
-            auto nodes =
-                mLedger->stateMap().getMissingNodes(missingNodesFind, &filter);
+            auto nodes = mLedger->stateMap().getMissingNodes(
+                missingNodesFind,
+                &filter,
+                app_.getJobQueue(),
+                missingNodesThreads);
             sl.lock();
 
             // Make sure nothing happened while we released the lock
@@ -721,25 +752,11 @@ InboundLedger::trigger(std::shared_ptr<Peer> const& peer, TriggerReason reason)
                 {
                     filterNodes(nodes, reason);
 
-                    if (!nodes.empty())
-                    {
-                        tmGL.set_itype(protocol::liAS_NODE);
-                        for (auto const& id : nodes)
-                        {
-                            *(tmGL.add_nodeids()) = id.first.getRawString();
-                        }
-
-                        JLOG(journal_.trace())
-                            << "Sending AS node request (" << nodes.size()
-                            << ") to "
-                            << (peer ? "selected peer" : "all peers");
-                        mPeerSet->sendRequest(tmGL, peer);
+                    tmGL.set_itype(protocol::liAS_NODE);
+                    if (requestNodes(tmGL, nodes, peer, reason))
                         return;
-                    }
-                    else
-                    {
-                        JLOG(journal_.trace()) << "All AS nodes filtered";
-                    }
+
+                    JLOG(journal_.trace()) << "All AS nodes filtered";
                 }
             }
         }
@@ -787,23 +804,11 @@ InboundLedger::trigger(std::shared_ptr<Peer> const& peer, TriggerReason reason)
             {
                 filterNodes(nodes, reason);
 
-                if (!nodes.empty())
-                {
-                    tmGL.set_itype(protocol::liTX_NODE);
-                    for (auto const& n : nodes)
-                    {
-                        *(tmGL.add_nodeids()) = n.first.getRawString();
-                    }
-                    JLOG(journal_.trace())
-                        << "Sending TX node request (" << nodes.size()
-                        << ") to " << (peer ? "selected peer" : "all peers");
-                    mPeerSet->sendRequest(tmGL, peer);
+                tmGL.set_itype(protocol::liTX_NODE);
+                if (requestNodes(tmGL, nodes, peer, reason))
                     return;
-                }
-                else
-                {
-                    JLOG(journal_.trace()) << "All TX nodes filtered";
-                }
+
+                JLOG(journal_.trace()) << "All TX nodes filtered";
             }
         }
     }
@@ -850,14 +855,99 @@ InboundLedger::filterNodes(
         nodes.erase(dup, nodes.end());
     }
 
-    std::size_t const limit =
-        (reason == TriggerReason::reply) ? reqNodesReply : reqNodes;
+    // Replies are split across the peers by requestNodes, which sizes
+    // the requests to each peer.
+    if (reason != TriggerReason::reply && nodes.size() > reqNodes)
+        nodes.resize(reqNodes);
+}
+
+/** Request nodes of the state or transaction map
+
+    Blind queries go to the given peer, or to all the peers. When a peer
+    replies the nodes are split across the peers expected to answer first,
+    keeping several requests in flight to the fastest ones.
+
+    Returns 'true' if any request was sent.
+*/
+bool
+InboundLedger::requestNodes(
+    protocol::TMGetLedger& tmGL,
+    std::vector<std::pair<SHAMapNodeID, uint256>> const& nodes,
+    std::shared_ptr<Peer> const& peer,
+    TriggerReason reason)
+{
+    if (nodes.empty())
+        return false;
+
+    auto const now = m_clock.now();
+    auto const& peerIds = mPeerSet->getPeerIds();
+
+    auto send = [&](std::shared_ptr<Peer> const& to,
+                    auto first,
+                    auto last) {
+        tmGL.clear_nodeids();
+        for (auto it = first; it != last; ++it)
+        {
+            *(tmGL.add_nodeids()) = it->first.getRawString();
+            mRecentNodes.insert(it->second);
+        }
+
+        JLOG(journal_.trace())
+            << "Sending "
+            << (tmGL.itype() == protocol::liAS_NODE ? "AS" : "TX")
+            << " node request (" << tmGL.nodeids_size() << ") to "
+            << (to ? "selected peer" : "all peers");
+        mPeerSet->sendRequest(tmGL, to);
+    };
+
+    if (reason != TriggerReason::reply)
+    {
+        send(peer, nodes.begin(), nodes.end());
+        if (peer)
+            mRequests.onRequest(peer->id(), nodes.size(), now);
+        else
+        {
+            // Asking every peer for the same nodes uses none of the
+            // capacity planned for each
+            for (auto const id : peerIds)
+                mRequests.onBroadcast(id, now);
+        }
+        return true;
+    }
+
+    auto const batches = mRequests.schedule(
+        std::vector<Peer::id_t>(peerIds.begin(), peerIds.end()), nodes.size());
+
+    auto next = nodes.begin();
+    for (auto const& [id, count] : batches)
+    {
+        auto to = (peer && peer->id() == id)
+            ? peer
+            : app_.overlay().findPeerByShortID(id);
+        if (!to)
+            continue;
+
+        // If the peer has high latency, query extra deep
+        tmGL.set_querydepth(to->isHighLatency() ? 2 : 1);
+        send(to, next, next + count);
+        mRequests.onRequest(id, count, now);
+        next += count;
+    }
+
+    if (next != nodes.begin())
+        return true;
 
-    if (nodes.size() > limit)
-        nodes.resize(limit);
+    // Every peer already has as many requests in flight as it should, but
+    // the one that replied is still worth asking.
+    if (peer && mRequests.inFlight(peer->id()) == 0)
+    {
+        auto const count = std::min<std::size_t>(nodes.size(), reqNodesReply);
+        send(peer, nodes.begin(), nodes.begin() + count);
+        mRequests.onRequest(peer->id(), count, now);
+        return true;
+    }
 
-    for (auto const& n : nodes)
-        mRecentNodes.insert(n.second);
+    return false;
 }
 
 /** Take ledger header data
@@ -1177,6 +1267,8 @@ InboundLedger::processData(
     if ((packet.type() == protocol::liTX_NODE) ||
         (packet.type() == protocol::liAS_NODE))
     {
+        mRequests.onReply(peer->id(), m_clock.now());
+
         if (packet.nodes().size() == 0)
         {
             JLOG(journal_.info()) << "Got response with no nodes";
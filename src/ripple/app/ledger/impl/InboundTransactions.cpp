@@ -158,8 +158,10 @@ public:
             return;
         }
 
-        std::list<SHAMapNodeID> nodeIDs;
-        std::list<Blob> nodeData;
+        // The node data is used in place; the packet outlives takeNodes
+        std::vector<std::pair<SHAMapNodeID, Slice>> data;
+        data.reserve(packet.nodes().size());
+
         for (auto const& node : packet.nodes())
         {
             if (!node.has_nodeid() || !node.has_nodedata())
@@ -176,12 +178,10 @@ public:
                 return;
             }
 
-            nodeIDs.emplace_back(*id);
-            nodeData.emplace_back(
-                node.nodedata().begin(), node.nodedata().end());
+            data.emplace_back(*id, makeSlice(node.nodedata()));
         }
 
-        if (!ta->takeNodes(nodeIDs, nodeData, peer).isUseful())
+        if (!ta->takeNodes(data, peer).isUseful())
             peer->charge(Resource::feeUnwantedData);
     }
 
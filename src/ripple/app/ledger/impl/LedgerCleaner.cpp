@@ -70,6 +70,10 @@ class LedgerCleanerImp : public LedgerCleaner
     // Number of errors encountered since last success
     int failures_ = 0;
 
+    // Subtrees found to have all their nodes, shared by the ledgers checked.
+    // Only used by the cleaner thread.
+    SHAMapVisitedSet completeNodes_;
+
     //--------------------------------------------------------------------------
 public:
     LedgerCleanerImp(
@@ -254,6 +258,9 @@ private:
 
                 state_ = State::cleaning;
             }
+
+            // Nodes may have been deleted since the last run
+            completeNodes_.clear();
             doLedgerCleaner();
         }
 
@@ -323,7 +330,8 @@ private:
             doTxns = true;
         }
 
-        if (doNodes && !nodeLedger->walkLedger(app_.journal("Ledger")))
+        if (doNodes &&
+            !nodeLedger->walkLedger(app_.journal("Ledger"), &completeNodes_))
         {
             JLOG(j_.debug()) << "Ledger " << ledgerIndex << " is missing nodes";
             app_.getLedgerMaster().clearLedger(ledgerIndex);
@@ -204,6 +204,18 @@ LedgerMaster::LedgerMaster(
           std::chrono::seconds{45},
           stopwatch,
           app_.journal("TaggedCache"))
+    , fetch_pack_deltas_(
+          "FetchPackDelta",
+          0,
+          std::chrono::seconds{60},
+          stopwatch,
+          app_.journal("TaggedCache"))
+    , fetch_pack_replies_(
+          "FetchPackReply",
+          16,
+          std::chrono::seconds{30},
+          stopwatch,
+          app_.journal("TaggedCache"))
     , m_stats(std::bind(&LedgerMaster::collect_metrics, this), collector)
 {
 }
@@ -543,7 +555,7 @@ LedgerMaster::applyHeldTransactions()
         {
             ApplyFlags flags = tapNONE;
             auto const result =
-                app_.getTxQ().apply(app_, view, it.second, flags, j);
+                app_.getTxQ().reapply(app_, view, it.second, flags, j);
             if (result.second)
                 any = true;
         }
@@ -1843,6 +1855,27 @@ LedgerMaster::sweep()
 {
     mLedgerHistory.sweep();
     fetch_packs_.sweep();
+    fetch_pack_deltas_.sweep();
+    fetch_pack_replies_.sweep();
+
+    {
+        // Stop counting the fetch pack deltas that expired
+        auto const keys = fetch_pack_deltas_.getKeys();
+        hash_set<uint256> const cached(keys.begin(), keys.end());
+
+        std::lock_guard lock(fetch_pack_deltas_mutex_);
+        auto it = fetch_pack_delta_sizes_.begin();
+        while (it != fetch_pack_delta_sizes_.end())
+        {
+            if (cached.count(it->first) == 0)
+            {
+                fetch_pack_delta_bytes_ -= it->second;
+                it = fetch_pack_delta_sizes_.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
 }
 
 float
@@ -2198,6 +2231,76 @@ populateFetchPack(
         });
 }
 
+std::shared_ptr<protocol::TMGetObjectByHash>
+LedgerMaster::getFetchPackDelta(Ledger const& want, Ledger const& have)
+{
+    // The delta only depends on the ledger the requester has, since the
+    // ledger it wants is that ledger's parent
+    if (auto delta = fetch_pack_deltas_.fetch(have.info().hash))
+        return delta;
+
+    auto delta = std::make_shared<protocol::TMGetObjectByHash>();
+    std::uint32_t const lSeq = want.info().seq;
+
+    {
+        // Serialize the ledger header:
+        Serializer hdr(128);
+        hdr.add32(HashPrefix::ledgerMaster);
+        addRaw(want.info(), hdr);
+
+        // Add the data
+        protocol::TMIndexedObject* obj = delta->add_objects();
+        obj->set_hash(want.info().hash.data(), want.info().hash.size());
+        obj->set_data(hdr.getDataPtr(), hdr.getLength());
+        obj->set_ledgerseq(lSeq);
+    }
+
+    populateFetchPack(
+        want.stateMap(), &have.stateMap(), 16384, delta.get(), lSeq);
+
+    // We use nullptr here because transaction maps are per ledger
+    // and so the requestor is unlikely to already have it.
+    if (want.info().txHash.isNonZero())
+        populateFetchPack(want.txMap(), nullptr, 512, delta.get(), lSeq);
+
+    auto const bytes = delta->ByteSizeLong();
+    if (!fetch_pack_deltas_.canonicalize_replace_client(
+            have.info().hash, delta))
+    {
+        std::lock_guard lock(fetch_pack_deltas_mutex_);
+
+        // An expired delta may not have been swept yet: replace its size
+        auto const stale = std::find_if(
+            fetch_pack_delta_sizes_.begin(),
+            fetch_pack_delta_sizes_.end(),
+            [&](auto const& entry) {
+                return entry.first == have.info().hash;
+            });
+        if (stale != fetch_pack_delta_sizes_.end())
+        {
+            fetch_pack_delta_bytes_ -= stale->second;
+            fetch_pack_delta_sizes_.erase(stale);
+        }
+
+        fetch_pack_delta_sizes_.emplace_back(have.info().hash, bytes);
+        fetch_pack_delta_bytes_ += bytes;
+        shrinkFetchPackDeltas();
+    }
+    return delta;
+}
+
+void
+LedgerMaster::shrinkFetchPackDeltas()
+{
+    while (fetch_pack_delta_bytes_ > fetch_pack_limits_.cacheBytes)
+    {
+        auto const& [key, size] = fetch_pack_delta_sizes_.front();
+        fetch_pack_deltas_.del(key, false);
+        fetch_pack_delta_bytes_ -= size;
+        fetch_pack_delta_sizes_.pop_front();
+    }
+}
+
 void
 LedgerMaster::makeFetchPack(
     std::weak_ptr<Peer> const& wPeer,
@@ -2259,9 +2362,28 @@ LedgerMaster::makeFetchPack(
         return;
     }
 
+    // A reply echoing the requester's sequence number can't be shared
+    bool const shared = !request->has_seq();
+
+    if (shared)
+    {
+        if (auto msg = fetch_pack_replies_.fetch(haveLedgerHash))
+        {
+            JLOG(m_journal.debug()) << "Sending cached fetch pack for "
+                                    << have->info().seq;
+            peer->send(msg);
+            return;
+        }
+    }
+
+    auto const limits = [this]() {
+        std::lock_guard ml(m_mutex);
+        return fetch_pack_limits_;
+    }();
+
     try
     {
-        Serializer hdr(128);
+        auto const start = std::chrono::steady_clock::now();
 
         protocol::TMGetObjectByHash reply;
         reply.set_query(false);
@@ -2277,49 +2399,51 @@ LedgerMaster::makeFetchPack(
         //  2. Add the nodes for the AccountStateMap of that ledger.
         //  3. If there are transactions, add the nodes for the
         //     transactions of the ledger.
-        //  4. If the FetchPack now contains at least 512 entries then stop.
-        //  5. If not very much time has elapsed, then loop back and repeat
+        //  4. If the FetchPack now has as many objects as the object
+        //     budget allows, or is larger than the byte budget, then stop.
+        //  5. If the time budget isn't spent, then loop back and repeat
         //     the same process adding the previous ledger to the FetchPack.
+        //
+        // Steps 1 to 3 are done once per ledger and cached, so that packs
+        // for overlapping ranges of ledgers share the work.
+        bool full = false;
+        int ledgers = 0;
         do
         {
-            std::uint32_t lSeq = want->info().seq;
+            auto const delta = getFetchPackDelta(*want, *have);
+            reply.mutable_objects()->MergeFrom(delta->objects());
+            ++ledgers;
 
+            if (reply.objects().size() >= limits.objects ||
+                reply.ByteSizeLong() >= limits.bytes)
             {
-                // Serialize the ledger header:
-                hdr.erase();
-
-                hdr.add32(HashPrefix::ledgerMaster);
-                addRaw(want->info(), hdr);
-
-                // Add the data
-                protocol::TMIndexedObject* obj = reply.add_objects();
-                obj->set_hash(
-                    want->info().hash.data(), want->info().hash.size());
-                obj->set_data(hdr.getDataPtr(), hdr.getLength());
-                obj->set_ledgerseq(lSeq);
+                full = true;
+                break;
             }
 
-            populateFetchPack(
-                want->stateMap(), &have->stateMap(), 16384, &reply, lSeq);
-
-            // We use nullptr here because transaction maps are per ledger
-            // and so the requestor is unlikely to already have it.
-            if (want->info().txHash.isNonZero())
-                populateFetchPack(want->txMap(), nullptr, 512, &reply, lSeq);
-
-            if (reply.objects().size() >= 512)
+            if (std::chrono::steady_clock::now() - start > limits.buildTime ||
+                UptimeClock::now() > uptime + 1s)
                 break;
 
             have = std::move(want);
             want = getLedgerByHash(have->info().parentHash);
-        } while (want && UptimeClock::now() <= uptime + 1s);
+        } while (want);
 
         auto msg = std::make_shared<Message>(reply, protocol::mtGET_OBJECTS);
 
         JLOG(m_journal.info())
-            << "Built fetch pack with " << reply.objects().size() << " nodes ("
+            << "Built fetch pack with " << reply.objects().size()
+            << " nodes from " << ledgers << " ledgers ("
             << msg->getBufferSize() << " bytes)";
 
+        // Only a pack that reached its object or byte budget is kept. One
+        // cut short by the time budget can be filled out later from the
+        // cached ledgers, and one that ran out of ledgers may grow once
+        // we have more of them.
+        if (shared && full)
+            fetch_pack_replies_.canonicalize_replace_client(
+                haveLedgerHash, msg);
+
         peer->send(msg);
     }
     catch (std::exception const&)
@@ -2334,6 +2458,28 @@ LedgerMaster::getFetchPackCacheSize() const
     return fetch_packs_.getCacheSize();
 }
 
+void
+LedgerMaster::setFetchPackLimits(FetchPackLimits const& limits)
+{
+    std::lock_guard ml(m_mutex);
+    std::lock_guard lock(fetch_pack_deltas_mutex_);
+    fetch_pack_limits_ = limits;
+    shrinkFetchPackDeltas();
+}
+
+std::pair<std::size_t, std::size_t>
+LedgerMaster::getFetchPackDeltaCacheSize()
+{
+    std::lock_guard lock(fetch_pack_deltas_mutex_);
+    return {fetch_pack_delta_sizes_.size(), fetch_pack_delta_bytes_};
+}
+
+float
+LedgerMaster::getFetchPackDeltaHitRate()
+{
+    return fetch_pack_deltas_.getHitRate();
+}
+
 // Returns the minimum ledger sequence in SQL database, if any.
 std::optional<LedgerIndex>
 LedgerMaster::minSqlSeq()
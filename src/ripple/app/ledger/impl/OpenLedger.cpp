@@ -23,9 +23,7 @@
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/app/tx/apply.h>
 #include <ripple/ledger/CachedView.h>
-#include <ripple/overlay/Message.h>
 #include <ripple/overlay/Overlay.h>
-#include <ripple/overlay/predicates.h>
 #include <ripple/protocol/Feature.h>
 #include <boost/range/adaptor/transformed.hpp>
 
@@ -130,9 +128,15 @@ OpenLedger::accept(
     // Call the modifier
     if (f)
         f(*next, j_);
-    // Apply local tx
+    // Apply local tx. Most of them were also in the old open view and
+    // have just been applied again, which leaves nothing to do here but
+    // fail with tefALREADY, so skip those.
     for (auto const& item : locals)
-        app.getTxQ().apply(app, *next, item.second, flags, j_);
+    {
+        if (next->txExists(item.first.getTXID()))
+            continue;
+        app.getTxQ().reapply(app, *next, item.second, flags, j_);
+    }
 
     // If we didn't relay this transaction recently, relay it to all peers
     for (auto const& txpair : next->txs)
@@ -150,9 +154,7 @@ OpenLedger::accept(
             msg.set_status(protocol::tsNEW);
             msg.set_receivetimestamp(
                 app.timeKeeper().now().time_since_epoch().count());
-            app.overlay().foreach(send_if_not(
-                std::make_shared<Message>(msg, protocol::mtTRANSACTION),
-                peer_in_set(*toSkip)));
+            app.overlay().relay(txId, msg, *toSkip);
         }
     }
 
@@ -188,7 +190,7 @@ OpenLedger::apply_one(
         flags = flags | tapRETRY;
     auto const result = [&] {
         auto const queueResult =
-            app.getTxQ().apply(app, view, tx, flags | tapPREFER_QUEUE, j);
+            app.getTxQ().reapply(app, view, tx, flags | tapPREFER_QUEUE, j);
         // If the transaction can't get into the queue for intrinsic
         // reasons, and it can still be recovered, try to put it
         // directly into the open ledger, else drop it.
@@ -0,0 +1,241 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/impl/PeerRequestTracker.h>
+
+#include <algorithm>
+
+namespace ripple {
+
+PeerRequestTracker::seconds
+PeerRequestTracker::latency(PeerState const& state) const
+{
+    if (!state.measured)
+        return std::max<seconds>(state.latency, setup_.initialLatency);
+    return state.latency;
+}
+
+std::size_t
+PeerRequestTracker::batchSize(PeerState const& state) const
+{
+    // Probe a peer we know nothing about with a small request
+    if (!state.measured)
+        return setup_.minBatch;
+
+    auto const nodes = static_cast<std::size_t>(
+        state.throughput * seconds(setup_.batchTime).count());
+    return std::clamp(nodes, setup_.minBatch, setup_.maxBatch);
+}
+
+std::vector<PeerRequestTracker::Batch>
+PeerRequestTracker::schedule(
+    std::vector<Peer::id_t> const& peers,
+    std::size_t nodes) const
+{
+    struct Candidate
+    {
+        Peer::id_t id;
+        PeerState const& state;
+        std::size_t batch;
+        std::size_t queued;
+        std::size_t queuedNodes;
+    };
+
+    // When a request sent now to a peer is expected to be answered,
+    // after the ones already queued at the peer
+    auto const answer = [this](Candidate const& c) {
+        auto const lat = latency(c.state);
+        if (c.state.throughput <= 0)
+            return lat * (c.queued + 1);
+        return lat + seconds((c.queuedNodes + c.batch) / c.state.throughput);
+    };
+
+    static PeerState const unknown;
+
+    std::vector<Candidate> candidates;
+    candidates.reserve(peers.size());
+
+    auto best = seconds::max();
+    for (auto const id : peers)
+    {
+        auto const it = peers_.find(id);
+        auto const& state = (it == peers_.end()) ? unknown : it->second;
+        Candidate c{id, state, batchSize(state), 0, 0};
+
+        best = std::min(best, answer(c));
+
+        c.queued = state.requests;
+        c.queuedNodes = state.inFlightNodes;
+        if (c.queued < setup_.maxInFlight)
+            candidates.push_back(c);
+    }
+
+    std::vector<Batch> result;
+
+    if (inFlightNodes_ >= setup_.maxInFlightNodes)
+        return result;
+
+    auto budget = std::min(nodes, setup_.maxInFlightNodes - inFlightNodes_);
+    auto const cutoff = best * setup_.slowFactor;
+
+    while (budget != 0)
+    {
+        Candidate* next = nullptr;
+        for (auto& c : candidates)
+        {
+            if (c.queued < setup_.maxInFlight &&
+                (!next || answer(c) < answer(*next)))
+                next = &c;
+        }
+
+        if (!next || answer(*next) > cutoff)
+            break;
+
+        auto const n = std::min(next->batch, budget);
+        result.emplace_back(next->id, n);
+        budget -= n;
+        ++next->queued;
+        next->queuedNodes += n;
+    }
+
+    return result;
+}
+
+void
+PeerRequestTracker::onRequest(
+    Peer::id_t peer,
+    std::size_t nodes,
+    time_point now)
+{
+    auto& state = peers_[peer];
+    state.inFlight.push_back({now, nodes, state.inFlight.empty(), false});
+    ++state.requests;
+    state.inFlightNodes += nodes;
+    inFlightNodes_ += nodes;
+}
+
+void
+PeerRequestTracker::onBroadcast(Peer::id_t peer, time_point now)
+{
+    auto& state = peers_[peer];
+    state.inFlight.push_back({now, 0, state.inFlight.empty(), true});
+}
+
+bool
+PeerRequestTracker::onReply(Peer::id_t peer, time_point now)
+{
+    auto const it = peers_.find(peer);
+    if (it == peers_.end() || it->second.inFlight.empty())
+        return false;
+
+    auto& state = it->second;
+    auto const request = state.inFlight.front();
+    state.inFlight.pop_front();
+    if (request.broadcast)
+        return true;
+
+    --state.requests;
+    state.inFlightNodes -= request.nodes;
+    inFlightNodes_ -= request.nodes;
+
+    // A request sent while others were in flight also waited for those
+    // to be served, so it only tells us the latency is lower than we
+    // thought.
+    seconds const sample = now - request.sent;
+    if (!state.measured)
+        state.latency = sample;
+    else if (request.idle || sample < state.latency)
+        state.latency = (3 * state.latency + sample) / 4;
+
+    // While requests are pipelined, the peer serves this one from the
+    // time it answered the previous one.
+    auto const start =
+        state.measured ? std::max(request.sent, state.lastReply) : request.sent;
+    auto const busy =
+        std::max<seconds>(now - start, std::chrono::milliseconds{1});
+    auto const rate = request.nodes / busy.count();
+
+    if (!state.measured)
+        state.throughput = rate;
+    else
+        state.throughput = (3 * state.throughput + rate) / 4;
+
+    state.measured = true;
+    state.lastReply = now;
+    return true;
+}
+
+std::size_t
+PeerRequestTracker::expire(time_point now, std::chrono::milliseconds timeout)
+{
+    std::size_t expired = 0;
+
+    for (auto& entry : peers_)
+    {
+        auto& state = entry.second;
+        bool late = false;
+        while (!state.inFlight.empty() &&
+               (now - state.inFlight.front().sent) > timeout)
+        {
+            auto const request = state.inFlight.front();
+            state.inFlight.pop_front();
+            if (request.broadcast)
+                continue;
+
+            --state.requests;
+            state.inFlightNodes -= request.nodes;
+            inFlightNodes_ -= request.nodes;
+            late = true;
+            ++expired;
+        }
+
+        if (late)
+        {
+            state.latency = std::max<seconds>(2 * latency(state), timeout);
+            state.measured = true;
+        }
+    }
+
+    return expired;
+}
+
+std::size_t
+PeerRequestTracker::inFlight(Peer::id_t peer) const
+{
+    auto const it = peers_.find(peer);
+    return (it == peers_.end()) ? 0 : it->second.requests;
+}
+
+std::chrono::milliseconds
+PeerRequestTracker::latency(Peer::id_t peer) const
+{
+    static PeerState const unknown;
+    auto const it = peers_.find(peer);
+    return std::chrono::round<std::chrono::milliseconds>(
+        latency((it == peers_.end()) ? unknown : it->second));
+}
+
+double
+PeerRequestTracker::throughput(Peer::id_t peer) const
+{
+    auto const it = peers_.find(peer);
+    return (it == peers_.end()) ? 0 : it->second.throughput;
+}
+
+}  // namespace ripple
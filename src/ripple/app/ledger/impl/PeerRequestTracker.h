@@ -0,0 +1,184 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_PEERREQUESTTRACKER_H_INCLUDED
+#define RIPPLE_APP_LEDGER_PEERREQUESTTRACKER_H_INCLUDED
+
+#include <ripple/overlay/Peer.h>
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace ripple {
+
+/** Splits the node requests of a ledger acquisition across peers.
+
+    For every peer asked, keeps the requests still in flight along with
+    estimates of the peer's round trip latency and of the rate at which
+    it serves requested nodes, updated as the replies arrive. The missing
+    nodes are split into batches sized to each peer's rate and handed out
+    to the peers expected to answer first, counting the requests already
+    queued at each: fast peers get several pipelined requests while slow
+    peers get few or none.
+
+    Replies carry no identifier of the request they answer (the cookie
+    routes indirect queries), so a reply completes the oldest request
+    in flight to the peer. Requests sent to the whole peer set are kept
+    in that order too, so that their replies are not taken for replies to
+    the requests planned here, but they take no share of a peer's
+    capacity and their replies do not update the estimates.
+
+    The caller serializes access.
+*/
+class PeerRequestTracker
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+    using time_point = clock_type::time_point;
+
+    struct Setup
+    {
+        // Requests in flight to any one peer
+        std::size_t maxInFlight = 8;
+
+        // Nodes in flight across all the peers
+        std::size_t maxInFlightNodes = 1024;
+
+        // Bounds on the number of nodes in one request
+        std::size_t minBatch = 8;
+        std::size_t maxBatch = 128;
+
+        // A batch holds what the peer is expected to serve in this time
+        std::chrono::milliseconds batchTime{200};
+
+        // Requests expected to be answered this many times later than a
+        // request to the best peer would be are not made
+        std::size_t slowFactor = 4;
+
+        // Latency assumed for a peer which has not replied yet
+        std::chrono::milliseconds initialLatency{250};
+    };
+
+    /** A request to make: the peer and the number of nodes to ask for. */
+    using Batch = std::pair<Peer::id_t, std::size_t>;
+
+    PeerRequestTracker() = default;
+
+    explicit PeerRequestTracker(Setup const& setup) : setup_(setup)
+    {
+    }
+
+    /** Split up to `nodes` nodes into requests to some of `peers`.
+
+        Only plans: call `onRequest` for each batch actually sent.
+    */
+    std::vector<Batch>
+    schedule(std::vector<Peer::id_t> const& peers, std::size_t nodes) const;
+
+    /** Record a request for `nodes` nodes sent to a peer. */
+    void
+    onRequest(Peer::id_t peer, std::size_t nodes, time_point now);
+
+    /** Record a request sent to a peer along with the rest of the set. */
+    void
+    onBroadcast(Peer::id_t peer, time_point now);
+
+    /** Record a reply from a peer.
+
+        @return `false` if no request to the peer was in flight.
+    */
+    bool
+    onReply(Peer::id_t peer, time_point now);
+
+    /** Give up on the requests in flight for longer than `timeout`.
+
+        The latency estimate of a peer which did not answer a request
+        made to it in time is at least doubled, so the peer is asked less,
+        if at all, from now on. Broadcasts are given up on silently.
+
+        @return The number of requests, not counting broadcasts, given up
+                on.
+    */
+    std::size_t
+    expire(time_point now, std::chrono::milliseconds timeout);
+
+    /** Requests, not counting broadcasts, in flight to a peer. */
+    std::size_t
+    inFlight(Peer::id_t peer) const;
+
+    /** Nodes in flight across all the peers. */
+    std::size_t
+    inFlightNodes() const
+    {
+        return inFlightNodes_;
+    }
+
+    /** Estimated round trip latency of a peer. */
+    std::chrono::milliseconds
+    latency(Peer::id_t peer) const;
+
+    /** Estimated rate at which a peer serves requested nodes, per second.
+
+        Zero until the peer replies.
+    */
+    double
+    throughput(Peer::id_t peer) const;
+
+private:
+    using seconds = std::chrono::duration<double>;
+
+    struct Request
+    {
+        time_point sent;
+        std::size_t nodes;
+        // Nothing else was in flight to the peer when the request was sent
+        bool idle;
+        // Sent to the whole peer set rather than planned by schedule
+        bool broadcast;
+    };
+
+    struct PeerState
+    {
+        // Requests and broadcasts, in the order they were sent
+        std::deque<Request> inFlight;
+        std::size_t requests = 0;
+        std::size_t inFlightNodes = 0;
+        seconds latency{0};
+        double throughput = 0;
+        time_point lastReply;
+        bool measured = false;
+    };
+
+    seconds
+    latency(PeerState const& state) const;
+
+    std::size_t
+    batchSize(PeerState const& state) const;
+
+    Setup const setup_{};
+    std::map<Peer::id_t, PeerState> peers_;
+    std::size_t inFlightNodes_ = 0;
+};
+
+}  // namespace ripple
+
+#endif
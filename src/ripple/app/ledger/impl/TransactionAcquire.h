@@ -42,10 +42,13 @@ public:
         std::unique_ptr<PeerSet> peerSet);
     ~TransactionAcquire() = default;
 
+    /** Add received nodes to the set.
+
+        @param data The IDs of the nodes and views of their wire data.
+    */
     SHAMapAddNode
     takeNodes(
-        const std::list<SHAMapNodeID>& IDs,
-        const std::list<Blob>& data,
+        std::vector<std::pair<SHAMapNodeID, Slice>> const& data,
         std::shared_ptr<Peer> const&);
 
     void
@@ -479,6 +479,7 @@ public:
 
         // VFALCO HACK
         m_nodeStoreScheduler.setJobQueue(*m_jobQueue);
+        m_nodeStoreScheduler.setCollector(m_collectorManager->collector());
 
         add(m_ledgerMaster->getPropertySource());
     }
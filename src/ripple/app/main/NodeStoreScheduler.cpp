@@ -33,6 +33,18 @@ NodeStoreScheduler::setJobQueue(JobQueue& jobQueue)
     m_jobQueue = &jobQueue;
 }
 
+void
+NodeStoreScheduler::setCollector(
+    beast::insight::Collector::ptr const& collector)
+{
+    m_writeQueue = collector->make_gauge("nodestore", "write_queue");
+    m_writeBatchLimit =
+        collector->make_gauge("nodestore", "write_batch_limit");
+    m_writeBatch = collector->make_event("nodestore", "write_batch");
+    m_writesCoalesced =
+        collector->make_counter("nodestore", "writes_coalesced");
+}
+
 void
 NodeStoreScheduler::onStop()
 {
@@ -89,6 +101,13 @@ void
 NodeStoreScheduler::onBatchWrite(NodeStore::BatchWriteReport const& report)
 {
     m_jobQueue->addLoadEvents(jtNS_WRITE, report.writeCount, report.elapsed);
+
+    m_writeBatch.notify(report.elapsed);
+    m_writeQueue = report.queueDepth;
+    if (report.batchLimit != 0)
+        m_writeBatchLimit = report.batchLimit;
+    if (report.coalesced != 0)
+        m_writesCoalesced.increment(report.coalesced);
 }
 
 }  // namespace ripple
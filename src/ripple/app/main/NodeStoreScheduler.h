@@ -20,6 +20,7 @@
 #ifndef RIPPLE_APP_MAIN_NODESTORESCHEDULER_H_INCLUDED
 #define RIPPLE_APP_MAIN_NODESTORESCHEDULER_H_INCLUDED
 
+#include <ripple/beast/insight/Insight.h>
 #include <ripple/core/JobQueue.h>
 #include <ripple/core/Stoppable.h>
 #include <ripple/nodestore/Scheduler.h>
@@ -40,6 +41,10 @@ public:
     void
     setJobQueue(JobQueue& jobQueue);
 
+    /** Publish batch write metrics through the collector. */
+    void
+    setCollector(beast::insight::Collector::ptr const& collector);
+
     void
     onStop() override;
     void
@@ -57,6 +62,12 @@ private:
 
     JobQueue* m_jobQueue{nullptr};
     std::atomic<int> m_taskCount{0};
+
+    // Batch write metrics, inert until a collector is set
+    beast::insight::Gauge m_writeQueue;
+    beast::insight::Gauge m_writeBatchLimit;
+    beast::insight::Event m_writeBatch;
+    beast::insight::Counter m_writesCoalesced;
 };
 
 }  // namespace ripple
@@ -363,6 +363,10 @@ public:
     recvValidation(
         std::shared_ptr<STValidation> const& val,
         std::string const& source) override;
+    std::vector<std::optional<bool>>
+    recvValidations(
+        std::vector<std::shared_ptr<STValidation>> const& vals,
+        std::string const& source) override;
 
     std::shared_ptr<SHAMap>
     getTXMap(uint256 const& hash);
@@ -1367,9 +1371,7 @@ NetworkOPsImp::apply(std::unique_lock<std::mutex>& batchLock)
                         app_.timeKeeper().now().time_since_epoch().count());
                     tx.set_deferred(e.result == terQUEUED);
                     // FIXME: This should be when we received it
-                    app_.overlay().foreach(send_if_not(
-                        std::make_shared<Message>(tx, protocol::mtTRANSACTION),
-                        peer_in_set(*toSkip)));
+                    app_.overlay().relay(e.transaction->getID(), tx, *toSkip);
                     e.transaction->setBroadcast();
                 }
             }
@@ -2162,6 +2164,41 @@ NetworkOPsImp::recvValidation(
     return app_.config().RELAY_UNTRUSTED_VALIDATIONS || val->isTrusted();
 }
 
+std::vector<std::optional<bool>>
+NetworkOPsImp::recvValidations(
+    std::vector<std::shared_ptr<STValidation>> const& vals,
+    std::string const& source)
+{
+    JLOG(m_journal.trace())
+        << "recvValidations " << vals.size() << " from " << source;
+
+    auto const handled = handleNewValidations(app_, vals, source);
+
+    std::vector<std::optional<bool>> relay(vals.size());
+    for (std::size_t i = 0; i < vals.size(); ++i)
+    {
+        if (!handled[i])
+            continue;
+
+        try
+        {
+            pubValidation(vals[i]);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(m_journal.warn())
+                << "Exception publishing validation: " << e.what();
+            continue;
+        }
+
+        // We will always relay trusted validations; if configured, we will
+        // also relay all untrusted validations.
+        relay[i] =
+            app_.config().RELAY_UNTRUSTED_VALIDATIONS || vals[i]->isTrusted();
+    }
+    return relay;
+}
+
 Json::Value
 NetworkOPsImp::getConsensusInfo()
 {
@@ -31,7 +31,9 @@
 #include <boost/asio.hpp>
 #include <deque>
 #include <memory>
+#include <optional>
 #include <tuple>
+#include <vector>
 
 namespace ripple {
 
@@ -176,6 +178,18 @@ public:
         std::shared_ptr<STValidation> const& val,
         std::string const& source) = 0;
 
+    /** Handle a batch of validations received from peers.
+
+        A validation which fails to be processed does not affect the others.
+
+        @return For each validation, in order, whether it should be relayed,
+                or nothing if processing it threw.
+    */
+    virtual std::vector<std::optional<bool>>
+    recvValidations(
+        std::vector<std::shared_ptr<STValidation>> const& vals,
+        std::string const& source) = 0;
+
     virtual void
     mapComplete(std::shared_ptr<SHAMap> const& map, bool fromAcquire) = 0;
 
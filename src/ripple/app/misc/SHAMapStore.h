@@ -43,6 +43,10 @@ public:
     virtual void
     onLedgerClosed(std::shared_ptr<Ledger const> const& ledger) = 0;
 
+    /** Called by InboundLedger when a ledger was acquired from peers. */
+    virtual void
+    onLedgerAcquired(LedgerIndex seq) = 0;
+
     virtual void
     rendezvous() const = 0;
 
@@ -141,6 +141,18 @@ SHAMapStoreImp::SHAMapStoreImp(
             recoveryWaitTime_.emplace(std::chrono::seconds{temp});
 
         get_if_exists(section, "advisory_delete", advisoryDelete_);
+        get_if_exists(section, "delta_rotation", deltaRotation_);
+        get_if_exists(section, "rotation_threads", rotationThreads_);
+        if (rotationThreads_ < 1 ||
+            rotationThreads_ > static_cast<int>(SHAMap::branchFactor))
+        {
+            Throw<std::runtime_error>(
+                "rotation_threads must be between 1 and " +
+                std::to_string(SHAMap::branchFactor));
+        }
+        for (auto& copied : copied_)
+            copied = std::make_unique<SHAMapVisitedSet>(
+                SHAMapVisitedSet::defaultCapacity / SHAMap::branchFactor);
 
         auto const minInterval = config.standalone()
             ? minimumDeletionIntervalSA_
@@ -230,6 +242,15 @@ SHAMapStoreImp::onLedgerClosed(std::shared_ptr<Ledger const> const& ledger)
     cond_.notify_one();
 }
 
+void
+SHAMapStoreImp::onLedgerAcquired(LedgerIndex seq)
+{
+    auto acquired = maxAcquired_.load();
+    while (acquired < seq &&
+           !maxAcquired_.compare_exchange_weak(acquired, seq))
+        ;
+}
+
 void
 SHAMapStoreImp::rendezvous() const
 {
@@ -247,17 +268,143 @@ SHAMapStoreImp::fdRequired() const
 }
 
 bool
-SHAMapStoreImp::copyNode(std::uint64_t& nodeCount, SHAMapTreeNode const& node)
+SHAMapStoreImp::copyBatch(std::vector<uint256>& batch)
 {
-    // Copy a single record from node to dbRotating_
-    dbRotating_->fetchNodeObject(node.getHash().as_uint256());
-    if (!(++nodeCount % checkHealthInterval_))
+    if (copyThrottle_)
+        std::this_thread::sleep_for(backOff_);
+
+    // The subtrees these nodes complete may already be recorded as
+    // copied, so the batch is written even when the copy stops
+    dbRotating_->copyToWritable(batch);
+    batch.clear();
+    return !copyAbort_;
+}
+
+bool
+SHAMapStoreImp::copyInParallel(std::function<void()> const& work)
+{
+    copyAbort_ = false;
+    copyThrottle_ = false;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    int running = rotationThreads_;
+
+    std::vector<std::thread> threads;
+    threads.reserve(rotationThreads_);
+    for (int i = 0; i < rotationThreads_; ++i)
     {
-        if (health())
-            return false;
+        threads.emplace_back([&, i] {
+            beast::setCurrentThreadName("SHAMapCopy:" + std::to_string(i));
+            work();
+            {
+                std::lock_guard lock(mutex);
+                --running;
+            }
+            cond.notify_one();
+        });
+    }
+
+    // health() may sleep, so it is only called from this thread. The copy
+    // threads back off while the node is struggling and stop once it is
+    // unhealthy.
+    {
+        std::unique_lock lock(mutex);
+        while (!cond.wait_for(lock, backOff_, [&] { return running == 0; }))
+        {
+            lock.unlock();
+            copyThrottle_ =
+                netOPs_->getOperatingMode() != OperatingMode::FULL ||
+                ledgerMaster_->getValidatedLedgerAge() > throttleAge_;
+            if (health())
+                copyAbort_ = true;
+            lock.lock();
+        }
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    return copyAbort_;
+}
+
+void
+SHAMapStoreImp::copyState(
+    Ledger const& validatedLedger,
+    std::uint64_t& nodeCount)
+{
+    auto const stateMap = validatedLedger.stateMap().snapShot(false);
+
+    // Nodes that differ from the base ledger's state were created by later
+    // ledgers, which stored them in the current writable backend. Only the
+    // part of the state that is still shared with the base may be missing.
+    // That does not hold for ledgers acquired from peers, which store only
+    // the nodes they could not find locally.
+    std::shared_ptr<Ledger const> base;
+    if (deltaRotation_ && deltaBase_ &&
+        deltaBase_ < validatedLedger.info().seq)
+    {
+        if (maxAcquired_ < deltaBase_)
+        {
+            base = ledgerMaster_->getLedgerBySeq(deltaBase_);
+        }
+        else
+        {
+            JLOG(journal_.debug())
+                << "ledger " << maxAcquired_ << " was acquired after ledger "
+                << deltaBase_ << ", copying the full state";
+        }
     }
 
-    return true;
+    std::shared_ptr<SHAMap> baseMap;
+    if (base)
+    {
+        JLOG(journal_.debug())
+            << "copying ledger " << validatedLedger.info().seq
+            << " nodes shared with ledger " << deltaBase_;
+        baseMap = base->stateMap().snapShot(false);
+    }
+    else
+    {
+        JLOG(journal_.debug())
+            << "copying ledger " << validatedLedger.info().seq;
+
+        std::vector<uint256> root{stateMap->getHash().as_uint256()};
+        copyBatch(root);
+        ++nodeCount;
+    }
+
+    // Each thread takes whole branches of the root until none are left
+    std::atomic<int> nextBranch{0};
+    std::atomic<std::uint64_t> copied{0};
+    copyInParallel([&] {
+        std::vector<uint256> batch;
+        batch.reserve(copyBatchSize_);
+        std::uint64_t count = 0;
+        auto const copy = [&](SHAMapTreeNode const& node, bool fetched) {
+            ++count;
+            // Reading a node from the archive backend stores it in the
+            // writable one, so only the nodes found in memory are copied
+            if (fetched)
+                return !copyAbort_.load();
+            batch.push_back(node.getHash().as_uint256());
+            return batch.size() < copyBatchSize_ || copyBatch(batch);
+        };
+
+        for (int branch = nextBranch++;
+             branch < static_cast<int>(SHAMap::branchFactor) && !copyAbort_;
+             branch = nextBranch++)
+        {
+            auto const copied = copied_[branch].get();
+            if (baseMap)
+                stateMap->visitCommon(*baseMap, copy, branch, copied);
+            else
+                stateMap->visitBranch(branch, copy, copied);
+        }
+        copyBatch(batch);
+        copied += count;
+    });
+    nodeCount += copied;
 }
 
 void
@@ -333,13 +480,8 @@ SHAMapStoreImp::run()
                 default:;
             }
 
-            JLOG(journal_.debug()) << "copying ledger " << validatedSeq;
             std::uint64_t nodeCount = 0;
-            validatedLedger->stateMap().snapShot(false)->visitNodes(std::bind(
-                &SHAMapStoreImp::copyNode,
-                this,
-                std::ref(nodeCount),
-                std::placeholders::_1));
+            copyState(*validatedLedger, nodeCount);
             switch (health())
             {
                 case Health::stopping:
@@ -400,6 +542,16 @@ SHAMapStoreImp::run()
 
                     return std::move(newBackend);
                 });
+            for (auto& copied : copied_)
+                copied->clear();
+
+            if (deltaRotation_)
+            {
+                // The next ledger to close may already be storing its nodes
+                // in the previous writable backend, so start after it.
+                if (auto const closed = ledgerMaster_->getClosedLedger())
+                    deltaBase_ = closed->info().seq + 1;
+            }
 
             JLOG(journal_.warn()) << "finished rotation " << validatedSeq;
         }
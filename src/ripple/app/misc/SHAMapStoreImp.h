@@ -27,6 +27,8 @@
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/core/Stoppable.h>
 #include <ripple/nodestore/DatabaseRotating.h>
+#include <ripple/shamap/SHAMapVisitedSet.h>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
@@ -76,8 +78,8 @@ private:
     std::string const dbName_ = "state";
     // prefix of on-disk nodestore backend instances
     std::string const dbPrefix_ = "rippledb";
-    // check health/stop status as records are copied
-    std::uint64_t const checkHealthInterval_ = 1000;
+    // records copied per batch written to the writable backend
+    std::size_t const copyBatchSize_ = 256;
     // minimum # of ledgers to maintain for health of network
     static std::uint32_t const minimumDeletionInterval_ = 256;
     // minimum # of ledgers required for standalone mode.
@@ -102,9 +104,30 @@ private:
 
     std::uint32_t deleteInterval_ = 0;
     bool advisoryDelete_ = false;
+    // Only copy the part of the state that is unchanged since deltaBase_.
+    bool deltaRotation_ = false;
+    // Every ledger after this one was built after the last rotation, so
+    // all nodes it created are in the writable backend. Zero if unknown.
+    LedgerIndex deltaBase_ = 0;
+    // Highest ledger acquired from peers. An acquired ledger may use nodes
+    // found in the tree node cache without storing them again, so the full
+    // state is copied if it is not older than deltaBase_.
+    std::atomic<LedgerIndex> maxAcquired_{0};
     std::uint32_t deleteBatch_ = 100;
     std::chrono::milliseconds backOff_{100};
     std::chrono::seconds ageThreshold_{60};
+    // slow down copying once the validated ledger is this old
+    std::chrono::seconds const throttleAge_{10};
+    // threads copying state and freshening caches during rotation
+    int rotationThreads_ = 4;
+    // set by run() to make the copy threads stop early or back off
+    std::atomic<bool> copyAbort_{false};
+    std::atomic<bool> copyThrottle_{false};
+    // Subtrees of the state known to be in the writable backend, one set
+    // per branch of the root, for the thread copying that branch. A copy
+    // cut short by a health check resumes from them on the next ledger.
+    std::array<std::unique_ptr<SHAMapVisitedSet>, SHAMap::branchFactor>
+        copied_;
     /// If set, and the node is out of sync during an
     /// online_delete health check, sleep the thread
     /// for this time and check again so the node can
@@ -177,6 +200,9 @@ public:
     void
     onLedgerClosed(std::shared_ptr<Ledger const> const& ledger) override;
 
+    void
+    onLedgerAcquired(LedgerIndex seq) override;
+
     void
     rendezvous() const override;
     int
@@ -186,9 +212,17 @@ public:
     minimumOnline() const override;
 
 private:
-    // callback for visitNodes
+    // copy one batch of records to the writable backend and clear it.
+    // Returns false if the copy has been aborted, after copying the batch.
     bool
-    copyNode(std::uint64_t& nodeCount, SHAMapTreeNode const& node);
+    copyBatch(std::vector<uint256>& batch);
+    // Run work on rotationThreads_ threads while checking health from
+    // this one. Returns true if the work was aborted.
+    bool
+    copyInParallel(std::function<void()> const& work);
+    // copy the validated state into the writable backend
+    void
+    copyState(Ledger const& validatedLedger, std::uint64_t& nodeCount);
     void
     run();
     void
@@ -201,16 +235,21 @@ private:
     bool
     freshenCache(CacheInstance& cache)
     {
-        std::uint64_t check = 0;
-
-        for (auto const& key : cache.getKeys())
-        {
-            dbRotating_->fetchNodeObject(key);
-            if (!(++check % checkHealthInterval_) && health())
-                return true;
-        }
-
-        return false;
+        auto const keys = cache.getKeys();
+        std::atomic<std::size_t> next{0};
+
+        return copyInParallel([&] {
+            std::vector<uint256> batch;
+            batch.reserve(copyBatchSize_);
+            for (auto i = next.fetch_add(copyBatchSize_); i < keys.size();
+                 i = next.fetch_add(copyBatchSize_))
+            {
+                auto const end = std::min(i + copyBatchSize_, keys.size());
+                batch.assign(keys.begin() + i, keys.begin() + end);
+                if (!copyBatch(batch))
+                    return;
+            }
+        });
     }
 
     /** delete from sqlite table in batches to not lock the db excessively.
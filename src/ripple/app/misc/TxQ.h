@@ -21,6 +21,7 @@
 #define RIPPLE_TXQ_H_INCLUDED
 
 #include <ripple/app/tx/applySteps.h>
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/ledger/ApplyView.h>
 #include <ripple/ledger/OpenView.h>
 #include <ripple/protocol/STTx.h>
@@ -28,6 +29,7 @@
 #include <ripple/protocol/TER.h>
 #include <boost/circular_buffer.hpp>
 #include <boost/intrusive/set.hpp>
+#include <atomic>
 #include <optional>
 
 namespace ripple {
@@ -274,6 +276,35 @@ public:
         ApplyFlags flags,
         beast::Journal j);
 
+    /**
+        Submit a transaction again after the ledger it was applied to,
+        held for or retried in has closed.
+
+        Same as @ref apply, but the preflight result is remembered, so
+        that submitting the transaction again after the following close
+        does not repeat preflight.
+    */
+    std::pair<TER, bool>
+    reapply(
+        Application& app,
+        OpenView& view,
+        std::shared_ptr<STTx const> const& tx,
+        ApplyFlags flags,
+        beast::Journal j);
+
+    /** Whether a preflight result for the transaction, rules and flags
+        is remembered. Only useful for testing.
+    */
+    bool
+    preflightCached(TxID const& txID, Rules const& rules, ApplyFlags flags)
+        const;
+
+    /** Number of preflight results reused by @ref reapply. Only useful
+        for testing.
+    */
+    std::uint64_t
+    preflightReused() const;
+
     /**
         Fill the new open ledger with transactions from the queue.
 
@@ -708,6 +739,7 @@ private:
         OpenView& view,
         std::shared_ptr<STTx const> const& tx,
         ApplyFlags flags,
+        bool resubmit,
         beast::Journal j);
 
     // Helper function that removes a replaced entry in _byFee.
@@ -757,12 +789,80 @@ private:
     */
     std::optional<size_t> maxSize_;
 
+    /** Lock-free summary of the queue and the fee metrics.
+
+        Republished by @ref publishMetrics every time the queue or the
+        metrics change, so that @ref getMetrics (and therefore the RPC
+        "fee" command) never has to wait for `apply`, `accept` or
+        `processClosedLedger` to release mutex_.
+
+        The fields are individually atomic but not collectively
+        consistent. A reader racing with a writer may see, for example,
+        a new transaction count with an old minimum fee level. That is
+        acceptable because the metrics are only advisory and are already
+        stale by the time they reach the client.
+    */
+    struct PublishedMetrics
+    {
+        std::atomic<std::size_t> txCount{0};
+        std::atomic<bool> hasMaxSize{false};
+        std::atomic<std::size_t> maxSize{0};
+        /// Fee level of the cheapest queued transaction
+        std::atomic<std::uint64_t> lowestFeeLevel{0};
+        std::atomic<std::size_t> txnsExpected{0};
+        std::atomic<std::uint64_t> escalationMultiplier{0};
+    };
+    PublishedMetrics published_;
+
     /** Most queue operations are done under the master lock,
         but use this mutex for the RPC "fee" command, which isn't.
     */
     std::mutex mutable mutex_;
 
+    /** Preflight results of resubmitted transactions.
+
+        Held and retried transactions are submitted again after every
+        close, through `reapply`. Their preflight result depends only on
+        the transaction, the flags and the rules, so it is remembered
+        instead of being recomputed. Entries survive one to two closes:
+        the older generation is discarded by `processClosedLedger`.
+    */
+    struct CachedPreflight
+    {
+        Rules rules;
+        ApplyFlags flags;
+        std::pair<NotTEC, TxConsequences> result;
+    };
+    hash_map<TxID, CachedPreflight> preflightCache_;
+    hash_map<TxID, CachedPreflight> preflightCacheOld_;
+    std::uint64_t preflightReused_ = 0;
+    /// Protects the preflight caches. Never locked together with mutex_.
+    std::mutex mutable preflightMutex_;
+
 private:
+    /// Shared implementation of `apply` and `reapply`.
+    std::pair<TER, bool>
+    apply(
+        Application& app,
+        OpenView& view,
+        std::shared_ptr<STTx const> const& tx,
+        ApplyFlags flags,
+        bool resubmit,
+        beast::Journal j);
+
+    /// `preflight`, reusing a cached result for the same inputs if any.
+    PreflightResult
+    cachedPreflight(
+        Application& app,
+        Rules const& rules,
+        STTx const& tx,
+        ApplyFlags flags,
+        beast::Journal j);
+
+    /// Refresh published_ from the locked state.
+    void
+    publishMetrics(std::lock_guard<std::mutex> const&);
+
     /// Is the queue at least `fillPercentage` full?
     template <size_t fillPercentage = 100>
     bool
@@ -350,6 +350,8 @@ TxQ::TxQAccount::remove(SeqProxy seqProx)
 TxQ::TxQ(Setup const& setup, beast::Journal j)
     : setup_(setup), j_(j), feeMetrics_(setup, j), maxSize_(std::nullopt)
 {
+    std::lock_guard lock(mutex_);
+    publishMetrics(lock);
 }
 
 TxQ::~TxQ()
@@ -357,6 +359,86 @@ TxQ::~TxQ()
     byFee_.clear();
 }
 
+PreflightResult
+TxQ::cachedPreflight(
+    Application& app,
+    Rules const& rules,
+    STTx const& tx,
+    ApplyFlags flags,
+    beast::Journal j)
+{
+    auto const txID = tx.getTransactionID();
+    {
+        std::lock_guard lock(preflightMutex_);
+        auto iter = preflightCache_.find(txID);
+        if (iter == preflightCache_.end())
+        {
+            // Seen in the previous generation: keep it for another one.
+            auto const old = preflightCacheOld_.find(txID);
+            if (old != preflightCacheOld_.end())
+                iter = preflightCache_.emplace(txID, old->second).first;
+        }
+        if (iter != preflightCache_.end() && iter->second.rules == rules &&
+            iter->second.flags == flags)
+        {
+            ++preflightReused_;
+            return reusePreflight(
+                app, rules, tx, flags, iter->second.result, j);
+        }
+    }
+
+    auto pfresult = preflight(app, rules, tx, flags, j);
+    if (pfresult.ter != tefEXCEPTION)
+    {
+        std::lock_guard lock(preflightMutex_);
+        preflightCache_.insert_or_assign(
+            txID,
+            CachedPreflight{
+                rules, flags, {pfresult.ter, pfresult.consequences}});
+    }
+    return pfresult;
+}
+
+bool
+TxQ::preflightCached(TxID const& txID, Rules const& rules, ApplyFlags flags)
+    const
+{
+    std::lock_guard lock(preflightMutex_);
+    for (auto const* cache : {&preflightCache_, &preflightCacheOld_})
+    {
+        if (auto const iter = cache->find(txID); iter != cache->end())
+            return iter->second.rules == rules && iter->second.flags == flags;
+    }
+    return false;
+}
+
+std::uint64_t
+TxQ::preflightReused() const
+{
+    std::lock_guard lock(preflightMutex_);
+    return preflightReused_;
+}
+
+void
+TxQ::publishMetrics(std::lock_guard<std::mutex> const&)
+{
+    auto const snapshot = feeMetrics_.getSnapshot();
+
+    // Relaxed ordering is enough: every field stands on its own, and
+    // the writers are already serialized by mutex_.
+    published_.txCount.store(byFee_.size(), std::memory_order_relaxed);
+    published_.hasMaxSize.store(
+        maxSize_.has_value(), std::memory_order_relaxed);
+    published_.maxSize.store(maxSize_.value_or(0), std::memory_order_relaxed);
+    published_.lowestFeeLevel.store(
+        byFee_.empty() ? 0 : byFee_.rbegin()->feeLevel.value(),
+        std::memory_order_relaxed);
+    published_.txnsExpected.store(
+        snapshot.txnsExpected, std::memory_order_relaxed);
+    published_.escalationMultiplier.store(
+        snapshot.escalationMultiplier.value(), std::memory_order_relaxed);
+}
+
 template <size_t fillPercentage>
 bool
 TxQ::isFull() const
@@ -729,12 +811,36 @@ TxQ::apply(
     std::shared_ptr<STTx const> const& tx,
     ApplyFlags flags,
     beast::Journal j)
+{
+    return apply(app, view, tx, flags, false, j);
+}
+
+std::pair<TER, bool>
+TxQ::reapply(
+    Application& app,
+    OpenView& view,
+    std::shared_ptr<STTx const> const& tx,
+    ApplyFlags flags,
+    beast::Journal j)
+{
+    return apply(app, view, tx, flags, true, j);
+}
+
+std::pair<TER, bool>
+TxQ::apply(
+    Application& app,
+    OpenView& view,
+    std::shared_ptr<STTx const> const& tx,
+    ApplyFlags flags,
+    bool resubmit,
+    beast::Journal j)
 {
     STAmountSO stAmountSO{view.rules().enabled(fixSTAmountCanonicalize)};
 
     // See if the transaction paid a high enough fee that it can go straight
     // into the ledger.
-    if (auto directApplied = tryDirectApply(app, view, tx, flags, j))
+    if (auto directApplied =
+            tryDirectApply(app, view, tx, flags, resubmit, j))
         return *directApplied;
 
     // If we get past tryDirectApply() without returning then we expect
@@ -747,7 +853,9 @@ TxQ::apply(
     // See if the transaction is valid, properly formed,
     // etc. before doing potentially expensive queue
     // replace and multi-transaction operations.
-    auto const pfresult = preflight(app, view.rules(), *tx, flags, j);
+    auto const pfresult = resubmit
+        ? cachedPreflight(app, view.rules(), *tx, flags, j)
+        : preflight(app, view.rules(), *tx, flags, j);
     if (pfresult.ter != tesSUCCESS)
         return {pfresult.ter, false};
 
@@ -1202,6 +1310,7 @@ TxQ::apply(
             /* Can't erase (*replacedTxIter) here because success
                 implies that it has already been deleted.
             */
+            publishMetrics(lock);
             return result;
         }
     }
@@ -1322,6 +1431,7 @@ TxQ::apply(
                      << candidate.account << " to queue."
                      << " Flags: " << flags;
 
+    publishMetrics(lock);
     return {terQUEUED, false};
 }
 
@@ -1340,6 +1450,12 @@ TxQ::apply(
 void
 TxQ::processClosedLedger(Application& app, ReadView const& view, bool timeLeap)
 {
+    {
+        std::lock_guard lock(preflightMutex_);
+        preflightCacheOld_ = std::move(preflightCache_);
+        preflightCache_.clear();
+    }
+
     std::lock_guard lock(mutex_);
 
     feeMetrics_.update(app, view, timeLeap, setup_);
@@ -1375,6 +1491,8 @@ TxQ::processClosedLedger(Application& app, ReadView const& view, bool timeLeap)
         else
             ++txQAccountIter;
     }
+
+    publishMetrics(lock);
 }
 
 /*
@@ -1540,6 +1658,7 @@ TxQ::accept(Application& app, OpenView& view)
         }
     }
 
+    publishMetrics(lock);
     return ledgerChanged;
 }
 
@@ -1628,6 +1747,7 @@ TxQ::tryDirectApply(
     OpenView& view,
     std::shared_ptr<STTx const> const& tx,
     ApplyFlags flags,
+    bool resubmit,
     beast::Journal j)
 {
     auto const account = (*tx)[sfAccount];
@@ -1662,8 +1782,14 @@ TxQ::tryDirectApply(
         JLOG(j_.trace()) << "Applying transaction " << transactionID
                          << " to open ledger.";
 
-        auto const [txnResult, didApply] =
-            ripple::apply(app, view, *tx, flags, j);
+        auto const [txnResult, didApply] = [&]() -> std::pair<TER, bool> {
+            if (!resubmit)
+                return ripple::apply(app, view, *tx, flags, j);
+            auto const pfresult =
+                cachedPreflight(app, view.rules(), *tx, flags, j);
+            auto const pcresult = preclaim(pfresult, app, view);
+            return doApply(pcresult, app, view);
+        }();
 
         JLOG(j_.trace()) << "New transaction " << transactionID
                          << (didApply ? " applied successfully with "
@@ -1685,6 +1811,7 @@ TxQ::tryDirectApply(
                     existingIter != txQAcct.transactions.end())
                 {
                     removeFromByFee(existingIter, tx);
+                    publishMetrics(lock);
                 }
             }
         }
@@ -1718,17 +1845,28 @@ TxQ::getMetrics(OpenView const& view) const
 {
     Metrics result;
 
-    std::lock_guard lock(mutex_);
-
-    auto const snapshot = feeMetrics_.getSnapshot();
-
-    result.txCount = byFee_.size();
-    result.txQMaxSize = maxSize_;
+    // Deliberately does not lock mutex_. See PublishedMetrics.
+    auto const txCount = published_.txCount.load(std::memory_order_relaxed);
+    auto const maxSize =
+        published_.hasMaxSize.load(std::memory_order_relaxed)
+        ? std::optional<std::size_t>(
+              published_.maxSize.load(std::memory_order_relaxed))
+        : std::nullopt;
+    FeeMetrics::Snapshot const snapshot{
+        published_.txnsExpected.load(std::memory_order_relaxed),
+        FeeLevel64{
+            published_.escalationMultiplier.load(std::memory_order_relaxed)}};
+
+    result.txCount = txCount;
+    result.txQMaxSize = maxSize;
     result.txInLedger = view.txCount();
     result.txPerLedger = snapshot.txnsExpected;
     result.referenceFeeLevel = baseLevel;
-    result.minProcessingFeeLevel =
-        isFull() ? byFee_.rbegin()->feeLevel + FeeLevel64{1} : baseLevel;
+    result.minProcessingFeeLevel = maxSize && txCount && txCount >= *maxSize
+        ? FeeLevel64{published_.lowestFeeLevel.load(
+              std::memory_order_relaxed)} +
+            FeeLevel64{1}
+        : baseLevel;
     result.medFeeLevel = snapshot.escalationMultiplier;
     result.openLedgerFeeLevel = FeeMetrics::scaleFeeLevel(snapshot, view);
 
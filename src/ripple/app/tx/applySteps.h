@@ -250,6 +250,26 @@ preflight(
     ApplyFlags flags,
     beast::Journal j);
 
+/** Rebuild the result of an earlier call to `preflight`.
+
+    `preflight` depends only on the transaction, the rules and the flags,
+    so its outcome can be remembered and reused while those are unchanged.
+    The caller is responsible for only passing a `result` that `preflight`
+    actually returned for the same inputs.
+
+    @param result The `ter` and `consequences` of the earlier result.
+
+    @see preflight
+*/
+PreflightResult
+reusePreflight(
+    Application& app,
+    Rules const& rules,
+    STTx const& tx,
+    ApplyFlags flags,
+    std::pair<NotTEC, TxConsequences> const& result,
+    beast::Journal j);
+
 /** Gate a transaction based on static ledger information.
 
     The transaction is checked against all possible
@@ -87,6 +87,13 @@ public:
     std::size_t
     size();
 
+    /** Get the keys of the entries read and changed so far. */
+    void
+    keys(std::vector<uint256>& reads, std::vector<uint256>& writes) const
+    {
+        view_->keys(reads, writes);
+    }
+
     /** Visit unapplied changes. */
     void
     visit(std::function<void(
@@ -23,6 +23,7 @@
 #include <ripple/app/tx/impl/SignerEntries.h>
 #include <ripple/app/tx/impl/Transactor.h>
 #include <ripple/basics/Log.h>
+#include <ripple/basics/PerfLog.h>
 #include <ripple/basics/contract.h>
 #include <ripple/core/Config.h>
 #include <ripple/json/to_string.h>
@@ -757,6 +758,13 @@ Transactor::operator()()
 {
     JLOG(j_.trace()) << "apply: " << ctx_.tx.getTransactionID();
 
+    // Only transactions applied to a closed ledger are profiled, and only
+    // when the performance log is enabled.
+    bool const profile =
+        !view().open() && ctx_.app.getPerfLog().txProfiling();
+    auto const start = profile ? std::chrono::steady_clock::now()
+                               : std::chrono::steady_clock::time_point{};
+
     STAmountSO stAmountSO{view().rules().enabled(fixSTAmountCanonicalize)};
 
 #ifdef DEBUG
@@ -893,6 +901,22 @@ Transactor::operator()()
         if (!view().open() && fee != beast::zero)
             ctx_.destroyXRP(fee);
 
+        // Record which ledger entries the transaction touched while the
+        // changes are still available.
+        if (profile)
+        {
+            std::vector<uint256> reads;
+            std::vector<uint256> writes;
+            ctx_.keys(reads, writes);
+            ctx_.app.getPerfLog().txApply(
+                ctx_.tx.getTransactionID(),
+                ctx_.tx.getTxnType(),
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start),
+                std::move(reads),
+                std::move(writes));
+        }
+
         // Once we call apply, we will no longer be able to look at view()
         ctx_.apply(result);
     }
@@ -434,6 +434,19 @@ preflight(
     }
 }
 
+PreflightResult
+reusePreflight(
+    Application& app,
+    Rules const& rules,
+    STTx const& tx,
+    ApplyFlags flags,
+    std::pair<NotTEC, TxConsequences> const& result,
+    beast::Journal j)
+{
+    PreflightContext const pfctx(app, tx, rules, flags, j);
+    return {pfctx, result};
+}
+
 PreclaimResult
 preclaim(
     PreflightResult const& preflightResult,
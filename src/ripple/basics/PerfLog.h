@@ -20,14 +20,17 @@
 #ifndef RIPPLE_BASICS_PERFLOG_H
 #define RIPPLE_BASICS_PERFLOG_H
 
+#include <ripple/basics/base_uint.h>
 #include <ripple/core/JobTypes.h>
 #include <ripple/json/json_value.h>
+#include <ripple/protocol/TxFormats.h>
 #include <boost/filesystem.hpp>
 #include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace beast {
 class Journal;
@@ -126,6 +129,32 @@ public:
     virtual void
     jobFinish(JobType const type, microseconds dur, int instance) = 0;
 
+    /**
+     * Log transaction applied to a ledger view
+     *
+     * @param txID Transaction hash
+     * @param type Transaction type
+     * @param dur Duration applying the transaction in microseconds
+     * @param reads Keys of ledger entries loaded for modification but
+     *              left unchanged. Entries only read are not included.
+     * @param writes Keys of ledger entries created, modified or deleted
+     */
+    virtual void
+    txApply(
+        uint256 const& txID,
+        TxType const type,
+        microseconds dur,
+        std::vector<uint256> reads,
+        std::vector<uint256> writes) = 0;
+
+    /**
+     * Whether applied transactions should be reported with txApply
+     *
+     * @return true if the performance log is enabled
+     */
+    virtual bool
+    txProfiling() const = 0;
+
     /**
      * Render performance counters in Json
      *
@@ -142,6 +171,17 @@ public:
     virtual Json::Value
     currentJson() const = 0;
 
+    /**
+     * Render per transaction type apply counters and latency histograms
+     * in Json
+     *
+     * @param recent Also render the read and write sets of the most
+     *               recently applied transactions
+     * @return Transaction profile Json object
+     */
+    virtual Json::Value
+    txJson(bool recent) const = 0;
+
     /**
      * Ensure enough room to store each currently executing job
      *
@@ -42,7 +42,8 @@ namespace perf {
 
 PerfLogImp::Counters::Counters(
     std::vector<char const*> const& labels,
-    JobTypes const& jobTypes)
+    JobTypes const& jobTypes,
+    TxFormats const& txFormats)
 {
     {
         // populateRpc
@@ -70,6 +71,18 @@ PerfLogImp::Counters::Counters(
             }
         }
     }
+    {
+        // populateTx
+        for (auto const& format : txFormats)
+        {
+            auto const inserted = tx_.emplace(format.getType(), Tx()).second;
+            if (!inserted)
+            {
+                // Ensure that no other function populates this entry.
+                assert(false);
+            }
+        }
+    }
 }
 
 Json::Value
@@ -214,6 +227,79 @@ PerfLogImp::Counters::currentJson() const
     return current;
 }
 
+Json::Value
+PerfLogImp::Counters::txJson(bool recent) const
+{
+    auto const render = [](Tx const& value) {
+        Json::Value t(Json::objectValue);
+        t[jss::applied] = std::to_string(value.applied);
+        t[jss::reads] = std::to_string(value.reads);
+        t[jss::writes] = std::to_string(value.writes);
+        t[jss::duration_us] = std::to_string(value.duration.count());
+        Json::Value histogram(Json::arrayValue);
+        for (auto const count : value.histogram)
+            histogram.append(std::to_string(count));
+        t[jss::histogram_us] = histogram;
+        return t;
+    };
+
+    Json::Value txobj(Json::objectValue);
+    // totalTx represents all transaction types.
+    Tx totalTx;
+    for (auto const& proc : tx_)
+    {
+        Tx value;
+        {
+            std::lock_guard lock(proc.second.mutex);
+            if (!proc.second.value.applied)
+                continue;
+            value = proc.second.value;
+        }
+
+        totalTx.applied += value.applied;
+        totalTx.reads += value.reads;
+        totalTx.writes += value.writes;
+        totalTx.duration += value.duration;
+        for (std::size_t i = 0; i < Tx::buckets; ++i)
+            totalTx.histogram[i] += value.histogram[i];
+
+        auto const format = TxFormats::getInstance().findByType(proc.first);
+        if (format)
+            txobj[format->getName()] = render(value);
+    }
+
+    if (totalTx.applied)
+        txobj[jss::total] = render(totalTx);
+
+    if (recent)
+    {
+        auto const keys = [this] {
+            std::lock_guard lock(recentTxMutex_);
+            return recentTx_;
+        }();
+
+        Json::Value recentArray(Json::arrayValue);
+        for (auto const& k : keys)
+        {
+            Json::Value kobj(Json::objectValue);
+            kobj[jss::hash] = to_string(k.txID);
+            if (auto const format = TxFormats::getInstance().findByType(k.type))
+                kobj[jss::type] = format->getName();
+            kobj[jss::duration_us] = std::to_string(k.duration.count());
+            Json::Value& reads = (kobj[jss::reads] = Json::arrayValue);
+            for (auto const& key : k.reads)
+                reads.append(to_string(key));
+            Json::Value& writes = (kobj[jss::writes] = Json::arrayValue);
+            for (auto const& key : k.writes)
+                writes.append(to_string(key));
+            recentArray.append(kobj);
+        }
+        txobj[jss::recent] = recentArray;
+    }
+
+    return txobj;
+}
+
 //-----------------------------------------------------------------------------
 
 void
@@ -297,6 +383,7 @@ PerfLogImp::report()
     report[jss::hostid] = hostname_;
     report[jss::counters] = counters_.countersJson();
     report[jss::current_activities] = counters_.currentJson();
+    report[jss::transactions] = counters_.txJson(false);
 
     logFile_ << Json::Compact{std::move(report)} << std::endl;
 }
@@ -428,6 +515,40 @@ PerfLogImp::jobFinish(JobType const type, microseconds dur, int instance)
         counters_.jobs_[instance] = {jtINVALID, steady_time_point()};
 }
 
+void
+PerfLogImp::txApply(
+    uint256 const& txID,
+    TxType const type,
+    microseconds dur,
+    std::vector<uint256> reads,
+    std::vector<uint256> writes)
+{
+    auto counter = counters_.tx_.find(type);
+    if (counter == counters_.tx_.end())
+    {
+        assert(false);
+        return;
+    }
+    {
+        std::size_t bucket = 0;
+        while (bucket + 1 < Counters::Tx::buckets &&
+               dur.count() >= (std::int64_t{1} << bucket))
+            ++bucket;
+
+        std::lock_guard lock(counter->second.mutex);
+        ++counter->second.value.applied;
+        counter->second.value.reads += reads.size();
+        counter->second.value.writes += writes.size();
+        counter->second.value.duration += dur;
+        ++counter->second.value.histogram[bucket];
+    }
+    std::lock_guard lock(counters_.recentTxMutex_);
+    if (counters_.recentTx_.size() >= Counters::recentTxLimit)
+        counters_.recentTx_.pop_front();
+    counters_.recentTx_.push_back(
+        {txID, type, dur, std::move(reads), std::move(writes)});
+}
+
 void
 PerfLogImp::resizeJobs(int const resize)
 {
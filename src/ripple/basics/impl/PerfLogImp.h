@@ -27,8 +27,10 @@
 #include <ripple/protocol/jss.h>
 #include <ripple/rpc/impl/Handler.h>
 #include <boost/asio/ip/host_name.hpp>
+#include <array>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <fstream>
 #include <memory>
 #include <mutex>
@@ -105,10 +107,46 @@ class PerfLogImp : public PerfLog, Stoppable
             microseconds runningDuration{0};
         };
 
-        // rpc_ and jq_ do not need mutex protection because all
+        /**
+         * Transaction apply performance counters.
+         */
+        struct Tx
+        {
+            // Bucket i counts transactions applied in less than 2^i
+            // microseconds. The last bucket counts everything slower.
+            static constexpr std::size_t buckets = 20;
+
+            std::uint64_t applied{0};
+            // Cumulative number of ledger entries read and written.
+            std::uint64_t reads{0};
+            std::uint64_t writes{0};
+            // Cumulative duration of all applied transactions.
+            microseconds duration{0};
+            std::array<std::uint64_t, buckets> histogram{};
+        };
+
+        /**
+         * Ledger entries touched by a recently applied transaction.
+         */
+        struct TxKeys
+        {
+            uint256 txID;
+            TxType type;
+            microseconds duration;
+            std::vector<uint256> reads;
+            std::vector<uint256> writes;
+        };
+
+        // Number of transactions for which the key sets are retained.
+        static constexpr std::size_t recentTxLimit = 256;
+
+        // rpc_, jq_ and tx_ do not need mutex protection because all
         // keys and values are created before more threads are started.
         std::unordered_map<std::string, Locked<Rpc>> rpc_;
         std::unordered_map<JobType, Locked<Jq>> jq_;
+        std::unordered_map<TxType, Locked<Tx>> tx_;
+        std::deque<TxKeys> recentTx_;
+        mutable std::mutex recentTxMutex_;
         std::vector<std::pair<JobType, steady_time_point>> jobs_;
         mutable std::mutex jobsMutex_;
         std::unordered_map<std::uint64_t, MethodStart> methods_;
@@ -116,17 +154,23 @@ class PerfLogImp : public PerfLog, Stoppable
 
         Counters(
             std::vector<char const*> const& labels,
-            JobTypes const& jobTypes);
+            JobTypes const& jobTypes,
+            TxFormats const& txFormats);
         Json::Value
         countersJson() const;
         Json::Value
         currentJson() const;
+        Json::Value
+        txJson(bool recent) const;
     };
 
     Setup const setup_;
     beast::Journal const j_;
     std::function<void()> const signalStop_;
-    Counters counters_{ripple::RPC::getHandlerNames(), JobTypes::instance()};
+    Counters counters_{
+        ripple::RPC::getHandlerNames(),
+        JobTypes::instance(),
+        TxFormats::getInstance()};
     std::ofstream logFile_;
     std::thread thread_;
     std::mutex mutex_;
@@ -182,6 +226,19 @@ public:
         int instance) override;
     void
     jobFinish(JobType const type, microseconds dur, int instance) override;
+    void
+    txApply(
+        uint256 const& txID,
+        TxType const type,
+        microseconds dur,
+        std::vector<uint256> reads,
+        std::vector<uint256> writes) override;
+
+    bool
+    txProfiling() const override
+    {
+        return !setup_.perfLog.empty();
+    }
 
     Json::Value
     countersJson() const override
@@ -195,6 +252,12 @@ public:
         return counters_.currentJson();
     }
 
+    Json::Value
+    txJson(bool recent) const override
+    {
+        return counters_.txJson(recent);
+    }
+
     void
     resizeJobs(int const resize) override;
     void
@@ -458,6 +458,95 @@ private:
         }
     }
 
+    /** Add a validation that has already been checked to be current
+
+        @param lock Existing lock of mutex_
+        @param nodeID The identity of the node issuing this validation
+        @param val The validation to store
+        @return The outcome
+    */
+    ValStatus
+    addCurrent(
+        std::lock_guard<Mutex> const& lock,
+        NodeID const& nodeID,
+        Validation const& val)
+    {
+        // Check that validation sequence is greater than any non-expired
+        // validations sequence from that validator; if it's not, perform
+        // additional work to detect Byzantine validations
+        auto const now = byLedger_.clock().now();
+
+        auto const [seqit, seqinserted] =
+            bySequence_[val.seq()].emplace(nodeID, val);
+
+        if (!seqinserted)
+        {
+            // Check if the entry we're already tracking was signed
+            // long enough ago that we can disregard it.
+            auto const diff =
+                std::max(seqit->second.signTime(), val.signTime()) -
+                std::min(seqit->second.signTime(), val.signTime());
+
+            if (diff > parms_.validationCURRENT_WALL &&
+                val.signTime() > seqit->second.signTime())
+                seqit->second = val;
+        }
+
+        // Enforce monotonically increasing sequences for validations
+        // by a given node, and run the active Byzantine detector:
+        if (auto& enf = seqEnforcers_[nodeID]; !enf(now, val.seq(), parms_))
+        {
+            // If the validation is for the same sequence as one we are
+            // tracking, check it closely:
+            if (seqit->second.seq() == val.seq())
+            {
+                // Two validations for the same sequence but for different
+                // ledgers. This could be the result of misconfiguration
+                // but it can also mean a Byzantine validator.
+                if (seqit->second.ledgerID() != val.ledgerID())
+                    return ValStatus::conflicting;
+
+                // Two validations for the same sequence and for the same
+                // ledger with different sign times. This could be the
+                // result of a misconfiguration but it can also mean a
+                // Byzantine validator.
+                if (seqit->second.signTime() != val.signTime())
+                    return ValStatus::conflicting;
+
+                // Two validations for the same sequence but with different
+                // cookies. This is probably accidental misconfiguration.
+                if (seqit->second.cookie() != val.cookie())
+                    return ValStatus::multiple;
+            }
+
+            return ValStatus::badSeq;
+        }
+
+        byLedger_[val.ledgerID()].insert_or_assign(nodeID, val);
+
+        auto const [it, inserted] = current_.emplace(nodeID, val);
+        if (!inserted)
+        {
+            // Replace existing only if this one is newer
+            Validation& oldVal = it->second;
+            if (val.signTime() > oldVal.signTime())
+            {
+                std::pair<Seq, ID> old(oldVal.seq(), oldVal.ledgerID());
+                it->second = val;
+                if (val.trusted())
+                    updateTrie(lock, nodeID, val, old);
+            }
+            else
+                return ValStatus::stale;
+        }
+        else if (val.trusted())
+        {
+            updateTrie(lock, nodeID, val, std::nullopt);
+        }
+
+        return ValStatus::current;
+    }
+
     /** Use the trie for a calculation
 
         Accessing the trie through this helper ensures acquiring validations
@@ -617,84 +706,55 @@ public:
         if (!isCurrent(parms_, adaptor_.now(), val.signTime(), val.seenTime()))
             return ValStatus::stale;
 
-        {
-            std::lock_guard lock{mutex_};
+        std::lock_guard lock{mutex_};
+        return addCurrent(lock, nodeID, val);
+    }
 
-            // Check that validation sequence is greater than any non-expired
-            // validations sequence from that validator; if it's not, perform
-            // additional work to detect Byzantine validations
-            auto const now = byLedger_.clock().now();
+    /** Add a batch of new validations
 
-            auto const [seqit, seqinserted] =
-                bySequence_[val.seq()].emplace(nodeID, val);
+        Equivalent to calling add for each validation in turn, but the
+        lock is acquired only once for the whole batch.
 
-            if (!seqinserted)
-            {
-                // Check if the entry we're already tracking was signed
-                // long enough ago that we can disregard it.
-                auto const diff =
-                    std::max(seqit->second.signTime(), val.signTime()) -
-                    std::min(seqit->second.signTime(), val.signTime());
-
-                if (diff > parms_.validationCURRENT_WALL &&
-                    val.signTime() > seqit->second.signTime())
-                    seqit->second = val;
-            }
+        @param vals The identity of the issuing node and the validation, for
+                    each validation to store
+        @return The outcome for each validation, in the same order
+    */
+    std::vector<ValStatus>
+    add(std::vector<std::pair<NodeID, Validation>> const& vals)
+    {
+        std::vector<ValStatus> outcomes;
+        add(vals, outcomes);
+        return outcomes;
+    }
 
-            // Enforce monotonically increasing sequences for validations
-            // by a given node, and run the active Byzantine detector:
-            if (auto& enf = seqEnforcers_[nodeID]; !enf(now, val.seq(), parms_))
-            {
-                // If the validation is for the same sequence as one we are
-                // tracking, check it closely:
-                if (seqit->second.seq() == val.seq())
-                {
-                    // Two validations for the same sequence but for different
-                    // ledgers. This could be the result of misconfiguration
-                    // but it can also mean a Byzantine validator.
-                    if (seqit->second.ledgerID() != val.ledgerID())
-                        return ValStatus::conflicting;
-
-                    // Two validations for the same sequence and for the same
-                    // ledger with different sign times. This could be the
-                    // result of a misconfiguration but it can also mean a
-                    // Byzantine validator.
-                    if (seqit->second.signTime() != val.signTime())
-                        return ValStatus::conflicting;
-
-                    // Two validations for the same sequence but with different
-                    // cookies. This is probably accidental misconfiguration.
-                    if (seqit->second.cookie() != val.cookie())
-                        return ValStatus::multiple;
-                }
+    /** Add a batch of new validations, resuming a previous attempt
 
-                return ValStatus::badSeq;
-            }
+        Adds the validations starting at index outcomes.size(), appending
+        the outcome of each one. If adding a validation throws, the
+        outcomes of the validations before it have already been appended,
+        so the caller can skip the offending validation and call again
+        without adding any validation twice.
 
-            byLedger_[val.ledgerID()].insert_or_assign(nodeID, val);
+        @param vals The identity of the issuing node and the validation, for
+                    each validation to store
+        @param outcomes The outcomes of the validations already added
+    */
+    void
+    add(std::vector<std::pair<NodeID, Validation>> const& vals,
+        std::vector<ValStatus>& outcomes)
+    {
+        outcomes.reserve(vals.size());
 
-            auto const [it, inserted] = current_.emplace(nodeID, val);
-            if (!inserted)
-            {
-                // Replace existing only if this one is newer
-                Validation& oldVal = it->second;
-                if (val.signTime() > oldVal.signTime())
-                {
-                    std::pair<Seq, ID> old(oldVal.seq(), oldVal.ledgerID());
-                    it->second = val;
-                    if (val.trusted())
-                        updateTrie(lock, nodeID, val, old);
-                }
-                else
-                    return ValStatus::stale;
-            }
-            else if (val.trusted())
-            {
-                updateTrie(lock, nodeID, val, std::nullopt);
-            }
+        auto const now = adaptor_.now();
+        std::lock_guard lock{mutex_};
+        for (auto i = outcomes.size(); i < vals.size(); ++i)
+        {
+            auto const& [nodeID, val] = vals[i];
+            if (!isCurrent(parms_, now, val.signTime(), val.seenTime()))
+                outcomes.push_back(ValStatus::stale);
+            else
+                outcomes.push_back(addCurrent(lock, nodeID, val));
         }
-
-        return ValStatus::current;
     }
 
     /**
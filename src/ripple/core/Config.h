@@ -188,6 +188,10 @@ public:
     // Enable the experimental Ledger Replay functionality
     bool LEDGER_REPLAY = false;
 
+    // Apply transactions speculatively on worker threads while building
+    // ledgers
+    bool PARALLEL_LEDGER_BUILD = false;
+
     // Work queue limits
     int MAX_TRANSACTIONS = 250;
     static constexpr int MAX_JOB_QUEUE_TX = 1000;
@@ -213,6 +217,14 @@ public:
     // analyzed.
     bool VP_REDUCE_RELAY_SQUELCH = false;
 
+    // Transaction reduce-relay feature: a transaction is relayed in full to
+    // a random subset of the peers and only announced by hash to the rest.
+    bool TX_REDUCE_RELAY_ENABLE = false;
+    // Relay to every peer when there are no more than this many to relay to
+    std::size_t TX_REDUCE_RELAY_MIN_PEERS = 20;
+    // Percentage of the peers sent a transaction in full
+    std::size_t TX_RELAY_PERCENTAGE = 25;
+
     // These override the command line client settings
     std::optional<beast::IP::Endpoint> rpc_ip;
 
@@ -98,6 +98,7 @@ struct ConfigSection
 #define SECTION_VETO_AMENDMENTS "veto_amendments"
 #define SECTION_WORKERS "workers"
 #define SECTION_LEDGER_REPLAY "ledger_replay"
+#define SECTION_PARALLEL_LEDGER_BUILD "parallel_ledger_build"
 
 }  // namespace ripple
 
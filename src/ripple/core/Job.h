@@ -47,10 +47,13 @@ enum JobType {
     jtPROPOSAL_ut,    // A proposal from an untrusted source
     jtREPLAY_TASK,    // A Ledger replay task/subtask
     jtLEDGER_DATA,    // Received data for a ledger we're acquiring
+    jtLEDGER_SCAN,    // Look for nodes missing from a ledger we're acquiring
     jtCLIENT,         // A websocket command from the client
     jtRPC,            // A websocket command from the client
     jtUPDATE_PF,      // Update pathfinding requests
     jtTRANSACTION,    // A transaction received from the network
+    jtMISSING_TXN,    // Request missing transactions from a peer
+    jtREQUESTED_TXN,  // Reply to a peer with requested transactions
     jtBATCH,          // Apply batched transactions
     jtADVANCE,        // Advance validated/acquired ledgers
     jtPUBLEDGER,      // Publish a fully-accepted ledger
@@ -58,6 +61,7 @@ enum JobType {
     jtWAL,            // Write-ahead logging
     jtVALIDATION_t,   // A validation from a trusted source
     jtWRITE,          // Write out hashed objects
+    jtACCEPT_CHECK,   // Apply transactions for a ledger being accepted
     jtACCEPT,         // Accept a consensus ledger
     jtPROPOSAL_t,     // A proposal from a trusted source
     jtSWEEP,          // Sweep for stale structures
@@ -206,6 +206,11 @@ public:
     void
     setThreadCount(int c, bool const standaloneMode);
 
+    /** Return the number of threads serving the job queue.
+     */
+    int
+    getThreadCount() const;
+
     /** Return a scoped LoadEvent.
      */
     std::unique_ptr<LoadEvent>
@@ -62,10 +62,13 @@ private:
         add(jtPROPOSAL_ut, "untrustedProposal", maxLimit, false, 500ms, 1250ms);
         add(jtREPLAY_TASK, "ledgerReplayTask", maxLimit, false, 0ms, 0ms);
         add(jtLEDGER_DATA, "ledgerData", 2, false, 0ms, 0ms);
+        add(jtLEDGER_SCAN, "ledgerScan", maxLimit, false, 0ms, 0ms);
         add(jtCLIENT, "clientCommand", maxLimit, false, 2000ms, 5000ms);
         add(jtRPC, "RPC", maxLimit, false, 0ms, 0ms);
         add(jtUPDATE_PF, "updatePaths", maxLimit, false, 0ms, 0ms);
         add(jtTRANSACTION, "transaction", maxLimit, false, 250ms, 1000ms);
+        add(jtMISSING_TXN, "handleHaveTransactions", 1200, false, 0ms, 0ms);
+        add(jtREQUESTED_TXN, "doTransactions", 1200, false, 0ms, 0ms);
         add(jtBATCH, "batch", maxLimit, false, 250ms, 1000ms);
         add(jtADVANCE, "advanceLedger", maxLimit, false, 0ms, 0ms);
         add(jtPUBLEDGER, "publishNewLedger", maxLimit, false, 3000ms, 4500ms);
@@ -78,6 +81,7 @@ private:
             500ms,
             1500ms);
         add(jtWRITE, "writeObjects", maxLimit, false, 1750ms, 2500ms);
+        add(jtACCEPT_CHECK, "acceptCheck", maxLimit, false, 0ms, 0ms);
         add(jtACCEPT, "acceptLedger", maxLimit, false, 0ms, 0ms);
         add(jtPROPOSAL_t, "trustedProposal", maxLimit, false, 100ms, 500ms);
         add(jtSWEEP, "sweep", maxLimit, false, 0ms, 0ms);
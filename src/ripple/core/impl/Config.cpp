@@ -532,11 +532,27 @@ Config::loadFromString(std::string const& fileContents)
     if (getSingleSection(secConfig, SECTION_LEDGER_REPLAY, strTemp, j_))
         LEDGER_REPLAY = beast::lexicalCastThrow<bool>(strTemp);
 
+    if (getSingleSection(
+            secConfig, SECTION_PARALLEL_LEDGER_BUILD, strTemp, j_))
+        PARALLEL_LEDGER_BUILD = beast::lexicalCastThrow<bool>(strTemp);
+
     if (exists(SECTION_REDUCE_RELAY))
     {
         auto sec = section(SECTION_REDUCE_RELAY);
         VP_REDUCE_RELAY_ENABLE = sec.value_or("vp_enable", false);
         VP_REDUCE_RELAY_SQUELCH = sec.value_or("vp_squelch", false);
+        TX_REDUCE_RELAY_ENABLE = sec.value_or("tx_enable", false);
+        TX_REDUCE_RELAY_MIN_PEERS =
+            sec.value_or<std::size_t>("tx_min_peers", 20);
+        TX_RELAY_PERCENTAGE =
+            sec.value_or<std::size_t>("tx_relay_percentage", 25);
+        if (TX_RELAY_PERCENTAGE < 10 || TX_RELAY_PERCENTAGE > 100 ||
+            TX_REDUCE_RELAY_MIN_PEERS < 10)
+            Throw<std::runtime_error>(
+                "Invalid " SECTION_REDUCE_RELAY
+                ", tx_min_peers must be greater or equal to 10"
+                ", tx_relay_percentage must be greater or equal to 10 "
+                "and less or equal to 100");
     }
 
     if (getSingleSection(secConfig, SECTION_MAX_TRANSACTIONS, strTemp, j_))
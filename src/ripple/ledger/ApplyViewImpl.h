@@ -73,6 +73,11 @@ public:
     std::size_t
     size();
 
+    /** Get the keys of the read and of the modified entries
+     */
+    void
+    keys(std::vector<uint256>& reads, std::vector<uint256>& writes) const;
+
     /** Visit modified entries
      */
     void
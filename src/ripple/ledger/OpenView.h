@@ -46,6 +46,19 @@ struct open_ledger_t
 
 extern open_ledger_t const open_ledger;
 
+/** Batch view construction tag.
+
+    Views constructed with this tag hold the changes of transactions
+    that are later applied to another view, and number those
+    transactions as if they had been applied to it directly.
+*/
+struct batch_view_t
+{
+    explicit batch_view_t() = default;
+};
+
+extern batch_view_t const batch_view;
+
 //------------------------------------------------------------------------------
 
 /** Writable ledger view that accumulates state and tx changes.
@@ -97,6 +110,7 @@ private:
     detail::RawStateTable items_;
     std::shared_ptr<void const> hold_;
     bool open_ = true;
+    std::size_t baseTxCount_ = 0;
 
 public:
     OpenView() = delete;
@@ -170,6 +184,20 @@ public:
     */
     OpenView(ReadView const* base, std::shared_ptr<void const> hold = nullptr);
 
+    /** Construct a view of changes to be applied to another view.
+
+        Effects:
+
+            The LedgerInfo and the rules are inherited
+            from the base.
+
+            Inserted tx are numbered starting at
+            `baseTxCount`, so that applying this view to
+            a view that holds that many tx gives the
+            same metadata as applying them there.
+    */
+    OpenView(batch_view_t, ReadView const* base, std::size_t baseTxCount);
+
     /** Returns true if this reflects an open ledger. */
     bool
     open() const override
@@ -180,7 +208,8 @@ public:
     /** Return the number of tx inserted since creation.
 
         This is used to set the "apply ordinal"
-        when calculating transaction metadata.
+        when calculating transaction metadata. For
+        a batch view, the base count is included.
     */
     std::size_t
     txCount() const;
@@ -27,6 +27,8 @@
 #include <ripple/ledger/ReadView.h>
 #include <ripple/ledger/TxMeta.h>
 #include <ripple/protocol/TER.h>
+#include <boost/container/flat_map.hpp>
+#include <boost/container/small_vector.hpp>
 #include <memory>
 
 namespace ripple {
@@ -46,7 +48,19 @@ private:
         modify,
     };
 
-    using items_t = std::map<key_type, std::pair<Action, std::shared_ptr<SLE>>>;
+    // Most transactions, and most of the nested sandboxes created while
+    // crossing offers and evaluating paths, touch only a handful of
+    // entries. Keep them sorted in a contiguous array which lives inside
+    // the table until it outgrows the inline capacity.
+    static constexpr std::size_t inlineItems = 16;
+
+    using item_t = std::pair<Action, std::shared_ptr<SLE>>;
+    using items_t = boost::container::flat_map<
+        key_type,
+        item_t,
+        std::less<key_type>,
+        boost::container::
+            small_vector<std::pair<key_type, item_t>, inlineItems>>;
 
     items_t items_;
     XRPAmount dropsDestroyed_{0};
@@ -90,6 +104,15 @@ public:
     std::size_t
     size() const;
 
+    /** Append the keys of all the entries the transaction loaded.
+
+        Entries that were peeked but left unchanged go to `reads`. Entries
+        that were inserted, modified or erased go to `writes`. Entries only
+        accessed through read() are not tracked and are not reported.
+    */
+    void
+    keys(std::vector<key_type>& reads, std::vector<key_type>& writes) const;
+
     void
     visit(
         ReadView const& base,
@@ -70,6 +70,20 @@ ApplyStateTable::size() const
     return ret;
 }
 
+void
+ApplyStateTable::keys(
+    std::vector<key_type>& reads,
+    std::vector<key_type>& writes) const
+{
+    for (auto const& item : items_)
+    {
+        if (item.second.first == Action::cache)
+            reads.push_back(item.first);
+        else
+            writes.push_back(item.first);
+    }
+}
+
 void
 ApplyStateTable::visit(
     ReadView const& to,
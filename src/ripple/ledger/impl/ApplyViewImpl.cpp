@@ -40,6 +40,14 @@ ApplyViewImpl::size()
     return items_.size();
 }
 
+void
+ApplyViewImpl::keys(
+    std::vector<uint256>& reads,
+    std::vector<uint256>& writes) const
+{
+    items_.keys(reads, writes);
+}
+
 void
 ApplyViewImpl::visit(
     OpenView& to,
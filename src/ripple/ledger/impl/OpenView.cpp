@@ -23,6 +23,7 @@
 namespace ripple {
 
 open_ledger_t const open_ledger{};
+batch_view_t const batch_view{};
 
 class OpenView::txs_iter_impl : public txs_type::iter_base
 {
@@ -86,7 +87,8 @@ OpenView::OpenView(OpenView const& rhs)
     , base_{rhs.base_}
     , items_{rhs.items_}
     , hold_{rhs.hold_}
-    , open_{rhs.open_} {};
+    , open_{rhs.open_}
+    , baseTxCount_{rhs.baseTxCount_} {};
 
 OpenView::OpenView(
     open_ledger_t,
@@ -120,10 +122,19 @@ OpenView::OpenView(ReadView const* base, std::shared_ptr<void const> hold)
 {
 }
 
+OpenView::OpenView(
+    batch_view_t,
+    ReadView const* base,
+    std::size_t baseTxCount)
+    : OpenView(base)
+{
+    baseTxCount_ = baseTxCount;
+}
+
 std::size_t
 OpenView::txCount() const
 {
-    return txs_.size();
+    return baseTxCount_ + txs_.size();
 }
 
 void
@@ -1104,6 +1104,22 @@ private:
         return jvRequest;
     }
 
+    // tx_profile [recent]
+    Json::Value
+    parseTxProfile(Json::Value const& jvParams)
+    {
+        Json::Value jvRequest{Json::objectValue};
+
+        if (jvParams.size() == 1)
+        {
+            if (jvParams[0u].asString() != "recent")
+                return rpcError(rpcINVALID_PARAMS);
+            jvRequest[jss::recent] = true;
+        }
+
+        return jvRequest;
+    }
+
     // validation_create [<pass_phrase>|<seed>|<seed_key>]
     //
     // NOTE: It is poor security to specify secret information on the command
@@ -1286,6 +1302,7 @@ public:
             {"tx", &RPCParser::parseTx, 1, 4},
             {"tx_account", &RPCParser::parseTxAccount, 1, 7},
             {"tx_history", &RPCParser::parseTxHistory, 1, 1},
+            {"tx_profile", &RPCParser::parseTxProfile, 0, 1},
             {"unl_list", &RPCParser::parseAsIs, 0, 0},
             {"validation_create", &RPCParser::parseValidationCreate, 0, 1},
             {"validator_info", &RPCParser::parseAsIs, 0, 0},
@@ -52,14 +52,37 @@ public:
             , writesDelayed(other.writesDelayed)
             , readRetries(other.readRetries)
             , readErrors(other.readErrors)
+            , writesRequested(other.writesRequested)
+            , writesCoalesced(other.writesCoalesced)
+            , writeBatches(other.writeBatches)
+            , writeBatchLimit(other.writeBatchLimit)
+            , writesIssued(other.writesIssued)
+            , writeBytesIssued(other.writeBytesIssued)
+            , tracksRequests(other.tracksRequests)
+            , tracksBatches(other.tracksBatches)
         {
         }
 
+        // Requests to a remote database, if tracksRequests
         T writeDurationUs = {};
         T writeRetries = {};
         T writesDelayed = {};
         T readRetries = {};
         T readErrors = {};
+
+        // Batched writes, see BatchWriter, if tracksBatches
+        T writesRequested = {};
+        T writesCoalesced = {};
+        T writeBatches = {};
+        T writeBatchLimit = {};
+
+        // Objects and bytes sent to storage, including objects written
+        // again, if tracksBatches
+        T writesIssued = {};
+        T writeBytesIssued = {};
+
+        bool tracksRequests = false;
+        bool tracksBatches = false;
     };
 
     /** Destroy the backend.
@@ -174,8 +197,9 @@ public:
 
     /** Returns read and write stats.
 
-        @note The Counters struct is specific to and only used
-              by CassandraBackend.
+        @note Backends fill in only the Counters they track, and say which:
+              the requests by CassandraBackend, and the batched writes by
+              backends that use a BatchWriter.
     */
     virtual std::optional<Counters<std::uint64_t>>
     counters() const
@@ -146,6 +146,24 @@ public:
         std::uint32_t ledgerSeq = 0,
         FetchType fetchType = FetchType::synchronous);
 
+    /** Fetch several node objects.
+        Databases able to read many objects from their backend at once
+        do so through Backend::fetchBatch.
+
+        @note This can be called concurrently.
+        @param hashes The keys of the objects to retrieve.
+        @param ledgerSeq The sequence of the ledger where the objects are
+                stored.
+        @param fetchType the type of fetch, synchronous or asynchronous.
+        @return The objects in the order of their keys, nullptr for the
+                objects that couldn't be retrieved.
+    */
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchNodeObjects(
+        std::vector<uint256> const& hashes,
+        std::uint32_t ledgerSeq = 0,
+        FetchType fetchType = FetchType::async);
+
     /** Fetch an object without waiting.
         If I/O is required to determine whether or not the object is present,
         `false` is returned. Otherwise, `true` is returned and `object` is set
@@ -303,6 +321,13 @@ private:
         std::uint32_t ledgerSeq,
         FetchReport& fetchReport) = 0;
 
+    // Fetches the objects one at a time unless overridden
+    virtual std::vector<std::shared_ptr<NodeObject>>
+    fetchNodeObjects(
+        std::vector<uint256> const& hashes,
+        std::uint32_t ledgerSeq,
+        FetchReport& fetchReport);
+
     /** Visit every object in the database
         This is usually called during import.
 
@@ -315,8 +340,7 @@ private:
 
     /** Retrieve backend read and write stats.
 
-        @note The Counters struct is specific to and only used
-              by CassandraBackend.
+        @see Backend::counters
     */
     virtual std::optional<Backend::Counters<std::uint64_t>>
     getCounters() const
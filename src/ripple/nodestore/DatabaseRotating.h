@@ -51,6 +51,17 @@ public:
     virtual void
     rotateWithLock(std::function<std::unique_ptr<NodeStore::Backend>(
                        std::string const& writableBackendName)> const& f) = 0;
+
+    /** Copy objects missing from the writable backend out of the archive.
+
+        Both backends are read and the writable backend is written in
+        batches, which is much cheaper than fetching each object.
+
+        @param hashes The keys of the objects that must be writable.
+        @return The number of objects copied.
+    */
+    virtual std::size_t
+    copyToWritable(std::vector<uint256> const& hashes) = 0;
 };
 
 }  // namespace NodeStore
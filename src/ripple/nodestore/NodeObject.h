@@ -22,6 +22,7 @@
 
 #include <ripple/basics/Blob.h>
 #include <ripple/basics/CountedObject.h>
+#include <ripple/basics/Slice.h>
 #include <ripple/protocol/Protocol.h>
 
 // VFALCO NOTE Intentionally not in the NodeStore namespace
@@ -60,10 +61,18 @@ private:
     };
 
 public:
-    // This constructor is private, use createObject instead.
+    // These constructors are private, use createObject instead.
     NodeObject(
         NodeObjectType type,
         Blob&& data,
+        std::size_t offset,
+        uint256 const& hash,
+        PrivateAccess);
+
+    NodeObject(
+        NodeObjectType type,
+        Slice data,
+        std::shared_ptr<void const> owner,
         uint256 const& hash,
         PrivateAccess);
 
@@ -81,6 +90,31 @@ public:
     static std::shared_ptr<NodeObject>
     createObject(NodeObjectType type, Blob&& data, uint256 const& hash);
 
+    /** Create an object from the tail of a buffer.
+
+        The buffer is taken over as with the other overload, but the data
+        starts `offset` bytes into it. This lets a decoded value keep its
+        header in front instead of moving the payload down over it.
+    */
+    static std::shared_ptr<NodeObject>
+    createObject(
+        NodeObjectType type,
+        Blob&& buffer,
+        std::size_t offset,
+        uint256 const& hash);
+
+    /** Create an object over data that it does not own.
+
+        Nothing is copied. The object holds a reference to `owner`, which
+        must keep the data valid and unchanged for as long as it lives.
+    */
+    static std::shared_ptr<NodeObject>
+    createObject(
+        NodeObjectType type,
+        Slice data,
+        std::shared_ptr<void const> owner,
+        uint256 const& hash);
+
     /** Returns the type of this object. */
     NodeObjectType
     getType() const;
@@ -90,13 +124,15 @@ public:
     getHash() const;
 
     /** Returns the underlying data. */
-    Blob const&
+    Slice
     getData() const;
 
 private:
     NodeObjectType const mType;
     uint256 const mHash;
-    Blob const mData;
+    Blob const mStorage;
+    std::shared_ptr<void const> const mOwner;
+    Slice const mData;
 };
 
 }  // namespace ripple
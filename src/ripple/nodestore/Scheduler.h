@@ -47,6 +47,15 @@ struct BatchWriteReport
 
     std::chrono::milliseconds elapsed;
     int writeCount;
+
+    // Objects still waiting to be written when the batch finished
+    int queueDepth = 0;
+
+    // Duplicate stores dropped since the previous report
+    int coalesced = 0;
+
+    // The number of objects the next batch may hold
+    int batchLimit = 0;
 };
 
 /** Scheduling for asynchronous backend activity
@@ -29,7 +29,6 @@
 #include <ripple/nodestore/Backend.h>
 #include <ripple/nodestore/Factory.h>
 #include <ripple/nodestore/Manager.h>
-#include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
 #include <ripple/nodestore/impl/codec.h>
 #include <ripple/protocol/digest.h>
@@ -560,21 +559,16 @@ public:
             return backendError;
         }
 
-        nudb::detail::buffer bf;
-        std::pair<void const*, std::size_t> uncompressed =
-            nodeobject_decompress(buf, bufSize, bf);
-        DecodedBlob decoded(key, uncompressed.first, uncompressed.second);
+        *pno = nodeobject_decode(key, buf, bufSize);
         cass_result_free(res);
 
-        if (!decoded.wasOk())
+        if (!*pno)
         {
-            pno->reset();
             JLOG(j_.error()) << "Cassandra error decoding result: " << rc
                              << ", " << cass_error_desc(rc);
             ++counters_.readErrors;
             return dataCorrupt;
         }
-        *pno = decoded.createObject();
         return ok;
     }
 
@@ -829,7 +823,9 @@ public:
     std::optional<Counters<std::uint64_t>>
     counters() const override
     {
-        return counters_;
+        Counters<std::uint64_t> c = counters_;
+        c.tracksRequests = true;
+        return c;
     }
 
     friend void
@@ -895,14 +891,11 @@ readCallback(CassFuture* fut, void* cbData)
             finish();
             return;
         }
-        nudb::detail::buffer bf;
-        std::pair<void const*, std::size_t> uncompressed =
-            nodeobject_decompress(buf, bufSize, bf);
-        DecodedBlob decoded(
-            requestParams.key, uncompressed.first, uncompressed.second);
+        requestParams.result =
+            nodeobject_decode(requestParams.key, buf, bufSize);
         cass_result_free(res);
 
-        if (!decoded.wasOk())
+        if (!requestParams.result)
         {
             JLOG(requestParams.backend.j_.fatal())
                 << "Cassandra fetch error - data corruption : " << rc << ", "
@@ -911,7 +904,6 @@ readCallback(CassFuture* fut, void* cbData)
             finish();
             return;
         }
-        requestParams.result = decoded.createObject();
         finish();
     }
 }
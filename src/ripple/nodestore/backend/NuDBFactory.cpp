@@ -20,8 +20,8 @@
 #include <ripple/basics/contract.h>
 #include <ripple/nodestore/Factory.h>
 #include <ripple/nodestore/Manager.h>
-#include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/ZstdDictionaries.h>
 #include <ripple/nodestore/impl/codec.h>
 #include <boost/filesystem.hpp>
 #include <cassert>
@@ -44,6 +44,12 @@ public:
     /* "SHRD" in ASCII */
     static constexpr std::uint64_t deterministicType = 0x5348524400000000ull;
 
+    /* "ZSTD" in ASCII, followed by the id of the database's dictionaries */
+    static constexpr std::uint64_t zstdType = 0x5A53544400000000ull;
+
+    /* Where a zstd database keeps its dictionaries */
+    static constexpr char const* dictionaryFile = "nudb.dict";
+
     beast::Journal const j_;
     size_t const keyBytes_;
     std::size_t const burstSize_;
@@ -51,6 +57,11 @@ public:
     nudb::store db_;
     std::atomic<bool> deletePath_;
     Scheduler& scheduler_;
+    int compressionLevel_ = ZstdDictionaries::defaultLevel;
+    // Dictionaries to create new databases with, if zstd is configured
+    std::shared_ptr<ZstdDictionaries const> newDictionaries_;
+    // Dictionaries of the open database, if it is compressed with zstd
+    std::shared_ptr<ZstdDictionaries const> dictionaries_;
 
     NuDBBackend(
         size_t keyBytes,
@@ -68,6 +79,7 @@ public:
         if (name_.empty())
             Throw<std::runtime_error>(
                 "nodestore: Missing path in NuDB backend");
+        configCompression(keyValues);
     }
 
     NuDBBackend(
@@ -88,6 +100,7 @@ public:
         if (name_.empty())
             Throw<std::runtime_error>(
                 "nodestore: Missing path in NuDB backend");
+        configCompression(keyValues);
     }
 
     ~NuDBBackend() override
@@ -120,6 +133,11 @@ public:
         if (createIfMissing)
         {
             create_directories(folder);
+            if ((appType & deterministicMask) == zstdType && !exists(dp))
+            {
+                assert(newDictionaries_);
+                newDictionaries_->save(folder / dictionaryFile);
+            }
             nudb::create<nudb::xxhasher>(
                 dp,
                 kp,
@@ -148,7 +166,14 @@ public:
          *  Random part depends on the contents of the shard and may be any.
          *  The contents of appnum field should match either old or new rule.
          */
-        if (db_.appnum() != currentType &&
+        /** A database whose appnum holds zstdType was written with the
+         *  dictionaries saved next to it, whatever is configured now.
+         */
+        dictionaries_.reset();
+        if ((db_.appnum() & deterministicMask) == zstdType)
+            dictionaries_ = openDictionaries(folder, db_.appnum());
+        else if (
+            db_.appnum() != currentType &&
             (db_.appnum() & deterministicMask) != deterministicType)
             Throw<std::runtime_error>("nodestore: unknown appnum");
         db_.set_burst(burstSize_);
@@ -163,7 +188,10 @@ public:
     void
     open(bool createIfMissing) override
     {
-        open(createIfMissing, currentType, nudb::make_uid(), nudb::make_salt());
+        auto const appType = newDictionaries_
+            ? zstdType | newDictionaries_->id()
+            : currentType;
+        open(createIfMissing, appType, nudb::make_uid(), nudb::make_salt());
     }
 
     void
@@ -190,17 +218,10 @@ public:
         nudb::error_code ec;
         db_.fetch(
             key,
-            [key, pno, &status](void const* data, std::size_t size) {
-                nudb::detail::buffer bf;
-                auto const result = nodeobject_decompress(data, size, bf);
-                DecodedBlob decoded(key, result.first, result.second);
-                if (!decoded.wasOk())
-                {
-                    status = dataCorrupt;
-                    return;
-                }
-                *pno = decoded.createObject();
-                status = ok;
+            [key, pno, &status, dictionaries = dictionaries_.get()](
+                void const* data, std::size_t size) {
+                *pno = nodeobject_decode(key, data, size, dictionaries);
+                status = *pno ? ok : dataCorrupt;
             },
             ec);
         if (ec == nudb::error::key_not_found)
@@ -241,7 +262,8 @@ public:
         e.prepare(no);
         nudb::error_code ec;
         nudb::detail::buffer bf;
-        auto const result = nodeobject_compress(e.getData(), e.getSize(), bf);
+        auto const result = nodeobject_compress(
+            e.getData(), e.getSize(), bf, dictionaries_.get());
         db_.insert(e.getKey(), result.first, result.second, ec);
         if (ec && ec != nudb::error::key_exists)
             Throw<nudb::system_error>(ec);
@@ -295,15 +317,14 @@ public:
                 void const* data,
                 std::size_t size,
                 nudb::error_code&) {
-                nudb::detail::buffer bf;
-                auto const result = nodeobject_decompress(data, size, bf);
-                DecodedBlob decoded(key, result.first, result.second);
-                if (!decoded.wasOk())
+                auto object =
+                    nodeobject_decode(key, data, size, dictionaries_.get());
+                if (!object)
                 {
                     ec = make_error_code(nudb::error::missing_value);
                     return;
                 }
-                f(decoded.createObject());
+                f(std::move(object));
             },
             nudb::no_progress{},
             ec);
@@ -350,6 +371,43 @@ public:
     {
         return 3;
     }
+
+private:
+    void
+    configCompression(Section const& keyValues)
+    {
+        std::string compression = "lz4";
+        get_if_exists(keyValues, "compression", compression);
+        get_if_exists(keyValues, "compression_level", compressionLevel_);
+        if (compression == "lz4")
+            return;
+        if (compression != "zstd")
+            Throw<std::runtime_error>(
+                "nodestore: unknown compression " + compression);
+
+        std::string path;
+        if (!get_if_exists(keyValues, "dictionaries", path))
+            Throw<std::runtime_error>(
+                "nodestore: zstd compression requires dictionaries");
+        newDictionaries_ = ZstdDictionaries::load(path, compressionLevel_);
+    }
+
+    std::shared_ptr<ZstdDictionaries const>
+    openDictionaries(
+        boost::filesystem::path const& folder,
+        std::uint64_t appnum)
+    {
+        auto const id = static_cast<std::uint32_t>(appnum & ~deterministicMask);
+        if (newDictionaries_ && newDictionaries_->id() == id)
+            return newDictionaries_;
+
+        auto dictionaries =
+            ZstdDictionaries::load(folder / dictionaryFile, compressionLevel_);
+        if (dictionaries->id() != id)
+            Throw<std::runtime_error>(
+                "nodestore: dictionaries do not match the database");
+        return dictionaries;
+    }
 };
 
 //------------------------------------------------------------------------------
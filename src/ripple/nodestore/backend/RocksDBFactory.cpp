@@ -30,8 +30,12 @@
 #include <ripple/nodestore/impl/BatchWriter.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <memory>
+#include <numeric>
 
 namespace ripple {
 namespace NodeStore {
@@ -85,6 +89,21 @@ class RocksDBBackend : public Backend, public BatchWriter::Callback
 private:
     std::atomic<bool> m_deletePath;
 
+    /*  Column families of the split layout, in the order fetches look
+        through them. Inner nodes are hashes that don't compress and are
+        read the most; state leaves are small and read at random;
+        transaction leaves are larger and mostly read with their ledger.
+        Ledger headers and anything else stay in the default family, which
+        is also where the original layout keeps everything.
+    */
+    enum Family { innerFamily, stateFamily, transactionFamily, otherFamily };
+    static constexpr std::size_t families = 4;
+    static constexpr char const* familyNames[families] = {
+        "inner",
+        "state",
+        "transaction",
+        "default"};
+
 public:
     beast::Journal m_journal;
     size_t const m_keyBytes;
@@ -94,6 +113,16 @@ public:
     std::unique_ptr<rocksdb::DB> m_db;
     int fdRequired_ = 2048;
     rocksdb::Options m_options;
+    // Create new databases with a column family per kind of object
+    bool m_splitFamilies = false;
+    std::array<rocksdb::ColumnFamilyOptions, families> m_familyOptions;
+    // Open column families in Family order; empty with the original layout
+    std::vector<rocksdb::ColumnFamilyHandle*> m_families;
+    // The column families an object may be in
+    std::vector<rocksdb::ColumnFamilyHandle*> m_readFamilies;
+    // Objects and bytes written, whether batched or not
+    std::atomic<std::uint64_t> m_writesIssued{0};
+    std::atomic<std::uint64_t> m_writeBytesIssued{0};
 
     RocksDBBackend(
         int keyBytes,
@@ -160,7 +189,8 @@ public:
 
         m_options.compression = rocksdb::kSnappyCompression;
 
-        get_if_exists(keyValues, "block_size", table_options.block_size);
+        bool const blockSizeSet =
+            get_if_exists(keyValues, "block_size", table_options.block_size);
 
         if (keyValues.exists("universal_compaction") &&
             (get<int>(keyValues, "universal_compaction") != 0))
@@ -195,6 +225,37 @@ public:
                     s.ToString());
         }
 
+        get_if_exists(keyValues, "column_families", m_splitFamilies);
+        for (std::size_t i = 0; i < families; ++i)
+        {
+            auto options = table_options;
+            auto& family = m_familyOptions[i];
+            family = rocksdb::ColumnFamilyOptions(m_options);
+
+            // Every fetch may probe each family, so all need a filter
+            if (!options.filter_policy)
+                options.filter_policy.reset(
+                    rocksdb::NewBloomFilterPolicy(10, false));
+
+            switch (i)
+            {
+                case innerFamily:
+                    family.compression = rocksdb::kNoCompression;
+                    break;
+                case stateFamily:
+                    family.compression = rocksdb::kLZ4Compression;
+                    break;
+                case transactionFamily:
+                    family.compression = rocksdb::kLZ4Compression;
+                    if (!blockSizeSet)
+                        options.block_size = 16 * 1024;
+                    break;
+                default:
+                    break;
+            }
+            family.table_factory.reset(NewBlockBasedTableFactory(options));
+        }
+
         std::string s1, s2;
         rocksdb::GetStringFromDBOptions(&s1, m_options, "; ");
         rocksdb::GetStringFromColumnFamilyOptions(&s2, m_options, "; ");
@@ -218,12 +279,45 @@ public:
         }
         rocksdb::DB* db = nullptr;
         m_options.create_if_missing = createIfMissing;
-        rocksdb::Status status = rocksdb::DB::Open(m_options, m_name, &db);
+
+        // An existing database keeps the layout it was created with
+        bool split = m_splitFamilies;
+        std::vector<std::string> names;
+        if (rocksdb::DB::ListColumnFamilies(m_options, m_name, &names).ok())
+        {
+            split = std::find(
+                        names.begin(),
+                        names.end(),
+                        familyNames[innerFamily]) != names.end();
+        }
+
+        rocksdb::Status status;
+        if (split)
+        {
+            std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+            for (std::size_t i = 0; i < families; ++i)
+                descriptors.emplace_back(familyNames[i], m_familyOptions[i]);
+            rocksdb::DBOptions options(m_options);
+            options.create_missing_column_families = createIfMissing;
+            status = rocksdb::DB::Open(
+                options, m_name, descriptors, &m_families, &db);
+        }
+        else
+        {
+            status = rocksdb::DB::Open(m_options, m_name, &db);
+        }
         if (!status.ok() || !db)
             Throw<std::runtime_error>(
                 std::string("Unable to open/create RocksDB: ") +
                 status.ToString());
         m_db.reset(db);
+        if (m_families.empty())
+            m_readFamilies = {m_db->DefaultColumnFamily()};
+        else
+            m_readFamilies = m_families;
+        JLOG(m_journal.debug())
+            << "RocksDB " << m_name << " layout: "
+            << (m_families.empty() ? "single" : "column family per kind");
     }
 
     bool
@@ -237,6 +331,10 @@ public:
     {
         if (m_db)
         {
+            for (auto const family : m_families)
+                m_db->DestroyColumnFamilyHandle(family);
+            m_families.clear();
+            m_readFamilies.clear();
             m_db.reset();
             if (m_deletePath)
             {
@@ -260,46 +358,68 @@ public:
         assert(m_db);
         pObject->reset();
 
-        Status status(ok);
+        Status status(notFound);
 
         rocksdb::ReadOptions const options;
         rocksdb::Slice const slice(static_cast<char const*>(key), m_keyBytes);
 
-        std::string string;
-
-        rocksdb::Status getStatus = m_db->Get(options, slice, &string);
-
-        if (getStatus.ok())
-        {
-            DecodedBlob decoded(key, string.data(), string.size());
-
-            if (decoded.wasOk())
+        // Returns true once the lookup in a family settled the fetch
+        auto found = [&](rocksdb::Status const& getStatus,
+                         rocksdb::Slice const& value) {
+            if (getStatus.ok())
             {
-                *pObject = decoded.createObject();
-            }
-            else
-            {
-                // Decoding failed, probably corrupted!
-                //
-                status = dataCorrupt;
+                DecodedBlob decoded(key, value.data(), value.size());
+
+                if (decoded.wasOk())
+                {
+                    *pObject = decoded.createObject();
+                    status = ok;
+                }
+                else
+                {
+                    // Decoding failed, probably corrupted!
+                    //
+                    status = dataCorrupt;
+                }
+                return true;
             }
-        }
-        else
-        {
+
             if (getStatus.IsCorruption())
             {
                 status = dataCorrupt;
+                return true;
             }
-            else if (getStatus.IsNotFound())
-            {
-                status = notFound;
-            }
-            else
+            else if (!getStatus.IsNotFound())
             {
                 status = Status(customCode + getStatus.code());
 
                 JLOG(m_journal.error()) << getStatus.ToString();
+                return true;
             }
+            return false;
+        };
+
+        auto const& families = columnFamilies();
+        if (families.size() == 1)
+        {
+            // Pinned values are read in place from the block cache
+            // rather than copied out first.
+            rocksdb::PinnableSlice value;
+            auto const getStatus =
+                m_db->Get(options, families.front(), slice, &value);
+            found(getStatus, value);
+            return status;
+        }
+
+        // Look the key up in every family with a single call. The key is
+        // in at most one of them, and the filters make the others cheap.
+        std::vector<rocksdb::Slice> const keys(families.size(), slice);
+        std::vector<std::string> values;
+        auto const statuses = m_db->MultiGet(options, families, keys, &values);
+        for (std::size_t i = 0; i < statuses.size(); ++i)
+        {
+            if (found(statuses[i], values[i]))
+                break;
         }
 
         return status;
@@ -308,22 +428,62 @@ public:
     bool
     canFetchBatch() override
     {
-        return false;
+        return true;
     }
 
     std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
     fetchBatch(std::vector<uint256 const*> const& hashes) override
     {
-        std::vector<std::shared_ptr<NodeObject>> results;
-        results.reserve(hashes.size());
-        for (auto const& h : hashes)
+        assert(m_db);
+        std::vector<std::shared_ptr<NodeObject>> results(hashes.size());
+
+        // Indexes of the hashes not found in the families looked at so far
+        std::vector<std::size_t> pending(hashes.size());
+        std::iota(pending.begin(), pending.end(), 0);
+
+        rocksdb::ReadOptions const options;
+        std::vector<rocksdb::Slice> keys;
+        std::vector<std::string> values;
+        for (auto const family : columnFamilies())
         {
-            std::shared_ptr<NodeObject> nObj;
-            Status status = fetch(h->begin(), &nObj);
-            if (status != ok)
-                results.push_back({});
-            else
-                results.push_back(nObj);
+            if (pending.empty())
+                break;
+
+            keys.clear();
+            for (auto const i : pending)
+                keys.emplace_back(
+                    reinterpret_cast<char const*>(hashes[i]->data()),
+                    m_keyBytes);
+            auto const statuses = m_db->MultiGet(
+                options,
+                std::vector<rocksdb::ColumnFamilyHandle*>(keys.size(), family),
+                keys,
+                &values);
+
+            std::size_t missing = 0;
+            for (std::size_t j = 0; j < pending.size(); ++j)
+            {
+                auto const i = pending[j];
+                if (statuses[j].ok())
+                {
+                    DecodedBlob decoded(
+                        hashes[i]->data(), values[j].data(), values[j].size());
+                    if (decoded.wasOk())
+                        results[i] = decoded.createObject();
+                    else
+                        JLOG(m_journal.fatal())
+                            << "Corrupt NodeObject #" << *hashes[i];
+                }
+                else if (statuses[j].IsNotFound())
+                {
+                    pending[missing++] = i;
+                }
+                else
+                {
+                    JLOG(m_journal.error()) << statuses[j].ToString();
+                }
+            }
+            pending.resize(missing);
         }
 
         return {results, ok};
@@ -342,12 +502,15 @@ public:
         rocksdb::WriteBatch wb;
 
         EncodedBlob encoded;
+        std::uint64_t bytes = 0;
 
         for (auto const& e : batch)
         {
             encoded.prepare(e);
+            bytes += m_keyBytes + encoded.getSize();
 
             wb.Put(
+                columnFamily(*e),
                 rocksdb::Slice(
                     reinterpret_cast<char const*>(encoded.getKey()),
                     m_keyBytes),
@@ -362,6 +525,9 @@ public:
 
         if (!ret.ok())
             Throw<std::runtime_error>("storeBatch failed: " + ret.ToString());
+
+        m_writesIssued += batch.size();
+        m_writeBytesIssued += bytes;
     }
 
     void
@@ -375,33 +541,11 @@ public:
         assert(m_db);
         rocksdb::ReadOptions const options;
 
-        std::unique_ptr<rocksdb::Iterator> it(m_db->NewIterator(options));
-
-        for (it->SeekToFirst(); it->Valid(); it->Next())
+        for (auto const family : columnFamilies())
         {
-            if (it->key().size() == m_keyBytes)
-            {
-                DecodedBlob decoded(
-                    it->key().data(), it->value().data(), it->value().size());
-
-                if (decoded.wasOk())
-                {
-                    f(decoded.createObject());
-                }
-                else
-                {
-                    // Uh oh, corrupted data!
-                    JLOG(m_journal.fatal())
-                        << "Corrupt NodeObject #" << it->key().ToString(true);
-                }
-            }
-            else
-            {
-                // VFALCO NOTE What does it mean to find an
-                //             incorrectly sized key? Corruption?
-                JLOG(m_journal.fatal())
-                    << "Bad key size = " << it->key().size();
-            }
+            std::unique_ptr<rocksdb::Iterator> it(
+                m_db->NewIterator(options, family));
+            for_each(*it, f);
         }
     }
 
@@ -411,6 +555,22 @@ public:
         return m_batch.getWriteLoad();
     }
 
+    std::optional<Counters<std::uint64_t>>
+    counters() const override
+    {
+        auto const stats = m_batch.getStats();
+
+        Counters<std::uint64_t> c;
+        c.writesRequested = stats.requested;
+        c.writesCoalesced = stats.coalesced;
+        c.writeBatches = stats.batches;
+        c.writeBatchLimit = stats.batchLimit;
+        c.writesIssued = m_writesIssued;
+        c.writeBytesIssued = m_writeBytesIssued;
+        c.tracksBatches = true;
+        return c;
+    }
+
     void
     setDeletePath() override
     {
@@ -436,6 +596,72 @@ public:
     {
         return fdRequired_;
     }
+
+private:
+    void
+    for_each(
+        rocksdb::Iterator& it,
+        std::function<void(std::shared_ptr<NodeObject>)> const& f)
+    {
+        for (it.SeekToFirst(); it.Valid(); it.Next())
+        {
+            if (it.key().size() == m_keyBytes)
+            {
+                DecodedBlob decoded(
+                    it.key().data(), it.value().data(), it.value().size());
+
+                if (decoded.wasOk())
+                {
+                    f(decoded.createObject());
+                }
+                else
+                {
+                    // Uh oh, corrupted data!
+                    JLOG(m_journal.fatal())
+                        << "Corrupt NodeObject #" << it.key().ToString(true);
+                }
+            }
+            else
+            {
+                // VFALCO NOTE What does it mean to find an
+                //             incorrectly sized key? Corruption?
+                JLOG(m_journal.fatal())
+                    << "Bad key size = " << it.key().size();
+            }
+        }
+    }
+
+    std::vector<rocksdb::ColumnFamilyHandle*> const&
+    columnFamilies() const
+    {
+        return m_readFamilies;
+    }
+
+    rocksdb::ColumnFamilyHandle*
+    columnFamily(NodeObject const& object) const
+    {
+        if (m_families.empty())
+            return m_db->DefaultColumnFamily();
+
+        auto const& data = object.getData();
+        if (data.size() >= 4 &&
+            ((std::uint32_t{data[0]} << 24) | (std::uint32_t{data[1]} << 16) |
+             (std::uint32_t{data[2]} << 8) | std::uint32_t{data[3]}) ==
+                static_cast<std::uint32_t>(HashPrefix::innerNode))
+        {
+            return m_families[innerFamily];
+        }
+
+        switch (object.getType())
+        {
+            case hotACCOUNT_NODE:
+                return m_families[stateFamily];
+            case hotTRANSACTION_NODE:
+                return m_families[transactionFamily];
+            default:
+                return m_families[otherFamily];
+        }
+    }
 };
 
 //------------------------------------------------------------------------------
@@ -18,6 +18,8 @@
 //==============================================================================
 
 #include <ripple/nodestore/impl/BatchWriter.h>
+#include <algorithm>
+#include <iterator>
 
 namespace ripple {
 namespace NodeStore {
@@ -26,9 +28,11 @@ BatchWriter::BatchWriter(Callback& callback, Scheduler& scheduler)
     : m_callback(callback)
     , m_scheduler(scheduler)
     , mWriteLoad(0)
-    , mWritePending(false)
+    , mInFlight(0)
+    , mBatchLimit(16 * batchWritePreallocationSize)
+    , mReportedCoalesced(0)
 {
-    mWriteSet.reserve(batchWritePreallocationSize);
+    mPending.reserve(batchWritePreallocationSize);
 }
 
 BatchWriter::~BatchWriter()
@@ -41,16 +45,28 @@ BatchWriter::store(std::shared_ptr<NodeObject> const& object)
 {
     std::unique_lock<decltype(mWriteMutex)> sl(mWriteMutex);
 
-    // If the batch has reached its limit, we wait
-    // until the batch writer is finished
+    ++mStats.requested;
+
+    // The same object is already queued or being written
+    if (!mPending.insert(object->getHash()).second)
+    {
+        ++mStats.coalesced;
+        return;
+    }
+
+    // If the queue has reached its limit, we wait
+    // until the batch writer catches up
     while (mWriteSet.size() >= batchWriteLimitSize)
         mWriteCondition.wait(sl);
 
     mWriteSet.push_back(object);
 
-    if (!mWritePending)
+    // Start writing if nothing is, or write a full batch alongside
+    // the one in flight
+    if (mInFlight == 0 ||
+        (mInFlight < maxInFlight && mWriteSet.size() >= mBatchLimit))
     {
-        mWritePending = true;
+        ++mInFlight;
 
         m_scheduler.scheduleTask(*this);
     }
@@ -64,6 +80,16 @@ BatchWriter::getWriteLoad()
     return std::max(mWriteLoad, static_cast<int>(mWriteSet.size()));
 }
 
+BatchWriter::Stats
+BatchWriter::getStats() const
+{
+    std::lock_guard sl(mWriteMutex);
+
+    Stats stats = mStats;
+    stats.batchLimit = mBatchLimit;
+    return stats;
+}
+
 void
 BatchWriter::performScheduledTask()
 {
@@ -73,27 +99,22 @@ BatchWriter::performScheduledTask()
 void
 BatchWriter::writeBatch()
 {
+    Batch set;
+    set.reserve(batchWritePreallocationSize);
+
     for (;;)
     {
-        std::vector<std::shared_ptr<NodeObject>> set;
-
-        set.reserve(batchWritePreallocationSize);
-
         {
             std::lock_guard sl(mWriteMutex);
 
-            mWriteSet.swap(set);
-            assert(mWriteSet.empty());
-            mWriteLoad = set.size();
-
-            if (set.empty())
+            if (mWriteSet.empty())
             {
-                mWritePending = false;
+                --mInFlight;
                 mWriteCondition.notify_all();
-
-                // VFALCO NOTE Fix this function to not return from the middle
                 return;
             }
+
+            takeBatch(set);
         }
 
         BatchWriteReport report;
@@ -102,19 +123,76 @@ BatchWriter::writeBatch()
 
         m_callback.writeBatch(set);
 
-        report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - before);
+        auto const elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - before);
+        report.elapsed =
+            std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
 
+        {
+            std::lock_guard sl(mWriteMutex);
+
+            for (auto const& object : set)
+                mPending.erase(object->getHash());
+            mWriteLoad -= static_cast<int>(set.size());
+            mStats.written += set.size();
+            ++mStats.batches;
+            updateBatchLimit(set.size(), elapsed);
+
+            report.queueDepth = mWriteSet.size();
+            report.coalesced = mStats.coalesced - mReportedCoalesced;
+            mReportedCoalesced = mStats.coalesced;
+            report.batchLimit = mBatchLimit;
+        }
+
+        set.clear();
         m_scheduler.onBatchWrite(report);
     }
 }
 
+void
+BatchWriter::takeBatch(Batch& batch)
+{
+    auto const end =
+        mWriteSet.begin() + std::min(mWriteSet.size(), mBatchLimit);
+
+    batch.assign(
+        std::make_move_iterator(mWriteSet.begin()),
+        std::make_move_iterator(end));
+    mWriteSet.erase(mWriteSet.begin(), end);
+    mWriteLoad += static_cast<int>(batch.size());
+
+    // Stores waiting for room in the queue may proceed
+    mWriteCondition.notify_all();
+}
+
+void
+BatchWriter::updateBatchLimit(
+    std::size_t count,
+    std::chrono::microseconds elapsed)
+{
+    // A partial batch that was written quickly says nothing about how
+    // many objects would meet the target.
+    if (count < mBatchLimit && elapsed <= targetLatency)
+        return;
+
+    // Scale the batch to the target and move a quarter of the way there
+    auto const target =
+        std::chrono::duration_cast<std::chrono::microseconds>(targetLatency);
+    auto const fits = count * target.count() /
+        std::max<std::chrono::microseconds::rep>(elapsed.count(), 1);
+    mBatchLimit = std::clamp<std::size_t>(
+        (3 * mBatchLimit + fits) / 4,
+        batchWritePreallocationSize,
+        batchWriteLimitSize);
+}
+
 void
 BatchWriter::waitForWriting()
 {
     std::unique_lock<decltype(mWriteMutex)> sl(mWriteMutex);
 
-    while (mWritePending)
+    while (mInFlight != 0)
         mWriteCondition.wait(sl);
 }
 
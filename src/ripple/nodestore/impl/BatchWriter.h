@@ -20,10 +20,14 @@
 #ifndef RIPPLE_NODESTORE_BATCHWRITER_H_INCLUDED
 #define RIPPLE_NODESTORE_BATCHWRITER_H_INCLUDED
 
+#include <ripple/basics/UnorderedContainers.h>
 #include <ripple/nodestore/Scheduler.h>
 #include <ripple/nodestore/Task.h>
 #include <ripple/nodestore/Types.h>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <mutex>
 
 namespace ripple {
@@ -35,6 +39,14 @@ namespace NodeStore {
     class it not required. A backend can implement its own write batching,
     or skip write batching if doing so yields a performance benefit.
 
+    Batches are group commits: objects stored while a batch is being
+    written accumulate into the next one. The number of objects a batch
+    may hold adapts so that writing it takes about `targetLatency`, and
+    when a full batch is waiting while another is being written, a second
+    task writes it concurrently. Node objects are immutable and keyed by
+    hash, so a store of an object that is already queued or being written
+    is dropped.
+
     @see Scheduler
 */
 class BatchWriter : private Task
@@ -53,6 +65,29 @@ public:
         writeBatch(Batch const& batch) = 0;
     };
 
+    /** Cumulative write statistics. */
+    struct Stats
+    {
+        // Objects passed to store()
+        std::uint64_t requested = 0;
+
+        // Stores dropped because the object was already pending
+        std::uint64_t coalesced = 0;
+
+        // Objects handed to the callback, and in how many batches
+        std::uint64_t written = 0;
+        std::uint64_t batches = 0;
+
+        // The number of objects the next batch may hold
+        std::size_t batchLimit = 0;
+    };
+
+    /** How long writing a batch should take. */
+    static constexpr std::chrono::milliseconds targetLatency{100};
+
+    /** The most batches written concurrently. */
+    static constexpr int maxInFlight = 2;
+
     /** Create a batch writer. */
     BatchWriter(Callback& callback, Scheduler& scheduler);
 
@@ -74,6 +109,10 @@ public:
     int
     getWriteLoad();
 
+    /** Get the cumulative write statistics. */
+    Stats
+    getStats() const;
+
 private:
     void
     performScheduledTask() override;
@@ -82,17 +121,32 @@ private:
     void
     waitForWriting();
 
+    // Move up to the batch limit of queued objects into a batch
+    void
+    takeBatch(Batch& batch);
+
+    // Adapt the batch limit to the time a batch of `count` objects took
+    void
+    updateBatchLimit(std::size_t count, std::chrono::microseconds elapsed);
+
 private:
     using LockType = std::recursive_mutex;
     using CondvarType = std::condition_variable_any;
 
     Callback& m_callback;
     Scheduler& m_scheduler;
-    LockType mWriteMutex;
+    LockType mutable mWriteMutex;
     CondvarType mWriteCondition;
     int mWriteLoad;
-    bool mWritePending;
-    Batch mWriteSet;
+    int mInFlight;
+    std::deque<std::shared_ptr<NodeObject>> mWriteSet;
+
+    // Hashes of the objects queued or being written
+    hash_set<uint256> mPending;
+
+    std::size_t mBatchLimit;
+    Stats mStats;
+    std::uint64_t mReportedCoalesced;
 };
 
 }  // namespace NodeStore
@@ -166,6 +166,52 @@ Database::fetchNodeObject(
     return nodeObject;
 }
 
+std::vector<std::shared_ptr<NodeObject>>
+Database::fetchNodeObjects(
+    std::vector<uint256> const& hashes,
+    std::uint32_t ledgerSeq,
+    FetchType fetchType)
+{
+    FetchReport fetchReport(fetchType);
+
+    using namespace std::chrono;
+    auto const begin{steady_clock::now()};
+
+    auto nodeObjects{fetchNodeObjects(hashes, ledgerSeq, fetchReport)};
+    assert(nodeObjects.size() == hashes.size());
+    for (auto const& nodeObject : nodeObjects)
+    {
+        if (nodeObject)
+        {
+            ++fetchHitCount_;
+            fetchSz_ += nodeObject->getData().size();
+        }
+    }
+    fetchTotalCount_ += hashes.size();
+
+    fetchReport.elapsed =
+        duration_cast<milliseconds>(steady_clock::now() - begin);
+    scheduler_.onFetch(fetchReport);
+    return nodeObjects;
+}
+
+std::vector<std::shared_ptr<NodeObject>>
+Database::fetchNodeObjects(
+    std::vector<uint256> const& hashes,
+    std::uint32_t ledgerSeq,
+    FetchReport& fetchReport)
+{
+    std::vector<std::shared_ptr<NodeObject>> nodeObjects;
+    nodeObjects.reserve(hashes.size());
+    for (auto const& hash : hashes)
+    {
+        FetchReport report(fetchReport.fetchType);
+        nodeObjects.push_back(fetchNodeObject(hash, ledgerSeq, report));
+        fetchReport.wasFound = fetchReport.wasFound || report.wasFound;
+    }
+    return nodeObjects;
+}
+
 bool
 Database::storeLedger(
     Ledger const& srcLedger,
@@ -326,7 +372,8 @@ Database::getCountsJson(Json::Value& obj)
     obj[jss::node_read_bytes] = std::to_string(fetchSz_);
     obj[jss::node_reads_duration_us] = std::to_string(fetchDurationUs_);
 
-    if (auto c = getCounters())
+    auto const c = getCounters();
+    if (c && c->tracksRequests)
     {
         obj[jss::node_read_errors] = std::to_string(c->readErrors);
         obj[jss::node_read_retries] = std::to_string(c->readRetries);
@@ -334,6 +381,23 @@ Database::getCountsJson(Json::Value& obj)
         obj[jss::node_writes_delayed] = std::to_string(c->writesDelayed);
         obj[jss::node_writes_duration_us] = std::to_string(c->writeDurationUs);
     }
+    if (c && c->tracksBatches)
+    {
+        if (c->writesRequested != 0)
+        {
+            // Objects written to storage per object stored. Batches
+            // written directly and objects stored again after they were
+            // written raise it; coalesced stores lower it.
+            obj[jss::node_write_amplification] =
+                static_cast<double>(c->writesIssued) / c->writesRequested;
+        }
+        obj[jss::node_writes_issued] = std::to_string(c->writesIssued);
+        obj[jss::node_write_bytes_issued] =
+            std::to_string(c->writeBytesIssued);
+        obj[jss::node_writes_coalesced] = std::to_string(c->writesCoalesced);
+        obj[jss::node_write_batches] = std::to_string(c->writeBatches);
+        obj[jss::node_write_batch_limit] = std::to_string(c->writeBatchLimit);
+    }
 }
 
 }  // namespace NodeStore
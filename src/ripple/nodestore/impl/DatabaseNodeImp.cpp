@@ -21,6 +21,8 @@
 #include <ripple/nodestore/impl/DatabaseNodeImp.h>
 #include <ripple/protocol/HashPrefix.h>
 
+#include <algorithm>
+
 namespace ripple {
 namespace NodeStore {
 
@@ -100,6 +102,65 @@ DatabaseNodeImp::fetchNodeObject(
     return nodeObject;
 }
 
+std::vector<std::shared_ptr<NodeObject>>
+DatabaseNodeImp::fetchNodeObjects(
+    std::vector<uint256> const& hashes,
+    std::uint32_t,
+    FetchReport& fetchReport)
+{
+    std::vector<std::shared_ptr<NodeObject>> nodeObjects(hashes.size());
+
+    // Read what the cache lacks with a single backend request
+    std::vector<uint256 const*> keys;
+    std::vector<std::size_t> positions;
+    for (std::size_t i = 0; i < hashes.size(); ++i)
+    {
+        if (cache_)
+            nodeObjects[i] = cache_->fetch(hashes[i]);
+        if (!nodeObjects[i])
+        {
+            keys.push_back(&hashes[i]);
+            positions.push_back(i);
+        }
+    }
+
+    if (!keys.empty())
+    {
+        std::pair<std::vector<std::shared_ptr<NodeObject>>, Status> result;
+        try
+        {
+            result = backend_->fetchBatch(keys);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.fatal()) << "Exception, " << e.what();
+            Rethrow();
+        }
+
+        if (result.second != ok && result.second != notFound)
+        {
+            JLOG(j_.warn()) << "Unknown status=" << result.second;
+        }
+
+        auto const size = std::min(result.first.size(), keys.size());
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            auto& nodeObject = result.first[i];
+            if (!nodeObject)
+                continue;
+            if (cache_)
+                cache_->canonicalize_replace_client(*keys[i], nodeObject);
+            nodeObjects[positions[i]] = std::move(nodeObject);
+        }
+    }
+
+    fetchReport.wasFound = std::any_of(
+        nodeObjects.begin(), nodeObjects.end(), [](auto const& nodeObject) {
+            return static_cast<bool>(nodeObject);
+        });
+    return nodeObjects;
+}
+
 std::vector<std::shared_ptr<NodeObject>>
 DatabaseNodeImp::fetchBatch(std::vector<uint256> const& hashes)
 {
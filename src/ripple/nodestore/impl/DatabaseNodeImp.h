@@ -147,6 +147,12 @@ private:
         std::uint32_t,
         FetchReport& fetchReport) override;
 
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchNodeObjects(
+        std::vector<uint256> const& hashes,
+        std::uint32_t,
+        FetchReport& fetchReport) override;
+
     void
     for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override
     {
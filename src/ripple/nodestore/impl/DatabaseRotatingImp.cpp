@@ -21,6 +21,8 @@
 #include <ripple/nodestore/impl/DatabaseRotatingImp.h>
 #include <ripple/protocol/HashPrefix.h>
 
+#include <algorithm>
+
 namespace ripple {
 namespace NodeStore {
 
@@ -57,6 +59,88 @@ DatabaseRotatingImp::rotateWithLock(
     writableBackend_ = std::move(newBackend);
 }
 
+std::size_t
+DatabaseRotatingImp::copyToWritable(std::vector<uint256> const& hashes)
+{
+    using namespace std::chrono;
+
+    if (hashes.empty())
+        return 0;
+
+    auto const before = steady_clock::now();
+    auto [writable, archive] = [&] {
+        std::lock_guard lock(mutex_);
+        return std::make_pair(writableBackend_, archiveBackend_);
+    }();
+
+    auto fetch = [&](std::shared_ptr<Backend> const& backend,
+                     std::vector<uint256 const*> const& keys) {
+        auto result = backend->fetchBatch(keys);
+        if (result.second != ok && result.second != notFound)
+        {
+            JLOG(j_.warn()) << "Unknown status=" << result.second;
+        }
+        result.first.resize(keys.size());
+        return std::move(result.first);
+    };
+
+    std::vector<uint256 const*> keys;
+    keys.reserve(hashes.size());
+    for (auto const& hash : hashes)
+        keys.push_back(&hash);
+
+    // Only look in the archive for what the writable backend lacks
+    std::uint64_t fetches = keys.size();
+    std::uint64_t hits = 0;
+    std::uint64_t size = 0;
+    {
+        auto const present = fetch(writable, keys);
+        std::vector<uint256 const*> missing;
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            if (present[i])
+            {
+                ++hits;
+                size += present[i]->getData().size();
+            }
+            else
+                missing.push_back(keys[i]);
+        }
+        keys = std::move(missing);
+    }
+
+    Batch batch;
+    std::uint64_t batchSize = 0;
+    if (!keys.empty())
+    {
+        fetches += keys.size();
+        for (auto& nodeObject : fetch(archive, keys))
+        {
+            if (!nodeObject)
+                continue;
+            batchSize += nodeObject->getData().size();
+            batch.push_back(std::move(nodeObject));
+        }
+        hits += batch.size();
+        size += batchSize;
+    }
+
+    if (!batch.empty())
+    {
+        std::lock_guard lock(copyMutex_);
+        writable->storeBatch(batch);
+    }
+
+    fetchSz_ += size;
+    updateFetchMetrics(
+        fetches,
+        hits,
+        duration_cast<microseconds>(steady_clock::now() - before).count());
+    if (!batch.empty())
+        storeStats(batch.size(), batchSize);
+    return batch.size();
+}
+
 std::string
 DatabaseRotatingImp::getName() const
 {
@@ -71,6 +155,13 @@ DatabaseRotatingImp::getWriteLoad() const
     return writableBackend_->getWriteLoad();
 }
 
+std::optional<Backend::Counters<std::uint64_t>>
+DatabaseRotatingImp::getCounters() const
+{
+    std::lock_guard lock(mutex_);
+    return writableBackend_->counters();
+}
+
 void
 DatabaseRotatingImp::import(Database& source)
 {
@@ -187,6 +278,7 @@ DatabaseRotatingImp::fetchNodeObject(
 
             // Update writable backend with data from the archive backend
             writable->store(nodeObject);
+            storeStats(1, nodeObject->getData().size());
         }
     }
 
@@ -196,6 +288,89 @@ DatabaseRotatingImp::fetchNodeObject(
     return nodeObject;
 }
 
+std::vector<std::shared_ptr<NodeObject>>
+DatabaseRotatingImp::fetchNodeObjects(
+    std::vector<uint256> const& hashes,
+    std::uint32_t,
+    FetchReport& fetchReport)
+{
+    auto fetch = [&](std::shared_ptr<Backend> const& backend,
+                     std::vector<uint256 const*> const& keys) {
+        std::pair<std::vector<std::shared_ptr<NodeObject>>, Status> result;
+        try
+        {
+            result = backend->fetchBatch(keys);
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.fatal()) << "Exception, " << e.what();
+            Rethrow();
+        }
+
+        if (result.second != ok && result.second != notFound)
+        {
+            JLOG(j_.warn()) << "Unknown status=" << result.second;
+        }
+        result.first.resize(keys.size());
+        return std::move(result.first);
+    };
+
+    auto [writable, archive] = [&] {
+        std::lock_guard lock(mutex_);
+        return std::make_pair(writableBackend_, archiveBackend_);
+    }();
+
+    std::vector<uint256 const*> keys;
+    keys.reserve(hashes.size());
+    for (auto const& hash : hashes)
+        keys.push_back(&hash);
+
+    // Try the writable backend, then the archive backend for the rest
+    auto nodeObjects = fetch(writable, keys);
+
+    std::vector<uint256 const*> missing;
+    std::vector<std::size_t> positions;
+    for (std::size_t i = 0; i < nodeObjects.size(); ++i)
+    {
+        if (!nodeObjects[i])
+        {
+            missing.push_back(keys[i]);
+            positions.push_back(i);
+        }
+    }
+
+    if (!missing.empty())
+    {
+        auto archived = fetch(archive, missing);
+        bool refreshed = false;
+        for (std::size_t i = 0; i < archived.size(); ++i)
+        {
+            auto& nodeObject = archived[i];
+            if (!nodeObject)
+                continue;
+
+            if (!refreshed)
+            {
+                // Refresh the writable backend pointer
+                std::lock_guard lock(mutex_);
+                writable = writableBackend_;
+                refreshed = true;
+            }
+
+            // Update writable backend with data from the archive backend
+            writable->store(nodeObject);
+            storeStats(1, nodeObject->getData().size());
+            nodeObjects[positions[i]] = std::move(nodeObject);
+        }
+    }
+
+    fetchReport.wasFound = std::any_of(
+        nodeObjects.begin(), nodeObjects.end(), [](auto const& nodeObject) {
+            return static_cast<bool>(nodeObject);
+        });
+    return nodeObjects;
+}
+
 void
 DatabaseRotatingImp::for_each(
     std::function<void(std::shared_ptr<NodeObject>)> f)
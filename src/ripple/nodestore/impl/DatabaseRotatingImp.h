@@ -54,12 +54,18 @@ public:
         std::function<std::unique_ptr<NodeStore::Backend>(
             std::string const& writableBackendName)> const& f) override;
 
+    std::size_t
+    copyToWritable(std::vector<uint256> const& hashes) override;
+
     std::string
     getName() const override;
 
     std::int32_t
     getWriteLoad() const override;
 
+    std::optional<Backend::Counters<std::uint64_t>>
+    getCounters() const override;
+
     void
     import(Database& source) override;
 
@@ -86,6 +92,8 @@ private:
     std::shared_ptr<Backend> writableBackend_;
     std::shared_ptr<Backend> archiveBackend_;
     mutable std::mutex mutex_;
+    // Serializes the batches written by copyToWritable
+    std::mutex copyMutex_;
 
     struct Backends
     {
@@ -99,6 +107,12 @@ private:
         std::uint32_t,
         FetchReport& fetchReport) override;
 
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchNodeObjects(
+        std::vector<uint256> const& hashes,
+        std::uint32_t,
+        FetchReport& fetchReport) override;
+
     void
     for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override;
 };
@@ -582,7 +582,7 @@ DatabaseShardImp::fetchLedger(uint256 const& hash, std::uint32_t ledgerSeq)
     };
 
     auto ledger{std::make_shared<Ledger>(
-        deserializePrefixedHeader(makeSlice(nodeObject->getData())),
+        deserializePrefixedHeader(nodeObject->getData()),
         app_.config(),
         *app_.getShardFamily())};
 
@@ -1204,6 +1204,13 @@ DatabaseShardImp::initConfig(std::lock_guard<std::mutex> const&)
         avgShardFileSz_ = ledgersPerShard_ * kilobytes(192);
     }
 
+    {
+        std::uint32_t finalizeThreads{4};
+        get_if_exists(section, "finalize_threads", finalizeThreads);
+        if (finalizeThreads == 0 || finalizeThreads > 32)
+            return fail("'finalize_threads' must be between 1 and 32");
+    }
+
     // NuDB is the default and only supported permanent storage backend
     backendName_ = get<std::string>(section, "type", "nudb");
     if (!boost::iequals(backendName_, "NuDB"))
@@ -88,5 +88,21 @@ DecodedBlob::createObject()
     return object;
 }
 
+std::shared_ptr<NodeObject>
+DecodedBlob::createObject(Blob&& buffer)
+{
+    assert(m_success);
+
+    if (!m_success)
+        return {};
+
+    if (buffer.size() != m_dataBytes + 9 || m_objectData != buffer.data() + 9)
+        return createObject();
+
+    // The header stays in front of the body
+    return NodeObject::createObject(
+        m_objectType, std::move(buffer), 9, uint256::fromVoid(m_key));
+}
+
 }  // namespace NodeStore
 }  // namespace ripple
@@ -52,6 +52,18 @@ public:
     std::shared_ptr<NodeObject>
     createObject();
 
+    /** Create a NodeObject, reusing the storage the value was decoded into.
+
+        If this blob was constructed over the whole of `buffer`, the buffer
+        becomes the object's storage and its data starts past the header,
+        so nothing is allocated, copied or moved. Otherwise the data is
+        copied as with createObject().
+
+        @note The blob must not be used after this call.
+    */
+    std::shared_ptr<NodeObject>
+    createObject(Blob&& buffer);
+
 private:
     bool m_success;
 
@@ -0,0 +1,304 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Log.h>
+#include <ripple/basics/contract.h>
+#include <ripple/nodestore/impl/MappedShard.h>
+#include <boost/endian/buffers.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+using boost::endian::little_uint32_buf_t;
+using boost::endian::little_uint64_buf_t;
+
+constexpr char magic[16] = {'r', 'i', 'p', 'p', 'l', 'e', 'd', ' ',
+                            'n', 'o', 'd', 'e', 's', ' ', '1', '\n'};
+
+struct Header
+{
+    char magic[16];
+    little_uint32_buf_t bucketBits;
+    little_uint32_buf_t reserved;
+    little_uint64_buf_t count;
+    little_uint64_buf_t dataSize;
+    std::uint8_t pad[24];
+};
+static_assert(sizeof(Header) == 64);
+
+// Objects per bucket the table is sized for
+constexpr std::uint64_t bucketLoad = 8;
+
+// Buckets are counted with this many bits before the table is sized
+constexpr std::uint32_t maxBucketBits = 16;
+
+std::uint32_t
+bucketOf(std::uint8_t const* key, std::uint32_t bits)
+{
+    if (bits == 0)
+        return 0;
+    std::uint32_t const prefix = (std::uint32_t{key[0]} << 24) |
+        (std::uint32_t{key[1]} << 16) | (std::uint32_t{key[2]} << 8) |
+        std::uint32_t{key[3]};
+    return prefix >> (32 - bits);
+}
+
+}  // namespace
+
+struct MappedShard::Entry
+{
+    std::uint8_t key[32];
+    little_uint64_buf_t offset;
+    little_uint32_buf_t size;
+    std::uint8_t type;
+    std::uint8_t pad[3];
+
+    friend bool
+    operator<(Entry const& lhs, Entry const& rhs)
+    {
+        return std::memcmp(lhs.key, rhs.key, sizeof(key)) < 0;
+    }
+};
+
+bool
+MappedShard::create(
+    Backend& backend,
+    boost::filesystem::path const& path,
+    beast::Journal j)
+{
+    static_assert(sizeof(Entry) == 48);
+    static_assert(NodeObject::keyBytes == sizeof(Entry::key));
+    using namespace boost::interprocess;
+    auto const temp = path.string() + ".tmp";
+
+    try
+    {
+        // First pass: size every part of the file
+        std::vector<std::uint64_t> counts(std::size_t{1} << maxBucketBits);
+        std::uint64_t count = 0;
+        std::uint64_t dataSize = 0;
+        backend.for_each([&](std::shared_ptr<NodeObject> object) {
+            ++counts[bucketOf(object->getHash().data(), maxBucketBits)];
+            ++count;
+            dataSize += object->getData().size();
+        });
+
+        std::uint32_t bits = 0;
+        while (bits < maxBucketBits && (bucketLoad << bits) < count)
+            ++bits;
+        std::uint64_t const buckets = std::uint64_t{1} << bits;
+        std::uint64_t const tableSize =
+            sizeof(Header) + (buckets + 1) * sizeof(little_uint64_buf_t);
+        std::uint64_t const entriesSize = count * sizeof(Entry);
+
+        boost::filesystem::remove(temp);
+        boost::filesystem::ofstream(temp, std::ios::binary);
+        boost::filesystem::resize_file(
+            temp, tableSize + entriesSize + dataSize);
+
+        file_mapping file(temp.c_str(), read_write);
+        mapped_region region(file, read_write);
+        auto const begin = static_cast<std::uint8_t*>(region.get_address());
+        auto const table =
+            reinterpret_cast<little_uint64_buf_t*>(begin + sizeof(Header));
+        auto const entries = reinterpret_cast<Entry*>(begin + tableSize);
+        auto const data = begin + tableSize + entriesSize;
+
+        // Each bucket starts where the previous one ends
+        std::vector<std::uint64_t> next(buckets + 1);
+        auto const shift = maxBucketBits - bits;
+        for (std::size_t i = 0; i < counts.size(); ++i)
+            next[(i >> shift) + 1] += counts[i];
+        for (std::uint64_t i = 0; i < buckets; ++i)
+            next[i + 1] += next[i];
+        for (std::uint64_t i = 0; i <= buckets; ++i)
+            table[i] = next[i];
+
+        // Second pass: place the objects
+        std::uint64_t offset = 0;
+        bool changed = false;
+        backend.for_each([&](std::shared_ptr<NodeObject> object) {
+            auto const& hash = object->getHash();
+            auto const& blob = object->getData();
+            auto const bucket = bucketOf(hash.data(), bits);
+            if (changed || next[bucket] == table[bucket + 1].value() ||
+                blob.size() > dataSize - offset)
+            {
+                changed = true;
+                return;
+            }
+
+            auto& entry = entries[next[bucket]++];
+            std::memcpy(entry.key, hash.data(), sizeof(entry.key));
+            entry.offset = offset;
+            entry.size = static_cast<std::uint32_t>(blob.size());
+            entry.type = static_cast<std::uint8_t>(object->getType());
+            if (!blob.empty())
+                std::memcpy(data + offset, blob.data(), blob.size());
+            offset += blob.size();
+        });
+        for (std::uint64_t i = 0; i < buckets; ++i)
+            changed = changed || next[i] != table[i + 1].value();
+        if (changed || offset != dataSize)
+            Throw<std::runtime_error>("backend changed while mapping");
+
+        for (std::uint64_t i = 0; i < buckets; ++i)
+            std::sort(
+                entries + table[i].value(), entries + table[i + 1].value());
+
+        // The header goes last, so that an incomplete file is rejected
+        auto& header = *reinterpret_cast<Header*>(begin);
+        header.bucketBits = bits;
+        header.reserved = 0;
+        header.count = count;
+        header.dataSize = dataSize;
+        std::memset(header.pad, 0, sizeof(header.pad));
+        std::memcpy(header.magic, magic, sizeof(magic));
+        region.flush();
+
+        boost::filesystem::rename(temp, path);
+        JLOG(j.debug()) << "mapped " << count << " node objects to " << path;
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j.error()) << "unable to map node objects to " << path << ": "
+                        << e.what();
+        boost::system::error_code ec;
+        boost::filesystem::remove(temp, ec);
+        return false;
+    }
+
+    return true;
+}
+
+std::unique_ptr<MappedShard>
+MappedShard::open(boost::filesystem::path const& path, beast::Journal j)
+{
+    using namespace boost::interprocess;
+
+    std::unique_ptr<MappedShard> shard(new MappedShard);
+    try
+    {
+        if (!boost::filesystem::exists(path))
+            return nullptr;
+
+        shard->file_ = file_mapping(path.string().c_str(), read_only);
+        shard->region_ =
+            std::make_shared<mapped_region const>(shard->file_, read_only);
+        shard->begin_ =
+            static_cast<std::uint8_t const*>(shard->region_->get_address());
+        std::uint64_t const fileSize = shard->region_->get_size();
+
+        auto fail = [&](char const* reason) {
+            JLOG(j.error()) << "ignoring " << path << ": " << reason;
+            return nullptr;
+        };
+
+        if (fileSize < sizeof(Header))
+            return fail("too small");
+        auto const& header = *reinterpret_cast<Header const*>(shard->begin_);
+        if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+            return fail("not a node map");
+        if (header.bucketBits.value() > maxBucketBits)
+            return fail("bad header");
+
+        shard->bucketBits_ = header.bucketBits.value();
+        shard->count_ = header.count.value();
+        shard->dataSize_ = header.dataSize.value();
+        std::uint64_t const buckets = std::uint64_t{1} << shard->bucketBits_;
+        std::uint64_t const tableSize =
+            sizeof(Header) + (buckets + 1) * sizeof(little_uint64_buf_t);
+        if (shard->count_ > (fileSize - tableSize) / sizeof(Entry) ||
+            tableSize + shard->count_ * sizeof(Entry) + shard->dataSize_ !=
+                fileSize)
+        {
+            return fail("bad size");
+        }
+
+        shard->buckets_ = shard->begin_ + sizeof(Header);
+        shard->entries_ =
+            reinterpret_cast<Entry const*>(shard->begin_ + tableSize);
+        shard->data_ =
+            shard->begin_ + tableSize + shard->count_ * sizeof(Entry);
+
+        // Lookups trust the bucket table, so check it once
+        auto const table =
+            reinterpret_cast<little_uint64_buf_t const*>(shard->buckets_);
+        if (table[0].value() != 0 || table[buckets].value() != shard->count_)
+            return fail("bad bucket table");
+        for (std::uint64_t i = 0; i < buckets; ++i)
+        {
+            if (table[i].value() > table[i + 1].value())
+                return fail("bad bucket table");
+        }
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(j.error()) << "unable to map " << path << ": " << e.what();
+        return nullptr;
+    }
+
+    return shard;
+}
+
+std::optional<std::pair<NodeObjectType, Slice>>
+MappedShard::find(uint256 const& hash) const
+{
+    auto const table = reinterpret_cast<little_uint64_buf_t const*>(buckets_);
+    auto const bucket = bucketOf(hash.data(), bucketBits_);
+    auto const first = entries_ + table[bucket].value();
+    auto const last = entries_ + table[bucket + 1].value();
+
+    auto const it = std::lower_bound(
+        first, last, hash, [](Entry const& entry, uint256 const& key) {
+            return std::memcmp(entry.key, key.data(), sizeof(entry.key)) < 0;
+        });
+    if (it == last || std::memcmp(it->key, hash.data(), sizeof(it->key)) != 0)
+        return std::nullopt;
+
+    auto const offset = it->offset.value();
+    auto const size = it->size.value();
+    if (offset > dataSize_ || size > dataSize_ - offset)
+        return std::nullopt;
+
+    return std::make_pair(
+        static_cast<NodeObjectType>(it->type), Slice(data_ + offset, size));
+}
+
+std::shared_ptr<NodeObject>
+MappedShard::fetch(uint256 const& hash) const
+{
+    auto const found = find(hash);
+    if (!found)
+        return nullptr;
+
+    auto const& [type, slice] = *found;
+    return NodeObject::createObject(type, slice, region_, hash);
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
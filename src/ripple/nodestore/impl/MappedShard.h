@@ -0,0 +1,124 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_MAPPEDSHARD_H_INCLUDED
+#define RIPPLE_NODESTORE_MAPPEDSHARD_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/nodestore/Backend.h>
+#include <ripple/nodestore/NodeObject.h>
+#include <boost/filesystem/path.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A read-only, memory-mapped copy of the node objects of a final shard.
+
+    A final shard never changes, so its objects can be laid out once in a
+    file that is looked up in place: a table of buckets indexed by the
+    leading bits of the hash, each holding the sorted keys that fall in it
+    and where their uncompressed data lives. A lookup is a binary search
+    in one bucket and returns a slice of the mapping, without reading,
+    allocating or decompressing anything.
+
+    All integers in the file are little endian.
+*/
+class MappedShard
+{
+public:
+    // Name of the file in the shard directory
+    static constexpr char const* fileName = "nodes.map";
+
+    MappedShard(MappedShard const&) = delete;
+    MappedShard&
+    operator=(MappedShard const&) = delete;
+
+    /** Write the objects of a backend to a new file.
+
+        The backend is read twice. The file is only put in place once it
+        is complete, so an interrupted build leaves nothing behind.
+
+        @return `true` if the file was created.
+    */
+    static bool
+    create(
+        Backend& backend,
+        boost::filesystem::path const& path,
+        beast::Journal j);
+
+    /** Map an existing file.
+
+        @return The mapping, or `nullptr` if the file is missing or
+                malformed.
+    */
+    static std::unique_ptr<MappedShard>
+    open(boost::filesystem::path const& path, beast::Journal j);
+
+    /** Look up an object.
+
+        @return The type and data of the object, which remain valid for
+                the life of this object, or nothing if it is not present.
+    */
+    std::optional<std::pair<NodeObjectType, Slice>>
+    find(uint256 const& hash) const;
+
+    /** Fetch an object without copying it.
+
+        The object's data is the slice of the mapping, and the object holds
+        a reference that keeps the mapping open until it is destroyed, even
+        if this object is destroyed first.
+    */
+    std::shared_ptr<NodeObject>
+    fetch(uint256 const& hash) const;
+
+    /** The number of objects in the file. */
+    std::uint64_t
+    size() const
+    {
+        return count_;
+    }
+
+private:
+    struct Entry;
+
+    MappedShard() = default;
+
+    boost::interprocess::file_mapping file_;
+    std::shared_ptr<boost::interprocess::mapped_region const> region_;
+    std::uint8_t const* begin_ = nullptr;
+    std::uint32_t bucketBits_ = 0;
+    std::uint64_t count_ = 0;
+    std::uint8_t const* buckets_ = nullptr;
+    Entry const* entries_ = nullptr;
+    std::uint8_t const* data_ = nullptr;
+    std::uint64_t dataSize_ = 0;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
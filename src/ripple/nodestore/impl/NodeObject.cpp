@@ -18,6 +18,7 @@
 //==============================================================================
 
 #include <ripple/nodestore/NodeObject.h>
+#include <cassert>
 #include <memory>
 
 namespace ripple {
@@ -27,9 +28,24 @@ namespace ripple {
 NodeObject::NodeObject(
     NodeObjectType type,
     Blob&& data,
+    std::size_t offset,
     uint256 const& hash,
     PrivateAccess)
-    : mType(type), mHash(hash), mData(std::move(data))
+    : mType(type)
+    , mHash(hash)
+    , mStorage(std::move(data))
+    , mData(mStorage.data() + offset, mStorage.size() - offset)
+{
+    assert(offset <= mStorage.size());
+}
+
+NodeObject::NodeObject(
+    NodeObjectType type,
+    Slice data,
+    std::shared_ptr<void const> owner,
+    uint256 const& hash,
+    PrivateAccess)
+    : mType(type), mHash(hash), mOwner(std::move(owner)), mData(data)
 {
 }
 
@@ -37,7 +53,29 @@ std::shared_ptr<NodeObject>
 NodeObject::createObject(NodeObjectType type, Blob&& data, uint256 const& hash)
 {
     return std::make_shared<NodeObject>(
-        type, std::move(data), hash, PrivateAccess());
+        type, std::move(data), 0, hash, PrivateAccess());
+}
+
+std::shared_ptr<NodeObject>
+NodeObject::createObject(
+    NodeObjectType type,
+    Blob&& buffer,
+    std::size_t offset,
+    uint256 const& hash)
+{
+    return std::make_shared<NodeObject>(
+        type, std::move(buffer), offset, hash, PrivateAccess());
+}
+
+std::shared_ptr<NodeObject>
+NodeObject::createObject(
+    NodeObjectType type,
+    Slice data,
+    std::shared_ptr<void const> owner,
+    uint256 const& hash)
+{
+    return std::make_shared<NodeObject>(
+        type, data, std::move(owner), hash, PrivateAccess());
 }
 
 NodeObjectType
@@ -52,7 +90,7 @@ NodeObject::getHash() const
     return mHash;
 }
 
-Blob const&
+Slice
 NodeObject::getData() const
 {
     return mData;
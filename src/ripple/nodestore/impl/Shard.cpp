@@ -22,6 +22,7 @@
 #include <ripple/app/rdb/RelationalDBInterface_global.h>
 #include <ripple/app/rdb/RelationalDBInterface_shards.h>
 #include <ripple/basics/StringUtilities.h>
+#include <ripple/beast/core/CurrentThreadName.h>
 #include <ripple/core/ConfigSections.h>
 #include <ripple/nodestore/Manager.h>
 #include <ripple/nodestore/impl/DeterministicShard.h>
@@ -31,6 +32,10 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 
+#include <condition_variable>
+#include <optional>
+#include <thread>
+
 namespace ripple {
 namespace NodeStore {
 
@@ -79,6 +84,7 @@ Shard::~Shard()
         }
 
         // Release database files first otherwise remove_all may fail
+        mapped_.reset();
         backend_.reset();
         lgrSQLiteDB_.reset();
         txSQLiteDB_.reset();
@@ -117,6 +123,8 @@ Shard::init(Scheduler& scheduler, nudb::context& context)
         JLOG(j_.error()) << "shard " << index_ << " already initialized";
         return false;
     }
+    get_if_exists(section, "memory_map", memoryMap_);
+    get_if_exists(section, "finalize_threads", finalizeThreads_);
     backend_ = factory->createInstance(
         NodeObject::keyBytes,
         section,
@@ -175,6 +183,7 @@ Shard::tryClose()
         return false;
     }
 
+    mapped_.reset();
     lgrSQLiteDB_.reset();
     txSQLiteDB_.reset();
     acquireInfo_.reset();
@@ -251,6 +260,15 @@ Shard::fetchNodeObject(uint256 const& hash, FetchReport& fetchReport)
 
     std::shared_ptr<NodeObject> nodeObject;
 
+    // A final shard's map holds all of its node objects
+    if (mapped_)
+    {
+        nodeObject = mapped_->fetch(hash);
+        if (nodeObject)
+            fetchReport.wasFound = true;
+        return nodeObject;
+    }
+
     // Try the backend
     Status status;
     try
@@ -658,8 +676,6 @@ Shard::finalize(bool writeSQLite, std::optional<uint256> const& referenceHash)
 
     // Verify every ledger stored in the backend
     Config const& config{app_.config()};
-    std::shared_ptr<Ledger> ledger;
-    std::shared_ptr<Ledger const> next;
     auto const lastLedgerHash{hash};
     auto& shardFamily{*app_.getShardFamily()};
     auto const fullBelowCache{shardFamily.getFullBelowCache(lastSeq_)};
@@ -681,7 +697,11 @@ Shard::finalize(bool writeSQLite, std::optional<uint256> const& referenceHash)
         return fail("Failed to create deterministic shard");
 
     // Start with the last ledger in the shard and walk backwards from
-    // child to parent until we reach the first ledger
+    // child to parent until we reach the first ledger. Ledger headers
+    // are small, so collect them all first.
+    std::uint32_t const ledgerCount{lastSeq_ - firstSeq_ + 1};
+    std::vector<std::shared_ptr<NodeObject>> headers;
+    headers.reserve(ledgerCount);
     ledgerSeq = lastSeq_;
     while (ledgerSeq >= firstSeq_)
     {
@@ -692,47 +712,182 @@ Shard::finalize(bool writeSQLite, std::optional<uint256> const& referenceHash)
         if (!nodeObject)
             return fail("invalid ledger");
 
-        ledger = std::make_shared<Ledger>(
-            deserializePrefixedHeader(makeSlice(nodeObject->getData())),
-            config,
-            shardFamily);
-        if (ledger->info().seq != ledgerSeq)
+        auto const info{deserializePrefixedHeader(nodeObject->getData())};
+        if (info.seq != ledgerSeq)
             return fail("invalid ledger sequence");
-        if (ledger->info().hash != hash)
+        if (info.hash != hash)
             return fail("invalid ledger hash");
 
-        ledger->stateMap().setLedgerSeq(ledgerSeq);
-        ledger->txMap().setLedgerSeq(ledgerSeq);
+        headers.emplace_back(std::move(nodeObject));
+        hash = info.parentHash;
+        --ledgerSeq;
+    }
+
+    auto makeLedger = [&](std::size_t i) -> std::shared_ptr<Ledger> {
+        auto ledger{std::make_shared<Ledger>(
+            deserializePrefixedHeader(headers[i]->getData()),
+            config,
+            shardFamily)};
+        ledger->stateMap().setLedgerSeq(ledger->info().seq);
+        ledger->txMap().setLedgerSeq(ledger->info().seq);
         ledger->setImmutable(config);
         if (!ledger->stateMap().fetchRoot(
                 SHAMapHash{ledger->info().accountHash}, nullptr))
         {
-            return fail("missing root STATE node");
+            return nullptr;
         }
         if (ledger->info().txHash.isNonZero() &&
             !ledger->txMap().fetchRoot(
                 SHAMapHash{ledger->info().txHash}, nullptr))
         {
-            return fail("missing root TXN node");
+            return nullptr;
         }
+        return ledger;
+    };
 
-        if (!verifyLedger(ledger, next, dShard))
-            return fail("failed to verify ledger");
+    // Each ledger is verified against its child alone, so the ledgers are
+    // verified concurrently. Most state nodes are shared with the child
+    // and skipped; the child's nodes loaded by the thread verifying it are
+    // found in the shared tree node cache. The verified node objects are
+    // stored here in the order a single thread would store them, which
+    // keeps the deterministic shard the same.
+    struct Verified
+    {
+        std::shared_ptr<Ledger> ledger;
+        std::vector<std::shared_ptr<NodeObject>> nodeObjects;
+    };
+    std::vector<std::optional<Verified>> verified(ledgerCount);
+    std::mutex verifiedMutex;
+    std::condition_variable verifiedCond;
+    std::atomic<std::uint32_t> nextIndex{0};
+    std::uint32_t storedCount{0};
+    std::optional<std::string> error;
+
+    // How far verification may run ahead of storage
+    std::uint32_t const window{2 * finalizeThreads_};
+
+    auto verify = [&]() {
+        for (;;)
+        {
+            auto const i{nextIndex++};
+            if (i >= ledgerCount)
+                return;
 
-        if (!dShard->store(nodeObject))
-            return fail("failed to store node object");
+            {
+                std::unique_lock lock(verifiedMutex);
+                while (!error && !stop_ && i >= storedCount + window)
+                    verifiedCond.wait_for(lock, std::chrono::milliseconds(100));
+                if (error || stop_)
+                    return;
+            }
 
-        if (writeSQLite && !storeSQLite(ledger))
-            return fail("failed storing to SQLite databases");
+            Verified result;
+            std::string msg;
+            try
+            {
+                result.ledger = makeLedger(i);
+                std::shared_ptr<Ledger const> next;
+                if (i > 0)
+                    next = makeLedger(i - 1);
+                if (!result.ledger || (i > 0 && !next))
+                    msg = "missing root node";
+                else if (!verifyLedger(
+                             result.ledger, next, result.nodeObjects))
+                    msg = "failed to verify ledger";
+            }
+            catch (std::exception const& e)
+            {
+                msg = std::string("exception caught verifying ledger") +
+                    ". Error: " + e.what();
+            }
 
-        hash = ledger->info().parentHash;
-        next = std::move(ledger);
-        --ledgerSeq;
+            std::lock_guard lock(verifiedMutex);
+            if (!msg.empty())
+            {
+                if (!error)
+                    error = msg + ". Ledger sequence " +
+                        std::to_string(lastSeq_ - i);
+                verifiedCond.notify_all();
+                return;
+            }
+            verified[i] = std::move(result);
+            verifiedCond.notify_all();
+        }
+    };
 
-        fullBelowCache->reset();
-        treeNodeCache->reset();
+    std::vector<std::thread> threads;
+    threads.reserve(finalizeThreads_);
+    for (std::uint32_t i = 0; i < finalizeThreads_; ++i)
+    {
+        threads.emplace_back([&verify, i, index = index_]() {
+            beast::setCurrentThreadName(
+                "Shard " + std::to_string(index) + ":" + std::to_string(i));
+            verify();
+        });
     }
 
+    auto storeVerified = [&]() -> std::optional<std::string> {
+        for (std::uint32_t i = 0; i < ledgerCount; ++i)
+        {
+            Verified result;
+            {
+                std::unique_lock lock(verifiedMutex);
+                while (!error && !stop_ && !verified[i])
+                    verifiedCond.wait_for(lock, std::chrono::milliseconds(100));
+                if (error)
+                    return error;
+                if (stop_)
+                    return std::nullopt;
+                result = std::move(*verified[i]);
+                verified[i].reset();
+            }
+
+            for (auto const& nodeObject : result.nodeObjects)
+            {
+                if (!dShard->store(nodeObject))
+                    return "failed to store node object";
+            }
+            if (!dShard->store(headers[i]))
+                return "failed to store node object";
+
+            if (writeSQLite && !storeSQLite(result.ledger))
+                return "failed storing to SQLite databases";
+
+            {
+                std::lock_guard lock(verifiedMutex);
+                ++storedCount;
+                verifiedCond.notify_all();
+            }
+
+            // Reset caches to reduce memory usage
+            if (storedCount % window == 0)
+            {
+                fullBelowCache->reset();
+                treeNodeCache->reset();
+            }
+        }
+        return std::nullopt;
+    };
+
+    auto const storeError{storeVerified()};
+    {
+        // Release the verifying threads if storing stopped early
+        std::lock_guard lock(verifiedMutex);
+        if (!error)
+            error = storeError.value_or("stopped");
+        verifiedCond.notify_all();
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    fullBelowCache->reset();
+    treeNodeCache->reset();
+
+    if (stop_)
+        return false;
+    if (storeError)
+        return fail(*storeError);
+
     JLOG(j_.debug()) << "shard " << index_ << " is valid";
 
     /*
@@ -810,11 +965,21 @@ Shard::finalize(bool writeSQLite, std::optional<uint256> const& referenceHash)
         remove(dir_ / "nudb.dat");
         rename(dShard->getDir() / "nudb.key", dir_ / "nudb.key");
         rename(dShard->getDir() / "nudb.dat", dir_ / "nudb.dat");
+        remove(dir_ / MappedShard::fileName);
 
         // Re-open deterministic shard
         if (!open(lock))
             return false;
 
+        // Lay the node objects out for lookups in place
+        if (memoryMap_ && !mapped_)
+        {
+            auto const path{dir_ / MappedShard::fileName};
+            if (MappedShard::create(*backend_, path, j_))
+                mapped_ = MappedShard::open(path, j_);
+            setFileStats(lock);
+        }
+
         // Allow all other threads work with the shard
         busy_ = false;
     }
@@ -835,6 +1000,7 @@ Shard::open(std::lock_guard<std::mutex> const& lock)
     Config const& config{app_.config()};
     auto preexist{false};
     auto fail = [this, &preexist](std::string const& msg) {
+        mapped_.reset();
         backend_->close();
         lgrSQLiteDB_.reset();
         txSQLiteDB_.reset();
@@ -932,6 +1098,12 @@ Shard::open(std::lock_guard<std::mutex> const& lock)
             {
                 lastAccess_ = std::chrono::steady_clock::now();
                 state_ = final;
+
+                if (memoryMap_)
+                {
+                    mapped_ =
+                        MappedShard::open(dir_ / MappedShard::fileName, j_);
+                }
             }
             else
                 state_ = complete;
@@ -1074,7 +1246,7 @@ bool
 Shard::verifyLedger(
     std::shared_ptr<Ledger const> const& ledger,
     std::shared_ptr<Ledger const> const& next,
-    std::shared_ptr<DeterministicShard> const& dShard) const
+    std::vector<std::shared_ptr<NodeObject>>& nodeObjects) const
 {
     auto fail = [j = j_, index = index_, &ledger](std::string const& msg) {
         JLOG(j.error()) << "shard " << index << ". " << msg
@@ -1093,13 +1265,15 @@ Shard::verifyLedger(
         return fail("Invalid ledger account hash");
 
     bool error{false};
-    auto visit = [this, &error, &dShard](SHAMapTreeNode const& node) {
+    auto visit = [this, &error, &nodeObjects](SHAMapTreeNode const& node) {
         if (stop_)
             return false;
 
         auto nodeObject{verifyFetch(node.getHash().as_uint256())};
-        if (!nodeObject || !dShard->store(nodeObject))
+        if (!nodeObject)
             error = true;
+        else
+            nodeObjects.emplace_back(std::move(nodeObject));
 
         return !error;
     };
@@ -1174,8 +1348,7 @@ Shard::verifyFetch(uint256 const& hash) const
         {
             case ok:
                 // Verify that the hash of node object matches the payload
-                if (nodeObject->getHash() !=
-                    sha512Half(makeSlice(nodeObject->getData())))
+                if (nodeObject->getHash() != sha512Half(nodeObject->getData()))
                     return fail("Node object hash does not match payload");
                 return nodeObject;
             case notFound:
@@ -28,6 +28,7 @@
 #include <ripple/nodestore/NodeObject.h>
 #include <ripple/nodestore/Scheduler.h>
 #include <ripple/nodestore/impl/DeterministicShard.h>
+#include <ripple/nodestore/impl/MappedShard.h>
 
 #include <boost/filesystem.hpp>
 #include <nudb/nudb.hpp>
@@ -306,6 +307,16 @@ private:
 
     std::atomic<std::uint32_t> backendCount_{0};
 
+    // Read-only copy of the node objects of a final shard, if configured.
+    // When present, node objects are fetched from it instead of the backend.
+    std::unique_ptr<MappedShard> mapped_;
+
+    // Create a memory-mapped copy of the node objects when finalizing
+    bool memoryMap_{false};
+
+    // Number of threads verifying ledgers when finalizing
+    std::uint32_t finalizeThreads_{4};
+
     // Ledger SQLite database used for indexes
     std::unique_ptr<DatabaseCon> lgrSQLiteDB_;
 
@@ -353,12 +364,13 @@ private:
     setFileStats(std::lock_guard<std::mutex> const&);
 
     // Verify this ledger by walking its SHAMaps and verifying its Merkle trees
-    // Every node object verified will be stored in the deterministic shard
+    // Every node object verified is added to nodeObjects, in the order
+    // it must be stored in the deterministic shard
     [[nodiscard]] bool
     verifyLedger(
         std::shared_ptr<Ledger const> const& ledger,
         std::shared_ptr<Ledger const> const& next,
-        std::shared_ptr<DeterministicShard> const& dShard) const;
+        std::vector<std::shared_ptr<NodeObject>>& nodeObjects) const;
 
     // Fetches from backend and log errors based on status codes
     [[nodiscard]] std::shared_ptr<NodeObject>
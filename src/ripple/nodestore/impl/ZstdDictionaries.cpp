@@ -0,0 +1,244 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/beast/hash/xxhasher.h>
+#include <ripple/nodestore/NodeObject.h>
+#include <ripple/nodestore/impl/ZstdDictionaries.h>
+#include <ripple/nodestore/impl/varint.h>
+#include <boost/filesystem/fstream.hpp>
+#include <iterator>
+#include <zdict.h>
+#include <zstd.h>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+// Identifies a dictionary file and the version of its format
+std::string const magic = "rippled zstd dictionaries 1\n";
+
+struct Contexts
+{
+    std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> compress{
+        ZSTD_createCCtx(),
+        &ZSTD_freeCCtx};
+    std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> decompress{
+        ZSTD_createDCtx(),
+        &ZSTD_freeDCtx};
+};
+
+// Contexts hold the working memory of zstd, so they are reused by each
+// thread rather than shared.
+Contexts&
+contexts()
+{
+    thread_local Contexts c;
+    return c;
+}
+
+}  // namespace
+
+ZstdDictionaries::ZstdDictionaries(std::string contents, int level)
+    : contents_(std::move(contents)), level_(level)
+{
+    if (contents_.compare(0, magic.size(), magic) != 0)
+        Throw<std::runtime_error>("zstd dictionaries: bad header");
+
+    auto p = reinterpret_cast<std::uint8_t const*>(contents_.data());
+    auto const end = p + contents_.size();
+    p += magic.size();
+    for (std::size_t i = 0; i < kinds; ++i)
+    {
+        std::size_t size;
+        auto const n = read_varint(p, end - p, size);
+        if (n == 0 || size > static_cast<std::size_t>(end - p) - n)
+            Throw<std::runtime_error>("zstd dictionaries: truncated");
+        p += n;
+        if (size != 0)
+        {
+            cdicts_[i].reset(ZSTD_createCDict(p, size, level_));
+            ddicts_[i].reset(ZSTD_createDDict(p, size));
+            if (!cdicts_[i] || !ddicts_[i])
+                Throw<std::runtime_error>("zstd dictionaries: bad dictionary");
+        }
+        p += size;
+    }
+    if (p != end)
+        Throw<std::runtime_error>("zstd dictionaries: trailing data");
+
+    beast::xxhasher h;
+    h(contents_.data(), contents_.size());
+    id_ = static_cast<std::uint32_t>(static_cast<std::size_t>(h));
+}
+
+ZstdDictionaries::~ZstdDictionaries() = default;
+
+void
+ZstdDictionaries::FreeCDict::operator()(ZSTD_CDict_s* cdict) const
+{
+    ZSTD_freeCDict(cdict);
+}
+
+void
+ZstdDictionaries::FreeDDict::operator()(ZSTD_DDict_s* ddict) const
+{
+    ZSTD_freeDDict(ddict);
+}
+
+std::string
+ZstdDictionaries::train(std::vector<Blob> const& samples, std::size_t maxSize)
+{
+    std::array<Blob, kinds> buffers;
+    std::array<std::vector<std::size_t>, kinds> sizes;
+    for (auto const& sample : samples)
+    {
+        auto const k = kind(sample.data(), sample.size());
+        buffers[k].insert(buffers[k].end(), sample.begin(), sample.end());
+        sizes[k].push_back(sample.size());
+    }
+
+    std::string result = magic;
+    std::array<std::uint8_t, varint_traits<std::size_t>::max> vi;
+    Blob dictionary(maxSize);
+    for (std::size_t i = 0; i < kinds; ++i)
+    {
+        std::size_t size = 0;
+        if (!sizes[i].empty())
+        {
+            size = ZDICT_trainFromBuffer(
+                dictionary.data(),
+                dictionary.size(),
+                buffers[i].data(),
+                sizes[i].data(),
+                static_cast<unsigned>(sizes[i].size()));
+            // Too few or too uniform samples; go without
+            if (ZDICT_isError(size))
+                size = 0;
+        }
+        auto const n = write_varint(vi.data(), size);
+        result.append(reinterpret_cast<char const*>(vi.data()), n);
+        result.append(reinterpret_cast<char const*>(dictionary.data()), size);
+    }
+    return result;
+}
+
+std::shared_ptr<ZstdDictionaries>
+ZstdDictionaries::load(boost::filesystem::path const& path, int level)
+{
+    boost::filesystem::ifstream ifs(path, std::ios::in | std::ios::binary);
+    if (!ifs)
+    {
+        Throw<std::runtime_error>(
+            "zstd dictionaries: unable to open " + path.string());
+    }
+    std::string contents{
+        std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+    return std::make_shared<ZstdDictionaries>(std::move(contents), level);
+}
+
+void
+ZstdDictionaries::save(boost::filesystem::path const& path) const
+{
+    boost::filesystem::ofstream ofs(
+        path, std::ios::out | std::ios::binary | std::ios::trunc);
+    ofs.write(contents_.data(), contents_.size());
+    ofs.close();
+    if (!ofs)
+    {
+        Throw<std::runtime_error>(
+            "zstd dictionaries: unable to write " + path.string());
+    }
+}
+
+ZstdDictionaries::Kind
+ZstdDictionaries::kind(void const* data, std::size_t size)
+{
+    // EncodedBlob: 8 unused bytes, the NodeObjectType, then the object
+    if (size < 9)
+        return other;
+    switch (static_cast<std::uint8_t const*>(data)[8])
+    {
+        case hotACCOUNT_NODE:
+            return accountState;
+        case hotTRANSACTION_NODE:
+            return transaction;
+        default:
+            return other;
+    }
+}
+
+std::size_t
+ZstdDictionaries::compressBound(std::size_t size)
+{
+    return ZSTD_compressBound(size);
+}
+
+std::size_t
+ZstdDictionaries::compress(
+    Kind kind,
+    void* out,
+    std::size_t outSize,
+    void const* in,
+    std::size_t inSize) const
+{
+    if (kind >= kinds)
+        Throw<std::runtime_error>("zstd compress: bad kind");
+
+    auto const ctx = contexts().compress.get();
+    auto const cdict = cdicts_[kind].get();
+    auto const result = cdict
+        ? ZSTD_compress_usingCDict(ctx, out, outSize, in, inSize, cdict)
+        : ZSTD_compressCCtx(ctx, out, outSize, in, inSize, level_);
+    if (ZSTD_isError(result))
+    {
+        Throw<std::runtime_error>(
+            std::string("zstd compress: ") + ZSTD_getErrorName(result));
+    }
+    return result;
+}
+
+void
+ZstdDictionaries::decompress(
+    Kind kind,
+    void* out,
+    std::size_t outSize,
+    void const* in,
+    std::size_t inSize) const
+{
+    if (kind >= kinds)
+        Throw<std::runtime_error>("zstd decompress: bad kind");
+
+    auto const ctx = contexts().decompress.get();
+    auto const ddict = ddicts_[kind].get();
+    auto const result = ddict
+        ? ZSTD_decompress_usingDDict(ctx, out, outSize, in, inSize, ddict)
+        : ZSTD_decompressDCtx(ctx, out, outSize, in, inSize);
+    if (ZSTD_isError(result))
+    {
+        Throw<std::runtime_error>(
+            std::string("zstd decompress: ") + ZSTD_getErrorName(result));
+    }
+    if (result != outSize)
+        Throw<std::runtime_error>("zstd decompress: size mismatch");
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,163 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_ZSTDDICTIONARIES_H_INCLUDED
+#define RIPPLE_NODESTORE_ZSTDDICTIONARIES_H_INCLUDED
+
+#include <ripple/basics/Blob.h>
+#include <boost/filesystem/path.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace ripple {
+namespace NodeStore {
+
+/** zstd dictionaries for compressing node objects.
+
+    Most node objects are small and compress poorly one at a time. Each
+    kind of object is instead compressed against a dictionary trained on
+    samples of the same kind, which holds what they typically share.
+
+    Inner nodes are not covered: the codec stores them as a branch mask
+    and their child hashes, which no dictionary can shrink further.
+*/
+class ZstdDictionaries
+{
+public:
+    enum Kind : std::uint8_t {
+        accountState = 0,  // account state leaves
+        transaction,       // transaction with metadata leaves
+        other,             // ledger headers and anything else
+        kinds
+    };
+
+    static constexpr std::size_t defaultSize = 64 * 1024;
+    static constexpr int defaultLevel = 3;
+
+    /** Create dictionaries from their serialized form.
+
+        @param contents What `contents()` returned, as written by `save`.
+        @param level The zstd compression level.
+        @throws std::runtime_error if `contents` is malformed.
+    */
+    explicit ZstdDictionaries(std::string contents, int level = defaultLevel);
+
+    ZstdDictionaries(ZstdDictionaries const&) = delete;
+    ZstdDictionaries&
+    operator=(ZstdDictionaries const&) = delete;
+
+    ~ZstdDictionaries();
+
+    /** Train dictionaries on samples of encoded node objects.
+
+        A kind with too few samples to train on gets an empty dictionary,
+        and its objects are compressed without one.
+
+        @param samples Node objects in the format produced by EncodedBlob.
+        @param maxSize The largest size of each dictionary.
+        @return The serialized dictionaries.
+    */
+    static std::string
+    train(std::vector<Blob> const& samples, std::size_t maxSize = defaultSize);
+
+    /** Read dictionaries from a file written by `save`. */
+    static std::shared_ptr<ZstdDictionaries>
+    load(boost::filesystem::path const& path, int level = defaultLevel);
+
+    void
+    save(boost::filesystem::path const& path) const;
+
+    /** Return the kind of an object in the format produced by EncodedBlob. */
+    static Kind
+    kind(void const* data, std::size_t size);
+
+    /** A checksum of the dictionaries, recorded by the databases using them.
+     */
+    std::uint32_t
+    id() const
+    {
+        return id_;
+    }
+
+    std::string const&
+    contents() const
+    {
+        return contents_;
+    }
+
+    /** Return the most space `compress` may need for `size` bytes. */
+    static std::size_t
+    compressBound(std::size_t size);
+
+    /** Compress an object with the dictionary for its kind.
+
+        @return The number of bytes written to `out`.
+        @throws std::runtime_error on failure.
+    */
+    std::size_t
+    compress(
+        Kind kind,
+        void* out,
+        std::size_t outSize,
+        void const* in,
+        std::size_t inSize) const;
+
+    /** Decompress an object into exactly `outSize` bytes.
+
+        @throws std::runtime_error on failure.
+    */
+    void
+    decompress(
+        Kind kind,
+        void* out,
+        std::size_t outSize,
+        void const* in,
+        std::size_t inSize) const;
+
+private:
+    struct FreeCDict
+    {
+        void
+        operator()(ZSTD_CDict_s* cdict) const;
+    };
+
+    struct FreeDDict
+    {
+        void
+        operator()(ZSTD_DDict_s* ddict) const;
+    };
+
+    std::string const contents_;
+    int const level_;
+    std::uint32_t id_ = 0;
+    std::array<std::unique_ptr<ZSTD_CDict_s, FreeCDict>, kinds> cdicts_;
+    std::array<std::unique_ptr<ZSTD_DDict_s, FreeDDict>, kinds> ddicts_;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -26,6 +26,8 @@
 #include <ripple/basics/contract.h>
 #include <ripple/basics/safe_cast.h>
 #include <ripple/nodestore/NodeObject.h>
+#include <ripple/nodestore/impl/DecodedBlob.h>
+#include <ripple/nodestore/impl/ZstdDictionaries.h>
 #include <ripple/nodestore/impl/varint.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <cstddef>
@@ -84,6 +86,51 @@ lz4_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
     return result;
 }
 
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+zstd_decompress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    ZstdDictionaries const& dictionaries)
+{
+    std::pair<void const*, std::size_t> result;
+    std::uint8_t const* p = reinterpret_cast<std::uint8_t const*>(in);
+    if (in_size == 0)
+        Throw<std::runtime_error>("zstd decompress: empty");
+    auto const kind = static_cast<ZstdDictionaries::Kind>(*p);
+    auto const n = read_varint(p + 1, in_size - 1, result.second);
+    if (n == 0)
+        Throw<std::runtime_error>("zstd decompress: n == 0");
+    void* const out = bf(result.second);
+    result.first = out;
+    dictionaries.decompress(
+        kind, out, result.second, p + 1 + n, in_size - 1 - n);
+    return result;
+}
+
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+zstd_compress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    ZstdDictionaries const& dictionaries)
+{
+    std::pair<void const*, std::size_t> result;
+    std::array<std::uint8_t, 1 + varint_traits<std::size_t>::max> vi;
+    auto const kind = ZstdDictionaries::kind(in, in_size);
+    vi[0] = kind;
+    auto const n = 1 + write_varint(vi.data() + 1, in_size);
+    auto const out_max = ZstdDictionaries::compressBound(in_size);
+    std::uint8_t* out = reinterpret_cast<std::uint8_t*>(bf(n + out_max));
+    result.first = out;
+    std::memcpy(out, vi.data(), n);
+    result.second =
+        n + dictionaries.compress(kind, out + n, out_max, in, in_size);
+    return result;
+}
+
 //------------------------------------------------------------------------------
 
 /*
@@ -93,11 +140,19 @@ lz4_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
     1 = lz4 compressed
     2 = inner node compressed
     3 = full inner node
+    4 = zstd compressed with a dictionary for the object's kind
+
+    Type 4 is only written to databases that record the dictionaries
+    they were written with, which must be passed in to read them.
 */
 
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
-nodeobject_decompress(void const* in, std::size_t in_size, BufferFactory&& bf)
+nodeobject_decompress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    ZstdDictionaries const* dictionaries = nullptr)
 {
     using namespace nudb::detail;
 
@@ -191,6 +246,14 @@ nodeobject_decompress(void const* in, std::size_t in_size, BufferFactory&& bf)
             write(os, is(512), 512);
             break;
         }
+        case 4:  // zstd
+        {
+            if (!dictionaries)
+                Throw<std::runtime_error>(
+                    "nodeobject codec: zstd without dictionaries");
+            result = zstd_decompress(p, in_size, bf, *dictionaries);
+            break;
+        }
         default:
             Throw<std::runtime_error>(
                 "nodeobject codec: bad type=" + std::to_string(type));
@@ -198,6 +261,39 @@ nodeobject_decompress(void const* in, std::size_t in_size, BufferFactory&& bf)
     return result;
 }
 
+/** Decode a stored value directly into a new NodeObject.
+
+    Compressed values are decompressed straight into the storage that
+    becomes the object's data, so that a fetch allocates only the object
+    and its data instead of also a scratch buffer for the decompressed
+    value.
+
+    @return The object, or nullptr if the value is not a valid object.
+*/
+template <class = void>
+std::shared_ptr<NodeObject>
+nodeobject_decode(
+    void const* key,
+    void const* in,
+    std::size_t in_size,
+    ZstdDictionaries const* dictionaries = nullptr)
+{
+    Blob buffer;
+    auto const result = nodeobject_decompress(
+        in,
+        in_size,
+        [&buffer](std::size_t n) {
+            buffer.resize(n);
+            return buffer.data();
+        },
+        dictionaries);
+
+    DecodedBlob decoded(key, result.first, result.second);
+    if (!decoded.wasOk())
+        return {};
+    return decoded.createObject(std::move(buffer));
+}
+
 template <class = void>
 void const*
 zero32()
@@ -208,7 +304,11 @@ zero32()
 
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
-nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
+nodeobject_compress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    ZstdDictionaries const* dictionaries = nullptr)
 {
     using std::runtime_error;
     using namespace nudb::detail;
@@ -272,7 +372,7 @@ nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
 
     std::array<std::uint8_t, varint_traits<std::size_t>::max> vi;
 
-    constexpr std::size_t codecType = 1;
+    std::size_t const codecType = dictionaries ? 4 : 1;
     auto const vn = write_varint(vi.data(), codecType);
     std::pair<void const*, std::size_t> result;
     switch (codecType)
@@ -291,6 +391,22 @@ nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
             result.second = vn + lzr.second;
             break;
         }
+        case 4:  // zstd
+        {
+            std::uint8_t* p;
+            auto const zr = NodeStore::zstd_compress(
+                in,
+                in_size,
+                [&p, &vn, &bf](std::size_t n) {
+                    p = reinterpret_cast<std::uint8_t*>(bf(vn + n));
+                    return p + vn;
+                },
+                *dictionaries);
+            std::memcpy(p, vi.data(), vn);
+            result.first = p;
+            result.second = vn + zr.second;
+            break;
+        }
         default:
             Throw<std::logic_error>(
                 "nodeobject codec: unknown=" + std::to_string(codecType));
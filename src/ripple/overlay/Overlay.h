@@ -114,6 +114,12 @@ public:
     virtual Json::Value
     json() = 0;
 
+    /** Return histograms of the size, send queue wait, handling time and
+        job queue delay of the messages of each traffic category.
+    */
+    virtual Json::Value
+    trafficHistograms() const = 0;
+
     /** Returns a sequence representing the current list of peers.
         The snapshot is made at the time of the call.
     */
@@ -166,6 +172,21 @@ public:
         uint256 const& uid,
         PublicKey const& validator) = 0;
 
+    /** Relay a transaction. If the tx reduce-relay feature is enabled
+     * then the transaction is sent in full to a random subset of the
+     * peers which support the feature and only announced, by hash, to
+     * the rest. Peers which don't support the feature always receive
+     * the transaction in full.
+     * @param hash the transaction's hash
+     * @param m the serialized transaction
+     * @param toSkip the peers which have already sent us this transaction
+     */
+    virtual void
+    relay(
+        uint256 const& hash,
+        protocol::TMTransaction& m,
+        std::set<Peer::id_t> const& toSkip) = 0;
+
     /** Visit every active peer.
      *
      * The visitor must be invocable as:
@@ -20,7 +20,9 @@
 #ifndef RIPPLE_OVERLAY_REDUCERELAYCOMMON_H_INCLUDED
 #define RIPPLE_OVERLAY_REDUCERELAYCOMMON_H_INCLUDED
 
+#include <algorithm>
 #include <chrono>
+#include <cstddef>
 
 namespace ripple {
 
@@ -48,6 +50,27 @@ static constexpr uint16_t MAX_SELECTED_PEERS = 5;
 // Wait before reduce-relay feature is enabled on boot up to let
 // the server establish peer connections
 static constexpr auto WAIT_ON_BOOTUP = std::chrono::minutes{10};
+// Maximum size of the per-peer queue of transaction hashes waiting to
+// be announced with TMHaveTransactions. The queue is flushed early once
+// it reaches this size.
+static constexpr std::size_t MAX_TX_QUEUE_SIZE = 10000;
+
+/** Number of peers supporting tx reduce-relay which receive a relayed
+    transaction in full. The rest only receive the transaction's hash.
+    @param eligible the number of peers supporting the feature
+    @param minPeers always relay in full to at least this many peers
+    @param percentage percent of the eligible peers to relay to in full
+*/
+inline std::size_t
+txRelayPeers(
+    std::size_t eligible,
+    std::size_t minPeers,
+    std::size_t percentage)
+{
+    if (eligible <= minPeers)
+        return eligible;
+    return std::max(minPeers, eligible * percentage / 100);
+}
 
 }  // namespace reduce_relay
 
@@ -74,15 +74,18 @@ std::string
 makeFeaturesRequestHeader(
     bool comprEnabled,
     bool vpReduceRelayEnabled,
-    bool ledgerReplayEnabled)
+    bool ledgerReplayEnabled,
+    bool txReduceRelayEnabled)
 {
     std::stringstream str;
     if (comprEnabled)
         str << FEATURE_COMPR << "=lz4" << DELIM_FEATURE;
+    if (ledgerReplayEnabled)
+        str << FEATURE_LEDGER_REPLAY << "=1" << DELIM_FEATURE;
+    if (txReduceRelayEnabled)
+        str << FEATURE_TXRR << "=1" << DELIM_FEATURE;
     if (vpReduceRelayEnabled)
         str << FEATURE_VPRR << "=1";
-    if (ledgerReplayEnabled)
-        str << FEATURE_LEDGER_REPLAY << "=1";
     return str.str();
 }
 
@@ -91,15 +94,18 @@ makeFeaturesResponseHeader(
     http_request_type const& headers,
     bool comprEnabled,
     bool vpReduceRelayEnabled,
-    bool ledgerReplayEnabled)
+    bool ledgerReplayEnabled,
+    bool txReduceRelayEnabled)
 {
     std::stringstream str;
     if (comprEnabled && isFeatureValue(headers, FEATURE_COMPR, "lz4"))
         str << FEATURE_COMPR << "=lz4" << DELIM_FEATURE;
+    if (ledgerReplayEnabled && featureEnabled(headers, FEATURE_LEDGER_REPLAY))
+        str << FEATURE_LEDGER_REPLAY << "=1" << DELIM_FEATURE;
+    if (txReduceRelayEnabled && featureEnabled(headers, FEATURE_TXRR))
+        str << FEATURE_TXRR << "=1" << DELIM_FEATURE;
     if (vpReduceRelayEnabled && featureEnabled(headers, FEATURE_VPRR))
         str << FEATURE_VPRR << "=1";
-    if (ledgerReplayEnabled && featureEnabled(headers, FEATURE_LEDGER_REPLAY))
-        str << FEATURE_LEDGER_REPLAY << "=1";
     return str.str();
 }
 
@@ -364,7 +370,8 @@ makeRequest(
     bool crawlPublic,
     bool comprEnabled,
     bool vpReduceRelayEnabled,
-    bool ledgerReplayEnabled) -> request_type
+    bool ledgerReplayEnabled,
+    bool txReduceRelayEnabled) -> request_type
 {
     request_type m;
     m.method(boost::beast::http::verb::get);
@@ -378,7 +385,10 @@ makeRequest(
     m.insert(
         "X-Protocol-Ctl",
         makeFeaturesRequestHeader(
-            comprEnabled, vpReduceRelayEnabled, ledgerReplayEnabled));
+            comprEnabled,
+            vpReduceRelayEnabled,
+            ledgerReplayEnabled,
+            txReduceRelayEnabled));
     return m;
 }
 
@@ -407,7 +417,8 @@ makeResponse(
             req,
             app.config().COMPRESSION,
             app.config().VP_REDUCE_RELAY_ENABLE,
-            app.config().LEDGER_REPLAY));
+            app.config().LEDGER_REPLAY,
+            app.config().TX_REDUCE_RELAY_ENABLE));
 
     buildHandshake(resp, sharedValue, networkID, public_ip, remote_ip, app);
 
@@ -97,6 +97,8 @@ verifyHandshake(
    @param comprEnabled if true then compression feature is enabled
    @param vpReduceRelayEnabled if true then reduce-relay feature is enabled
    @param ledgerReplayEnabled if true then ledger-replay feature is enabled
+   @param txReduceRelayEnabled if true then transaction reduce-relay feature
+          is enabled
    @return http request with empty body
  */
 request_type
@@ -104,7 +106,8 @@ makeRequest(
     bool crawlPublic,
     bool comprEnabled,
     bool vpReduceRelayEnabled,
-    bool ledgerReplayEnabled);
+    bool ledgerReplayEnabled,
+    bool txReduceRelayEnabled);
 
 /** Make http response
 
@@ -138,6 +141,8 @@ static constexpr char FEATURE_VPRR[] =
     "vprr";  // validation/proposal reduce-relay
 static constexpr char FEATURE_LEDGER_REPLAY[] =
     "ledgerreplay";  // ledger replay
+static constexpr char FEATURE_TXRR[] =
+    "txrr";  // transaction reduce-relay
 static constexpr char DELIM_FEATURE[] = ";";
 static constexpr char DELIM_VALUE[] = ",";
 
@@ -212,13 +217,16 @@ peerFeatureEnabled(
    @param comprEnabled if true then compression feature is enabled
    @param vpReduceRelayEnabled if true then reduce-relay feature is enabled
    @param ledgerReplayEnabled if true then ledger-replay feature is enabled
+   @param txReduceRelayEnabled if true then transaction reduce-relay feature
+          is enabled
    @return X-Protocol-Ctl header value
  */
 std::string
 makeFeaturesRequestHeader(
     bool comprEnabled,
     bool vpReduceRelayEnabled,
-    bool ledgerReplayEnabled);
+    bool ledgerReplayEnabled,
+    bool txReduceRelayEnabled);
 
 /** Make response header X-Protocol-Ctl value with supported features.
     If the request has a feature that we support enabled
@@ -228,6 +236,8 @@ makeFeaturesRequestHeader(
    @param comprEnabled if true then compression feature is enabled
    @param vpReduceRelayEnabled if true then reduce-relay feature is enabled
    @param ledgerReplayEnabled if true then ledger-replay feature is enabled
+   @param txReduceRelayEnabled if true then transaction reduce-relay feature
+          is enabled
    @return X-Protocol-Ctl header value
  */
 std::string
@@ -235,7 +245,8 @@ makeFeaturesResponseHeader(
     http_request_type const& headers,
     bool comprEnabled,
     bool vpReduceRelayEnabled,
-    bool ledgerReplayEnabled);
+    bool ledgerReplayEnabled,
+    bool txReduceRelayEnabled);
 
 }  // namespace ripple
 
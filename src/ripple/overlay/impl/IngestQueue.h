@@ -0,0 +1,130 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_OVERLAY_INGESTQUEUE_H_INCLUDED
+#define RIPPLE_OVERLAY_INGESTQUEUE_H_INCLUDED
+
+#include <ripple/core/JobQueue.h>
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+/** Inbound items checked in batches on the job queue.
+
+    Instead of one job per item, items are queued here and a job takes up
+    to a batch of them at a time, until the queue is empty. Another job is
+    scheduled only when the queue holds more than a batch for each job
+    already scheduled, so a burst is spread over several threads while a
+    steady trickle is handled by one.
+
+    @tparam Item The type of the queued items.
+*/
+template <class Item>
+class IngestQueue
+{
+public:
+    /** Called on the job queue with each batch of items. */
+    using Handler = std::function<void(std::vector<Item>&)>;
+
+    IngestQueue(
+        JobQueue& jobQueue,
+        JobType type,
+        std::string name,
+        std::size_t batchSize,
+        Handler handler)
+        : jobQueue_(jobQueue)
+        , type_(type)
+        , name_(std::move(name))
+        , batchSize_(batchSize)
+        , handler_(std::move(handler))
+    {
+    }
+
+    IngestQueue(IngestQueue const&) = delete;
+    IngestQueue&
+    operator=(IngestQueue const&) = delete;
+
+    /** Queue an item, scheduling a job if needed. */
+    void
+    push(Item&& item)
+    {
+        std::lock_guard lock(mutex_);
+        items_.push_back(std::move(item));
+        if (items_.size() <= jobs_ * batchSize_)
+            return;
+        if (jobQueue_.addJob(type_, name_, [this](Job&) { drain(); }))
+            ++jobs_;
+    }
+
+    /** Return the number of items waiting for a job. */
+    std::size_t
+    size() const
+    {
+        std::lock_guard lock(mutex_);
+        return items_.size();
+    }
+
+private:
+    void
+    drain()
+    {
+        std::vector<Item> batch;
+        for (;;)
+        {
+            {
+                std::lock_guard lock(mutex_);
+                if (items_.empty())
+                {
+                    --jobs_;
+                    return;
+                }
+                auto const last =
+                    items_.begin() + std::min(items_.size(), batchSize_);
+                batch.assign(
+                    std::make_move_iterator(items_.begin()),
+                    std::make_move_iterator(last));
+                items_.erase(items_.begin(), last);
+            }
+            handler_(batch);
+            batch.clear();
+        }
+    }
+
+    JobQueue& jobQueue_;
+    JobType const type_;
+    std::string const name_;
+    std::size_t const batchSize_;
+    Handler const handler_;
+
+    mutable std::mutex mutex_;
+    std::deque<Item> items_;
+    // Jobs scheduled or running
+    std::size_t jobs_ = 0;
+};
+
+}  // namespace ripple
+
+#endif
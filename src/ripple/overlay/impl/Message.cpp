@@ -86,6 +86,8 @@ Message::compress()
             case protocol::mtVALIDATORLIST:
             case protocol::mtVALIDATORLISTCOLLECTION:
             case protocol::mtREPLAY_DELTA_RESPONSE:
+            case protocol::mtHAVE_TRANSACTIONS:
+            case protocol::mtTRANSACTIONS:
                 return true;
             case protocol::mtPING:
             case protocol::mtCLUSTER:
@@ -26,6 +26,7 @@
 #include <ripple/app/rdb/RelationalDBInterface_global.h>
 #include <ripple/basics/base64.h>
 #include <ripple/basics/make_SSLContext.h>
+#include <ripple/basics/random.h>
 #include <ripple/beast/core/LexicalCast.h>
 #include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/overlay/Cluster.h>
@@ -33,6 +34,7 @@
 #include <ripple/overlay/impl/PeerImp.h>
 #include <ripple/overlay/predicates.h>
 #include <ripple/peerfinder/make_Manager.h>
+#include <ripple/protocol/jss.h>
 #include <ripple/rpc/handlers/GetCounts.h>
 #include <ripple/rpc/json_body.h>
 #include <ripple/server/SimpleWriter.h>
@@ -104,6 +106,9 @@ OverlayImpl::Timer::on_timer(error_code ec)
     if ((++overlay_.timer_count_ % Tuning::checkIdlePeers) == 0)
         overlay_.deleteIdlePeers();
 
+    if (overlay_.app_.config().TX_REDUCE_RELAY_ENABLE)
+        overlay_.sendTxQueue();
+
     timer_.expires_from_now(std::chrono::seconds(1));
     timer_.async_wait(overlay_.strand_.wrap(std::bind(
         &Timer::on_timer, shared_from_this(), std::placeholders::_1)));
@@ -141,6 +146,42 @@ OverlayImpl::OverlayImpl(
     , next_id_(1)
     , timer_count_(0)
     , slots_(app, *this)
+    , trustedValidations_(
+          app.getJobQueue(),
+          jtVALIDATION_t,
+          "recvValidation->checkValidations",
+          Tuning::ingestBatchSize,
+          [this](std::vector<InboundValidation>& batch) {
+              reportJobDelay(TrafficCount::category::validation, batch);
+              PeerImp::checkValidations(app_, batch);
+          })
+    , untrustedValidations_(
+          app.getJobQueue(),
+          jtVALIDATION_ut,
+          "recvValidation->checkValidations",
+          Tuning::ingestBatchSize,
+          [this](std::vector<InboundValidation>& batch) {
+              reportJobDelay(TrafficCount::category::validation, batch);
+              PeerImp::checkValidations(app_, batch);
+          })
+    , trustedProposals_(
+          app.getJobQueue(),
+          jtPROPOSAL_t,
+          "recvPropose->checkProposals",
+          Tuning::ingestBatchSize,
+          [this](std::vector<InboundProposal>& batch) {
+              reportJobDelay(TrafficCount::category::proposal, batch);
+              PeerImp::checkProposals(true, batch);
+          })
+    , untrustedProposals_(
+          app.getJobQueue(),
+          jtPROPOSAL_ut,
+          "recvPropose->checkProposals",
+          Tuning::ingestBatchSize,
+          [this](std::vector<InboundProposal>& batch) {
+              reportJobDelay(TrafficCount::category::proposal, batch);
+              PeerImp::checkProposals(false, batch);
+          })
     , m_stats(
           std::bind(&OverlayImpl::collect_metrics, this),
           collector,
@@ -457,6 +498,7 @@ OverlayImpl::add_active(std::shared_ptr<PeerImp> const& peer)
         (void)result.second;
     }
 
+    active_.insert(peer);
     list_.emplace(peer.get(), peer);
 
     JLOG(journal_.debug()) << "activated " << peer->getRemoteAddress() << " ("
@@ -603,8 +645,9 @@ OverlayImpl::onWrite(beast::PropertyStream::Map& stream)
 {
     beast::PropertyStream::Set set("traffic", stream);
     auto const stats = m_traffic.getCounts();
-    for (auto const& i : stats)
+    for (std::size_t c = 0; c < stats.size(); ++c)
     {
+        auto const& i = stats[c];
         if (i)
         {
             beast::PropertyStream::Map item(set);
@@ -613,8 +656,55 @@ OverlayImpl::onWrite(beast::PropertyStream::Map& stream)
             item["messages_in"] = std::to_string(i.messagesIn.load());
             item["bytes_out"] = std::to_string(i.bytesOut.load());
             item["messages_out"] = std::to_string(i.messagesOut.load());
+
+            auto const cat = safe_cast<TrafficCount::category>(c);
+            for (std::size_t j = 0; j < TrafficCount::metrics; ++j)
+            {
+                auto const metric = static_cast<TrafficCount::Metric>(j);
+                auto const snapshot =
+                    m_traffic.histogram(cat, metric).snapshot();
+                if (snapshot.count == 0)
+                    continue;
+
+                beast::PropertyStream::Map h(TrafficCount::name(metric), item);
+                h["count"] = std::to_string(snapshot.count);
+                h["total"] = std::to_string(snapshot.sum);
+                beast::PropertyStream::Set buckets("histogram", h);
+                for (std::size_t k = 0; k < snapshot.used(); ++k)
+                    buckets.add(std::to_string(snapshot.counts[k]));
+            }
+        }
+    }
+}
+
+Json::Value
+OverlayImpl::trafficHistograms() const
+{
+    Json::Value ret(Json::objectValue);
+    auto const& counts = m_traffic.getCounts();
+    for (std::size_t i = 0; i < counts.size(); ++i)
+    {
+        auto const cat = safe_cast<TrafficCount::category>(i);
+        Json::Value c(Json::objectValue);
+        for (std::size_t j = 0; j < TrafficCount::metrics; ++j)
+        {
+            auto const metric = static_cast<TrafficCount::Metric>(j);
+            auto const snapshot = m_traffic.histogram(cat, metric).snapshot();
+            if (snapshot.count == 0)
+                continue;
+
+            // Bucket i counts the samples less than 2^i
+            auto& h = c[TrafficCount::name(metric)] = Json::objectValue;
+            h[jss::count] = std::to_string(snapshot.count);
+            h[jss::total] = std::to_string(snapshot.sum);
+            auto& buckets = h[jss::histogram] = Json::arrayValue;
+            for (std::size_t k = 0; k < snapshot.used(); ++k)
+                buckets.append(std::to_string(snapshot.counts[k]));
         }
+        if (c.size() != 0)
+            ret[counts[i].name] = std::move(c);
     }
+    return ret;
 }
 
 //------------------------------------------------------------------------------
@@ -636,6 +726,7 @@ OverlayImpl::activate(std::shared_ptr<PeerImp> const& peer)
         assert(result.second);
         (void)result.second;
     }
+    active_.insert(peer);
 
     JLOG(journal_.debug()) << "activated " << peer->getRemoteAddress() << " ("
                            << peer->id() << ":"
@@ -647,13 +738,39 @@ OverlayImpl::activate(std::shared_ptr<PeerImp> const& peer)
     assert(size() != 0);
 }
 
+void
+OverlayImpl::onPeerClosed(Peer::id_t id)
+{
+    // Drop the snapshot's reference so the peer can be destroyed
+    active_.erase(id);
+}
+
 void
 OverlayImpl::onPeerDeactivate(Peer::id_t id)
 {
+    active_.erase(id);
     std::lock_guard lock(mutex_);
     ids_.erase(id);
 }
 
+void
+OverlayImpl::ingest(InboundValidation&& validation, bool trusted)
+{
+    if (trusted)
+        trustedValidations_.push(std::move(validation));
+    else
+        untrustedValidations_.push(std::move(validation));
+}
+
+void
+OverlayImpl::ingest(InboundProposal&& proposal, bool trusted)
+{
+    if (trusted)
+        trustedProposals_.push(std::move(proposal));
+    else
+        untrustedProposals_.push(std::move(proposal));
+}
+
 void
 OverlayImpl::onManifests(
     std::shared_ptr<protocol::TMManifests> const& m,
@@ -1261,6 +1378,62 @@ OverlayImpl::relay(
     return {};
 }
 
+void
+OverlayImpl::relay(
+    uint256 const& hash,
+    protocol::TMTransaction& m,
+    std::set<Peer::id_t> const& toSkip)
+{
+    auto const sm = std::make_shared<Message>(m, protocol::mtTRANSACTION);
+
+    if (!app_.config().TX_REDUCE_RELAY_ENABLE)
+    {
+        for_each([&](std::shared_ptr<PeerImp>&& p) {
+            if (toSkip.find(p->id()) == toSkip.end())
+                p->send(sm);
+        });
+        return;
+    }
+
+    // Peers without the feature get the transaction in full. The others
+    // are shuffled; a subset gets the transaction in full and the rest
+    // only the hash, with the next TMHaveTransactions.
+    std::vector<std::shared_ptr<PeerImp>> reduced;
+    reduced.reserve(active_.size());
+    for_each([&](std::shared_ptr<PeerImp>&& p) {
+        if (toSkip.find(p->id()) != toSkip.end())
+            return;
+        if (p->txReduceRelayEnabled())
+            reduced.emplace_back(std::move(p));
+        else
+            p->send(sm);
+    });
+
+    auto const full = reduce_relay::txRelayPeers(
+        reduced.size(),
+        app_.config().TX_REDUCE_RELAY_MIN_PEERS,
+        app_.config().TX_RELAY_PERCENTAGE);
+    if (full < reduced.size())
+        std::shuffle(reduced.begin(), reduced.end(), default_prng());
+
+    for (std::size_t i = 0; i < reduced.size(); ++i)
+    {
+        if (i < full)
+            reduced[i]->send(sm);
+        else
+            reduced[i]->addTxQueue(hash);
+    }
+}
+
+void
+OverlayImpl::sendTxQueue()
+{
+    for_each([](std::shared_ptr<PeerImp>&& p) {
+        if (p->txReduceRelayEnabled())
+            p->sendTxQueue();
+    });
+}
+
 std::shared_ptr<Message>
 OverlayImpl::getManifestsMessage()
 {
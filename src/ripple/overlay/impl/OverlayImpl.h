@@ -20,6 +20,7 @@
 #ifndef RIPPLE_OVERLAY_OVERLAYIMPL_H_INCLUDED
 #define RIPPLE_OVERLAY_OVERLAYIMPL_H_INCLUDED
 
+#include <ripple/app/consensus/RCLCxPeerPos.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/basics/Resolver.h>
 #include <ripple/basics/UnorderedContainers.h>
@@ -29,8 +30,11 @@
 #include <ripple/overlay/Overlay.h>
 #include <ripple/overlay/Slot.h>
 #include <ripple/overlay/impl/Handshake.h>
+#include <ripple/overlay/impl/IngestQueue.h>
+#include <ripple/overlay/impl/PeerSnapshot.h>
 #include <ripple/overlay/impl/TrafficCount.h>
 #include <ripple/peerfinder/PeerfinderManager.h>
+#include <ripple/protocol/STValidation.h>
 #include <ripple/resource/ResourceManager.h>
 #include <ripple/rpc/ServerHandler.h>
 #include <ripple/server/Handoff.h>
@@ -71,6 +75,26 @@ public:
         stop() = 0;
     };
 
+    // A validation received from a peer, waiting for its signature check
+    struct InboundValidation
+    {
+        std::weak_ptr<PeerImp> peer;
+        std::shared_ptr<STValidation> val;
+        std::shared_ptr<protocol::TMValidation> packet;
+        std::chrono::steady_clock::time_point queued =
+            std::chrono::steady_clock::now();
+    };
+
+    // A proposal received from a peer, waiting for its signature check
+    struct InboundProposal
+    {
+        std::weak_ptr<PeerImp> peer;
+        std::shared_ptr<protocol::TMProposeSet> packet;
+        RCLCxPeerPos peerPos;
+        std::chrono::steady_clock::time_point queued =
+            std::chrono::steady_clock::now();
+    };
+
 private:
     using clock_type = std::chrono::steady_clock;
     using socket_type = boost::asio::ip::tcp::socket;
@@ -110,6 +134,8 @@ private:
     TrafficCount m_traffic;
     hash_map<std::shared_ptr<PeerFinder::Slot>, std::weak_ptr<PeerImp>> m_peers;
     hash_map<Peer::id_t, std::weak_ptr<PeerImp>> ids_;
+    // Open peers, for relaying without taking mutex_
+    PeerSnapshot<PeerImp> active_;
     Resolver& m_resolver;
     std::atomic<Peer::id_t> next_id_;
     int timer_count_;
@@ -135,6 +161,12 @@ private:
     // Protects the message and the sequence list of manifests
     std::mutex manifestLock_;
 
+    // Validations and proposals from peers, checked in batches
+    IngestQueue<InboundValidation> trustedValidations_;
+    IngestQueue<InboundValidation> untrustedValidations_;
+    IngestQueue<InboundProposal> trustedProposals_;
+    IngestQueue<InboundProposal> untrustedProposals_;
+
     //--------------------------------------------------------------------------
 
 public:
@@ -197,6 +229,9 @@ public:
     Json::Value
     json() override;
 
+    Json::Value
+    trafficHistograms() const override;
+
     PeerSequence
     getActivePeers() const override;
 
@@ -226,6 +261,12 @@ public:
         uint256 const& uid,
         PublicKey const& validator) override;
 
+    void
+    relay(
+        uint256 const& hash,
+        protocol::TMTransaction& m,
+        std::set<Peer::id_t> const& toSkip) override;
+
     std::shared_ptr<Message>
     getManifestsMessage();
 
@@ -248,6 +289,10 @@ public:
     void
     activate(std::shared_ptr<PeerImp> const& peer);
 
+    // Called when an active peer closes its connection.
+    void
+    onPeerClosed(Peer::id_t id);
+
     // Called when an active peer is destroyed.
     void
     onPeerDeactivate(Peer::id_t id);
@@ -255,28 +300,30 @@ public:
     // UnaryFunc will be called as
     //  void(std::shared_ptr<PeerImp>&&)
     //
+    // Iterates a snapshot of the open peers, so neither the overlay
+    // lock nor peer destruction is involved.
     template <class UnaryFunc>
     void
     for_each(UnaryFunc&& f) const
     {
-        std::vector<std::weak_ptr<PeerImp>> wp;
-        {
-            std::lock_guard lock(mutex_);
+        active_.for_each([&f](std::shared_ptr<PeerImp> const& p) {
+            f(std::shared_ptr<PeerImp>(p));
+        });
+    }
 
-            // Iterate over a copy of the peer list because peer
-            // destruction can invalidate iterators.
-            wp.reserve(ids_.size());
+    /** Queue a validation from a peer to be checked and processed.
 
-            for (auto& x : ids_)
-                wp.push_back(x.second);
-        }
+        @param trusted Whether the validation is from a trusted validator
+    */
+    void
+    ingest(InboundValidation&& validation, bool trusted);
 
-        for (auto& w : wp)
-        {
-            if (auto p = w.lock())
-                f(std::move(p));
-        }
-    }
+    /** Queue a proposal from a peer to be checked and processed.
+
+        @param trusted Whether the proposal is from a trusted validator
+    */
+    void
+    ingest(InboundProposal&& proposal, bool trusted);
 
     // Called when TMManifests is received from a peer
     void
@@ -329,6 +376,22 @@ public:
     void
     reportTraffic(TrafficCount::category cat, bool isInbound, int bytes);
 
+    /** Add a sample to a traffic histogram */
+    void
+    reportSample(
+        TrafficCount::category cat,
+        TrafficCount::Metric metric,
+        std::uint64_t value)
+    {
+        m_traffic.addSample(cat, metric, value);
+    }
+
+    TrafficCount&
+    traffic()
+    {
+        return m_traffic;
+    }
+
     void
     incJqTransOverflow() override
     {
@@ -540,6 +603,27 @@ private:
     void
     sendEndpoints();
 
+    /** Add the time each item of a batch waited to the traffic
+     * histograms */
+    template <class Item>
+    void
+    reportJobDelay(TrafficCount::category cat, std::vector<Item> const& batch)
+    {
+        auto const now = clock_type::now();
+        for (auto const& item : batch)
+            m_traffic.addSample(
+                cat,
+                TrafficCount::Metric::jobDelay,
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    now - item.queued)
+                    .count());
+    }
+
+    /** Announce the queued transaction hashes to the peers which
+     * support tx reduce-relay */
+    void
+    sendTxQueue();
+
     /** Check if peers stopped relaying messages
      * and if slots stopped receiving messages from the validator */
     void
@@ -556,11 +640,30 @@ private:
             , messagesIn(collector->make_gauge(name, "Messages_In"))
             , messagesOut(collector->make_gauge(name, "Messages_Out"))
         {
+            for (std::size_t i = 0; i < TrafficCount::metrics; ++i)
+            {
+                std::string const metric = TrafficCount::name(
+                    static_cast<TrafficCount::Metric>(i));
+                histograms[i].avg =
+                    collector->make_gauge(name, metric + "_avg");
+                histograms[i].p99 =
+                    collector->make_gauge(name, metric + "_p99");
+            }
         }
         beast::insight::Gauge bytesIn;
         beast::insight::Gauge bytesOut;
         beast::insight::Gauge messagesIn;
         beast::insight::Gauge messagesOut;
+
+        // The average and 99th percentile of each histogram over the
+        // last collection interval
+        struct HistogramGauges
+        {
+            beast::insight::Gauge avg;
+            beast::insight::Gauge p99;
+            TrafficCount::Histogram::Snapshot last;
+        };
+        std::array<HistogramGauges, TrafficCount::metrics> histograms;
     };
 
     struct Stats
@@ -599,6 +702,20 @@ private:
             m_stats.trafficGauges[i].bytesOut = counts[i].bytesOut;
             m_stats.trafficGauges[i].messagesIn = counts[i].messagesIn;
             m_stats.trafficGauges[i].messagesOut = counts[i].messagesOut;
+
+            auto const cat = safe_cast<TrafficCount::category>(i);
+            for (std::size_t j = 0; j < TrafficCount::metrics; ++j)
+            {
+                auto& gauges = m_stats.trafficGauges[i].histograms[j];
+                auto const now =
+                    m_traffic
+                        .histogram(cat, static_cast<TrafficCount::Metric>(j))
+                        .snapshot();
+                auto const interval = now.since(gauges.last);
+                gauges.avg = interval.count ? interval.sum / interval.count : 0;
+                gauges.p99 = interval.percentile(0.99);
+                gauges.last = now;
+            }
         }
         m_stats.peerDisconnects = getPeerDisconnect();
     }
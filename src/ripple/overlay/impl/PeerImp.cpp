@@ -21,6 +21,7 @@
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/InboundTransactions.h>
 #include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/TransactionMaster.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
@@ -112,6 +113,10 @@ PeerImp::PeerImp(
           headers_,
           FEATURE_VPRR,
           app_.config().VP_REDUCE_RELAY_ENABLE))
+    , txReduceRelayEnabled_(peerFeatureEnabled(
+          headers_,
+          FEATURE_TXRR,
+          app_.config().TX_REDUCE_RELAY_ENABLE))
     , ledgerReplayEnabled_(peerFeatureEnabled(
           headers_,
           FEATURE_LEDGER_REPLAY,
@@ -121,7 +126,9 @@ PeerImp::PeerImp(
     JLOG(journal_.debug()) << " compression enabled "
                            << (compressionEnabled_ == Compressed::On)
                            << " vp reduce-relay enabled "
-                           << vpReduceRelayEnabled_ << " on " << remote_address_
+                           << vpReduceRelayEnabled_
+                           << " tx reduce-relay enabled "
+                           << txReduceRelayEnabled_ << " on " << remote_address_
                            << " " << id_;
 }
 
@@ -188,6 +195,11 @@ PeerImp::run()
     if (previous && !closed)
         fail("Malformed handshake data (3)");
 
+    // A peer that failed above must not be activated: it would never be
+    // removed from the overlay's list of open peers.
+    if (!socket_.is_open())
+        return;
+
     {
         std::lock_guard<std::mutex> sl(recentLock_);
         if (closed)
@@ -250,39 +262,67 @@ PeerImp::send(std::shared_ptr<Message> const& m)
         false,
         static_cast<int>(m->getBuffer(compressionEnabled_).size()));
 
-    auto sendq_size = send_queue_.size();
-
-    if (sendq_size < Tuning::targetSendQueue)
+    // The queue of each traffic class is bounded, and drops messages
+    // when full
+    if (!send_queue_.push(m))
     {
-        // To detect a peer that does not read from their
-        // side of the connection, we expect a peer to have
-        // a small senq periodically
-        large_sendq_ = 0;
-    }
-    else if (auto sink = journal_.debug();
-             sink && (sendq_size % Tuning::sendQueueLogFreq) == 0)
-    {
-        std::string const n = name();
-        sink << (n.empty() ? remote_address_.to_string() : n)
-             << " sendq: " << sendq_size;
+        if (auto sink = journal_.debug();
+            sink && (send_queue_.dropped() % Tuning::sendQueueLogFreq) == 1)
+        {
+            std::string const n = name();
+            sink << (n.empty() ? remote_address_.to_string() : n)
+                 << " sendq: " << send_queue_.size() << " queued, "
+                 << send_queue_.dropped() << " dropped";
+        }
     }
 
-    send_queue_.push(m);
+    if (send_queue_.writing() || send_queue_.empty())
+        return;
+
+    writeSendQueue();
+}
 
-    if (sendq_size != 0)
+void
+PeerImp::addTxQueue(uint256 const& hash)
+{
+    if (!strand_.running_in_this_thread())
+        return post(
+            strand_,
+            std::bind(&PeerImp::addTxQueue, shared_from_this(), hash));
+
+    txQueue_.insert(hash);
+    if (txQueue_.size() >= reduce_relay::MAX_TX_QUEUE_SIZE)
+        sendTxQueue();
+}
+
+void
+PeerImp::sendTxQueue()
+{
+    if (!strand_.running_in_this_thread())
+        return post(
+            strand_, std::bind(&PeerImp::sendTxQueue, shared_from_this()));
+
+    if (txQueue_.empty())
         return;
 
-    boost::asio::async_write(
-        stream_,
-        boost::asio::buffer(
-            send_queue_.front()->getBuffer(compressionEnabled_)),
-        bind_executor(
+    protocol::TMHaveTransactions ht;
+    ht.mutable_hashes()->Reserve(txQueue_.size());
+    for (auto const& hash : txQueue_)
+        ht.add_hashes(hash.data(), hash.size());
+    JLOG(p_journal_.trace()) << "sendTxQueue " << txQueue_.size();
+    txQueue_.clear();
+    send(std::make_shared<Message>(ht, protocol::mtHAVE_TRANSACTIONS));
+}
+
+void
+PeerImp::removeTxQueue(uint256 const& hash)
+{
+    if (!strand_.running_in_this_thread())
+        return post(
             strand_,
-            std::bind(
-                &PeerImp::onWriteMessage,
-                shared_from_this(),
-                std::placeholders::_1,
-                std::placeholders::_2)));
+            std::bind(&PeerImp::removeTxQueue, shared_from_this(), hash));
+
+    txQueue_.erase(hash);
 }
 
 void
@@ -436,6 +476,20 @@ PeerImp::json()
         std::to_string(metrics_.recv.average_bytes());
     ret[jss::metrics][jss::avg_bps_sent] =
         std::to_string(metrics_.sent.average_bytes());
+    ret[jss::metrics][jss::writes_sent] = std::to_string(send_queue_.writes());
+    ret[jss::metrics][jss::msgs_per_write_sent] =
+        send_queue_.messagesPerWrite();
+
+    auto& sendq = ret[jss::metrics][jss::send_queue] = Json::objectValue;
+    for (std::size_t i = 0; i < SendQueue::priorities; ++i)
+    {
+        auto const priority = static_cast<SendQueue::Priority>(i);
+        auto const stats = send_queue_.stats(priority);
+        auto& c = sendq[SendQueue::name(priority)] = Json::objectValue;
+        c[jss::queued] = std::to_string(stats.queued);
+        c[jss::sent] = std::to_string(stats.sent);
+        c[jss::dropped] = std::to_string(stats.dropped);
+    }
 
     return ret;
 }
@@ -451,6 +505,8 @@ PeerImp::supportsFeature(ProtocolFeature f) const
             return protocol_ >= make_protocol(2, 2);
         case ProtocolFeature::LedgerReplay:
             return ledgerReplayEnabled_;
+        case ProtocolFeature::TxReduceRelay:
+            return txReduceRelayEnabled_;
     }
     return false;
 }
@@ -531,6 +587,7 @@ PeerImp::close()
         error_code ec;
         timer_.cancel(ec);
         socket_.close(ec);
+        overlay_.onPeerClosed(id_);
         overlay_.incPeerDisconnect();
         if (inbound_)
         {
@@ -666,11 +723,37 @@ PeerImp::onTimer(error_code const& ec)
         return close();
     }
 
-    if (large_sendq_++ >= Tuning::sendqIntervals)
+    // To detect a peer that does not read from their side of the
+    // connection, we expect its send queue to stop dropping messages
+    // periodically
+    if (auto const dropped = send_queue_.dropped(); dropped != sendq_dropped_)
     {
-        fail("Large send queue");
-        return;
+        sendq_dropped_ = dropped;
+        if (++overflow_sendq_ >= Tuning::sendqOverflowIntervals)
+        {
+            fail("Send queue overflow");
+            return;
+        }
     }
+    else
+    {
+        overflow_sendq_ = 0;
+    }
+
+    // We also expect a write in progress to complete
+    if (send_queue_.writing() && send_queue_.writes() == sendq_writes_)
+    {
+        if (++stalled_sendq_ >= Tuning::sendqOverflowIntervals)
+        {
+            fail("Stalled send queue");
+            return;
+        }
+    }
+    else
+    {
+        stalled_sendq_ = 0;
+    }
+    sendq_writes_ = send_queue_.writes();
 
     if (auto const t = tracking_.load(); !inbound_ && t != Tracking::converged)
     {
@@ -909,6 +992,21 @@ PeerImp::onReadMessage(error_code ec, std::size_t bytes_transferred)
                 std::placeholders::_2)));
 }
 
+void
+PeerImp::writeSendQueue()
+{
+    boost::asio::async_write(
+        stream_,
+        send_queue_.prepare(compressionEnabled_),
+        bind_executor(
+            strand_,
+            std::bind(
+                &PeerImp::onWriteMessage,
+                shared_from_this(),
+                std::placeholders::_1,
+                std::placeholders::_2)));
+}
+
 void
 PeerImp::onWriteMessage(error_code ec, std::size_t bytes_transferred)
 {
@@ -929,21 +1027,11 @@ PeerImp::onWriteMessage(error_code ec, std::size_t bytes_transferred)
     metrics_.sent.add_message(bytes_transferred);
 
     assert(!send_queue_.empty());
-    send_queue_.pop();
+    send_queue_.consume();
     if (!send_queue_.empty())
     {
         // Timeout on writes only
-        return boost::asio::async_write(
-            stream_,
-            boost::asio::buffer(
-                send_queue_.front()->getBuffer(compressionEnabled_)),
-            bind_executor(
-                strand_,
-                std::bind(
-                    &PeerImp::onWriteMessage,
-                    shared_from_this(),
-                    std::placeholders::_1,
-                    std::placeholders::_2)));
+        return writeSendQueue();
     }
 
     if (gracefulClose_)
@@ -980,8 +1068,9 @@ PeerImp::onMessageBegin(
     load_event_ =
         app_.getJobQueue().makeLoadEvent(jtPEER, protocolMessageName(type));
     fee_ = Resource::feeLightPeer;
-    overlay_.reportTraffic(
-        TrafficCount::categorize(*m, type, true), true, static_cast<int>(size));
+    inboundCategory_ = TrafficCount::categorize(*m, type, true);
+    inboundTime_ = clock_type::now();
+    overlay_.reportTraffic(inboundCategory_, true, static_cast<int>(size));
     JLOG(journal_.trace()) << "onMessageBegin: " << type << " " << size << " "
                            << uncompressed_size << " " << isCompressed;
 }
@@ -993,6 +1082,37 @@ PeerImp::onMessageEnd(
 {
     load_event_.reset();
     charge(fee_);
+    overlay_.reportSample(
+        inboundCategory_,
+        TrafficCount::Metric::handler,
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            clock_type::now() - inboundTime_)
+            .count());
+}
+
+template <class JobHandler>
+bool
+PeerImp::addInboundJob(
+    JobType type,
+    std::string const& name,
+    JobHandler&& jobHandler)
+{
+    return app_.getJobQueue().addJob(
+        type,
+        name,
+        [weak = weak_from_this(),
+         category = inboundCategory_,
+         queued = clock_type::now(),
+         jobHandler = std::forward<JobHandler>(jobHandler)](Job& job) mutable {
+            if (auto peer = weak.lock())
+                peer->overlay_.reportSample(
+                    category,
+                    TrafficCount::Metric::jobDelay,
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        clock_type::now() - queued)
+                        .count());
+            jobHandler(job);
+        });
 }
 
 void
@@ -1383,6 +1503,14 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMEndpoints> const& m)
 
 void
 PeerImp::onMessage(std::shared_ptr<protocol::TMTransaction> const& m)
+{
+    handleTransaction(m, true);
+}
+
+void
+PeerImp::handleTransaction(
+    std::shared_ptr<protocol::TMTransaction> const& m,
+    bool eraseTxQueue)
 {
     if (tracking_.load() == Tracking::diverged)
         return;
@@ -1403,6 +1531,10 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMTransaction> const& m)
         auto stx = std::make_shared<STTx const>(sit);
         uint256 txID = stx->getTransactionID();
 
+        // The peer has the transaction, there's no need to announce it
+        if (txReduceRelayEnabled_ && eraseTxQueue)
+            removeTxQueue(txID);
+
         int flags;
         constexpr std::chrono::seconds tx_interval = 10s;
 
@@ -1451,7 +1583,7 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMTransaction> const& m)
         }
         else
         {
-            app_.getJobQueue().addJob(
+            addInboundJob(
                 jtTRANSACTION,
                 "recvTransaction->checkTransaction",
                 [weak = std::weak_ptr<PeerImp>(shared_from_this()),
@@ -1470,12 +1602,93 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMTransaction> const& m)
     }
 }
 
+void
+PeerImp::onMessage(std::shared_ptr<protocol::TMHaveTransactions> const& m)
+{
+    if (!txReduceRelayEnabled_)
+    {
+        JLOG(p_journal_.error())
+            << "TMHaveTransactions: tx reduce-relay is disabled";
+        fee_ = Resource::feeUnwantedData;
+        return;
+    }
+
+    std::weak_ptr<PeerImp> weak = shared_from_this();
+    addInboundJob(jtMISSING_TXN, "handleHaveTransactions", [weak, m](Job&) {
+        if (auto peer = weak.lock())
+            peer->handleHaveTransactions(m);
+    });
+}
+
+void
+PeerImp::handleHaveTransactions(
+    std::shared_ptr<protocol::TMHaveTransactions> const& m)
+{
+    protocol::TMGetObjectByHash tmBH;
+    tmBH.set_type(protocol::TMGetObjectByHash_ObjectType_otTRANSACTIONS);
+    tmBH.set_query(true);
+
+    JLOG(p_journal_.trace())
+        << "received TMHaveTransactions " << m->hashes_size();
+
+    for (int i = 0; i < m->hashes_size(); ++i)
+    {
+        if (!stringIsUint256Sized(m->hashes(i)))
+        {
+            JLOG(p_journal_.error())
+                << "TMHaveTransactions with invalid hash size";
+            charge(Resource::feeInvalidRequest);
+            return;
+        }
+
+        uint256 const hash(m->hashes(i));
+
+        // If we already have the transaction then note that the peer
+        // has it too, so it isn't relayed back to the peer
+        if (app_.getMasterTransaction().fetch_from_cache(hash))
+        {
+            app_.getHashRouter().addSuppressionPeer(hash, id_);
+            continue;
+        }
+
+        protocol::TMIndexedObject* obj = tmBH.add_objects();
+        obj->set_hash(hash.data(), hash.size());
+    }
+
+    JLOG(p_journal_.trace())
+        << "transaction request object is " << tmBH.objects_size();
+
+    if (tmBH.objects_size() > 0)
+        send(std::make_shared<Message>(tmBH, protocol::mtGET_OBJECTS));
+}
+
+void
+PeerImp::onMessage(std::shared_ptr<protocol::TMTransactions> const& m)
+{
+    if (!txReduceRelayEnabled_)
+    {
+        JLOG(p_journal_.error())
+            << "TMTransactions: tx reduce-relay is disabled";
+        fee_ = Resource::feeUnwantedData;
+        return;
+    }
+
+    JLOG(p_journal_.trace())
+        << "received TMTransactions " << m->transactions_size();
+
+    for (int i = 0; i < m->transactions_size(); ++i)
+        handleTransaction(
+            std::shared_ptr<protocol::TMTransaction>(
+                m, m->mutable_transactions(i)),
+            false);
+}
+
 void
 PeerImp::onMessage(std::shared_ptr<protocol::TMGetLedger> const& m)
 {
     fee_ = Resource::feeMediumBurdenPeer;
     std::weak_ptr<PeerImp> weak = shared_from_this();
-    app_.getJobQueue().addJob(jtLEDGER_REQ, "recvGetLedger", [weak, m](Job&) {
+    addInboundJob(jtLEDGER_REQ, "recvGetLedger", [weak, m](Job&) {
         if (auto peer = weak.lock())
             peer->getLedger(m);
     });
@@ -1493,26 +1706,25 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMProofPathRequest> const& m)
 
     fee_ = Resource::feeMediumBurdenPeer;
     std::weak_ptr<PeerImp> weak = shared_from_this();
-    app_.getJobQueue().addJob(
-        jtREPLAY_REQ, "recvProofPathRequest", [weak, m](Job&) {
-            if (auto peer = weak.lock())
+    addInboundJob(jtREPLAY_REQ, "recvProofPathRequest", [weak, m](Job&) {
+        if (auto peer = weak.lock())
+        {
+            auto reply =
+                peer->ledgerReplayMsgHandler_.processProofPathRequest(m);
+            if (reply.has_error())
             {
-                auto reply =
-                    peer->ledgerReplayMsgHandler_.processProofPathRequest(m);
-                if (reply.has_error())
-                {
-                    if (reply.error() == protocol::TMReplyError::reBAD_REQUEST)
-                        peer->charge(Resource::feeInvalidRequest);
-                    else
-                        peer->charge(Resource::feeRequestNoReply);
-                }
+                if (reply.error() == protocol::TMReplyError::reBAD_REQUEST)
+                    peer->charge(Resource::feeInvalidRequest);
                 else
-                {
-                    peer->send(std::make_shared<Message>(
-                        reply, protocol::mtPROOF_PATH_RESPONSE));
-                }
+                    peer->charge(Resource::feeRequestNoReply);
             }
-        });
+            else
+            {
+                peer->send(std::make_shared<Message>(
+                    reply, protocol::mtPROOF_PATH_RESPONSE));
+            }
+        }
+    });
 }
 
 void
@@ -1542,26 +1754,25 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMReplayDeltaRequest> const& m)
 
     fee_ = Resource::feeMediumBurdenPeer;
     std::weak_ptr<PeerImp> weak = shared_from_this();
-    app_.getJobQueue().addJob(
-        jtREPLAY_REQ, "recvReplayDeltaRequest", [weak, m](Job&) {
-            if (auto peer = weak.lock())
+    addInboundJob(jtREPLAY_REQ, "recvReplayDeltaRequest", [weak, m](Job&) {
+        if (auto peer = weak.lock())
+        {
+            auto reply =
+                peer->ledgerReplayMsgHandler_.processReplayDeltaRequest(m);
+            if (reply.has_error())
             {
-                auto reply =
-                    peer->ledgerReplayMsgHandler_.processReplayDeltaRequest(m);
-                if (reply.has_error())
-                {
-                    if (reply.error() == protocol::TMReplyError::reBAD_REQUEST)
-                        peer->charge(Resource::feeInvalidRequest);
-                    else
-                        peer->charge(Resource::feeRequestNoReply);
-                }
+                if (reply.error() == protocol::TMReplyError::reBAD_REQUEST)
+                    peer->charge(Resource::feeInvalidRequest);
                 else
-                {
-                    peer->send(std::make_shared<Message>(
-                        reply, protocol::mtREPLAY_DELTA_RESPONSE));
-                }
+                    peer->charge(Resource::feeRequestNoReply);
             }
-        });
+            else
+            {
+                peer->send(std::make_shared<Message>(
+                    reply, protocol::mtREPLAY_DELTA_RESPONSE));
+            }
+        }
+    });
 }
 
 void
@@ -1621,11 +1832,10 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMLedgerData> const& m)
     {
         // got data for a candidate transaction set
         std::weak_ptr<PeerImp> weak = shared_from_this();
-        app_.getJobQueue().addJob(
-            jtTXN_DATA, "recvPeerData", [weak, hash, m](Job&) {
-                if (auto peer = weak.lock())
-                    peer->app_.getInboundTransactions().gotData(hash, peer, m);
-            });
+        addInboundJob(jtTXN_DATA, "recvPeerData", [weak, hash, m](Job&) {
+            if (auto peer = weak.lock())
+                peer->app_.getInboundTransactions().gotData(hash, peer, m);
+        });
         return;
     }
 
@@ -1722,14 +1932,8 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMProposeSet> const& m)
             app_.timeKeeper().closeTime(),
             calcNodeID(app_.validatorManifests().getMasterKey(publicKey))});
 
-    std::weak_ptr<PeerImp> weak = shared_from_this();
-    app_.getJobQueue().addJob(
-        isTrusted ? jtPROPOSAL_t : jtPROPOSAL_ut,
-        "recvPropose->checkPropose",
-        [weak, m, proposal](Job& job) {
-            if (auto peer = weak.lock())
-                peer->checkPropose(job, m, proposal);
-        });
+    overlay_.ingest(
+        OverlayImpl::InboundProposal{weak_from_this(), m, proposal}, isTrusted);
 }
 
 void
@@ -2251,10 +2455,9 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMValidation> const& m)
     {
         auto const closeTime = app_.timeKeeper().closeTime();
 
-        std::shared_ptr<STValidation> val;
-        {
+        auto parse = [&]() {
             SerialIter sit(makeSlice(m->validation()));
-            val = std::make_shared<STValidation>(
+            auto val = std::make_shared<STValidation>(
                 std::ref(sit),
                 [this](PublicKey const& pk) {
                     return calcNodeID(
@@ -2262,19 +2465,11 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMValidation> const& m)
                 },
                 false);
             val->setSeen(closeTime);
-        }
-
-        if (!isCurrent(
-                app_.getValidations().parms(),
-                app_.timeKeeper().closeTime(),
-                val->getSignTime(),
-                val->getSeenTime()))
-        {
-            JLOG(p_journal_.trace()) << "Validation: Not current";
-            fee_ = Resource::feeUnwantedData;
-            return;
-        }
+            return val;
+        };
 
+        // Most validations arrive from several peers; drop the copies
+        // before paying for deserialization.
         auto key = sha512Half(makeSlice(m->validation()));
         if (auto [added, relayed] =
                 app_.getHashRouter().addSuppressionPeerWithStatus(key, id_);
@@ -2283,15 +2478,31 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMValidation> const& m)
             // Count unique messages (Slots has it's own 'HashRouter'), which a
             // peer receives within IDLED seconds since the message has been
             // relayed. Wait WAIT_ON_BOOTUP time to let the server establish
-            // connections to peers.
+            // connections to peers. Only then is the signer needed.
             if (reduceRelayReady() && relayed &&
                 (stopwatch().now() - *relayed) < reduce_relay::IDLED)
                 overlay_.updateSlotAndSquelch(
-                    key, val->getSignerPublic(), id_, protocol::mtVALIDATION);
+                    key,
+                    parse()->getSignerPublic(),
+                    id_,
+                    protocol::mtVALIDATION);
             JLOG(p_journal_.trace()) << "Validation: duplicate";
             return;
         }
 
+        auto const val = parse();
+
+        if (!isCurrent(
+                app_.getValidations().parms(),
+                app_.timeKeeper().closeTime(),
+                val->getSignTime(),
+                val->getSeenTime()))
+        {
+            JLOG(p_journal_.trace()) << "Validation: Not current";
+            fee_ = Resource::feeUnwantedData;
+            return;
+        }
+
         auto const isTrusted =
             app_.validators().trusted(val->getSignerPublic());
 
@@ -2302,14 +2513,9 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMValidation> const& m)
         }
         if (isTrusted || cluster() || !app_.getFeeTrack().isLoadedLocal())
         {
-            std::weak_ptr<PeerImp> weak = shared_from_this();
-            app_.getJobQueue().addJob(
-                isTrusted ? jtVALIDATION_t : jtVALIDATION_ut,
-                "recvValidation->checkValidation",
-                [weak, val, m](Job&) {
-                    if (auto peer = weak.lock())
-                        peer->checkValidation(val, m);
-                });
+            overlay_.ingest(
+                OverlayImpl::InboundValidation{weak_from_this(), val, m},
+                isTrusted);
         }
         else
         {
@@ -2331,10 +2537,13 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMGetObjectByHash> const& m)
 
     if (packet.query())
     {
-        // this is a query
-        if (send_queue_.size() >= Tuning::dropSendQueue)
+        // this is a query; the reply would be dropped
+        if (send_queue_.full(
+                packet.type() == protocol::TMGetObjectByHash::otTRANSACTIONS
+                    ? SendQueue::Priority::transaction
+                    : SendQueue::Priority::ledger))
         {
-            JLOG(p_journal_.debug()) << "GetObject: Large send queue";
+            JLOG(p_journal_.debug()) << "GetObject: Send queue full";
             return;
         }
 
@@ -2344,6 +2553,24 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMGetObjectByHash> const& m)
             return;
         }
 
+        if (packet.type() == protocol::TMGetObjectByHash::otTRANSACTIONS)
+        {
+            if (!txReduceRelayEnabled_)
+            {
+                JLOG(p_journal_.error())
+                    << "TMGetObjectByHash: tx reduce-relay is disabled";
+                fee_ = Resource::feeUnwantedData;
+                return;
+            }
+
+            std::weak_ptr<PeerImp> weak = shared_from_this();
+            addInboundJob(jtREQUESTED_TXN, "doTransactions", [weak, m](Job&) {
+                if (auto peer = weak.lock())
+                    peer->doTransactions(m);
+            });
+            return;
+        }
+
         fee_ = Resource::feeMediumBurdenPeer;
 
         protocol::TMGetObjectByHash reply;
@@ -2390,7 +2617,7 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMGetObjectByHash> const& m)
                     protocol::TMIndexedObject& newObj = *reply.add_objects();
                     newObj.set_hash(hash.begin(), hash.size());
                     newObj.set_data(
-                        &nodeObject->getData().front(),
+                        nodeObject->getData().data(),
                         nodeObject->getData().size());
 
                     if (obj.has_nodeid())
@@ -2464,6 +2691,59 @@ PeerImp::onMessage(std::shared_ptr<protocol::TMGetObjectByHash> const& m)
     }
 }
 
+void
+PeerImp::doTransactions(
+    std::shared_ptr<protocol::TMGetObjectByHash> const& packet)
+{
+    protocol::TMTransactions reply;
+
+    JLOG(p_journal_.trace()) << "received TMGetObjectByHash requesting tx "
+                             << packet->objects_size();
+
+    if (static_cast<std::size_t>(packet->objects_size()) >
+        reduce_relay::MAX_TX_QUEUE_SIZE)
+    {
+        JLOG(p_journal_.error()) << "doTransactions, invalid number of hashes";
+        charge(Resource::feeHighBurdenPeer);
+        return;
+    }
+
+    for (int i = 0; i < packet->objects_size(); ++i)
+    {
+        auto const& obj = packet->objects(i);
+
+        if (!stringIsUint256Sized(obj.hash()))
+        {
+            charge(Resource::feeInvalidRequest);
+            return;
+        }
+
+        uint256 const hash(obj.hash());
+        // Only transactions still in the cache are served, anything older
+        // has been relayed long ago
+        auto txn = app_.getMasterTransaction().fetch_from_cache(hash);
+        if (!txn)
+        {
+            JLOG(p_journal_.debug()) << "doTransactions, tx not found " << hash;
+            continue;
+        }
+
+        Serializer s;
+        txn->getSTransaction()->add(s);
+        auto tx = reply.add_transactions();
+        tx->set_rawtransaction(s.data(), s.size());
+        tx->set_status(
+            txn->getStatus() == INCLUDED ? protocol::tsCURRENT
+                                         : protocol::tsNEW);
+        tx->set_receivetimestamp(
+            app_.timeKeeper().now().time_since_epoch().count());
+        tx->set_deferred(txn->getSubmitResult().queued);
+    }
+
+    if (reply.transactions_size() > 0)
+        send(std::make_shared<Message>(reply, protocol::mtTRANSACTIONS));
+}
+
 void
 PeerImp::onMessage(std::shared_ptr<protocol::TMSquelch> const& m)
 {
@@ -2634,14 +2914,24 @@ PeerImp::checkTransaction(
 }
 
 // Called from our JobQueue
+void
+PeerImp::checkProposals(
+    bool isTrusted,
+    std::vector<OverlayImpl::InboundProposal>& batch)
+{
+    for (auto& proposal : batch)
+    {
+        if (auto peer = proposal.peer.lock())
+            peer->checkPropose(isTrusted, proposal.packet, proposal.peerPos);
+    }
+}
+
 void
 PeerImp::checkPropose(
-    Job& job,
+    bool isTrusted,
     std::shared_ptr<protocol::TMProposeSet> const& packet,
-    RCLCxPeerPos peerPos)
+    RCLCxPeerPos const& peerPos)
 {
-    bool isTrusted = (job.getType() == jtPROPOSAL_t);
-
     JLOG(p_journal_.trace())
         << "Checking " << (isTrusted ? "trusted" : "UNTRUSTED") << " proposal";
 
@@ -2678,46 +2968,76 @@ PeerImp::checkPropose(
     }
 }
 
+// Called from our JobQueue
 void
-PeerImp::checkValidation(
-    std::shared_ptr<STValidation> const& val,
-    std::shared_ptr<protocol::TMValidation> const& packet)
+PeerImp::checkValidations(
+    Application& app,
+    std::vector<OverlayImpl::InboundValidation>& batch)
 {
-    if (!cluster() && !val->isValid())
+    std::vector<std::shared_ptr<PeerImp>> peers;
+    std::vector<std::shared_ptr<STValidation>> vals;
+    std::vector<std::shared_ptr<protocol::TMValidation>> packets;
+    peers.reserve(batch.size());
+    vals.reserve(batch.size());
+    packets.reserve(batch.size());
+
+    for (auto& validation : batch)
     {
-        JLOG(p_journal_.debug()) << "Validation forwarded by peer is invalid";
-        charge(Resource::feeInvalidRequest);
-        return;
+        auto peer = validation.peer.lock();
+        if (!peer)
+            continue;
+
+        if (!peer->cluster() && !validation.val->isValid())
+        {
+            JLOG(peer->p_journal_.debug())
+                << "Validation forwarded by peer is invalid";
+            peer->charge(Resource::feeInvalidRequest);
+            continue;
+        }
+
+        peers.push_back(std::move(peer));
+        vals.push_back(std::move(validation.val));
+        packets.push_back(std::move(validation.packet));
     }
 
-    // FIXME it should be safe to remove this try/catch. Investigate codepaths.
-    try
+    if (vals.empty())
+        return;
+
+    auto const relay = app.getOPs().recvValidations(vals, "peers");
+
+    for (std::size_t i = 0; i < vals.size(); ++i)
     {
-        if (app_.getOPs().recvValidation(val, std::to_string(id())) ||
-            cluster())
-        {
-            auto const suppression =
-                sha512Half(makeSlice(val->getSerialized()));
-            // haveMessage contains peers, which are suppressed; i.e. the peers
-            // are the source of the message, consequently the message should
-            // not be relayed to these peers. But the message must be counted
-            // as part of the squelch logic.
-            auto haveMessage =
-                overlay_.relay(*packet, suppression, val->getSignerPublic());
-            if (reduceRelayReady() && !haveMessage.empty())
-            {
-                overlay_.updateSlotAndSquelch(
-                    suppression,
-                    val->getSignerPublic(),
-                    std::move(haveMessage),
-                    protocol::mtVALIDATION);
-            }
+        // Only the peer which sent the offending validation is charged
+        if (!relay[i])
+        {
+            JLOG(peers[i]->p_journal_.trace())
+                << "Exception processing validation";
+            peers[i]->charge(Resource::feeInvalidRequest);
         }
+        else if (*relay[i] || peers[i]->cluster())
+            peers[i]->relayValidation(vals[i], *packets[i]);
     }
-    catch (std::exception const&)
+}
+
+void
+PeerImp::relayValidation(
+    std::shared_ptr<STValidation> const& val,
+    protocol::TMValidation& packet)
+{
+    auto const suppression = sha512Half(makeSlice(val->getSerialized()));
+    // haveMessage contains peers, which are suppressed; i.e. the peers
+    // are the source of the message, consequently the message should
+    // not be relayed to these peers. But the message must be counted
+    // as part of the squelch logic.
+    auto haveMessage =
+        overlay_.relay(packet, suppression, val->getSignerPublic());
+    if (reduceRelayReady() && !haveMessage.empty())
     {
-        JLOG(p_journal_.trace()) << "Exception processing validation";
-        charge(Resource::feeInvalidRequest);
+        overlay_.updateSlotAndSquelch(
+            suppression,
+            val->getSignerPublic(),
+            std::move(haveMessage),
+            protocol::mtVALIDATION);
     }
 }
 
@@ -2837,9 +3157,9 @@ PeerImp::getLedger(std::shared_ptr<protocol::TMGetLedger> const& m)
     }
     else
     {
-        if (send_queue_.size() >= Tuning::dropSendQueue)
+        if (send_queue_.full(SendQueue::Priority::ledger))
         {
-            JLOG(p_journal_.debug()) << "GetLedger: Large send queue";
+            JLOG(p_journal_.debug()) << "GetLedger: Send queue full";
             return;
         }
 
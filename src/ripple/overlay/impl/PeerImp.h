@@ -29,6 +29,8 @@
 #include <ripple/overlay/impl/OverlayImpl.h>
 #include <ripple/overlay/impl/ProtocolMessage.h>
 #include <ripple/overlay/impl/ProtocolVersion.h>
+#include <ripple/overlay/impl/SendQueue.h>
+#include <ripple/overlay/impl/Tuning.h>
 #include <ripple/peerfinder/PeerfinderManager.h>
 #include <ripple/protocol/Protocol.h>
 #include <ripple/protocol/STTx.h>
@@ -158,10 +160,18 @@ private:
     http_request_type request_;
     http_response_type response_;
     boost::beast::http::fields const& headers_;
-    std::queue<std::shared_ptr<Message>> send_queue_;
+    SendQueue send_queue_{Tuning::sendBatchBytes, &overlay_.traffic()};
     bool gracefulClose_ = false;
-    int large_sendq_ = 0;
+    // Timer intervals in a row in which the send queue dropped messages
+    int overflow_sendq_ = 0;
+    std::uint64_t sendq_dropped_ = 0;
+    // Timer intervals a write has been in progress without completing
+    int stalled_sendq_ = 0;
+    std::uint64_t sendq_writes_ = 0;
     std::unique_ptr<LoadEvent> load_event_;
+    // The traffic category and arrival time of the message being handled
+    TrafficCount::category inboundCategory_ = TrafficCount::category::unknown;
+    clock_type::time_point inboundTime_;
     // The highest sequence of each PublisherList that has
     // been sent to or received from this peer.
     hash_map<PublicKey, std::size_t> publisherListSequences_;
@@ -173,6 +183,11 @@ private:
     // true if validation/proposal reduce-relay feature is enabled
     // on the peer.
     bool vpReduceRelayEnabled_ = false;
+    // true if transaction reduce-relay feature is enabled on the peer.
+    bool txReduceRelayEnabled_ = false;
+    // Hashes of transactions to announce to the peer with the next
+    // TMHaveTransactions. Only accessed on the strand.
+    hash_set<uint256> txQueue_;
     bool ledgerReplayEnabled_ = false;
     LedgerReplayMsgHandler ledgerReplayMsgHandler_;
 
@@ -411,6 +426,28 @@ public:
         return compressionEnabled_ == Compressed::On;
     }
 
+    bool
+    txReduceRelayEnabled() const
+    {
+        return txReduceRelayEnabled_;
+    }
+
+    /** Queue a transaction's hash to announce to the peer with the next
+        TMHaveTransactions. The queue is sent early if it gets too large.
+    */
+    void
+    addTxQueue(uint256 const& hash);
+
+    /** Announce the queued transaction hashes to the peer. */
+    void
+    sendTxQueue();
+
+    /** Remove a transaction's hash from the queue, for instance
+        because the peer sent us the transaction.
+    */
+    void
+    removeTxQueue(uint256 const& hash);
+
 private:
     void
     close();
@@ -462,6 +499,10 @@ private:
     void
     onReadMessage(error_code ec, std::size_t bytes_transferred);
 
+    // Writes the messages at the front of the send queue
+    void
+    writeSendQueue();
+
     // Called when protocol messages bytes are sent
     void
     onWriteMessage(error_code ec, std::size_t bytes_transferred);
@@ -513,6 +554,10 @@ public:
     void
     onMessage(std::shared_ptr<protocol::TMTransaction> const& m);
     void
+    onMessage(std::shared_ptr<protocol::TMHaveTransactions> const& m);
+    void
+    onMessage(std::shared_ptr<protocol::TMTransactions> const& m);
+    void
     onMessage(std::shared_ptr<protocol::TMGetLedger> const& m);
     void
     onMessage(std::shared_ptr<protocol::TMLedgerData> const& m);
@@ -541,6 +586,22 @@ public:
     void
     onMessage(std::shared_ptr<protocol::TMReplayDeltaResponse> const& m);
 
+    /** Check and process a batch of proposals queued by any peers. */
+    static void
+    checkProposals(
+        bool isTrusted,
+        std::vector<OverlayImpl::InboundProposal>& batch);
+
+    /** Check and process a batch of validations queued by any peers.
+
+        Signatures are checked first, then the valid validations are added
+        to the set of validations together and relayed.
+    */
+    static void
+    checkValidations(
+        Application& app,
+        std::vector<OverlayImpl::InboundValidation>& batch);
+
 private:
     //--------------------------------------------------------------------------
     // lockedRecentLock is passed as a reminder to callers that recentLock_
@@ -550,9 +611,24 @@ private:
         uint256 const& hash,
         std::lock_guard<std::mutex> const& lockedRecentLock);
 
+    /** Add a job to process the message being handled. The time the job
+        waits in the job queue is added to the traffic histograms.
+    */
+    template <class JobHandler>
+    bool
+    addInboundJob(
+        JobType type,
+        std::string const& name,
+        JobHandler&& jobHandler);
+
     void
     doFetchPack(const std::shared_ptr<protocol::TMGetObjectByHash>& packet);
 
+    /** Reply to a peer's request for the transactions it was
+        announced with TMHaveTransactions. */
+    void
+    doTransactions(std::shared_ptr<protocol::TMGetObjectByHash> const& packet);
+
     void
     onValidatorListMessage(
         std::string const& messageType,
@@ -560,6 +636,23 @@ private:
         std::uint32_t version,
         std::vector<ValidatorBlobInfo> const& blobs);
 
+    /** Process a transaction received from the peer.
+        @param m the transaction
+        @param eraseTxQueue true if the transaction's hash should be
+               removed from the queue of hashes announced to the peer
+    */
+    void
+    handleTransaction(
+        std::shared_ptr<protocol::TMTransaction> const& m,
+        bool eraseTxQueue);
+
+    /** Request the transactions announced by the peer that we don't
+        have yet.
+    */
+    void
+    handleHaveTransactions(
+        std::shared_ptr<protocol::TMHaveTransactions> const& m);
+
     void
     checkTransaction(
         int flags,
@@ -568,14 +661,14 @@ private:
 
     void
     checkPropose(
-        Job& job,
+        bool isTrusted,
         std::shared_ptr<protocol::TMProposeSet> const& packet,
-        RCLCxPeerPos peerPos);
+        RCLCxPeerPos const& peerPos);
 
     void
-    checkValidation(
+    relayValidation(
         std::shared_ptr<STValidation> const& val,
-        std::shared_ptr<protocol::TMValidation> const& packet);
+        protocol::TMValidation& packet);
 
     void
     getLedger(std::shared_ptr<protocol::TMGetLedger> const& packet);
@@ -634,6 +727,10 @@ PeerImp::PeerImp(
           headers_,
           FEATURE_VPRR,
           app_.config().VP_REDUCE_RELAY_ENABLE))
+    , txReduceRelayEnabled_(peerFeatureEnabled(
+          headers_,
+          FEATURE_TXRR,
+          app_.config().TX_REDUCE_RELAY_ENABLE))
     , ledgerReplayEnabled_(peerFeatureEnabled(
           headers_,
           FEATURE_LEDGER_REPLAY,
@@ -645,7 +742,9 @@ PeerImp::PeerImp(
     JLOG(journal_.debug()) << "compression enabled "
                            << (compressionEnabled_ == Compressed::On)
                            << " vp reduce-relay enabled "
-                           << vpReduceRelayEnabled_ << " on " << remote_address_
+                           << vpReduceRelayEnabled_
+                           << " tx reduce-relay enabled "
+                           << txReduceRelayEnabled_ << " on " << remote_address_
                            << " " << id_;
 }
 
@@ -0,0 +1,181 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_OVERLAY_PEERSNAPSHOT_H_INCLUDED
+#define RIPPLE_OVERLAY_PEERSNAPSHOT_H_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+/** An immutable list of the active peers, replaced as a whole on change.
+
+    Readers take a reference to the current list and then iterate it
+    without holding any lock; the list they took stays valid for as long
+    as they hold it, even if peers are added or removed in the meantime.
+    Writers copy the list, modify the copy and publish it. Peers join and
+    leave rarely compared to how often messages are relayed, so the copy
+    is cheap overall.
+
+    The list is published in one of two slots. A reader announces itself
+    in the counter of the current slot, checks that the slot is still
+    current, and copies the reference out of it. A writer fills the empty
+    slot and makes it current, then empties the other slot once the
+    readers that may still be copying from it have left. Readers never
+    block and only retry if the current slot changed while they announced
+    themselves.
+    (std::atomic_load of a std::shared_ptr takes a lock from a shared pool
+    in common standard libraries, so it is not used.)
+
+    The list holds strong references: a peer must be removed when it is
+    closed, otherwise it is kept alive until the overlay is destroyed.
+
+    @tparam PeerType A type with an `id()` member function.
+*/
+template <class PeerType>
+class PeerSnapshot
+{
+public:
+    using list_type = std::vector<std::shared_ptr<PeerType>>;
+
+    PeerSnapshot()
+    {
+        slots_[0] = std::make_shared<list_type const>();
+    }
+
+    PeerSnapshot(PeerSnapshot const&) = delete;
+    PeerSnapshot&
+    operator=(PeerSnapshot const&) = delete;
+
+    /** Return the current list. */
+    std::shared_ptr<list_type const>
+    load() const
+    {
+        for (;;)
+        {
+            auto const i = current_.load();
+            readers_[i].fetch_add(1);
+            if (current_.load() == i)
+            {
+                auto list = slots_[i];
+                readers_[i].fetch_sub(1);
+                return list;
+            }
+            readers_[i].fetch_sub(1);
+        }
+    }
+
+    /** Add a peer. Does nothing if it is already present. */
+    void
+    insert(std::shared_ptr<PeerType> const& peer)
+    {
+        std::lock_guard lock(mutex_);
+        auto const& current = *slots_[current_.load()];
+        if (std::any_of(current.begin(), current.end(), [&](auto const& p) {
+                return p->id() == peer->id();
+            }))
+            return;
+        auto next = std::make_shared<list_type>();
+        next->reserve(current.size() + 1);
+        next->insert(next->end(), current.begin(), current.end());
+        next->push_back(peer);
+        publish(lock, std::move(next));
+    }
+
+    /** Remove a peer. Does nothing if it is not present. */
+    template <class Id>
+    void
+    erase(Id const& id)
+    {
+        std::lock_guard lock(mutex_);
+        auto const& current = *slots_[current_.load()];
+        auto const iter =
+            std::find_if(current.begin(), current.end(), [&](auto const& p) {
+                return p->id() == id;
+            });
+        if (iter == current.end())
+            return;
+        auto next = std::make_shared<list_type>();
+        next->reserve(current.size() - 1);
+        next->insert(next->end(), current.begin(), iter);
+        next->insert(next->end(), std::next(iter), current.end());
+        publish(lock, std::move(next));
+    }
+
+    /** Return the number of peers in the current list. */
+    std::size_t
+    size() const
+    {
+        return load()->size();
+    }
+
+    /** Call f for each peer in the current list, without locking.
+
+        f is called as `void(std::shared_ptr<PeerType> const&)`.
+    */
+    template <class UnaryFunc>
+    void
+    for_each(UnaryFunc&& f) const
+    {
+        auto const list = load();
+        for (auto const& peer : *list)
+            f(peer);
+    }
+
+private:
+    void
+    publish(std::lock_guard<std::mutex> const&, std::shared_ptr<list_type> next)
+    {
+        auto const previous = current_.load();
+        slots_[previous ^ 1] = std::move(next);
+        current_.store(previous ^ 1);
+
+        // Readers that saw the previous slot as current may still be
+        // copying from it. They hold it for a few instructions, and
+        // readers arriving now leave it without reading, so the previous
+        // list can be released once they are done.
+        while (readers_[previous].load() != 0)
+            std::this_thread::yield();
+        slots_[previous].reset();
+    }
+
+    static_assert(std::atomic<unsigned>::is_always_lock_free);
+    static_assert(std::atomic<std::size_t>::is_always_lock_free);
+
+    // Serializes writers only; readers never take it.
+    std::mutex mutex_;
+
+    // The slot holding the current list
+    std::atomic<unsigned> current_{0};
+
+    // The readers in each slot
+    mutable std::array<std::atomic<std::size_t>, 2> readers_{};
+
+    std::array<std::shared_ptr<list_type const>, 2> slots_;
+};
+
+}  // namespace ripple
+
+#endif
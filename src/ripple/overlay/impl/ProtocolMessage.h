@@ -28,7 +28,10 @@
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/buffers_iterator.hpp>
 #include <boost/system/error_code.hpp>
+#include <google/protobuf/arena.h>
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -109,6 +112,10 @@ protocolMessageName(int type)
             return "replay_delta_request";
         case protocol::mtREPLAY_DELTA_RESPONSE:
             return "replay_delta_response";
+        case protocol::mtHAVE_TRANSACTIONS:
+            return "have_transactions";
+        case protocol::mtTRANSACTIONS:
+            return "transactions";
         default:
             break;
     }
@@ -260,23 +267,101 @@ parseMessageHeader(
     return std::nullopt;
 }
 
+/** Returns the arena options for parsing a message.
+
+    The first block is sized from the payload, so that a message and its
+    submessages are usually allocated together rather than one at a time.
+*/
+inline ::google::protobuf::ArenaOptions
+arenaOptions(std::size_t payloadBytes)
+{
+    std::size_t constexpr maxBlockBytes = 64 * 1024;
+
+    ::google::protobuf::ArenaOptions options;
+    options.start_block_size =
+        std::clamp<std::size_t>(payloadBytes, 256, maxBlockBytes);
+    options.max_block_size = maxBlockBytes;
+    return options;
+}
+
+/** An arena and its first block, allocated together.
+
+    Most messages are small, and for those allocating the arena and then
+    its first block would cost more than it saves.
+*/
+struct InlineArena
+{
+    /** The largest payload parsed into an inline arena. */
+    static std::size_t constexpr maxPayloadBytes = 512;
+
+    alignas(std::max_align_t) char block[4 * maxPayloadBytes];
+    ::google::protobuf::Arena arena;
+
+    explicit InlineArena(::google::protobuf::ArenaOptions options)
+        : arena([&] {
+            options.initial_block = block;
+            options.initial_block_size = sizeof(block);
+            return options;
+        }())
+    {
+    }
+};
+
+/** Returns a buffer to decompress a payload into.
+
+    A decompressed payload is only needed while it is parsed, so each
+    thread reuses one buffer.
+*/
+inline std::vector<std::uint8_t>&
+decompressBuffer(std::size_t size)
+{
+    thread_local std::vector<std::uint8_t> buffer;
+
+    // Don't hold on to the memory of an unusually large message
+    if (buffer.capacity() > megabytes(1) && size <= megabytes(1))
+        buffer = {};
+
+    buffer.resize(size);
+    return buffer;
+}
+
+/** Parse the content of a message.
+
+    The message is created in an arena that lives as long as the message,
+    and an uncompressed payload that is contiguous in the buffers is parsed
+    in place.
+*/
 template <
     class T,
     class Buffers,
     class = std::enable_if_t<
         std::is_base_of<::google::protobuf::Message, T>::value>>
 std::shared_ptr<T>
-parseMessageContent(MessageHeader const& header, Buffers const& buffers)
+parseMessageContent(
+    MessageHeader const& header,
+    Buffers const& buffers,
+    ::google::protobuf::ArenaOptions const& options)
 {
-    auto const m = std::make_shared<T>();
+    using ::google::protobuf::Arena;
 
-    ZeroCopyInputStream<Buffers> stream(buffers);
-    stream.Skip(header.header_size);
+    std::shared_ptr<T> m;
+    if (header.uncompressed_size <= InlineArena::maxPayloadBytes)
+    {
+        auto const owner = std::make_shared<InlineArena>(options);
+        m = std::shared_ptr<T>(owner, Arena::CreateMessage<T>(&owner->arena));
+    }
+    else
+    {
+        auto const owner = std::make_shared<Arena>(options);
+        m = std::shared_ptr<T>(owner, Arena::CreateMessage<T>(owner.get()));
+    }
 
     if (header.algorithm != compression::Algorithm::None)
     {
-        std::vector<std::uint8_t> payload;
-        payload.resize(header.uncompressed_size);
+        ZeroCopyInputStream<Buffers> stream(buffers);
+        stream.Skip(header.header_size);
+
+        auto& payload = decompressBuffer(header.uncompressed_size);
 
         auto const payloadSize = ripple::compression::decompress(
             stream,
@@ -287,13 +372,46 @@ parseMessageContent(MessageHeader const& header, Buffers const& buffers)
 
         if (payloadSize == 0 || !m->ParseFromArray(payload.data(), payloadSize))
             return {};
+
+        return m;
+    }
+
+    if (auto const first = boost::asio::buffer_sequence_begin(buffers);
+        first != boost::asio::buffer_sequence_end(buffers))
+    {
+        boost::asio::const_buffer const buffer = *first;
+        if (buffer.size() >= header.total_wire_size)
+        {
+            auto const data = static_cast<std::uint8_t const*>(buffer.data());
+            if (!m->ParseFromArray(
+                    data + header.header_size, header.payload_wire_size))
+                return {};
+
+            return m;
+        }
     }
-    else if (!m->ParseFromZeroCopyStream(&stream))
+
+    ZeroCopyInputStream<Buffers> stream(buffers);
+    stream.Skip(header.header_size);
+
+    if (!m->ParseFromBoundedZeroCopyStream(&stream, header.payload_wire_size))
         return {};
 
     return m;
 }
 
+template <
+    class T,
+    class Buffers,
+    class = std::enable_if_t<
+        std::is_base_of<::google::protobuf::Message, T>::value>>
+std::shared_ptr<T>
+parseMessageContent(MessageHeader const& header, Buffers const& buffers)
+{
+    return parseMessageContent<T>(
+        header, buffers, arenaOptions(header.uncompressed_size));
+}
+
 template <
     class T,
     class Buffers,
@@ -481,6 +599,14 @@ invokeProtocolMessage(
             success = detail::invoke<protocol::TMReplayDeltaResponse>(
                 *header, buffers, handler);
             break;
+        case protocol::mtHAVE_TRANSACTIONS:
+            success = detail::invoke<protocol::TMHaveTransactions>(
+                *header, buffers, handler);
+            break;
+        case protocol::mtTRANSACTIONS:
+            success = detail::invoke<protocol::TMTransactions>(
+                *header, buffers, handler);
+            break;
         default:
             handler.onMessageUnknown(header->message_type);
             success = true;
@@ -0,0 +1,282 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/safe_cast.h>
+#include <ripple/overlay/impl/SendQueue.h>
+#include <algorithm>
+#include <cassert>
+
+namespace ripple {
+
+// The weights add up to a whole write
+std::array<SendQueue::Policy, SendQueue::priorities> const
+    SendQueue::policies_{{
+        {256, 4, false},  // consensus
+        {256, 4, true},   // validation
+        {128, 4, false},  // ledger
+        {256, 2, false},  // transaction
+        {128, 2, false},  // other
+    }};
+
+SendQueue::SendQueue(std::size_t maxWriteBytes, TrafficCount* traffic)
+    : maxWriteBytes_(maxWriteBytes), traffic_(traffic)
+{
+}
+
+SendQueue::Priority
+SendQueue::priorityOf(TrafficCount::category category)
+{
+    using category_t = TrafficCount::category;
+
+    switch (category)
+    {
+        case category_t::base:
+        case category_t::proposal:
+        case category_t::get_set:
+        case category_t::share_set:
+        case category_t::ld_tsc_get:
+        case category_t::ld_tsc_share:
+        case category_t::gl_tsc_share:
+        case category_t::gl_tsc_get:
+            return Priority::consensus;
+
+        case category_t::validation:
+        case category_t::manifests:
+            return Priority::validation;
+
+        case category_t::ld_txn_get:
+        case category_t::ld_txn_share:
+        case category_t::ld_asn_get:
+        case category_t::ld_asn_share:
+        case category_t::ld_get:
+        case category_t::ld_share:
+        case category_t::gl_txn_share:
+        case category_t::gl_txn_get:
+        case category_t::gl_asn_share:
+        case category_t::gl_asn_get:
+        case category_t::gl_share:
+        case category_t::gl_get:
+        case category_t::share_hash_ledger:
+        case category_t::get_hash_ledger:
+        case category_t::share_hash_tx:
+        case category_t::get_hash_tx:
+        case category_t::share_hash_txnode:
+        case category_t::get_hash_txnode:
+        case category_t::share_hash_asnode:
+        case category_t::get_hash_asnode:
+        case category_t::share_cas_object:
+        case category_t::get_cas_object:
+        case category_t::share_fetch_pack:
+        case category_t::get_fetch_pack:
+        case category_t::share_hash:
+        case category_t::get_hash:
+        case category_t::proof_path_request:
+        case category_t::proof_path_response:
+        case category_t::replay_delta_request:
+        case category_t::replay_delta_response:
+            return Priority::ledger;
+
+        case category_t::transaction:
+        case category_t::have_transactions:
+        case category_t::requested_transactions:
+            return Priority::transaction;
+
+        default:
+            return Priority::other;
+    }
+}
+
+char const*
+SendQueue::name(Priority priority)
+{
+    switch (priority)
+    {
+        case Priority::consensus:
+            return "consensus";
+        case Priority::validation:
+            return "validation";
+        case Priority::ledger:
+            return "ledger";
+        case Priority::transaction:
+            return "transaction";
+        case Priority::other:
+            break;
+    }
+    return "other";
+}
+
+bool
+SendQueue::push(std::shared_ptr<Message> const& m)
+{
+    auto const priority =
+        priorityOf(safe_cast<TrafficCount::category>(m->getCategory()));
+    auto const& policy = policies_[static_cast<std::size_t>(priority)];
+    auto& c = classes_[static_cast<std::size_t>(priority)];
+
+    bool const full = c.queue.size() >= policy.limit;
+    if (full)
+    {
+        ++c.dropped;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        if (!policy.dropOldest)
+            return false;
+        c.queue.pop_front();
+        --c.queued;
+        --queued_;
+    }
+
+    c.queue.push_back({m, clock_type::now()});
+    ++c.queued;
+    ++queued_;
+    return !full;
+}
+
+bool
+SendQueue::full(Priority priority) const
+{
+    return classes_[static_cast<std::size_t>(priority)].queued.load(
+               std::memory_order_relaxed) >=
+        policies_[static_cast<std::size_t>(priority)].limit;
+}
+
+SendQueue::buffers_type const&
+SendQueue::prepare(compression::Compressed compressed)
+{
+    assert(queued_ != 0);
+    assert(inFlight_.empty());
+
+    std::size_t bytes = 0;
+    bool full = false;
+    auto const now = clock_type::now();
+
+    auto const sizeOf = [&](Class const& c) {
+        return c.queue.front().message->getBuffer(compressed).size();
+    };
+
+    auto const take = [&](Class& c) {
+        auto& entry = c.queue.front();
+        auto const& buffer = entry.message->getBuffer(compressed);
+        buffers_.emplace_back(buffer.data(), buffer.size());
+        bytes += buffer.size();
+        c.deficit -= buffer.size();
+
+        if (traffic_)
+            traffic_->addSample(
+                safe_cast<TrafficCount::category>(entry.message->getCategory()),
+                TrafficCount::Metric::sendQueue,
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    now - entry.queued)
+                    .count());
+
+        inFlight_.push_back(std::move(entry.message));
+        c.queue.pop_front();
+        --c.queued;
+        ++c.sent;
+        --queued_;
+
+        // An idle class does not save up an allowance
+        if (c.queue.empty())
+            c.deficit = 0;
+    };
+
+    // The message that did not fit into the last write starts this one.
+    // Otherwise a large message would only be written when nothing else
+    // is queued ahead of it.
+    if (held_)
+    {
+        auto& c = classes_[*held_];
+        held_.reset();
+        if (!c.queue.empty() && sizeOf(c) <= c.deficit)
+        {
+            full = sizeOf(c) >= maxWriteBytes_;
+            take(c);
+        }
+    }
+
+    // Each round visits the classes in priority order. A round may leave
+    // room in the write, and then another round fills it.
+    while (!full && queued_ != 0)
+    {
+        for (std::size_t i = 0; i < priorities && !full; ++i)
+        {
+            auto& c = classes_[i];
+            if (c.queue.empty())
+                continue;
+
+            // A class saves up no more than it needs for its next message
+            c.deficit = std::min(
+                c.deficit +
+                    std::max<std::size_t>(
+                        maxWriteBytes_ * policies_[i].weight / 16, 1),
+                std::max(maxWriteBytes_, sizeOf(c)));
+
+            while (!c.queue.empty() && sizeOf(c) <= c.deficit)
+            {
+                if (!buffers_.empty() && bytes + sizeOf(c) > maxWriteBytes_)
+                {
+                    held_ = i;
+                    full = true;
+                    break;
+                }
+
+                // A message larger than a write is written by itself
+                full = sizeOf(c) >= maxWriteBytes_;
+                take(c);
+                if (full)
+                    break;
+            }
+        }
+    }
+
+    return buffers_;
+}
+
+void
+SendQueue::consume()
+{
+    assert(!inFlight_.empty());
+
+    messages_.fetch_add(inFlight_.size(), std::memory_order_relaxed);
+    writes_.fetch_add(1, std::memory_order_relaxed);
+    inFlight_.clear();
+    buffers_.clear();
+}
+
+double
+SendQueue::messagesPerWrite() const
+{
+    auto const writes = this->writes();
+    if (writes == 0)
+        return 0;
+    return static_cast<double>(messagesWritten()) / writes;
+}
+
+SendQueue::ClassStats
+SendQueue::stats(Priority priority) const
+{
+    auto const& c = classes_[static_cast<std::size_t>(priority)];
+
+    ClassStats stats;
+    stats.queued = c.queued.load(std::memory_order_relaxed);
+    stats.sent = c.sent.load(std::memory_order_relaxed);
+    stats.dropped = c.dropped.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}  // namespace ripple
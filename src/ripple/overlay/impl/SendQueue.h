@@ -0,0 +1,244 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_OVERLAY_SENDQUEUE_H_INCLUDED
+#define RIPPLE_OVERLAY_SENDQUEUE_H_INCLUDED
+
+#include <ripple/overlay/Compression.h>
+#include <ripple/overlay/Message.h>
+#include <ripple/overlay/impl/TrafficCount.h>
+#include <boost/asio/buffer.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace ripple {
+
+/** Messages waiting to be written to a peer.
+
+    Messages are queued by traffic class, and each class has its own
+    queue. A write visits the classes in priority order, and each class
+    may add up to its quantum of bytes to the write (deficit round robin).
+    The quanta add up to the size of a write, so a busy class delays a
+    message of another class by at most one write, and no class is
+    starved. A message that has saved up its allowance but does not fit
+    into a write starts the next one.
+
+    Each class has a limit on the number of messages queued. When the
+    validation class is full it drops the oldest message, since
+    validations of a newer ledger supersede it. Other classes drop the
+    new message. The consensus class mixes proposals of different
+    validators with transaction set data, which newer messages do not
+    replace. A peer that keeps a class full is not keeping up, and the
+    drop counts tell its owner when to stop serving it or disconnect.
+
+    Messages are written with gather writes. The TLS stream packs the
+    buffers of a write into as few records as it can, so a burst of small
+    messages costs a few records and system calls rather than one per
+    message.
+
+    The queue is used from the peer's strand, except for the statistics
+    and whether a class is full, which may be read from any thread. The time each message waits in
+    the queue is added to the traffic histograms, if given.
+*/
+class SendQueue
+{
+public:
+    using buffers_type = std::vector<boost::asio::const_buffer>;
+
+    /** Traffic classes, from highest to lowest priority. */
+    enum class Priority : std::size_t {
+        consensus,
+        validation,
+        ledger,
+        transaction,
+        other,
+    };
+
+    static std::size_t constexpr priorities = 5;
+
+    /** Statistics for a traffic class. */
+    struct ClassStats
+    {
+        // Messages waiting to be written
+        std::size_t queued = 0;
+
+        // Messages handed to a write
+        std::uint64_t sent = 0;
+
+        // Messages dropped because the class was full
+        std::uint64_t dropped = 0;
+    };
+
+    /** Create a queue.
+
+        @param maxWriteBytes The most bytes gathered into one write.
+        @param traffic Where to record the time messages wait, if any.
+    */
+    explicit SendQueue(
+        std::size_t maxWriteBytes,
+        TrafficCount* traffic = nullptr);
+
+    SendQueue(SendQueue const&) = delete;
+    SendQueue&
+    operator=(SendQueue const&) = delete;
+
+    /** Return the traffic class of a traffic category. */
+    static Priority
+    priorityOf(TrafficCount::category category);
+
+    /** Return the name of a traffic class. */
+    static char const*
+    name(Priority priority);
+
+    /** Return the number of messages queued, including any being written. */
+    std::size_t
+    size() const
+    {
+        return queued_ + inFlight_.size();
+    }
+
+    bool
+    empty() const
+    {
+        return size() == 0;
+    }
+
+    /** Return true if a write is in progress. */
+    bool
+    writing() const
+    {
+        return !inFlight_.empty();
+    }
+
+    /** Add a message to the queue of its traffic class.
+
+        @return `false` if the class was full, and the new message or the
+                oldest one was dropped.
+    */
+    bool
+    push(std::shared_ptr<Message> const& m);
+
+    /** Return true if a message of the class would be dropped. */
+    bool
+    full(Priority priority) const;
+
+    /** Return the number of messages dropped from all classes. */
+    std::uint64_t
+    dropped() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /** Gather queued messages into a write.
+
+        There must be messages queued, and no write in progress. The
+        buffers remain valid until consume is called.
+
+        @param compressed Whether to write the compressed payloads.
+    */
+    buffers_type const&
+    prepare(compression::Compressed compressed);
+
+    /** Release the messages of the completed write. */
+    void
+    consume();
+
+    /** Return the number of writes completed. */
+    std::uint64_t
+    writes() const
+    {
+        return writes_.load(std::memory_order_relaxed);
+    }
+
+    /** Return the number of messages carried by completed writes. */
+    std::uint64_t
+    messagesWritten() const
+    {
+        return messages_.load(std::memory_order_relaxed);
+    }
+
+    /** Return the average number of messages per completed write. */
+    double
+    messagesPerWrite() const;
+
+    /** Return the statistics of a traffic class. */
+    ClassStats
+    stats(Priority priority) const;
+
+private:
+    struct Policy
+    {
+        // The most messages queued
+        std::size_t limit;
+
+        // The class's share of a write, in sixteenths
+        std::size_t weight;
+
+        // Drop the oldest message rather than the new one when full
+        bool dropOldest;
+    };
+
+    static std::array<Policy, priorities> const policies_;
+
+    using clock_type = std::chrono::steady_clock;
+
+    struct Entry
+    {
+        std::shared_ptr<Message> message;
+        clock_type::time_point queued;
+    };
+
+    struct Class
+    {
+        std::deque<Entry> queue;
+
+        // Bytes the class may still add to writes
+        std::size_t deficit = 0;
+
+        std::atomic<std::size_t> queued{0};
+        std::atomic<std::uint64_t> sent{0};
+        std::atomic<std::uint64_t> dropped{0};
+    };
+
+    std::size_t const maxWriteBytes_;
+    TrafficCount* const traffic_;
+    std::array<Class, priorities> classes_;
+    std::size_t queued_ = 0;
+
+    // The class whose next message did not fit into the last write
+    std::optional<std::size_t> held_;
+
+    // The write in progress: its messages and one buffer per message
+    std::vector<std::shared_ptr<Message>> inFlight_;
+    buffers_type buffers_;
+
+    std::atomic<std::uint64_t> writes_{0};
+    std::atomic<std::uint64_t> messages_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+};
+
+}  // namespace ripple
+
+#endif
@@ -19,8 +19,81 @@
 
 #include <ripple/overlay/impl/TrafficCount.h>
 
+#include <cmath>
+
 namespace ripple {
 
+TrafficCount::Histogram::Snapshot
+TrafficCount::Histogram::snapshot() const
+{
+    Snapshot ret;
+    for (auto const& shard : shards_)
+    {
+        ret.sum += shard.sum.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < buckets; ++i)
+        {
+            auto const n = shard.counts[i].load(std::memory_order_relaxed);
+            ret.counts[i] += n;
+            ret.count += n;
+        }
+    }
+    return ret;
+}
+
+TrafficCount::Histogram::Snapshot
+TrafficCount::Histogram::Snapshot::since(Snapshot const& earlier) const
+{
+    Snapshot ret;
+    ret.count = count - earlier.count;
+    ret.sum = sum - earlier.sum;
+    for (std::size_t i = 0; i < buckets; ++i)
+        ret.counts[i] = counts[i] - earlier.counts[i];
+    return ret;
+}
+
+std::uint64_t
+TrafficCount::Histogram::Snapshot::percentile(double p) const
+{
+    if (count == 0)
+        return 0;
+
+    auto const target = static_cast<std::uint64_t>(std::ceil(p * count));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets; ++i)
+    {
+        seen += counts[i];
+        if (seen >= target)
+            return std::uint64_t{1} << i;
+    }
+    return std::uint64_t{1} << (buckets - 1);
+}
+
+std::size_t
+TrafficCount::Histogram::shardIndex()
+{
+    static std::atomic<std::size_t> next{0};
+    thread_local std::size_t const index =
+        next.fetch_add(1, std::memory_order_relaxed) % shards;
+    return index;
+}
+
+char const*
+TrafficCount::name(Metric metric)
+{
+    switch (metric)
+    {
+        case Metric::size:
+            return "message_bytes";
+        case Metric::sendQueue:
+            return "send_queue_us";
+        case Metric::handler:
+            return "handler_us";
+        case Metric::jobDelay:
+            return "job_delay_us";
+    }
+    return "unknown";
+}
+
 TrafficCount::category
 TrafficCount::categorize(
     ::google::protobuf::Message const& message,
@@ -106,8 +179,17 @@ TrafficCount::categorize(
             : TrafficCount::category::gl_get;
     }
 
+    if (type == protocol::mtHAVE_TRANSACTIONS)
+        return TrafficCount::category::have_transactions;
+
+    if (type == protocol::mtTRANSACTIONS)
+        return TrafficCount::category::requested_transactions;
+
     if (auto msg = dynamic_cast<protocol::TMGetObjectByHash const*>(&message))
     {
+        if (msg->type() == protocol::TMGetObjectByHash::otTRANSACTIONS)
+            return TrafficCount::category::requested_transactions;
+
         if (msg->type() == protocol::TMGetObjectByHash::otLEDGER)
             return (msg->query() == inbound)
                 ? TrafficCount::category::share_hash_ledger
@@ -25,6 +25,7 @@
 
 #include <array>
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
 
 namespace ripple {
@@ -61,6 +62,108 @@ public:
         }
     };
 
+    /** Histogram of a measurement, with power of two buckets.
+
+        Bucket i counts the samples less than 2^i which are not counted by
+        a lower bucket, and the last bucket counts everything larger.
+
+        A sample is added to one of several shards, picked by the thread
+        adding it, so threads rarely contend on a cache line. Nothing is
+        locked: the shards are merged when the histogram is read.
+    */
+    class Histogram
+    {
+    public:
+        static constexpr std::size_t buckets = 24;
+
+        struct Snapshot
+        {
+            std::uint64_t count = 0;
+            std::uint64_t sum = 0;
+            std::array<std::uint64_t, buckets> counts{};
+
+            /** Return the number of buckets, leaving out the trailing
+                empty ones.
+            */
+            std::size_t
+            used() const
+            {
+                std::size_t n = buckets;
+                while (n != 0 && counts[n - 1] == 0)
+                    --n;
+                return n;
+            }
+
+            /** Return the samples added since an earlier snapshot. */
+            Snapshot
+            since(Snapshot const& earlier) const;
+
+            /** Return the upper bound of the bucket holding the given
+                fraction of the samples, or 0 if there are none.
+            */
+            std::uint64_t
+            percentile(double p) const;
+        };
+
+        Histogram() = default;
+        Histogram(Histogram const&) = delete;
+        Histogram&
+        operator=(Histogram const&) = delete;
+
+        /** Return the bucket which counts a sample. */
+        static std::size_t
+        bucket(std::uint64_t value)
+        {
+            std::size_t b = 0;
+            while (b + 1 < buckets && value >= (std::uint64_t{1} << b))
+                ++b;
+            return b;
+        }
+
+        void
+        insert(std::uint64_t value)
+        {
+            auto& shard = shards_[shardIndex()];
+            shard.sum.fetch_add(value, std::memory_order_relaxed);
+            shard.counts[bucket(value)].fetch_add(
+                1, std::memory_order_relaxed);
+        }
+
+        /** Merge the shards. */
+        Snapshot
+        snapshot() const;
+
+    private:
+        static constexpr std::size_t shards = 8;
+
+        struct alignas(64) Shard
+        {
+            std::atomic<std::uint64_t> sum{0};
+            std::array<std::atomic<std::uint64_t>, buckets> counts{};
+        };
+
+        static std::size_t
+        shardIndex();
+
+        std::array<Shard, shards> shards_;
+    };
+
+    /** The measurements kept as histograms for each category. */
+    enum class Metric : std::size_t {
+        // Size of messages sent and received, in bytes
+        size,
+        // Time a sent message waited in the send queue, in microseconds
+        sendQueue,
+        // Time to handle a received message on the peer's strand,
+        // in microseconds
+        handler,
+        // Time from the receipt of a message to the start of the job
+        // processing it, in microseconds
+        jobDelay,
+    };
+
+    static constexpr std::size_t metrics = 4;
+
     // If you add entries to this enum, you need to update the initialization
     // of the arrays at the bottom of this file which map array numbers to
     // human-readable, monitoring-tool friendly names.
@@ -148,6 +251,12 @@ public:
         replay_delta_request,
         replay_delta_response,
 
+        // TMHaveTransactions
+        have_transactions,
+
+        // TMTransactions, and the TMGetObjectByHash queries for them
+        requested_transactions,
+
         unknown  // must be last
     };
 
@@ -175,8 +284,31 @@ public:
             counts_[cat].bytesOut += bytes;
             ++counts_[cat].messagesOut;
         }
+
+        histograms_[cat][static_cast<std::size_t>(Metric::size)].insert(
+            static_cast<std::uint64_t>(bytes));
+    }
+
+    /** Add a sample to a histogram of the given category */
+    void
+    addSample(category cat, Metric metric, std::uint64_t value)
+    {
+        assert(cat <= category::unknown);
+        histograms_[cat][static_cast<std::size_t>(metric)].insert(value);
     }
 
+    /** Return a histogram of the given category */
+    Histogram const&
+    histogram(category cat, Metric metric) const
+    {
+        assert(cat <= category::unknown);
+        return histograms_[cat][static_cast<std::size_t>(metric)];
+    }
+
+    /** Return the name of a metric */
+    static char const*
+    name(Metric metric);
+
     TrafficCount() = default;
 
     /** An up-to-date copy of all the counters
@@ -233,11 +365,16 @@ protected:
         {"getobject_share"},                     // category::share_hash
         {"getobject_get"},                       // category::get_hash
         {"proof_path_request"},                  // category::proof_path_request
-        {"proof_path_response"},    // category::proof_path_response
-        {"replay_delta_request"},   // category::replay_delta_request
-        {"replay_delta_response"},  // category::replay_delta_response
-        {"unknown"}                 // category::unknown
+        {"proof_path_response"},     // category::proof_path_response
+        {"replay_delta_request"},    // category::replay_delta_request
+        {"replay_delta_response"},   // category::replay_delta_response
+        {"have_transactions"},       // category::have_transactions
+        {"requested_transactions"},  // category::requested_transactions
+        {"unknown"}                  // category::unknown
     }};
+
+    std::array<std::array<Histogram, metrics>, category::unknown + 1>
+        histograms_;
 };
 
 }  // namespace ripple
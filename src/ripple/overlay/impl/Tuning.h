@@ -39,17 +39,11 @@ enum {
         reply */
     maxReplyNodes = 8192,
 
-    /** How many timer intervals a sendq has to stay large before we disconnect
-     */
-    sendqIntervals = 4,
+    /** How many timer intervals in a row a send queue may drop messages,
+        or a write stay in progress, before we disconnect */
+    sendqOverflowIntervals = 4,
 
-    /** How many messages on a send queue before we refuse queries */
-    dropSendQueue = 192,
-
-    /** How many messages we consider reasonable sustained on a send queue */
-    targetSendQueue = 128,
-
-    /** How often to log send queue size */
+    /** How often to log messages dropped from a send queue */
     sendQueueLogFreq = 64,
 
     /** How often we check for idle peers (seconds) */
@@ -59,6 +53,12 @@ enum {
 /** Size of buffer used to read from the socket. */
 std::size_t constexpr readBufferBytes = 16384;
 
+/** The most bytes of queued messages gathered into one write. */
+std::size_t constexpr sendBatchBytes = 65536;
+
+/** The most validations or proposals checked by one job at a time. */
+std::size_t constexpr ingestBatchSize = 32;
+
 }  // namespace Tuning
 
 }  // namespace ripple
@@ -211,6 +211,7 @@ JSS(dir_index);               // out: DirectoryEntryIterator
 JSS(dir_root);                // out: DirectoryEntryIterator
 JSS(directory);               // in: LedgerEntry
 JSS(domain);                  // out: ValidatorInfo, Manifest
+JSS(dropped);                 // out: Peers
 JSS(drops);                   // out: TxQ
 JSS(duration_us);             // out: NetworkOPs
 JSS(effective);               // out: ValidatorList
@@ -265,6 +266,8 @@ JSS(have_state);            // out: InboundLedger
 JSS(have_transactions);     // out: InboundLedger
 JSS(highest_sequence);      // out: AccountInfo
 JSS(highest_ticket);        // out: AccountInfo
+JSS(histogram);             // out: GetCounts
+JSS(histogram_us);          // out: TxProfile
 JSS(historical_perminute);  // historical_perminute.
 JSS(hostid);                // out: NetworkOPs
 JSS(hotwallet);             // in: GatewayBalances
@@ -372,6 +375,7 @@ JSS(min_ledger);                 // in: LedgerCleaner
 JSS(minimum_fee);                // out: TxQ
 JSS(minimum_level);              // out: TxQ
 JSS(missingCommand);             // error
+JSS(msgs_per_write_sent);        // out: Peers
 JSS(name);                       // out: AmendmentTableImpl, PeerImp
 JSS(needed_state_hashes);        // out: InboundLedger
 JSS(needed_transaction_hashes);  // out: InboundLedger
@@ -390,6 +394,12 @@ JSS(node_reads_total);           // out: GetCounts
 JSS(node_reads_duration_us);     // out: GetCounts
 JSS(nodestore);                  // out: GetCounts
 JSS(node_writes);                // out: GetCounts
+JSS(node_write_amplification);   // out: GetCounts
+JSS(node_write_batch_limit);     // out: GetCounts
+JSS(node_write_batches);         // out: GetCounts
+JSS(node_write_bytes_issued);    // out: GetCounts
+JSS(node_writes_coalesced);      // out: GetCounts
+JSS(node_writes_issued);         // out: GetCounts
 JSS(node_written_bytes);         // out: GetCounts
 JSS(node_writes_duration_us);    // out: GetCounts
 JSS(node_write_retries);         // out: GetCounts
@@ -448,7 +458,9 @@ JSS(queued);                      // out: SubmitTransaction
 JSS(queued_duration_us);
 JSS(random);                // out: Random
 JSS(raw_meta);              // out: AcceptedLedgerTx
+JSS(reads);                 // out: TxProfile
 JSS(receive_currencies);    // out: AccountCurrencies
+JSS(recent);                // in/out: TxProfile
 JSS(reference_level);       // out: TxQ
 JSS(refresh_interval);      // in: UNL
 JSS(refresh_interval_min);  // out: ValidatorSites
@@ -480,6 +492,8 @@ JSS(seed);                      //
 JSS(seed_hex);                  // in: WalletPropose, TransactionSign
 JSS(send_currencies);           // out: AccountCurrencies
 JSS(send_max);                  // in: PathRequest, RipplePathFind
+JSS(send_queue);                // out: Peers
+JSS(sent);                      // out: Peers
 JSS(seq);                       // in: LedgerEntry;
                                 // out: NetworkOPs, RPCSub, AccountOffers,
                                 //      ValidatorList, ValidatorInfo, Manifest
@@ -533,7 +547,7 @@ JSS(ticket_seq);          // in: LedgerEntry
 JSS(time);
 JSS(timeouts);                // out: InboundLedger
 JSS(track);                   // out: PeerImp
-JSS(traffic);                 // out: Overlay
+JSS(traffic);                 // out: Overlay, GetCounts
 JSS(total);                   // out: counters
 JSS(totalCoins);              // out: LedgerToJson
 JSS(total_bytes_recv);        // out: Peers
@@ -546,7 +560,9 @@ JSS(transaction_hash);        // out: RCLCxPeerPos, LedgerToJson
 JSS(transactions);            // out: LedgerToJson,
                               // in: AccountTx*, Unsubscribe
 JSS(transitions);             // out: NetworkOPs
+JSS(treenode_cache_bytes);    // out: GetCounts
 JSS(treenode_cache_size);     // out: GetCounts
+JSS(treenode_hit_rate);       // out: GetCounts
 JSS(treenode_track_size);     // out: GetCounts
 JSS(trusted);                 // out: UnlList
 JSS(trusted_validator_keys);  // out: ValidatorList
@@ -596,6 +612,8 @@ JSS(warning);                 // rpc:
 JSS(warnings);                // out: server_info, server_state
 JSS(workers);
 JSS(write_load);   // out: GetCounts
+JSS(writes);       // out: TxProfile
+JSS(writes_sent);  // out: Peers
 JSS(NegativeUNL);  // out: ValidatorList; ledger type
 #undef JSS
 
@@ -29,6 +29,7 @@
 #include <ripple/net/RPCErr.h>
 #include <ripple/nodestore/Database.h>
 #include <ripple/nodestore/DatabaseShard.h>
+#include <ripple/overlay/Overlay.h>
 #include <ripple/protocol/ErrorCodes.h>
 #include <ripple/protocol/jss.h>
 #include <ripple/rpc/Context.h>
@@ -111,12 +112,28 @@ getCountsJson(Application& app, int minObjectCount)
     ret[jss::ledger_hit_rate] = app.getLedgerMaster().getCacheHitRate();
     ret[jss::AL_hit_rate] = app.getAcceptedLedgerCache().getHitRate();
 
+    ret[jss::traffic] = app.overlay().trafficHistograms();
+
     ret[jss::fullbelow_size] =
         static_cast<int>(app.getNodeFamily().getFullBelowCache(0)->size());
-    ret[jss::treenode_cache_size] =
-        app.getNodeFamily().getTreeNodeCache(0)->getCacheSize();
-    ret[jss::treenode_track_size] =
-        app.getNodeFamily().getTreeNodeCache(0)->getTrackSize();
+    {
+        auto const treeNodeCache = app.getNodeFamily().getTreeNodeCache(0);
+        ret[jss::treenode_cache_size] = treeNodeCache->getCacheSize();
+        ret[jss::treenode_track_size] = treeNodeCache->getTrackSize();
+        ret[jss::treenode_cache_bytes] =
+            std::to_string(treeNodeCache->getCacheBytes());
+
+        Json::Value& hitRate = (ret[jss::treenode_hit_rate] =
+                                    Json::objectValue);
+        for (auto const tier :
+             {TreeNodeCache::Tier::upper,
+              TreeNodeCache::Tier::inner,
+              TreeNodeCache::Tier::leaf})
+        {
+            hitRate[TreeNodeCache::tierName(tier)] =
+                treeNodeCache->getHitRate(tier);
+        }
+    }
 
     std::string uptime;
     auto s = UptimeClock::now();
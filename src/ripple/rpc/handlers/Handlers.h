@@ -139,6 +139,8 @@ doTxJson(RPC::JsonContext&);
 Json::Value
 doTxHistory(RPC::JsonContext&);
 Json::Value
+doTxProfile(RPC::JsonContext&);
+Json::Value
 doUnlList(RPC::JsonContext&);
 Json::Value
 doUnsubscribe(RPC::JsonContext&);
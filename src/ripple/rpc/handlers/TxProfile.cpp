@@ -0,0 +1,46 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/main/Application.h>
+#include <ripple/basics/PerfLog.h>
+#include <ripple/json/json_value.h>
+#include <ripple/ledger/CachedSLEs.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/Context.h>
+
+namespace ripple {
+
+// {
+//   recent: <bool> // optional, include key sets of recent transactions
+// }
+//
+// Transactions are only profiled while the performance log is enabled.
+Json::Value
+doTxProfile(RPC::JsonContext& context)
+{
+    bool const recent = context.params.isMember(jss::recent) &&
+        context.params[jss::recent].asBool();
+
+    Json::Value ret(Json::objectValue);
+    ret[jss::transactions] = context.app.getPerfLog().txJson(recent);
+    ret[jss::SLE_hit_rate] = context.app.cachedSLEs().rate();
+    return ret;
+}
+
+}  // namespace ripple
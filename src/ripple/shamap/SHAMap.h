@@ -32,13 +32,17 @@
 #include <ripple/shamap/SHAMapLeafNode.h>
 #include <ripple/shamap/SHAMapMissingNode.h>
 #include <ripple/shamap/SHAMapTreeNode.h>
+#include <ripple/shamap/SHAMapVisitedSet.h>
 #include <ripple/shamap/TreeNodeCache.h>
+#include <atomic>
 #include <cassert>
+#include <optional>
 #include <stack>
 #include <vector>
 
 namespace ripple {
 
+class JobQueue;
 class SHAMapNodeID;
 class SHAMapSyncFilter;
 
@@ -221,6 +225,30 @@ public:
     void
     visitNodes(std::function<bool(SHAMapTreeNode&)> const& function) const;
 
+    /** Called with each node visited by visitBranch or visitCommon, and
+        whether the node was read from the node store to visit it.
+    */
+    using VisitFunction =
+        std::function<bool(SHAMapTreeNode const& node, bool fetched)>;
+
+    /**  Visit every node below one branch of the root
+
+         The root itself is not visited. Different branches of the same
+         map may be visited concurrently.
+
+         @param branch the branch of the root to descend.
+         @param function called with every node visited.
+         If function returns false, visitBranch exits.
+         @param visited if set, the subtrees below the inner nodes it
+         holds are skipped, and every inner node whose subtree is
+         visited in full is added to it.
+    */
+    void
+    visitBranch(
+        int branch,
+        VisitFunction const& function,
+        SHAMapVisitedSet* visited = nullptr) const;
+
     /**  Visit every node in this SHAMap that
          is not present in the specified SHAMap
 
@@ -232,6 +260,25 @@ public:
         SHAMap const* have,
         std::function<bool(SHAMapTreeNode const&)>) const;
 
+    /**  Visit every node in this SHAMap that the specified
+         SHAMap holds at the same position
+
+         Only the parts of `have` that differ from this map are loaded.
+
+         @param function called with every node visited.
+         If function returns false, visitCommon exits.
+         @param branch if set, only the nodes below this branch of the
+         root are visited, as with visitBranch.
+         @param visited if set, used for the subtrees this map shares
+         with `have` as by visitBranch.
+    */
+    void
+    visitCommon(
+        SHAMap const& have,
+        VisitFunction const& function,
+        std::optional<int> branch = std::nullopt,
+        SHAMapVisitedSet* visited = nullptr) const;
+
     /**  Visit every leaf node in this SHAMap
 
          @param function called with every non inner node visited.
@@ -256,6 +303,26 @@ public:
     std::vector<std::pair<SHAMapNodeID, uint256>>
     getMissingNodes(int maxNodes, SHAMapSyncFilter* filter);
 
+    /** Check for nodes in the SHAMap not available, on several threads
+
+        The subtrees below the root's children are traversed
+        concurrently by the calling thread and by jobs added to
+        the job queue. Each traversal reads the nodes it defers
+        from the database in batches.
+
+        @param maxNodes The maximum number of found nodes to return
+        @param filter The filter to use when retrieving nodes
+        @param jobQueue The job queue running the other traversals
+        @param threads The maximum number of concurrent traversals
+        @param return The nodes known to be missing
+    */
+    std::vector<std::pair<SHAMapNodeID, uint256>>
+    getMissingNodes(
+        int maxNodes,
+        SHAMapSyncFilter* filter,
+        JobQueue& jobQueue,
+        int threads);
+
     bool
     getNodeFat(
         SHAMapNodeID const& wanted,
@@ -326,8 +393,17 @@ public:
     int
     flushDirty(NodeObjectType t);
 
+    /** Find nodes missing from the node store
+
+        @param complete if set, the subtrees below the inner nodes it
+        holds are skipped, and every inner node found to have no missing
+        node below it is added to it.
+    */
     void
-    walkMap(std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const;
+    walkMap(
+        std::vector<SHAMapMissingNode>& missingNodes,
+        int maxMissing,
+        SHAMapVisitedSet* complete = nullptr) const;
     bool
     deepCompare(SHAMap& other) const;  // Intended for debug/test only
 
@@ -413,17 +489,14 @@ private:
     std::shared_ptr<SHAMapTreeNode>
     descendThrow(std::shared_ptr<SHAMapInnerNode> const&, int branch) const;
 
-    // Descend with filter
-    // If pending, callback is called as if it called fetchNodeNT
-    using descendCallback =
-        std::function<void(std::shared_ptr<SHAMapTreeNode>, SHAMapHash const&)>;
+    // Descend with filter, without reading the database
+    // If pending, the child must be read from the database
     SHAMapTreeNode*
-    descendAsync(
+    descendDeferred(
         SHAMapInnerNode* parent,
         int branch,
         SHAMapSyncFilter* filter,
-        bool& pending,
-        descendCallback&&) const;
+        bool& pending) const;
 
     std::pair<SHAMapTreeNode*, SHAMapNodeID>
     descend(
@@ -437,6 +510,32 @@ private:
     std::shared_ptr<SHAMapTreeNode>
     descendNoStore(std::shared_ptr<SHAMapInnerNode> const&, int branch) const;
 
+    // Like descendNoStore, and says whether the node was read from the
+    // node store. Throws if the node is missing.
+    std::shared_ptr<SHAMapTreeNode>
+    descendNoStore(
+        std::shared_ptr<SHAMapInnerNode> const& parent,
+        int branch,
+        bool& fetched) const;
+
+    // Visit the subtree below a branch of parent, including its top,
+    // skipping visited subtrees
+    bool
+    visitSubtree(
+        std::shared_ptr<SHAMapInnerNode> const& parent,
+        int branch,
+        VisitFunction const& function,
+        SHAMapVisitedSet* visited) const;
+
+    // Find missing nodes below node, skipping complete subtrees.
+    // Returns true if none is missing.
+    bool
+    walkIncomplete(
+        std::shared_ptr<SHAMapInnerNode> const& node,
+        std::vector<SHAMapMissingNode>& missingNodes,
+        int& maxMissing,
+        SHAMapVisitedSet& complete) const;
+
     /** If there is only one leaf below this node, get its contents */
     std::shared_ptr<SHAMapItem const> const&
     onlyBelow(SHAMapTreeNode*) const;
@@ -470,7 +569,8 @@ private:
         operator=(const MissingNodes&) = delete;
 
         // basic parameters
-        int max_;
+        // The number of nodes still to find, shared by the threads
+        std::atomic<int>& max_;
         SHAMapSyncFilter* filter_;
         int const maxDefer_;
         std::uint32_t generation_;
@@ -501,28 +601,38 @@ private:
             int,                               // branch
             std::shared_ptr<SHAMapTreeNode>>;  // node
 
+        // Whether deferred reads are made in batches instead of
+        // asynchronously one at a time
+        bool const batch_;
         int deferred_;
         std::mutex deferLock_;
         std::condition_variable deferCondVar_;
         std::vector<DeferredNode> finishedReads_;
 
+        // nodes to read from the database with the next batch
+        std::vector<std::tuple<SHAMapInnerNode*, SHAMapNodeID, int>>
+            batchReads_;
+
         // nodes we need to resume after we get their children from deferred
         // reads
         std::map<SHAMapInnerNode*, SHAMapNodeID> resumes_;
 
         MissingNodes(
-            int max,
+            std::atomic<int>& max,
             SHAMapSyncFilter* filter,
             int maxDefer,
-            std::uint32_t generation)
+            std::uint32_t generation,
+            bool batch)
             : max_(max)
             , filter_(filter)
             , maxDefer_(maxDefer)
             , generation_(generation)
+            , batch_(batch)
             , deferred_(0)
         {
-            missingNodes_.reserve(max);
             finishedReads_.reserve(maxDefer);
+            if (batch_)
+                batchReads_.reserve(maxDefer);
         }
     };
 
@@ -531,6 +641,8 @@ private:
     gmn_ProcessNodes(MissingNodes&, MissingNodes::StackEntry& node);
     void
     gmn_ProcessDeferredReads(MissingNodes&);
+    void
+    gmn_Traverse(MissingNodes&, MissingNodes::StackEntry pos);
 
     // fetch from DB helper function
     std::shared_ptr<SHAMapTreeNode>
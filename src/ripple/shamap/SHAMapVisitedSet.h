@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_SHAMAP_SHAMAPVISITEDSET_H_INCLUDED
+#define RIPPLE_SHAMAP_SHAMAPVISITEDSET_H_INCLUDED
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <cstddef>
+
+namespace ripple {
+
+/** Remembers inner nodes whose subtrees were already visited in full.
+
+    Consecutive ledgers share nearly all of their state tree. A walk that
+    records here every inner node it finished can skip those subtrees in
+    the next ledger, so its cost follows the changes between the ledgers
+    rather than the size of the tree.
+
+    The set is exact, since a false positive would skip a subtree that
+    was never visited. It is bounded by keeping two generations: when
+    the recent one is full it replaces the older one, and a lookup that
+    hits the older one moves the hash back to the recent one. Walks
+    insert inner nodes after their children, so the nodes nearest the
+    root, which prune the most, are the last to be forgotten.
+
+    Thread safety:
+        Not thread safe. A set is used by one walking thread at a time,
+        so a lookup for each child costs no lock.
+*/
+class SHAMapVisitedSet
+{
+public:
+    enum { defaultCapacity = 256 * 1024 };
+
+    explicit SHAMapVisitedSet(std::size_t capacity = defaultCapacity)
+        : generationSize_(capacity > 1 ? capacity / 2 : 1)
+    {
+    }
+
+    SHAMapVisitedSet(SHAMapVisitedSet const&) = delete;
+    SHAMapVisitedSet&
+    operator=(SHAMapVisitedSet const&) = delete;
+
+    /** Returns `true` if the subtree below the inner node was visited. */
+    bool
+    contains(uint256 const& hash)
+    {
+        if (recent_.count(hash))
+            return true;
+        if (older_.erase(hash) == 0)
+            return false;
+        add(hash);
+        return true;
+    }
+
+    /** Record that the subtree below the inner node was visited. */
+    void
+    insert(uint256 const& hash)
+    {
+        add(hash);
+    }
+
+    /** Forget every node. */
+    void
+    clear()
+    {
+        recent_.clear();
+        older_.clear();
+    }
+
+    /** Returns the number of nodes remembered. */
+    std::size_t
+    size() const
+    {
+        return recent_.size() + older_.size();
+    }
+
+private:
+    void
+    add(uint256 const& hash)
+    {
+        if (recent_.size() >= generationSize_)
+        {
+            older_ = std::move(recent_);
+            recent_.clear();
+        }
+        recent_.insert(hash);
+    }
+
+    std::size_t const generationSize_;
+    hash_set<uint256> recent_;
+    hash_set<uint256> older_;
+};
+
+}  // namespace ripple
+
+#endif
@@ -111,6 +111,9 @@ private:
     int const tnTargetSize_;
     std::chrono::seconds const tnTargetAge_;
 
+    // Memory budget for each shard's tree node cache (0 = none)
+    std::uint64_t tnTargetBytes_{0};
+
     // Missing node handler
     LedgerIndex maxSeq_{0};
     std::mutex maxSeqMutex_;
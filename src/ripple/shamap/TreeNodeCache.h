@@ -20,11 +20,307 @@
 #ifndef RIPPLE_SHAMAP_TREENODECACHE_H_INCLUDED
 #define RIPPLE_SHAMAP_TREENODECACHE_H_INCLUDED
 
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/basics/hardened_hash.h>
+#include <ripple/beast/clock/abstract_clock.h>
+#include <ripple/beast/insight/Insight.h>
+#include <ripple/beast/utility/Journal.h>
 #include <ripple/shamap/SHAMapTreeNode.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace ripple {
 
-using TreeNodeCache = TaggedCache<uint256, SHAMapTreeNode>;
+/** Cache of SHAMap tree nodes, keyed by node hash.
+
+    Behaves like a TaggedCache: strongly held nodes age out after the
+    target age, and nodes still referenced elsewhere stay tracked weakly
+    so that every code path canonicalizes to the same object.
+
+    In addition the cache may be given a memory budget. Each node is
+    charged an estimate of its footprint and, whenever the strongly held
+    nodes exceed the budget, nodes are evicted in tier order: leaves
+    first, then sparse inner nodes, then fully populated inner nodes.
+    A fully populated inner node is almost always one of the few levels
+    nearest the root, which every lookup traverses, so they are kept the
+    longest. Within a tier, nodes that were fetched since the previous
+    sweep are protected from eviction until all cold nodes are gone, and
+    the remainder are evicted least recently used first.
+
+    Strongly held nodes are kept on one least recently used list per
+    eviction class, so meeting the budget costs time in proportion to the
+    nodes evicted rather than the size of the cache.
+*/
+class TreeNodeCache
+{
+public:
+    using key_type = uint256;
+    using mapped_type = SHAMapTreeNode;
+    using clock_type = beast::abstract_clock<std::chrono::steady_clock>;
+
+    /** Eviction tiers, lowest evicted first. */
+    enum class Tier : std::uint8_t { leaf = 0, inner, upper };
+
+    static constexpr std::size_t tierCount = 3;
+
+    TreeNodeCache(
+        std::string const& name,
+        int size,
+        clock_type::duration expiration,
+        clock_type& clock,
+        beast::Journal journal,
+        beast::insight::Collector::ptr const& collector =
+            beast::insight::NullCollector::New());
+
+    /** Return the clock associated with the cache. */
+    clock_type&
+    clock()
+    {
+        return m_clock;
+    }
+
+    int
+    getTargetSize() const;
+
+    void
+    setTargetSize(int s);
+
+    clock_type::duration
+    getTargetAge() const;
+
+    void
+    setTargetAge(clock_type::duration s);
+
+    /** The memory budget in bytes for strongly held nodes (0 = none). */
+    std::uint64_t
+    getTargetBytes() const;
+
+    void
+    setTargetBytes(std::uint64_t bytes);
+
+    int
+    getCacheSize() const;
+
+    int
+    getTrackSize() const;
+
+    /** Estimated bytes held by strongly cached nodes. */
+    std::uint64_t
+    getCacheBytes() const;
+
+    float
+    getHitRate() const;
+
+    /** Hit rate, in percent, of lookups for nodes in the given tier.
+
+        A lookup that misses the cache is charged to a tier when the node
+        is subsequently fetched and canonicalized.
+    */
+    float
+    getHitRate(Tier tier) const;
+
+    void
+    clear();
+
+    void
+    reset();
+
+    void
+    sweep();
+
+    /** Replace aliased objects with originals.
+
+        If a node with the same key is already tracked, `data` is replaced
+        with the tracked node. Otherwise `data` is stored.
+
+        @return `true` If the key already existed.
+    */
+    bool
+    canonicalize_replace_client(
+        key_type const& key,
+        std::shared_ptr<SHAMapTreeNode>& data)
+    {
+        return canonicalize(key, data, true);
+    }
+
+    /** Canonicalize a node that was just created and written locally.
+
+        Identical to canonicalize_replace_client except that storing the
+        node is not charged as a miss against its tier.
+    */
+    bool
+    canonicalize_written(
+        key_type const& key,
+        std::shared_ptr<SHAMapTreeNode>& data)
+    {
+        return canonicalize(key, data, false);
+    }
+
+    std::shared_ptr<SHAMapTreeNode>
+    fetch(key_type const& key);
+
+    std::vector<key_type>
+    getKeys() const;
+
+    static Tier
+    tierOf(SHAMapTreeNode const& node);
+
+    static char const*
+    tierName(Tier tier);
+
+    /** Estimate the memory charged to a cached node. */
+    static std::uint32_t
+    bytesOf(SHAMapTreeNode const& node);
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<SHAMapTreeNode> ptr;
+        std::weak_ptr<SHAMapTreeNode> weak_ptr;
+        clock_type::time_point last_access;
+        std::uint32_t bytes;
+        Tier tier;
+
+        // Fetched since the last sweep
+        bool referenced = false;
+
+        // Was referenced during the previous sweep interval
+        bool hot = false;
+
+        // The entry's key, and its neighbours on the list of its eviction
+        // class while strongly held, least recently used first
+        key_type const* key = nullptr;
+        Entry* prev = nullptr;
+        Entry* next = nullptr;
+
+        Entry(
+            clock_type::time_point const& last_access_,
+            std::shared_ptr<SHAMapTreeNode> const& ptr_);
+
+        bool
+        isWeak() const
+        {
+            return ptr == nullptr;
+        }
+
+        bool
+        isCached() const
+        {
+            return ptr != nullptr;
+        }
+
+        bool
+        isExpired() const
+        {
+            return weak_ptr.expired();
+        }
+    };
+
+    using cache_type = hardened_hash_map<key_type, Entry>;
+
+    // Strongly held entries of one eviction class
+    struct List
+    {
+        Entry* head = nullptr;
+        Entry* tail = nullptr;
+    };
+
+    // Cold nodes of every tier are evicted before hot ones, and lower
+    // tiers before higher ones
+    static constexpr std::size_t classCount = 2 * tierCount;
+
+    static std::size_t
+    classOf(Entry const& entry)
+    {
+        return (entry.hot ? tierCount : 0) +
+            static_cast<std::size_t>(entry.tier);
+    }
+
+    struct Stats
+    {
+        template <class Handler>
+        Stats(
+            std::string const& prefix,
+            Handler const& handler,
+            beast::insight::Collector::ptr const& collector);
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge size;
+        beast::insight::Gauge bytes;
+        beast::insight::Gauge hit_rate;
+        std::array<beast::insight::Gauge, tierCount> tier_hit_rate;
+    };
+
+    void
+    collect_metrics();
+
+    bool
+    canonicalize(
+        key_type const& key,
+        std::shared_ptr<SHAMapTreeNode>& data,
+        bool fetched);
+
+    // Make a weakly held entry strong again, if the node is still alive.
+    bool
+    strengthen(Entry& entry);
+
+    // Add a strongly held entry as the most recently used of its class,
+    // or remove it from its class.
+    void
+    link(Entry& entry);
+    void
+    unlink(Entry& entry);
+
+    // Drop the strong reference held by an entry, erasing the entry if
+    // nothing else references the node. Returns the next iterator.
+    cache_type::iterator
+    evict(
+        cache_type::iterator cit,
+        std::vector<std::shared_ptr<SHAMapTreeNode>>& stuffToSweep);
+
+    // Evict the least recently used nodes, in class order, until the
+    // budget is met.
+    void
+    trim(
+        std::lock_guard<std::recursive_mutex> const&,
+        std::uint64_t target,
+        std::vector<std::shared_ptr<SHAMapTreeNode>>& stuffToSweep);
+
+    beast::Journal m_journal;
+    clock_type& m_clock;
+    Stats m_stats;
+
+    std::recursive_mutex mutable m_mutex;
+
+    // Used for logging
+    std::string m_name;
+
+    // Desired number of cache entries (0 = ignore)
+    int m_target_size;
+
+    // Desired maximum cache age
+    clock_type::duration m_target_age;
+
+    // Memory budget for strongly held nodes (0 = ignore)
+    std::uint64_t m_target_bytes = 0;
+
+    // Number of items cached and their estimated footprint
+    int m_cache_count = 0;
+    std::uint64_t m_cache_bytes = 0;
+
+    cache_type m_cache;  // Hold strong reference to recent objects
+    std::array<List, classCount> m_lists;
+    std::uint64_t m_hits = 0;
+    std::uint64_t m_misses = 0;
+    std::array<std::uint64_t, tierCount> m_tier_hits{};
+    std::array<std::uint64_t, tierCount> m_tier_misses{};
+};
 
 }  // namespace ripple
 
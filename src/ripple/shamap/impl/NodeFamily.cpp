@@ -20,6 +20,8 @@
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/main/Tuning.h>
+#include <ripple/basics/ByteUtilities.h>
+#include <ripple/core/ConfigSections.h>
 #include <ripple/shamap/NodeFamily.h>
 
 namespace ripple {
@@ -40,8 +42,20 @@ NodeFamily::NodeFamily(Application& app, CollectorManager& cm)
           std::chrono::seconds(
               app.config().getValueFor(SizedItem::treeCacheAge)),
           stopwatch(),
-          j_))
+          j_,
+          cm.collector()))
 {
+    // A memory budget replaces the entry count derived from node_size
+    std::uint64_t budget{0};
+    if (get_if_exists(
+            app.config().section(ConfigSection::nodeDatabase()),
+            "tree_cache_mb",
+            budget) &&
+        budget > 0)
+    {
+        tnCache_->setTargetSize(0);
+        tnCache_->setTargetBytes(megabytes(budget));
+    }
 }
 
 void
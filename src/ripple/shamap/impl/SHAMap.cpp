@@ -186,8 +186,7 @@ SHAMap::finishFetch(
     std::shared_ptr<SHAMapTreeNode> node;
     try
     {
-        node =
-            SHAMapTreeNode::makeFromPrefix(makeSlice(object->getData()), hash);
+        node = SHAMapTreeNode::makeFromPrefix(object->getData(), hash);
         if (node)
             canonicalize(hash, node);
         return node;
@@ -377,12 +376,11 @@ SHAMap::descend(
 }
 
 SHAMapTreeNode*
-SHAMap::descendAsync(
+SHAMap::descendDeferred(
     SHAMapInnerNode* parent,
     int branch,
     SHAMapSyncFilter* filter,
-    bool& pending,
-    descendCallback&& callback) const
+    bool& pending) const
 {
     pending = false;
 
@@ -400,14 +398,6 @@ SHAMap::descendAsync(
 
         if (!ptr && backed_)
         {
-            f_.db().asyncFetch(
-                hash.as_uint256(),
-                ledgerSeq_,
-                [this, hash, cb{std::move(callback)}](
-                    std::shared_ptr<NodeObject> const& object) {
-                    auto node = finishFetch(hash, object);
-                    cb(node, hash);
-                });
             pending = true;
             return nullptr;
         }
@@ -883,7 +873,8 @@ SHAMap::writeNode(NodeObjectType t, std::shared_ptr<SHAMapTreeNode> node) const
     assert(node->cowid() == 0);
     assert(backed_);
 
-    canonicalize(node->getHash(), node);
+    f_.getTreeNodeCache(ledgerSeq_)
+        ->canonicalize_written(node->getHash().as_uint256(), node);
 
     Serializer s;
     node->serializeWithPrefix(s);
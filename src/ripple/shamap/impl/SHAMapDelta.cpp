@@ -245,12 +245,24 @@ SHAMap::compare(SHAMap const& otherMap, Delta& differences, int maxCount) const
 }
 
 void
-SHAMap::walkMap(std::vector<SHAMapMissingNode>& missingNodes, int maxMissing)
-    const
+SHAMap::walkMap(
+    std::vector<SHAMapMissingNode>& missingNodes,
+    int maxMissing,
+    SHAMapVisitedSet* complete) const
 {
     if (!root_->isInner())  // root_ is only node, and we have it
         return;
 
+    if (complete)
+    {
+        walkIncomplete(
+            std::static_pointer_cast<SHAMapInnerNode>(root_),
+            missingNodes,
+            maxMissing,
+            *complete);
+        return;
+    }
+
     using StackEntry = std::shared_ptr<SHAMapInnerNode>;
     std::stack<StackEntry, std::vector<StackEntry>> nodeStack;
 
@@ -286,4 +298,47 @@ SHAMap::walkMap(std::vector<SHAMapMissingNode>& missingNodes, int maxMissing)
     }
 }
 
+bool
+SHAMap::walkIncomplete(
+    std::shared_ptr<SHAMapInnerNode> const& node,
+    std::vector<SHAMapMissingNode>& missingNodes,
+    int& maxMissing,
+    SHAMapVisitedSet& complete) const
+{
+    if (complete.contains(node->getHash().as_uint256()))
+        return true;
+
+    bool full = true;
+    for (int i = 0; i < branchFactor; ++i)
+    {
+        if (node->isEmptyBranch(i))
+            continue;
+
+        std::shared_ptr<SHAMapTreeNode> nextNode = descendNoStore(node, i);
+        if (!nextNode)
+        {
+            full = false;
+            missingNodes.emplace_back(type_, node->getChildHash(i));
+            if (--maxMissing <= 0)
+                return false;
+        }
+        else if (
+            nextNode->isInner() &&
+            !walkIncomplete(
+                std::static_pointer_cast<SHAMapInnerNode>(nextNode),
+                missingNodes,
+                maxMissing,
+                complete))
+        {
+            full = false;
+            if (maxMissing <= 0)
+                return false;
+        }
+    }
+
+    if (full)
+        complete.insert(node->getHash().as_uint256());
+    return full;
+}
+
 }  // namespace ripple
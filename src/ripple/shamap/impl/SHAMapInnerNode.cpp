@@ -132,23 +132,29 @@ SHAMapInnerNode::makeFullInner(
     SHAMapHash const& hash,
     bool hashValid)
 {
-    if (data.size() != 512)
+    if (data.size() != branchFactor * uint256::bytes)
         Throw<std::runtime_error>("Invalid FI node");
 
-    auto ret = std::make_shared<SHAMapInnerNode>(0, branchFactor);
-
-    Serializer s(data.data(), data.size());
+    // Find the branches first so that the child arrays are allocated at
+    // their final size and the hashes read straight from the data.
+    auto const hashAt = [&data](int i) {
+        return uint256::fromVoid(data.data() + i * uint256::bytes);
+    };
 
-    auto retHashes = ret->hashesAndChildren_.getHashes();
+    std::uint16_t isBranch = 0;
     for (int i = 0; i < branchFactor; ++i)
     {
-        s.getBitString(retHashes[i].as_uint256(), i * 32);
-
-        if (retHashes[i].isNonZero())
-            ret->isBranch_ |= (1 << i);
+        if (hashAt(i).isNonZero())
+            isBranch |= (1 << i);
     }
 
-    ret->resizeChildArrays(ret->getBranchCount());
+    auto ret = std::make_shared<SHAMapInnerNode>(0, popcnt16(isBranch));
+    ret->isBranch_ = isBranch;
+
+    auto retHashes = ret->hashesAndChildren_.getHashes();
+    ret->iterNonEmptyChildIndexes([&](auto branchNum, auto indexNum) {
+        retHashes[indexNum].as_uint256() = hashAt(branchNum);
+    });
 
     if (hashValid)
         ret->hash_ = hash;
@@ -18,9 +18,13 @@
 //==============================================================================
 
 #include <ripple/basics/random.h>
+#include <ripple/core/JobQueue.h>
 #include <ripple/shamap/SHAMap.h>
 #include <ripple/shamap/SHAMapSyncFilter.h>
 
+#include <condition_variable>
+#include <mutex>
+
 namespace ripple {
 
 void
@@ -164,6 +168,176 @@ SHAMap::visitDifferences(
     }
 }
 
+std::shared_ptr<SHAMapTreeNode>
+SHAMap::descendNoStore(
+    std::shared_ptr<SHAMapInnerNode> const& parent,
+    int branch,
+    bool& fetched) const
+{
+    fetched = false;
+    std::shared_ptr<SHAMapTreeNode> ret = parent->getChild(branch);
+    if (ret || !backed_)
+        return ret;
+
+    auto const& hash = parent->getChildHash(branch);
+    ret = cacheLookup(hash);
+    if (!ret)
+    {
+        ret = fetchNodeFromDB(hash);
+        if (!ret)
+            Throw<SHAMapMissingNode>(type_, hash);
+        fetched = true;
+    }
+    return ret;
+}
+
+bool
+SHAMap::visitSubtree(
+    std::shared_ptr<SHAMapInnerNode> const& parent,
+    int branch,
+    VisitFunction const& function,
+    SHAMapVisitedSet* visited) const
+{
+    // Only inner nodes are added to the set
+    auto const skip = [visited](SHAMapHash const& hash) {
+        return visited && visited->contains(hash.as_uint256());
+    };
+
+    if (skip(parent->getChildHash(branch)))
+        return true;
+
+    bool fetched;
+    auto top = descendNoStore(parent, branch, fetched);
+    if (!function(*top, fetched))
+        return false;
+    if (!top->isInner())
+        return true;
+
+    // Inner nodes and the next branch of each to descend
+    using StackEntry = std::pair<std::shared_ptr<SHAMapInnerNode>, int>;
+    std::stack<StackEntry, std::vector<StackEntry>> stack;
+    stack.push(
+        {std::static_pointer_cast<SHAMapInnerNode>(std::move(top)), 0});
+    while (!stack.empty())
+    {
+        auto& [node, pos] = stack.top();
+        while (pos < branchFactor &&
+               (node->isEmptyBranch(pos) || skip(node->getChildHash(pos))))
+            ++pos;
+
+        if (pos == branchFactor)
+        {
+            // Inner nodes complete after their children
+            if (visited)
+                visited->insert(node->getHash().as_uint256());
+            stack.pop();
+            continue;
+        }
+
+        auto child = descendNoStore(node, pos++, fetched);
+        if (!function(*child, fetched))
+            return false;
+        if (child->isInner())
+            stack.push(
+                {std::static_pointer_cast<SHAMapInnerNode>(std::move(child)),
+                 0});
+    }
+    return true;
+}
+
+void
+SHAMap::visitBranch(
+    int branch,
+    VisitFunction const& function,
+    SHAMapVisitedSet* visited) const
+{
+    assert(branch >= 0 && branch < branchFactor);
+    if (!root_ || !root_->isInner())
+        return;
+
+    auto const root = std::static_pointer_cast<SHAMapInnerNode>(root_);
+    if (!root->isEmptyBranch(branch))
+        visitSubtree(root, branch, function, visited);
+}
+
+void
+SHAMap::visitCommon(
+    SHAMap const& have,
+    VisitFunction const& function,
+    std::optional<int> branch,
+    SHAMapVisitedSet* visited) const
+{
+    if (!root_ || !have.root_)
+        return;
+
+    if (root_->getHash().isZero() || have.root_->getHash().isZero())
+        return;
+
+    if (root_->getHash() == have.root_->getHash())
+    {
+        if (branch)
+        {
+            visitBranch(*branch, function, visited);
+            return;
+        }
+
+        if (!function(*root_, false) || !root_->isInner())
+            return;
+        auto const root = std::static_pointer_cast<SHAMapInnerNode>(root_);
+        for (int i = 0; i < branchFactor; ++i)
+        {
+            if (!root->isEmptyBranch(i) &&
+                !visitSubtree(root, i, function, visited))
+                return;
+        }
+        return;
+    }
+
+    if (!root_->isInner() || !have.root_->isInner())
+        return;
+
+    // Pairs of inner nodes at the same position whose hashes differ
+    using Inner = std::shared_ptr<SHAMapInnerNode>;
+    using StackEntry = std::pair<Inner, Inner>;
+    std::stack<StackEntry, std::vector<StackEntry>> stack;
+    stack.push(
+        {std::static_pointer_cast<SHAMapInnerNode>(root_),
+         std::static_pointer_cast<SHAMapInnerNode>(have.root_)});
+
+    while (!stack.empty())
+    {
+        auto const [node, other] = std::move(stack.top());
+        stack.pop();
+
+        for (int i = 0; i < branchFactor; ++i)
+        {
+            if (branch && node == root_ && i != *branch)
+                continue;
+
+            if (node->isEmptyBranch(i) || other->isEmptyBranch(i))
+                continue;
+
+            if (node->getChildHash(i) == other->getChildHash(i))
+            {
+                if (!visitSubtree(node, i, function, visited))
+                    return;
+                continue;
+            }
+
+            auto child = descendNoStore(node, i);
+            if (!child->isInner())
+                continue;
+            auto otherChild = have.descendNoStore(other, i);
+            if (!otherChild->isInner())
+                continue;
+            stack.push(
+                {std::static_pointer_cast<SHAMapInnerNode>(std::move(child)),
+                 std::static_pointer_cast<SHAMapInnerNode>(
+                     std::move(otherChild))});
+        }
+    }
+}
+
 // Starting at the position referred to by the specfied
 // StackEntry, process that node and its first resident
 // children, descending the SHAMap until we complete the
@@ -196,24 +370,33 @@ SHAMap::gmn_ProcessNodes(MissingNodes& mn, MissingNodes::StackEntry& se)
                  ->touch_if_exists(childHash.as_uint256()))
         {
             bool pending = false;
-            auto d = descendAsync(
-                node,
-                branch,
-                mn.filter_,
-                pending,
-                [node, nodeID, branch, &mn](
-                    std::shared_ptr<SHAMapTreeNode> found, SHAMapHash const&) {
-                    // a read completed asynchronously
-                    std::unique_lock<std::mutex> lock{mn.deferLock_};
-                    mn.finishedReads_.emplace_back(
-                        node, nodeID, branch, std::move(found));
-                    mn.deferCondVar_.notify_one();
-                });
+            auto d = descendDeferred(node, branch, mn.filter_, pending);
 
             if (pending)
             {
                 fullBelow = false;
                 ++mn.deferred_;
+                if (mn.batch_)
+                {
+                    // read with the next batch
+                    mn.batchReads_.emplace_back(node, nodeID, branch);
+                }
+                else
+                {
+                    f_.db().asyncFetch(
+                        childHash.as_uint256(),
+                        ledgerSeq_,
+                        [this, node, nodeID, branch, &mn](
+                            std::shared_ptr<NodeObject> const& object) {
+                            // a read completed asynchronously
+                            auto found = finishFetch(
+                                node->getChildHash(branch), object);
+                            std::unique_lock<std::mutex> lock{mn.deferLock_};
+                            mn.finishedReads_.emplace_back(
+                                node, nodeID, branch, std::move(found));
+                            mn.deferCondVar_.notify_one();
+                        });
+                }
             }
             else if (!d)
             {
@@ -264,6 +447,29 @@ SHAMap::gmn_ProcessNodes(MissingNodes& mn, MissingNodes::StackEntry& se)
 void
 SHAMap::gmn_ProcessDeferredReads(MissingNodes& mn)
 {
+    if (!mn.batchReads_.empty())
+    {
+        // Read the nodes deferred for this batch all at once
+        std::vector<uint256> hashes;
+        hashes.reserve(mn.batchReads_.size());
+        for (auto const& [parent, parentID, branch] : mn.batchReads_)
+            hashes.push_back(parent->getChildHash(branch).as_uint256());
+
+        auto const objects = f_.db().fetchNodeObjects(hashes, ledgerSeq_);
+
+        std::unique_lock<std::mutex> lock{mn.deferLock_};
+        for (std::size_t i = 0; i < mn.batchReads_.size(); ++i)
+        {
+            auto const& [parent, parentID, branch] = mn.batchReads_[i];
+            mn.finishedReads_.emplace_back(
+                parent,
+                parentID,
+                branch,
+                finishFetch(parent->getChildHash(branch), objects[i]));
+        }
+        mn.batchReads_.clear();
+    }
+
     // Process all deferred reads
     int complete = 0;
     while (complete != mn.deferred_)
@@ -308,42 +514,11 @@ SHAMap::gmn_ProcessDeferredReads(MissingNodes& mn)
     mn.deferred_ = 0;
 }
 
-/** Get a list of node IDs and hashes for nodes that are part of this SHAMap
-    but not available locally.  The filter can hold alternate sources of
-    nodes that are not permanently stored locally
-*/
-std::vector<std::pair<SHAMapNodeID, uint256>>
-SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter)
+// Traverse the map from the specified position, until every node
+// below it was found or enough missing nodes were
+void
+SHAMap::gmn_Traverse(MissingNodes& mn, MissingNodes::StackEntry pos)
 {
-    assert(root_->getHash().isNonZero());
-    assert(max > 0);
-
-    MissingNodes mn(
-        max,
-        filter,
-        4096,  // number of async reads per pass
-        f_.getFullBelowCache(ledgerSeq_)->getGeneration());
-
-    if (!root_->isInner() ||
-        std::static_pointer_cast<SHAMapInnerNode>(root_)->isFullBelow(
-            mn.generation_))
-    {
-        clearSynching();
-        return std::move(mn.missingNodes_);
-    }
-
-    // Start at the root.
-    // The firstChild value is selected randomly so if multiple threads
-    // are traversing the map, each thread will start at a different
-    // (randomly selected) inner node.  This increases the likelihood
-    // that the two threads will produce different request sets (which is
-    // more efficient than sending identical requests).
-    MissingNodes::StackEntry pos{
-        static_cast<SHAMapInnerNode*>(root_.get()),
-        SHAMapNodeID(),
-        rand_int(255),
-        0,
-        true};
     auto& node = std::get<0>(pos);
     auto& nextChild = std::get<3>(pos);
     auto& fullBelow = std::get<4>(pos);
@@ -380,12 +555,12 @@ SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter)
         }
 
         // We have either emptied the stack or
-        // posted as many deferred reads as we can
+        // deferred as many reads as we can
         if (mn.deferred_)
             gmn_ProcessDeferredReads(mn);
 
         if (mn.max_ <= 0)
-            return std::move(mn.missingNodes_);
+            return;
 
         if (node == nullptr)
         {  // We weren't in the middle of processing a node
@@ -415,6 +590,233 @@ SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter)
         // and we have no nodes to resume
 
     } while (node != nullptr);
+}
+
+/** Get a list of node IDs and hashes for nodes that are part of this SHAMap
+    but not available locally.  The filter can hold alternate sources of
+    nodes that are not permanently stored locally
+*/
+std::vector<std::pair<SHAMapNodeID, uint256>>
+SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter)
+{
+    assert(root_->getHash().isNonZero());
+    assert(max > 0);
+
+    std::atomic<int> remaining{max};
+    MissingNodes mn(
+        remaining,
+        filter,
+        4096,  // number of async reads per pass
+        f_.getFullBelowCache(ledgerSeq_)->getGeneration(),
+        false);
+
+    if (!root_->isInner() ||
+        std::static_pointer_cast<SHAMapInnerNode>(root_)->isFullBelow(
+            mn.generation_))
+    {
+        clearSynching();
+        return std::move(mn.missingNodes_);
+    }
+
+    // Start at the root.
+    // The firstChild value is selected randomly so if multiple threads
+    // are traversing the map, each thread will start at a different
+    // (randomly selected) inner node.  This increases the likelihood
+    // that the two threads will produce different request sets (which is
+    // more efficient than sending identical requests).
+    gmn_Traverse(
+        mn,
+        {static_cast<SHAMapInnerNode*>(root_.get()),
+         SHAMapNodeID(),
+         rand_int(255),
+         0,
+         true});
+
+    if (mn.missingNodes_.empty())
+        clearSynching();
+
+    return std::move(mn.missingNodes_);
+}
+
+std::vector<std::pair<SHAMapNodeID, uint256>>
+SHAMap::getMissingNodes(
+    int max,
+    SHAMapSyncFilter* filter,
+    JobQueue& jobQueue,
+    int threads)
+{
+    if (threads <= 1 || !backed_)
+        return getMissingNodes(max, filter);
+
+    assert(root_->getHash().isNonZero());
+    assert(max > 0);
+
+    // number of reads per batch
+    int constexpr maxDefer = 4096;
+
+    // Shared with the jobs, which may start after we return
+    struct State
+    {
+        std::atomic<int> remaining;
+        std::vector<MissingNodes::StackEntry> subtrees;
+        std::atomic<std::size_t> next{0};
+        std::size_t done = 0;
+        std::vector<std::pair<SHAMapNodeID, uint256>> missing;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto state = std::make_shared<State>();
+    state->remaining = max;
+
+    auto const generation = f_.getFullBelowCache(ledgerSeq_)->getGeneration();
+    MissingNodes mn(state->remaining, filter, maxDefer, generation, true);
+    mn.missingNodes_.reserve(max);
+
+    if (!root_->isInner() ||
+        std::static_pointer_cast<SHAMapInnerNode>(root_)->isFullBelow(
+            mn.generation_))
+    {
+        clearSynching();
+        return std::move(mn.missingNodes_);
+    }
+
+    auto const root = static_cast<SHAMapInnerNode*>(root_.get());
+
+    // Find the root's children, then traverse the subtrees below them
+    // concurrently. The subtrees share no nodes, so each traversal
+    // tracks its own state and only the count of nodes still to find
+    // is shared.
+    auto const firstChild = rand_int(255);
+    for (int i = 0; i < branchFactor; ++i)
+    {
+        int const branch = (firstChild + i) % branchFactor;
+        if (root->isEmptyBranch(branch))
+            continue;
+
+        auto const& childHash = root->getChildHash(branch);
+        if (f_.getFullBelowCache(ledgerSeq_)->touch_if_exists(
+                childHash.as_uint256()))
+            continue;
+
+        bool pending = false;
+        auto const child = descendDeferred(root, branch, filter, pending);
+        if (pending)
+        {
+            ++mn.deferred_;
+            mn.batchReads_.emplace_back(root, SHAMapNodeID(), branch);
+        }
+        else if (!child && mn.missingHashes_.insert(childHash).second)
+        {
+            mn.missingNodes_.emplace_back(
+                SHAMapNodeID().getChildNodeID(branch), childHash.as_uint256());
+            --mn.max_;
+        }
+    }
+    if (mn.deferred_)
+        gmn_ProcessDeferredReads(mn);
+    mn.resumes_.clear();
+
+    for (int i = 0; i < branchFactor; ++i)
+    {
+        int const branch = (firstChild + i) % branchFactor;
+        auto const child = root->getChildPointer(branch);
+        if (child && child->isInner() &&
+            !static_cast<SHAMapInnerNode*>(child)->isFullBelow(generation))
+        {
+            state->subtrees.emplace_back(
+                static_cast<SHAMapInnerNode*>(child),
+                SHAMapNodeID().getChildNodeID(branch),
+                rand_int(255),
+                0,
+                true);
+        }
+    }
+
+    auto const total = state->subtrees.size();
+    auto work = [this, state, filter, generation, total]() {
+        MissingNodes tmn(state->remaining, filter, maxDefer, generation, true);
+        std::size_t completed = 0;
+        for (auto i = state->next++; i < total; i = state->next++)
+        {
+            try
+            {
+                if (state->remaining > 0)
+                    gmn_Traverse(tmn, state->subtrees[i]);
+            }
+            catch (...)
+            {
+                std::lock_guard lock(state->mutex);
+                if (!state->error)
+                    state->error = std::current_exception();
+                state->remaining = 0;
+            }
+            ++completed;
+        }
+
+        if (completed != 0)
+        {
+            std::lock_guard lock(state->mutex);
+            state->missing.insert(
+                state->missing.end(),
+                tmn.missingNodes_.begin(),
+                tmn.missingNodes_.end());
+            state->done += completed;
+            if (state->done == total)
+                state->cv.notify_all();
+        }
+    };
+
+    // The calling thread traverses too, and only waits for the subtrees
+    // a job has already started on.
+    auto const helpers =
+        std::min<std::size_t>(threads - 1, total > 0 ? total - 1 : 0);
+    for (std::size_t i = 0; i < helpers; ++i)
+        jobQueue.addJob(
+            jtLEDGER_SCAN, "getMissingNodes", [work](Job&) { work(); });
+
+    work();
+
+    {
+        std::unique_lock lock(state->mutex);
+        state->cv.wait(lock, [&] { return state->done == total; });
+    }
+
+    if (state->error)
+        std::rethrow_exception(state->error);
+
+    mn.missingNodes_.insert(
+        mn.missingNodes_.end(), state->missing.begin(), state->missing.end());
+
+    // Traversals finding their last nodes at the same time may find
+    // a few more than we asked for
+    if (mn.missingNodes_.size() > static_cast<std::size_t>(max))
+        mn.missingNodes_.resize(max);
+
+    if (mn.missingNodes_.empty() && state->remaining > 0)
+    {
+        // No partial node encountered below the root
+        bool fullBelow = true;
+        for (int branch = 0; fullBelow && branch < branchFactor; ++branch)
+        {
+            if (root->isEmptyBranch(branch))
+                continue;
+            if (auto const child = root->getChildPointer(branch))
+                fullBelow = !child->isInner() ||
+                    static_cast<SHAMapInnerNode*>(child)->isFullBelow(
+                        generation);
+            else
+                fullBelow = f_.getFullBelowCache(ledgerSeq_)->touch_if_exists(
+                    root->getChildHash(branch).as_uint256());
+        }
+
+        if (fullBelow)
+        {
+            root->setFullBelowGen(generation);
+            f_.getFullBelowCache(ledgerSeq_)->insert(
+                root->getHash().as_uint256());
+        }
+    }
 
     if (mn.missingNodes_.empty())
         clearSynching();
@@ -20,6 +20,8 @@
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/main/Tuning.h>
+#include <ripple/basics/ByteUtilities.h>
+#include <ripple/core/ConfigSections.h>
 #include <ripple/nodestore/DatabaseShard.h>
 #include <ripple/shamap/ShardFamily.h>
 
@@ -41,6 +43,14 @@ ShardFamily::ShardFamily(Application& app, CollectorManager& cm)
     , tnTargetSize_(app.config().getValueFor(SizedItem::treeCacheSize, 0))
     , tnTargetAge_(app.config().getValueFor(SizedItem::treeCacheAge, 0))
 {
+    std::uint64_t budget{0};
+    if (get_if_exists(
+            app.config().section(ConfigSection::shardDatabase()),
+            "tree_cache_mb",
+            budget))
+    {
+        tnTargetBytes_ = megabytes(budget);
+    }
 }
 
 std::shared_ptr<FullBelowCache>
@@ -80,12 +90,14 @@ ShardFamily::getTreeNodeCache(std::uint32_t ledgerSeq)
         return it->second;
 
     // Create a cache for the corresponding shard
+    // A memory budget replaces the entry count derived from node_size
     auto tnCache{std::make_shared<TreeNodeCache>(
         "Shard family tree node cache shard " + std::to_string(shardIndex),
-        tnTargetSize_,
+        tnTargetBytes_ > 0 ? 0 : tnTargetSize_,
         tnTargetAge_,
         stopwatch(),
         j_)};
+    tnCache->setTargetBytes(tnTargetBytes_);
     return tnCache_.emplace(shardIndex, std::move(tnCache)).first->second;
 }
 
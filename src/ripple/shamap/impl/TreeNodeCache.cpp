@@ -0,0 +1,565 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Log.h>
+#include <ripple/shamap/SHAMapInnerNode.h>
+#include <ripple/shamap/SHAMapItem.h>
+#include <ripple/shamap/SHAMapLeafNode.h>
+#include <ripple/shamap/TreeNodeCache.h>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace ripple {
+
+TreeNodeCache::Entry::Entry(
+    clock_type::time_point const& last_access_,
+    std::shared_ptr<SHAMapTreeNode> const& ptr_)
+    : ptr(ptr_)
+    , weak_ptr(ptr_)
+    , last_access(last_access_)
+    , bytes(bytesOf(*ptr_))
+    , tier(tierOf(*ptr_))
+{
+}
+
+template <class Handler>
+TreeNodeCache::Stats::Stats(
+    std::string const& prefix,
+    Handler const& handler,
+    beast::insight::Collector::ptr const& collector)
+    : hook(collector->make_hook(handler))
+    , size(collector->make_gauge(prefix, "size"))
+    , bytes(collector->make_gauge(prefix, "bytes"))
+    , hit_rate(collector->make_gauge(prefix, "hit_rate"))
+    , tier_hit_rate{
+          {collector->make_gauge(prefix, "leaf_hit_rate"),
+           collector->make_gauge(prefix, "inner_hit_rate"),
+           collector->make_gauge(prefix, "upper_hit_rate")}}
+{
+}
+
+TreeNodeCache::TreeNodeCache(
+    std::string const& name,
+    int size,
+    clock_type::duration expiration,
+    clock_type& clock,
+    beast::Journal journal,
+    beast::insight::Collector::ptr const& collector)
+    : m_journal(journal)
+    , m_clock(clock)
+    , m_stats(name, std::bind(&TreeNodeCache::collect_metrics, this), collector)
+    , m_name(name)
+    , m_target_size(size)
+    , m_target_age(expiration)
+{
+}
+
+int
+TreeNodeCache::getTargetSize() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_target_size;
+}
+
+void
+TreeNodeCache::setTargetSize(int s)
+{
+    std::lock_guard lock(m_mutex);
+    m_target_size = s;
+
+    if (s > 0)
+        m_cache.rehash(static_cast<std::size_t>(
+            (s + (s >> 2)) / m_cache.max_load_factor() + 1));
+
+    JLOG(m_journal.debug()) << m_name << " target size set to " << s;
+}
+
+TreeNodeCache::clock_type::duration
+TreeNodeCache::getTargetAge() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_target_age;
+}
+
+void
+TreeNodeCache::setTargetAge(clock_type::duration s)
+{
+    std::lock_guard lock(m_mutex);
+    m_target_age = s;
+    JLOG(m_journal.debug())
+        << m_name << " target age set to " << m_target_age.count();
+}
+
+std::uint64_t
+TreeNodeCache::getTargetBytes() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_target_bytes;
+}
+
+void
+TreeNodeCache::setTargetBytes(std::uint64_t bytes)
+{
+    std::lock_guard lock(m_mutex);
+    m_target_bytes = bytes;
+    JLOG(m_journal.debug())
+        << m_name << " target bytes set to " << m_target_bytes;
+}
+
+int
+TreeNodeCache::getCacheSize() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_cache_count;
+}
+
+int
+TreeNodeCache::getTrackSize() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_cache.size();
+}
+
+std::uint64_t
+TreeNodeCache::getCacheBytes() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_cache_bytes;
+}
+
+float
+TreeNodeCache::getHitRate() const
+{
+    std::lock_guard lock(m_mutex);
+    auto const total = static_cast<float>(m_hits + m_misses);
+    return m_hits * (100.0f / std::max(1.0f, total));
+}
+
+float
+TreeNodeCache::getHitRate(Tier tier) const
+{
+    auto const i = static_cast<std::size_t>(tier);
+    std::lock_guard lock(m_mutex);
+    auto const total = static_cast<float>(m_tier_hits[i] + m_tier_misses[i]);
+    return m_tier_hits[i] * (100.0f / std::max(1.0f, total));
+}
+
+void
+TreeNodeCache::clear()
+{
+    std::lock_guard lock(m_mutex);
+    m_cache.clear();
+    m_lists = {};
+    m_cache_count = 0;
+    m_cache_bytes = 0;
+}
+
+void
+TreeNodeCache::reset()
+{
+    std::lock_guard lock(m_mutex);
+    m_cache.clear();
+    m_lists = {};
+    m_cache_count = 0;
+    m_cache_bytes = 0;
+    m_hits = 0;
+    m_misses = 0;
+    m_tier_hits.fill(0);
+    m_tier_misses.fill(0);
+}
+
+void
+TreeNodeCache::sweep()
+{
+    int cacheRemovals = 0;
+    int mapRemovals = 0;
+
+    // Keep references to all the stuff we sweep
+    // so that we can destroy them outside the lock.
+    std::vector<std::shared_ptr<SHAMapTreeNode>> stuffToSweep;
+
+    {
+        clock_type::time_point const now(m_clock.now());
+        clock_type::time_point when_expire;
+
+        std::lock_guard lock(m_mutex);
+
+        if (m_target_size == 0 ||
+            (static_cast<int>(m_cache.size()) <= m_target_size))
+        {
+            when_expire = now - m_target_age;
+        }
+        else
+        {
+            when_expire = now - m_target_age * m_target_size / m_cache.size();
+
+            clock_type::duration const minimumAge(std::chrono::seconds(1));
+            if (when_expire > (now - minimumAge))
+                when_expire = now - minimumAge;
+
+            JLOG(m_journal.trace())
+                << m_name << " is growing fast " << m_cache.size() << " of "
+                << m_target_size << " aging at "
+                << (now - when_expire).count() << " of "
+                << m_target_age.count();
+        }
+
+        stuffToSweep.reserve(m_cache.size());
+
+        auto cit = m_cache.begin();
+        while (cit != m_cache.end())
+        {
+            Entry& entry = cit->second;
+
+            if (entry.isWeak())
+            {
+                if (entry.isExpired())
+                {
+                    ++mapRemovals;
+                    cit = m_cache.erase(cit);
+                }
+                else
+                {
+                    ++cit;
+                }
+            }
+            else if (entry.last_access <= when_expire)
+            {
+                // strong, expired
+                ++cacheRemovals;
+                if (entry.ptr.unique())
+                    ++mapRemovals;
+                cit = evict(cit, stuffToSweep);
+            }
+            else
+            {
+                ++cit;
+            }
+        }
+
+        // Age the reference bits of the remaining strong entries, merging
+        // the cold and hot lists of each tier to keep them in access order.
+        auto const lists = std::exchange(m_lists, {});
+        for (std::size_t i = 0; i < tierCount; ++i)
+        {
+            Entry* cold = lists[i].head;
+            Entry* hot = lists[tierCount + i].head;
+
+            while (cold || hot)
+            {
+                Entry* entry;
+                if (!hot || (cold && cold->last_access <= hot->last_access))
+                    entry = std::exchange(cold, cold->next);
+                else
+                    entry = std::exchange(hot, hot->next);
+
+                entry->hot = entry->referenced;
+                entry->referenced = false;
+                link(*entry);
+            }
+        }
+
+        if (m_target_bytes != 0 && m_cache_bytes > m_target_bytes)
+        {
+            auto const before = stuffToSweep.size();
+            trim(lock, m_target_bytes, stuffToSweep);
+            mapRemovals += stuffToSweep.size() - before;
+        }
+    }
+
+    if (mapRemovals || cacheRemovals)
+    {
+        JLOG(m_journal.trace())
+            << m_name << ": cache = " << m_cache.size() << "-"
+            << cacheRemovals << ", map-=" << mapRemovals;
+    }
+
+    // At this point stuffToSweep will go out of scope outside the lock
+    // and decrement the reference count on each strong pointer.
+}
+
+bool
+TreeNodeCache::canonicalize(
+    key_type const& key,
+    std::shared_ptr<SHAMapTreeNode>& data,
+    bool fetched)
+{
+    // Nodes evicted to honor the memory budget, destroyed outside the lock
+    std::vector<std::shared_ptr<SHAMapTreeNode>> stuffToSweep;
+
+    std::lock_guard lock(m_mutex);
+
+    auto cit = m_cache.find(key);
+
+    if (cit == m_cache.end())
+    {
+        cit = m_cache
+                  .emplace(
+                      std::piecewise_construct,
+                      std::forward_as_tuple(key),
+                      std::forward_as_tuple(m_clock.now(), data))
+                  .first;
+        cit->second.key = &cit->first;
+        link(cit->second);
+        ++m_cache_count;
+        m_cache_bytes += cit->second.bytes;
+        if (fetched)
+            ++m_tier_misses[static_cast<std::size_t>(cit->second.tier)];
+
+        if (m_target_bytes != 0 && m_cache_bytes > m_target_bytes)
+            trim(lock, m_target_bytes, stuffToSweep);
+
+        return false;
+    }
+
+    Entry& entry = cit->second;
+    entry.last_access = m_clock.now();
+
+    if (entry.isCached())
+    {
+        unlink(entry);
+        link(entry);
+        data = entry.ptr;
+        return true;
+    }
+
+    if (strengthen(entry))
+    {
+        data = entry.ptr;
+        return true;
+    }
+
+    entry.ptr = data;
+    entry.weak_ptr = data;
+    link(entry);
+    ++m_cache_count;
+    m_cache_bytes += entry.bytes;
+    if (fetched)
+        ++m_tier_misses[static_cast<std::size_t>(entry.tier)];
+    return false;
+}
+
+std::shared_ptr<SHAMapTreeNode>
+TreeNodeCache::fetch(key_type const& key)
+{
+    std::lock_guard lock(m_mutex);
+
+    auto cit = m_cache.find(key);
+
+    if (cit == m_cache.end())
+    {
+        ++m_misses;
+        return {};
+    }
+
+    Entry& entry = cit->second;
+    entry.last_access = m_clock.now();
+
+    if (entry.isCached())
+    {
+        ++m_hits;
+        ++m_tier_hits[static_cast<std::size_t>(entry.tier)];
+        entry.referenced = true;
+        unlink(entry);
+        link(entry);
+        return entry.ptr;
+    }
+
+    // independent of cache size, so not counted as a hit
+    if (strengthen(entry))
+        return entry.ptr;
+
+    m_cache.erase(cit);
+    ++m_misses;
+    return {};
+}
+
+std::vector<TreeNodeCache::key_type>
+TreeNodeCache::getKeys() const
+{
+    std::vector<key_type> v;
+
+    {
+        std::lock_guard lock(m_mutex);
+        v.reserve(m_cache.size());
+        for (auto const& _ : m_cache)
+            v.push_back(_.first);
+    }
+
+    return v;
+}
+
+TreeNodeCache::Tier
+TreeNodeCache::tierOf(SHAMapTreeNode const& node)
+{
+    if (node.isLeaf())
+        return Tier::leaf;
+
+    if (static_cast<SHAMapInnerNode const&>(node).getBranchCount() ==
+        SHAMapInnerNode::branchFactor)
+        return Tier::upper;
+
+    return Tier::inner;
+}
+
+char const*
+TreeNodeCache::tierName(Tier tier)
+{
+    switch (tier)
+    {
+        case Tier::leaf:
+            return "leaf";
+        case Tier::inner:
+            return "inner";
+        case Tier::upper:
+            return "upper";
+    }
+    return "unknown";
+}
+
+std::uint32_t
+TreeNodeCache::bytesOf(SHAMapTreeNode const& node)
+{
+    // Map node, key and control block overhead per tracked node
+    static constexpr std::size_t overhead =
+        sizeof(key_type) + sizeof(Entry) + 4 * sizeof(void*);
+
+    if (node.isLeaf())
+    {
+        auto const& item = static_cast<SHAMapLeafNode const&>(node).peekItem();
+        return overhead + sizeof(SHAMapLeafNode) + sizeof(SHAMapItem) +
+            (item ? item->size() : 0);
+    }
+
+    auto const branches =
+        static_cast<SHAMapInnerNode const&>(node).getBranchCount();
+    return overhead + sizeof(SHAMapInnerNode) +
+        branches *
+        (sizeof(SHAMapHash) + sizeof(std::shared_ptr<SHAMapTreeNode>));
+}
+
+bool
+TreeNodeCache::strengthen(Entry& entry)
+{
+    entry.ptr = entry.weak_ptr.lock();
+    if (!entry.isCached())
+        return false;
+
+    link(entry);
+    ++m_cache_count;
+    m_cache_bytes += entry.bytes;
+    return true;
+}
+
+void
+TreeNodeCache::link(Entry& entry)
+{
+    List& list = m_lists[classOf(entry)];
+
+    entry.prev = list.tail;
+    entry.next = nullptr;
+    if (list.tail)
+        list.tail->next = &entry;
+    else
+        list.head = &entry;
+    list.tail = &entry;
+}
+
+void
+TreeNodeCache::unlink(Entry& entry)
+{
+    List& list = m_lists[classOf(entry)];
+
+    if (entry.prev)
+        entry.prev->next = entry.next;
+    else
+        list.head = entry.next;
+    if (entry.next)
+        entry.next->prev = entry.prev;
+    else
+        list.tail = entry.prev;
+    entry.prev = nullptr;
+    entry.next = nullptr;
+}
+
+TreeNodeCache::cache_type::iterator
+TreeNodeCache::evict(
+    cache_type::iterator cit,
+    std::vector<std::shared_ptr<SHAMapTreeNode>>& stuffToSweep)
+{
+    Entry& entry = cit->second;
+
+    unlink(entry);
+    --m_cache_count;
+    m_cache_bytes -= entry.bytes;
+    entry.hot = false;
+    entry.referenced = false;
+
+    if (entry.ptr.unique())
+    {
+        stuffToSweep.push_back(std::move(entry.ptr));
+        return m_cache.erase(cit);
+    }
+
+    // remains weakly cached
+    entry.ptr.reset();
+    return std::next(cit);
+}
+
+void
+TreeNodeCache::trim(
+    std::lock_guard<std::recursive_mutex> const&,
+    std::uint64_t target,
+    std::vector<std::shared_ptr<SHAMapTreeNode>>& stuffToSweep)
+{
+    if (m_cache_bytes <= target)
+        return;
+
+    auto const before = m_cache_bytes;
+
+    for (auto& list : m_lists)
+    {
+        while (list.head && m_cache_bytes > target)
+            evict(m_cache.find(*list.head->key), stuffToSweep);
+    }
+
+    JLOG(m_journal.debug()) << m_name << " trimmed from " << before << " to "
+                            << m_cache_bytes << " bytes";
+}
+
+void
+TreeNodeCache::collect_metrics()
+{
+    std::lock_guard lock(m_mutex);
+
+    m_stats.size.set(m_cache_count);
+    m_stats.bytes.set(m_cache_bytes);
+
+    auto const rate = [](std::uint64_t hits, std::uint64_t misses) {
+        auto const total = hits + misses;
+        return total == 0 ? 0 : (hits * 100) / total;
+    };
+
+    m_stats.hit_rate.set(rate(m_hits, m_misses));
+    for (std::size_t i = 0; i < tierCount; ++i)
+        m_stats.tier_hit_rate[i].set(rate(m_tier_hits[i], m_tier_misses[i]));
+}
+
+}  // namespace ripple
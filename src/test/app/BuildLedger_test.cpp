@@ -0,0 +1,257 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/BuildLedger.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/LedgerReplay.h>
+#include <ripple/basics/random.h>
+#include <test/jtx.h>
+#include <test/jtx/envconfig.h>
+
+namespace ripple {
+namespace test {
+
+/** Ledgers built with [parallel_ledger_build] enabled must be identical to
+    ledgers built serially.
+*/
+class BuildLedger_test : public beast::unit_test::suite
+{
+    static std::unique_ptr<Config>
+    makeConfig(bool parallel)
+    {
+        auto cfg = jtx::envconfig();
+        cfg->PARALLEL_LEDGER_BUILD = parallel;
+        return cfg;
+    }
+
+    // Submit the same pseudo-random mix of payments and offers to each
+    // environment. Some of them are expected to fail.
+    void
+    randomRound(
+        std::vector<std::reference_wrapper<jtx::Env>> const& envs,
+        std::vector<jtx::Account> const& accounts,
+        jtx::Account const& gw,
+        beast::xor_shift_engine& engine,
+        std::size_t txCount)
+    {
+        using namespace jtx;
+        auto const USD = gw["USD"];
+
+        for (std::size_t i = 0; i < txCount; ++i)
+        {
+            auto const& from = accounts[rand_int(engine, accounts.size() - 1)];
+            auto const& to = accounts[rand_int(engine, accounts.size() - 1)];
+            auto const amount = rand_int(engine, 1, 1000);
+            auto const kind = rand_int(engine, 2);
+
+            for (jtx::Env& env : envs)
+            {
+                switch (kind)
+                {
+                    case 0:
+                        env(pay(from, to, XRP(amount)), ter(std::ignore));
+                        break;
+                    case 1:
+                        env(pay(from, to, USD(amount)), ter(std::ignore));
+                        break;
+                    default:
+                        env(offer(from, XRP(amount), USD(amount)),
+                            ter(std::ignore));
+                        break;
+                }
+            }
+        }
+    }
+
+    void
+    testMatchesSerial()
+    {
+        testcase("Parallel build matches serial build");
+
+        using namespace jtx;
+        using namespace std::chrono_literals;
+
+        Env serial(*this, makeConfig(false));
+        Env parallel(*this, makeConfig(true));
+        std::vector<std::reference_wrapper<Env>> const envs{serial, parallel};
+
+        Account const gw("gateway");
+        std::vector<Account> accounts;
+        for (int i = 0; i < 20; ++i)
+            accounts.emplace_back("acct" + std::to_string(i));
+
+        for (Env& env : envs)
+        {
+            env.fund(XRP(1000000), gw);
+            for (auto const& acct : accounts)
+                env.fund(XRP(1000000), acct);
+            env.close();
+            for (auto const& acct : accounts)
+                env(trust(acct, gw["USD"](1000000)));
+            env.close();
+            for (auto const& acct : accounts)
+                env(pay(gw, acct, gw["USD"](10000)));
+            env.close();
+        }
+        BEAST_EXPECT(
+            serial.closed()->info().hash == parallel.closed()->info().hash);
+
+        beast::xor_shift_engine engine(1234);
+        for (int round = 0; round < 10; ++round)
+        {
+            randomRound(envs, accounts, gw, engine, 200);
+
+            auto const closeTime = serial.now() + 10s;
+            for (Env& env : envs)
+                env.close(closeTime);
+
+            BEAST_EXPECT(
+                serial.closed()->info().hash ==
+                parallel.closed()->info().hash);
+        }
+    }
+
+    void
+    testReplay()
+    {
+        testcase("Parallel replay matches the original ledger");
+
+        using namespace jtx;
+
+        Env env(*this, makeConfig(true));
+        Account const gw("gateway");
+        std::vector<Account> accounts;
+        for (int i = 0; i < 20; ++i)
+            accounts.emplace_back("acct" + std::to_string(i));
+
+        env.fund(XRP(1000000), gw);
+        for (auto const& acct : accounts)
+            env.fund(XRP(1000000), acct);
+        env.close();
+        for (auto const& acct : accounts)
+            env(trust(acct, gw["USD"](1000000)));
+        env.close();
+
+        beast::xor_shift_engine engine(5678);
+        randomRound({env}, accounts, gw, engine, 300);
+        env.close();
+
+        LedgerMaster& ledgerMaster = env.app().getLedgerMaster();
+        auto const lastClosed = ledgerMaster.getClosedLedger();
+        auto const lastClosedParent =
+            ledgerMaster.getLedgerByHash(lastClosed->info().parentHash);
+
+        auto const replayed = buildLedger(
+            LedgerReplay(lastClosedParent, lastClosed),
+            tapNONE,
+            env.app(),
+            env.journal);
+
+        BEAST_EXPECT(replayed->info().hash == lastClosed->info().hash);
+    }
+
+    void
+    testSpeculation()
+    {
+        testcase("Speculative results are kept unless they conflict");
+
+        using namespace jtx;
+
+        // Enough transactions to dispatch some of them to the job queue,
+        // which has one thread in standalone mode.
+        std::size_t constexpr pairs = 32;
+        std::vector<Account> accounts;
+        for (std::size_t i = 0; i < 2 * pairs; ++i)
+            accounts.emplace_back("acct" + std::to_string(i));
+
+        Env env(*this, makeConfig(true));
+        for (auto const& acct : accounts)
+            env.fund(XRP(1000000), acct);
+        env.close();
+
+        // Return the transactions kept and applied again by one close
+        auto close = [&]() {
+            auto const before = getSpeculativeApplyCounts();
+            env.close();
+            auto const after = getSpeculativeApplyCounts();
+            return std::make_pair(
+                after.kept - before.kept, after.reapplied - before.reapplied);
+        };
+
+        // Payments between disjoint pairs of accounts
+        for (std::size_t i = 0; i < pairs; ++i)
+            env(pay(accounts[i], accounts[pairs + i], XRP(10)));
+        {
+            auto const [kept, reapplied] = close();
+            BEAST_EXPECT(kept == pairs);
+            BEAST_EXPECT(reapplied == 0);
+        }
+
+        // Payments that all change the same account; only the first one
+        // can be kept
+        for (std::size_t i = 1; i <= pairs; ++i)
+            env(pay(accounts[i], accounts[0], XRP(10)));
+        {
+            auto const [kept, reapplied] = close();
+            BEAST_EXPECT(kept == 1);
+            BEAST_EXPECT(reapplied == pairs - 1);
+        }
+
+        // New accounts which pay from the ledger that creates them. In
+        // canonical order some payments come before the account exists and
+        // are retried, and the transactions after them are numbered one
+        // lower than was assumed. Only a payment which comes after the
+        // account was created needs to be applied again.
+        std::vector<Account> created;
+        for (std::size_t i = 0; i < pairs; ++i)
+        {
+            created.emplace_back("new" + std::to_string(i));
+            env(pay(accounts[i], created.back(), XRP(10000)));
+            env(pay(created.back(), accounts[pairs + i], XRP(10)));
+        }
+        {
+            auto const [kept, reapplied] = close();
+            BEAST_EXPECT(kept + reapplied == 2 * pairs);
+            BEAST_EXPECT(reapplied < pairs);
+
+            // The retried payments were applied by a later pass
+            std::size_t applied = 0;
+            for (auto const& tx : env.closed()->txs)
+            {
+                (void)tx;
+                ++applied;
+            }
+            BEAST_EXPECT(applied == 2 * pairs);
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testMatchesSerial();
+        testReplay();
+        testSpeculation();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BuildLedger, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
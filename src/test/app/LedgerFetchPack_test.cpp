@@ -0,0 +1,400 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/Compression.h>
+#include <ripple/overlay/Message.h>
+#include <ripple/overlay/Peer.h>
+#include <test/jtx.h>
+
+#include <cmath>
+#include <limits>
+#include <set>
+
+namespace ripple {
+namespace test {
+
+class LedgerFetchPack_test : public beast::unit_test::suite
+{
+    // A peer keeping the messages sent to it
+    class TestPeer : public Peer
+    {
+    public:
+        std::vector<std::shared_ptr<Message>> sent;
+
+        void
+        send(std::shared_ptr<Message> const& m) override
+        {
+            sent.push_back(m);
+        }
+        beast::IP::Endpoint
+        getRemoteAddress() const override
+        {
+            return {};
+        }
+        void
+        charge(Resource::Charge const& fee) override
+        {
+        }
+        id_t
+        id() const override
+        {
+            return 1234;
+        }
+        bool
+        cluster() const override
+        {
+            return false;
+        }
+        bool
+        isHighLatency() const override
+        {
+            return false;
+        }
+        int
+        getScore(bool) const override
+        {
+            return 0;
+        }
+        PublicKey const&
+        getNodePublic() const override
+        {
+            static PublicKey key{};
+            return key;
+        }
+        Json::Value
+        json() override
+        {
+            return {};
+        }
+        bool
+        supportsFeature(ProtocolFeature f) const override
+        {
+            return false;
+        }
+        std::optional<std::size_t>
+        publisherListSequence(PublicKey const&) const override
+        {
+            return {};
+        }
+        void
+        setPublisherListSequence(PublicKey const&, std::size_t const) override
+        {
+        }
+        uint256 const&
+        getClosedLedgerHash() const override
+        {
+            static uint256 hash{};
+            return hash;
+        }
+        bool
+        hasLedger(uint256 const& hash, std::uint32_t seq) const override
+        {
+            return false;
+        }
+        void
+        ledgerRange(std::uint32_t& minSeq, std::uint32_t& maxSeq) const override
+        {
+        }
+        bool
+        hasShard(std::uint32_t shardIndex) const override
+        {
+            return false;
+        }
+        bool
+        hasTxSet(uint256 const& hash) const override
+        {
+            return false;
+        }
+        void
+        cycleStatus() override
+        {
+        }
+        bool
+        hasRange(std::uint32_t uMin, std::uint32_t uMax) override
+        {
+            return false;
+        }
+        bool
+        compressionEnabled() const override
+        {
+            return false;
+        }
+    };
+
+    // Limits that never end a pack before it runs out of ledgers
+    static LedgerMaster::FetchPackLimits
+    unlimited()
+    {
+        using namespace std::chrono_literals;
+        LedgerMaster::FetchPackLimits limits;
+        limits.objects = std::numeric_limits<int>::max();
+        limits.bytes = std::numeric_limits<std::size_t>::max();
+        limits.buildTime = 1h;
+        return limits;
+    }
+
+    // Close ledgers with a few payments in each and return their hashes,
+    // oldest first
+    static std::vector<uint256>
+    closeLedgers(jtx::Env& env, int count)
+    {
+        using namespace jtx;
+        std::vector<Account> accounts;
+        for (int i = 0; i < 8; ++i)
+            accounts.emplace_back("acct" + std::to_string(i));
+        for (auto const& account : accounts)
+            env.fund(XRP(10000), account);
+        env.close();
+
+        std::vector<uint256> hashes;
+        for (int i = 0; i < count; ++i)
+        {
+            for (std::size_t j = 0; j < accounts.size(); ++j)
+                env(pay(accounts[j],
+                        accounts[(j + i + 1) % accounts.size()],
+                        XRP(1)));
+            env.close();
+            hashes.push_back(env.closed()->info().hash);
+        }
+        return hashes;
+    }
+
+    // Ask for a fetch pack from the ledger with the given hash
+    static void
+    request(
+        jtx::Env& env,
+        std::shared_ptr<TestPeer> const& peer,
+        uint256 const& have,
+        std::optional<std::uint32_t> seq = {})
+    {
+        auto packet = std::make_shared<protocol::TMGetObjectByHash>();
+        packet->set_type(protocol::TMGetObjectByHash::otFETCH_PACK);
+        packet->set_query(true);
+        packet->set_ledgerhash(have.data(), have.size());
+        if (seq)
+            packet->set_seq(*seq);
+        env.app().getLedgerMaster().makeFetchPack(
+            peer, packet, have, UptimeClock::now());
+    }
+
+    // The fetch pack carried by a message
+    static protocol::TMGetObjectByHash
+    parse(std::shared_ptr<Message> const& m)
+    {
+        auto const& buffer = m->getBuffer(compression::Compressed::Off);
+        protocol::TMGetObjectByHash reply;
+        reply.ParseFromArray(
+            buffer.data() + compression::headerBytes,
+            buffer.size() - compression::headerBytes);
+        return reply;
+    }
+
+    // The number of ledgers a fetch pack has objects for
+    static std::size_t
+    ledgers(protocol::TMGetObjectByHash const& reply)
+    {
+        std::set<std::uint32_t> seqs;
+        for (auto const& obj : reply.objects())
+            seqs.insert(obj.ledgerseq());
+        return seqs.size();
+    }
+
+    void
+    testDeltaReuse()
+    {
+        testcase("ledger objects are reused");
+
+        jtx::Env env(*this);
+        auto const hashes = closeLedgers(env, 6);
+        auto& lm = env.app().getLedgerMaster();
+        lm.setFetchPackLimits(unlimited());
+
+        auto const peer = std::make_shared<TestPeer>();
+        request(env, peer, hashes.back());
+        if (!BEAST_EXPECT(peer->sent.size() == 1))
+            return;
+        auto const first = parse(peer->sent[0]);
+        BEAST_EXPECT(ledgers(first) >= hashes.size());
+        BEAST_EXPECT(lm.getFetchPackDeltaCacheSize().first == ledgers(first));
+        BEAST_EXPECT(lm.getFetchPackDeltaHitRate() == 0);
+
+        // The pack ended because we have no older ledger, so it isn't
+        // kept. It is built again from the cached ledger objects.
+        request(env, peer, hashes.back());
+        if (!BEAST_EXPECT(peer->sent.size() == 2))
+            return;
+        BEAST_EXPECT(peer->sent[0] != peer->sent[1]);
+        auto const second = parse(peer->sent[1]);
+        BEAST_EXPECT(
+            second.SerializeAsString() == first.SerializeAsString());
+        BEAST_EXPECT(std::abs(lm.getFetchPackDeltaHitRate() - 50) < 0.01);
+
+        // A pack for an overlapping range reuses the objects too
+        request(env, peer, hashes[hashes.size() - 2]);
+        if (!BEAST_EXPECT(peer->sent.size() == 3))
+            return;
+        BEAST_EXPECT(ledgers(parse(peer->sent[2])) == ledgers(first) - 1);
+        BEAST_EXPECT(lm.getFetchPackDeltaCacheSize().first == ledgers(first));
+    }
+
+    void
+    testReplyShared()
+    {
+        testcase("budgeted replies are shared");
+
+        jtx::Env env(*this);
+        auto const hashes = closeLedgers(env, 6);
+        auto& lm = env.app().getLedgerMaster();
+
+        auto const check = [&](uint256 const& have) {
+            std::vector<std::shared_ptr<TestPeer>> peers;
+            for (int i = 0; i < 3; ++i)
+            {
+                peers.push_back(std::make_shared<TestPeer>());
+                request(env, peers.back(), have);
+                if (!BEAST_EXPECT(peers.back()->sent.size() == 1))
+                    return;
+            }
+
+            // One message, compressed once, is sent to every peer
+            for (auto const& peer : peers)
+                BEAST_EXPECT(peer->sent[0] == peers[0]->sent[0]);
+            BEAST_EXPECT(ledgers(parse(peers[0]->sent[0])) == 1);
+
+            // A reply echoing the request's sequence is built anew
+            auto const peer = std::make_shared<TestPeer>();
+            request(env, peer, have, 42);
+            if (!BEAST_EXPECT(peer->sent.size() == 1))
+                return;
+            BEAST_EXPECT(peer->sent[0] != peers[0]->sent[0]);
+            auto const reply = parse(peer->sent[0]);
+            BEAST_EXPECT(reply.has_seq() && reply.seq() == 42);
+            BEAST_EXPECT(ledgers(reply) == 1);
+        };
+
+        // The object budget ends the pack
+        {
+            auto limits = unlimited();
+            limits.objects = 1;
+            lm.setFetchPackLimits(limits);
+            check(hashes[hashes.size() - 1]);
+        }
+
+        // The byte budget ends the pack
+        {
+            auto limits = unlimited();
+            limits.bytes = 1;
+            lm.setFetchPackLimits(limits);
+            check(hashes[hashes.size() - 2]);
+        }
+    }
+
+    void
+    testTimeBudget()
+    {
+        using namespace std::chrono_literals;
+        testcase("time budget");
+
+        jtx::Env env(*this);
+        auto const hashes = closeLedgers(env, 6);
+        auto& lm = env.app().getLedgerMaster();
+
+        auto limits = unlimited();
+        limits.buildTime = 0ms;
+        lm.setFetchPackLimits(limits);
+
+        // A pack cut short by the time budget isn't kept
+        auto const peer = std::make_shared<TestPeer>();
+        request(env, peer, hashes.back());
+        request(env, peer, hashes.back());
+        if (!BEAST_EXPECT(peer->sent.size() == 2))
+            return;
+        BEAST_EXPECT(peer->sent[0] != peer->sent[1]);
+        BEAST_EXPECT(ledgers(parse(peer->sent[0])) == 1);
+        BEAST_EXPECT(ledgers(parse(peer->sent[1])) == 1);
+    }
+
+    void
+    testCacheBudget()
+    {
+        testcase("ledger object cache budget");
+
+        jtx::Env env(*this);
+        auto const hashes = closeLedgers(env, 6);
+        auto& lm = env.app().getLedgerMaster();
+
+        // Nothing is kept without a budget, but packs are still built
+        auto limits = unlimited();
+        limits.cacheBytes = 0;
+        lm.setFetchPackLimits(limits);
+
+        auto const peer = std::make_shared<TestPeer>();
+        request(env, peer, hashes.back());
+        if (!BEAST_EXPECT(peer->sent.size() == 1))
+            return;
+        auto const count = ledgers(parse(peer->sent[0]));
+        BEAST_EXPECT(count >= hashes.size());
+        BEAST_EXPECT(lm.getFetchPackDeltaCacheSize().first == 0);
+        BEAST_EXPECT(lm.getFetchPackDeltaCacheSize().second == 0);
+
+        // Without a limit every ledger is kept
+        lm.setFetchPackLimits(unlimited());
+        request(env, peer, hashes.back());
+        auto const [entries, bytes] = lm.getFetchPackDeltaCacheSize();
+        BEAST_EXPECT(entries == count);
+        BEAST_EXPECT(bytes > 0);
+
+        // The oldest ledgers are evicted to keep within a smaller budget
+        limits.cacheBytes = bytes / 2;
+        lm.setFetchPackLimits(limits);
+        {
+            auto const [smaller, used] = lm.getFetchPackDeltaCacheSize();
+            BEAST_EXPECT(smaller > 0 && smaller < count);
+            BEAST_EXPECT(used <= limits.cacheBytes);
+        }
+
+        // Building the evicted ledgers again stays within the budget
+        request(env, peer, hashes.back());
+        if (!BEAST_EXPECT(peer->sent.size() == 3))
+            return;
+        BEAST_EXPECT(ledgers(parse(peer->sent[2])) == count);
+        {
+            auto const [smaller, used] = lm.getFetchPackDeltaCacheSize();
+            BEAST_EXPECT(smaller > 0 && smaller < count);
+            BEAST_EXPECT(used <= limits.cacheBytes);
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testDeltaReuse();
+        testReplyShared();
+        testTimeBudget();
+        testCacheBudget();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LedgerFetchPack, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
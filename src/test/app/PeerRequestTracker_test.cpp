@@ -0,0 +1,491 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/impl/PeerRequestTracker.h>
+#include <ripple/beast/unit_test.h>
+#include <test/csf/Histogram.h>
+#include <test/csf/Scheduler.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class PeerRequestTracker_test : public beast::unit_test::suite
+{
+    using time_point = PeerRequestTracker::time_point;
+
+    void
+    testSchedule()
+    {
+        testcase("Schedule");
+
+        using namespace std::chrono_literals;
+
+        PeerRequestTracker::Setup setup;
+        PeerRequestTracker tracker(setup);
+        time_point const start{};
+
+        // Peers we know nothing about are all probed with small requests
+        {
+            auto const batches = tracker.schedule({1, 2, 3}, 1000);
+            BEAST_EXPECT(batches.size() == 3 * setup.slowFactor);
+            for (auto const& [id, count] : batches)
+            {
+                (void)id;
+                BEAST_EXPECT(count == setup.minBatch);
+            }
+            BEAST_EXPECT(tracker.schedule({1, 2, 3}, 5).size() == 1);
+            BEAST_EXPECT(tracker.schedule({}, 1000).empty());
+        }
+
+        // Peer 1 answers in 20ms, peer 2 in 50ms and peer 3 in 500ms
+        for (auto [id, delay] : {std::pair{1u, 20ms}, {2u, 50ms}, {3u, 500ms}})
+        {
+            tracker.onRequest(id, setup.minBatch, start);
+            BEAST_EXPECT(tracker.inFlight(id) == 1);
+            BEAST_EXPECT(tracker.onReply(id, start + delay));
+            BEAST_EXPECT(tracker.inFlight(id) == 0);
+            BEAST_EXPECT(tracker.latency(id) == delay);
+        }
+        BEAST_EXPECT(!tracker.onReply(1, start));
+        BEAST_EXPECT(!tracker.onReply(4, start));
+        BEAST_EXPECT(tracker.inFlightNodes() == 0);
+        BEAST_EXPECT(tracker.throughput(1) > tracker.throughput(2));
+        BEAST_EXPECT(tracker.throughput(4) == 0);
+
+        auto const batches = tracker.schedule({1, 2, 3}, 10000);
+        std::map<Peer::id_t, std::size_t> requests;
+        std::map<Peer::id_t, std::size_t> nodes;
+        for (auto const& [id, count] : batches)
+        {
+            ++requests[id];
+            nodes[id] += count;
+        }
+
+        // The fastest peers get several requests, the fastest of them the
+        // first and largest ones, and the slowest none at all
+        BEAST_EXPECT(batches.front().first == 1);
+        BEAST_EXPECT(requests[1] > 1);
+        BEAST_EXPECT(requests[2] > 1);
+        BEAST_EXPECT(nodes[1] > nodes[2]);
+        BEAST_EXPECT(requests.count(3) == 0);
+
+        for (auto const& [id, count] : batches)
+            tracker.onRequest(id, count, start);
+        BEAST_EXPECT(tracker.inFlight(1) == requests[1]);
+        BEAST_EXPECT(tracker.inFlightNodes() <= setup.maxInFlightNodes);
+
+        // The first of these requests was sent while nothing else was in
+        // flight to the peer, so its reply updates the latency. The reply
+        // to a pipelined one only updates the throughput.
+        BEAST_EXPECT(tracker.onReply(1, start + 40ms));
+        BEAST_EXPECT(tracker.latency(1) == 25ms);
+        auto const rate = tracker.throughput(1);
+        BEAST_EXPECT(tracker.onReply(1, start + 45ms));
+        BEAST_EXPECT(tracker.latency(1) == 25ms);
+        BEAST_EXPECT(tracker.throughput(1) > rate);
+
+        // Requests left unanswered are given up on, and the peers that
+        // did not answer in time are asked less
+        auto const inFlight = tracker.inFlight(1) + tracker.inFlight(2);
+        BEAST_EXPECT(tracker.expire(start + 1s, 2500ms) == 0);
+        BEAST_EXPECT(tracker.expire(start + 3s, 2500ms) == inFlight);
+        BEAST_EXPECT(tracker.inFlightNodes() == 0);
+        BEAST_EXPECT(tracker.latency(1) == 2500ms);
+        BEAST_EXPECT(tracker.latency(3) == 500ms);
+        BEAST_EXPECT(tracker.schedule({1, 3}, 1000).front().first == 3);
+    }
+
+    void
+    testBroadcast()
+    {
+        testcase("Broadcast");
+
+        using namespace std::chrono_literals;
+
+        PeerRequestTracker::Setup setup;
+        PeerRequestTracker tracker(setup);
+        time_point const start{};
+
+        // Broadcasts take none of the capacity of a peer
+        for (int i = 0; i < 3; ++i)
+            tracker.onBroadcast(1, start);
+        BEAST_EXPECT(tracker.inFlight(1) == 0);
+        BEAST_EXPECT(tracker.inFlightNodes() == 0);
+        BEAST_EXPECT(!tracker.schedule({1}, 1000).empty());
+
+        // Their replies come before the reply to a later request, and do
+        // not update the estimates
+        tracker.onRequest(1, setup.minBatch, start);
+        BEAST_EXPECT(tracker.inFlight(1) == 1);
+        for (int i = 0; i < 3; ++i)
+            BEAST_EXPECT(tracker.onReply(1, start + 10ms));
+        BEAST_EXPECT(tracker.inFlight(1) == 1);
+        BEAST_EXPECT(tracker.throughput(1) == 0);
+        BEAST_EXPECT(tracker.onReply(1, start + 20ms));
+        BEAST_EXPECT(tracker.inFlight(1) == 0);
+        BEAST_EXPECT(tracker.latency(1) == 20ms);
+
+        // Unanswered broadcasts are given up on without penalty
+        tracker.onBroadcast(2, start);
+        BEAST_EXPECT(tracker.expire(start + 3s, 2500ms) == 0);
+        BEAST_EXPECT(tracker.latency(2) == setup.initialLatency);
+        BEAST_EXPECT(!tracker.onReply(2, start + 3s));
+    }
+
+    // Simulated ledger acquisition ------------------------------------------
+
+    struct SimPeer
+    {
+        // One way link latency
+        std::chrono::milliseconds delay;
+        // Nodes served per second
+        double rate;
+        // Drop every request
+        bool silent = false;
+        csf::Scheduler::time_point busyUntil{};
+    };
+
+    // Acquire a map shaped like a SHAMap: every inner node has 16
+    // children, numbered in breadth first order.
+    struct Sim
+    {
+        static constexpr std::size_t branches = 16;
+
+        // The constants InboundLedger uses
+        static constexpr std::size_t missingNodesFind = 2048;
+        static constexpr std::size_t legacyMissingNodesFind = 256;
+        static constexpr std::size_t reqNodesReply = 128;
+        static constexpr std::size_t reqNodes = 8;
+
+        bool const adaptive;
+        std::size_t const size;
+        csf::Scheduler scheduler;
+        std::vector<SimPeer> peers;
+        PeerRequestTracker tracker;
+
+        std::vector<bool> have;
+        std::set<std::size_t> missing;
+        std::set<std::size_t> recent;
+        bool progress = false;
+        bool done = false;
+        std::size_t requests = 0;
+        std::size_t received = 0;
+
+        Sim(bool adaptive_,
+            std::size_t size_,
+            std::vector<SimPeer> peers_,
+            PeerRequestTracker::Setup const& setup)
+            : adaptive(adaptive_)
+            , size(size_)
+            , peers(std::move(peers_))
+            , tracker(setup)
+            , have(size_, false)
+        {
+            // We have the root from the ledger header
+            take(0);
+        }
+
+        void
+        take(std::size_t node)
+        {
+            if (have[node])
+                return;
+            have[node] = true;
+            missing.erase(node);
+            for (std::size_t i = 1; i <= branches; ++i)
+            {
+                auto const child = node * branches + i;
+                if (child < size && !have[child])
+                    missing.insert(child);
+            }
+        }
+
+        std::vector<std::size_t>
+        children(std::size_t node) const
+        {
+            std::vector<std::size_t> result;
+            for (std::size_t i = 1; i <= branches; ++i)
+                if (auto const child = node * branches + i; child < size)
+                    result.push_back(child);
+            return result;
+        }
+
+        void
+        send(
+            std::size_t peer,
+            std::vector<std::size_t> nodes,
+            int depth,
+            bool broadcast = false)
+        {
+            ++requests;
+            if (adaptive && broadcast)
+                tracker.onBroadcast(peer, scheduler.now());
+            else if (adaptive)
+                tracker.onRequest(peer, nodes.size(), scheduler.now());
+            for (auto n : nodes)
+                recent.insert(n);
+
+            auto& p = peers[peer];
+            if (p.silent)
+                return;
+
+            // The peer answers its requests one at a time
+            scheduler.in(p.delay, [this, peer, nodes, depth] {
+                auto& p = peers[peer];
+                auto reply = nodes;
+                if (depth > 0)
+                {
+                    for (auto n : nodes)
+                    {
+                        auto const c = children(n);
+                        reply.insert(reply.end(), c.begin(), c.end());
+                    }
+                }
+
+                auto const start = std::max(scheduler.now(), p.busyUntil);
+                p.busyUntil = start +
+                    std::chrono::microseconds(static_cast<std::int64_t>(
+                        1e6 * reply.size() / p.rate));
+                scheduler.at(p.busyUntil + p.delay, [this, peer, reply] {
+                    onReply(peer, reply);
+                });
+            });
+        }
+
+        // InboundLedger::trigger for the state map
+        void
+        trigger(std::optional<std::size_t> peer, bool reply, bool timeout)
+        {
+            if (done)
+                return;
+
+            std::vector<std::size_t> nodes;
+            auto const find =
+                adaptive ? missingNodesFind : legacyMissingNodesFind;
+            for (auto n : missing)
+            {
+                if (nodes.size() == find)
+                    break;
+                nodes.push_back(n);
+            }
+
+            // filterNodes
+            auto dup = std::stable_partition(
+                nodes.begin(), nodes.end(), [this](auto n) {
+                    return recent.count(n) == 0;
+                });
+            if (dup == nodes.begin())
+            {
+                if (!timeout)
+                    return;
+            }
+            else
+                nodes.erase(dup, nodes.end());
+
+            if (!reply || !adaptive)
+            {
+                auto const limit = reply ? reqNodesReply : reqNodes;
+                if (nodes.size() > limit)
+                    nodes.resize(limit);
+                for (std::size_t i = 0; i < peers.size(); ++i)
+                    if (!peer || *peer == i)
+                        send(i, nodes, reply ? 1 : 0, !peer);
+                return;
+            }
+
+            // InboundLedger::requestNodes
+            std::vector<Peer::id_t> ids;
+            for (std::size_t i = 0; i < peers.size(); ++i)
+                ids.push_back(i);
+            auto next = nodes.begin();
+            for (auto const& [id, count] : tracker.schedule(ids, nodes.size()))
+            {
+                send(id, {next, next + count}, 1);
+                next += count;
+            }
+            if (next == nodes.begin() && peer && tracker.inFlight(*peer) == 0)
+            {
+                auto const count = std::min(nodes.size(), reqNodesReply);
+                send(*peer, {nodes.begin(), nodes.begin() + count}, 1);
+            }
+        }
+
+        void
+        onReply(std::size_t peer, std::vector<std::size_t> const& nodes)
+        {
+            if (adaptive)
+                tracker.onReply(peer, scheduler.now());
+            if (done)
+                return;
+
+            received += nodes.size();
+            for (auto n : nodes)
+            {
+                if (!have[n])
+                    progress = true;
+                take(n);
+            }
+
+            if (missing.empty())
+            {
+                done = true;
+                return;
+            }
+
+            trigger(peer, true, false);
+        }
+
+        void
+        onTimer()
+        {
+            if (done)
+                return;
+
+            using namespace std::chrono_literals;
+
+            recent.clear();
+            if (adaptive)
+                tracker.expire(scheduler.now(), 2500ms);
+            if (!progress)
+                trigger(std::nullopt, false, true);
+            progress = false;
+            scheduler.in(2500ms, [this] { onTimer(); });
+        }
+
+        std::chrono::milliseconds
+        run()
+        {
+            using namespace std::chrono_literals;
+
+            auto const start = scheduler.now();
+            for (std::size_t i = 0; i < peers.size(); ++i)
+                trigger(i, false, false);
+            scheduler.in(2500ms, [this] { onTimer(); });
+            scheduler.step_while([&] {
+                return !done && scheduler.now() < start + 600s;
+            });
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                scheduler.now() - start);
+        }
+    };
+
+    struct Result
+    {
+        std::chrono::milliseconds time;
+        std::size_t requests;
+        std::size_t received;
+        bool done;
+    };
+
+    Result
+    acquire(bool adaptive, std::vector<SimPeer> const& peers)
+    {
+        PeerRequestTracker::Setup setup;
+        setup.minBatch = Sim::reqNodes;
+        setup.maxBatch = Sim::reqNodesReply;
+        setup.maxInFlightNodes = Sim::missingNodesFind / 2;
+
+        // About the size of the state map of a ledger with 100k objects
+        Sim sim{adaptive, 100000, peers, setup};
+        auto const time = sim.run();
+        return {time, sim.requests, sim.received, sim.done};
+    }
+
+    void
+    testTimeToFullLedger()
+    {
+        testcase("Time to full ledger");
+
+        using namespace std::chrono_literals;
+
+        struct Scenario
+        {
+            char const* name;
+            std::vector<SimPeer> peers;
+        };
+
+        std::vector<Scenario> const scenarios{
+            {"uniform",
+             {{50ms, 20000},
+              {50ms, 20000},
+              {50ms, 20000},
+              {50ms, 20000},
+              {50ms, 20000},
+              {50ms, 20000}}},
+            {"mixed",
+             {{10ms, 40000},
+              {30ms, 20000},
+              {80ms, 10000},
+              {200ms, 5000},
+              {500ms, 5000},
+              {1200ms, 2000}}},
+            {"one fast",
+             {{20ms, 40000},
+              {400ms, 10000},
+              {400ms, 10000},
+              {400ms, 10000},
+              {400ms, 10000},
+              {400ms, 10000}}},
+            {"unresponsive",
+             {{50ms, 20000},
+              {100ms, 20000},
+              {150ms, 20000},
+              {50ms, 20000, true},
+              {100ms, 20000, true},
+              {150ms, 20000, true}}}};
+
+        for (auto const& scenario : scenarios)
+        {
+            auto const legacy = acquire(false, scenario.peers);
+            auto const adaptive = acquire(true, scenario.peers);
+
+            log << scenario.name << ": legacy " << legacy.time.count()
+                << " ms, " << legacy.requests << " requests, "
+                << legacy.received << " nodes; adaptive "
+                << adaptive.time.count() << " ms, " << adaptive.requests
+                << " requests, " << adaptive.received << " nodes"
+                << std::endl;
+
+            BEAST_EXPECT(legacy.done);
+            BEAST_EXPECT(adaptive.done);
+            BEAST_EXPECT(adaptive.time * 2 < legacy.time);
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testSchedule();
+        testBroadcast();
+        testTimeToFullLedger();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(PeerRequestTracker, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
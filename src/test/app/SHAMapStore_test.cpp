@@ -17,11 +17,16 @@
 */
 //==============================================================================
 
+#include <ripple/app/ledger/AccountStateSF.h>
+#include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/SHAMapStore.h>
 #include <ripple/app/rdb/backend/RelationalDBInterfaceSqlite.h>
 #include <ripple/core/ConfigSections.h>
+#include <ripple/nodestore/Database.h>
 #include <ripple/protocol/jss.h>
+#include <ripple/shamap/SHAMap.h>
+#include <ripple/shamap/SHAMapMissingNode.h>
 #include <test/jtx.h>
 #include <test/jtx/envconfig.h>
 
@@ -49,6 +54,22 @@ class SHAMapStore_test : public beast::unit_test::suite
         return cfg;
     }
 
+    static auto
+    deltaRotation(std::unique_ptr<Config> cfg)
+    {
+        cfg = onlineDelete(std::move(cfg));
+        cfg->section(ConfigSection::nodeDatabase()).set("delta_rotation", "1");
+        return cfg;
+    }
+
+    // Node store traffic of the ledger close which triggered a rotation
+    struct RotationCost
+    {
+        std::uint64_t fetches = 0;
+        std::uint64_t bytesRead = 0;
+        std::uint64_t bytesWritten = 0;
+    };
+
     bool
     goodLedger(
         jtx::Env& env,
@@ -168,6 +189,85 @@ class SHAMapStore_test : public beast::unit_test::suite
         return ledgerSeq;
     }
 
+    // Load a ledger's state from the node store, bypassing the caches.
+    bool
+    stateComplete(jtx::Env& env, std::shared_ptr<Ledger const> const& ledger)
+    {
+        if (!ledger)
+            return false;
+
+        env.app().getNodeFamily().getTreeNodeCache(0)->clear();
+        SHAMap map(SHAMapType::STATE, env.app().getNodeFamily());
+        try
+        {
+            if (!map.fetchRoot(SHAMapHash{ledger->info().accountHash}, nullptr))
+                return false;
+            map.visitNodes([](SHAMapTreeNode&) { return true; });
+        }
+        catch (SHAMapMissingNode const&)
+        {
+            return false;
+        }
+        return true;
+    }
+
+    // Build a synthetic history in which a few of many accounts change in
+    // every ledger and measure each rotation.
+    template <class Setup>
+    std::vector<RotationCost>
+    measureRotations(Setup setup, std::size_t const rotations)
+    {
+        using namespace jtx;
+        Env env(*this, envconfig(setup));
+        auto& store = env.app().getSHAMapStore();
+        auto& db = env.app().getNodeStore();
+
+        waitForReady(env);
+
+        std::vector<Account> accounts;
+        for (int i = 0; i < 200; ++i)
+        {
+            accounts.emplace_back("acct" + std::to_string(i));
+            env.fund(XRP(1000), accounts.back());
+            if (i % 50 == 49)
+                env.close();
+        }
+        env.close();
+        store.rendezvous();
+
+        std::vector<RotationCost> costs;
+        std::size_t payment = 0;
+        while (costs.size() < rotations)
+        {
+            auto const lastRotated = store.getLastRotated();
+            for (int i = 0; i < 3; ++i, ++payment)
+            {
+                env(
+                    pay(accounts[payment % accounts.size()],
+                        accounts[(payment * 7 + 1) % accounts.size()],
+                        XRP(1)));
+            }
+
+            RotationCost const before{
+                db.getFetchTotalCount(),
+                db.getFetchSize(),
+                db.getStoreSize()};
+            env.close();
+            store.rendezvous();
+
+            if (store.getLastRotated() == lastRotated)
+                continue;
+
+            costs.push_back(
+                {db.getFetchTotalCount() - before.fetches,
+                 db.getFetchSize() - before.bytesRead,
+                 db.getStoreSize() - before.bytesWritten});
+            BEAST_EXPECT(stateComplete(
+                env, env.app().getLedgerMaster().getValidatedLedger()));
+        }
+        return costs;
+    }
+
 public:
     void
     testClear()
@@ -520,12 +620,189 @@ public:
         lastRotated = ledgerSeq - 1;
     }
 
+    void
+    testDeltaRotation()
+    {
+        testcase("delta rotation");
+
+        std::size_t const rotations = 4;
+        auto const full = measureRotations(onlineDelete, rotations);
+        auto const delta = measureRotations(deltaRotation, rotations);
+        if (!BEAST_EXPECT(
+                full.size() == rotations && delta.size() == rotations))
+            return;
+
+        // The first rotation after startup always copies the whole state.
+        std::uint64_t fullFetches = 0;
+        std::uint64_t deltaFetches = 0;
+        for (std::size_t i = 0; i < rotations; ++i)
+        {
+            log << "rotation " << i << ": full " << full[i].fetches
+                << " fetches, " << full[i].bytesRead << " bytes read, "
+                << full[i].bytesWritten << " bytes written; delta "
+                << delta[i].fetches << " fetches, " << delta[i].bytesRead
+                << " bytes read, " << delta[i].bytesWritten
+                << " bytes written" << std::endl;
+            if (i == 0)
+                continue;
+            fullFetches += full[i].fetches;
+            deltaFetches += delta[i].fetches;
+        }
+        BEAST_EXPECT(deltaFetches < fullFetches);
+    }
+
+    // Sync a ledger's state from a peer's copy of it the way InboundLedger
+    // does, with the peer answering from its own map.
+    bool
+    acquireState(
+        jtx::Env& env,
+        std::shared_ptr<Ledger> const& ledger,
+        SHAMap const& peer)
+    {
+        auto& map = ledger->stateMap();
+        map.setLedgerSeq(ledger->info().seq);
+        map.setSynching();
+
+        AccountStateSF filter(
+            env.app().getNodeFamily().db(), env.app().getLedgerMaster());
+        auto const hash = SHAMapHash{ledger->info().accountHash};
+        if (!map.fetchRoot(hash, &filter))
+        {
+            Serializer s;
+            peer.serializeRoot(s);
+            if (!map.addRootNode(hash, s.slice(), &filter).isGood())
+                return false;
+        }
+
+        while (true)
+        {
+            auto const missing = map.getMissingNodes(256, &filter);
+            if (missing.empty())
+                break;
+
+            for (auto const& [nodeID, nodeHash] : missing)
+            {
+                (void)nodeHash;
+                std::vector<SHAMapNodeID> nodeIDs;
+                std::vector<Blob> rawNodes;
+                if (!peer.getNodeFat(nodeID, nodeIDs, rawNodes, false, 1))
+                    return false;
+                for (std::size_t i = 0; i < nodeIDs.size(); ++i)
+                {
+                    if (!map.addKnownNode(
+                                nodeIDs[i], makeSlice(rawNodes[i]), &filter)
+                             .isGood())
+                        return false;
+                }
+            }
+        }
+
+        map.clearSynching();
+        return map.isValid();
+    }
+
+    void
+    testDeltaRotationAcquired()
+    {
+        testcase("delta rotation of an acquired ledger");
+
+        using namespace jtx;
+        Env env(*this, envconfig(deltaRotation));
+        auto& store = env.app().getSHAMapStore();
+        auto& ledgerMaster = env.app().getLedgerMaster();
+
+        waitForReady(env);
+
+        std::vector<Account> accounts;
+        for (int i = 0; i < 20; ++i)
+        {
+            accounts.emplace_back("acct" + std::to_string(i));
+            env.fund(XRP(1000), accounts.back());
+        }
+        env.close();
+        store.rendezvous();
+
+        // The peer serves this state later. Until then its nodes are only
+        // in the current writable backend and in the tree node cache.
+        auto const old = ledgerMaster.getValidatedLedger();
+        old->stateMap().visitNodes([](SHAMapTreeNode&) { return true; });
+
+        // Change every account, rotate, and close past the ledger that
+        // delta rotation uses as its base.
+        auto const firstRotated = store.getLastRotated();
+        std::size_t payment = 0;
+        auto const payAll = [&] {
+            for (std::size_t i = 0; i < accounts.size(); ++i, ++payment)
+            {
+                env(jtx::pay(
+                    accounts[payment % accounts.size()],
+                    accounts[(payment + 1) % accounts.size()],
+                    XRP(1)));
+            }
+            env.close();
+            store.rendezvous();
+        };
+        while (store.getLastRotated() == firstRotated)
+            payAll();
+        auto const lastRotated = store.getLastRotated();
+        payAll();
+        payAll();
+        if (!BEAST_EXPECT(store.getLastRotated() == lastRotated))
+            return;
+
+        // Acquire a ledger whose state is the old state. Every node of it
+        // is found in the tree node cache, so none is stored again.
+        auto info = old->info();
+        info.seq = lastRotated + deleteInterval;
+        auto const acquired = std::make_shared<Ledger>(
+            info, env.app().config(), env.app().getNodeFamily());
+        if (!BEAST_EXPECT(acquireState(env, acquired, old->stateMap())))
+            return;
+        store.onLedgerAcquired(info.seq);
+
+        // Forget the cached nodes, as happens over time, so that the
+        // rotation cannot freshen them.
+        env.app().getNodeFamily().getTreeNodeCache(0)->clear();
+
+        store.onLedgerClosed(acquired);
+        store.rendezvous();
+        BEAST_EXPECT(store.getLastRotated() == info.seq);
+
+        // The backend that held the old state has been deleted
+        BEAST_EXPECT(stateComplete(env, acquired));
+    }
+
+    void
+    testParallelRotation()
+    {
+        testcase("parallel rotation");
+
+        for (auto const threads : {"1", "16"})
+        {
+            for (bool const delta : {false, true})
+            {
+                auto const setup = [&](std::unique_ptr<Config> cfg) {
+                    cfg = delta ? deltaRotation(std::move(cfg))
+                                : onlineDelete(std::move(cfg));
+                    cfg->section(ConfigSection::nodeDatabase())
+                        .set("rotation_threads", threads);
+                    return cfg;
+                };
+                // Every rotation checks that the state it copied is complete
+                BEAST_EXPECT(measureRotations(setup, 2).size() == 2);
+            }
+        }
+    }
+
     void
     run() override
     {
         testClear();
         testAutomatic();
         testCanDelete();
+        testDeltaRotation();
+        testDeltaRotationAcquired();
+        testParallelRotation();
     }
 };
 
@@ -17,6 +17,8 @@
 */
 //==============================================================================
 
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/TxQ.h>
@@ -32,6 +34,10 @@
 #include <test/jtx/envconfig.h>
 #include <test/jtx/ticket.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 namespace ripple {
 
 namespace test {
@@ -4630,6 +4636,100 @@ public:
         }
     }
 
+    void
+    testPreflightCache()
+    {
+        testcase("Preflight cache");
+        using namespace jtx;
+
+        Env env(*this, makeConfig({{"minimum_txn_in_ledger_standalone", "3"}}));
+        auto& app = env.app();
+        auto& txq = app.getTxQ();
+
+        Account const alice("alice");
+        Account const bob("bob");
+        env.fund(XRP(50000), noripple(alice, bob));
+        env.close();
+
+        auto const tx = env.jt(pay(alice, bob, XRP(1))).stx;
+        auto const txID = tx->getTransactionID();
+        auto const rules = env.current()->rules();
+        auto const reused = txq.preflightReused();
+
+        // Each submission goes to a fresh view on the closed ledger, so
+        // that it can be applied again.
+        auto submit = [&](Rules const& r, ApplyFlags flags, bool again) {
+            OpenView view(open_ledger, r, env.closed());
+            if (again)
+                return txq.reapply(app, view, tx, flags, env.journal);
+            return txq.apply(app, view, tx, flags, env.journal);
+        };
+
+        // A first submission does not fill the cache
+        BEAST_EXPECT(submit(rules, tapNONE, false).second);
+        BEAST_EXPECT(!txq.preflightCached(txID, rules, tapNONE));
+
+        // A resubmission fills it, and the next one reuses the result
+        BEAST_EXPECT(submit(rules, tapNONE, true).second);
+        BEAST_EXPECT(txq.preflightCached(txID, rules, tapNONE));
+        BEAST_EXPECT(txq.preflightReused() == reused);
+        BEAST_EXPECT(submit(rules, tapNONE, true).second);
+        BEAST_EXPECT(txq.preflightReused() == reused + 1);
+
+        // Different flags invalidate the result
+        BEAST_EXPECT(submit(rules, tapRETRY, true).second);
+        BEAST_EXPECT(txq.preflightReused() == reused + 1);
+        BEAST_EXPECT(txq.preflightCached(txID, rules, tapRETRY));
+        BEAST_EXPECT(!txq.preflightCached(txID, rules, tapNONE));
+
+        // So do different rules
+        Rules const genesis{std::unordered_set<uint256, beast::uhash<>>{}};
+        BEAST_EXPECT(genesis != rules);
+        submit(genesis, tapRETRY, true);
+        BEAST_EXPECT(txq.preflightReused() == reused + 1);
+        BEAST_EXPECT(txq.preflightCached(txID, genesis, tapRETRY));
+        BEAST_EXPECT(!txq.preflightCached(txID, rules, tapRETRY));
+
+        // A result survives one close and is dropped by the next one
+        env.close();
+        BEAST_EXPECT(txq.preflightCached(txID, genesis, tapRETRY));
+        env.close();
+        BEAST_EXPECT(!txq.preflightCached(txID, genesis, tapRETRY));
+
+        // A result kept across a close is still reused
+        submit(rules, tapNONE, true);
+        env.close();
+        BEAST_EXPECT(submit(rules, tapNONE, true).second);
+        BEAST_EXPECT(txq.preflightReused() == reused + 2);
+
+        // Local transactions already in the new open view are not
+        // submitted again when the open ledger is accepted.
+        auto const inView = env.jt(pay(alice, bob, XRP(2))).stx;
+        auto const notInView = env.jt(pay(bob, alice, XRP(2))).stx;
+        OrderedTxs locals(uint256{});
+        locals.insert(inView);
+        locals.insert(notInView);
+        OrderedTxs retries(uint256{});
+        app.openLedger().accept(
+            app,
+            env.current()->rules(),
+            app.getLedgerMaster().getClosedLedger(),
+            locals,
+            false,
+            retries,
+            tapNONE,
+            "",
+            [&](OpenView& view, beast::Journal j) {
+                return ripple::apply(app, view, *inView, tapNONE, j).second;
+            });
+        BEAST_EXPECT(env.current()->txExists(inView->getTransactionID()));
+        BEAST_EXPECT(env.current()->txExists(notInView->getTransactionID()));
+        BEAST_EXPECT(
+            !txq.preflightCached(inView->getTransactionID(), rules, tapNONE));
+        BEAST_EXPECT(
+            txq.preflightCached(notInView->getTransactionID(), rules, tapNONE));
+    }
+
     void
     run() override
     {
@@ -4650,6 +4750,7 @@ public:
         testBlockersTicket();
         testInFlightBalance();
         testConsequences();
+        testPreflightCache();
     }
 
     void
@@ -4682,8 +4783,142 @@ class TxQ2_test : public TxQ1_test
     }
 };
 
+/** Measures how quickly transactions can be queued while the fee is
+    escalated, with the RPC "fee" metrics being polled concurrently.
+
+    Not run by default. Run with
+    `--unittest=TxQStress --unittest-arg=accounts=N,txns=M,threads=T`
+*/
+class TxQStress_test : public beast::unit_test::suite
+{
+    std::size_t
+    argOr(std::string const& name, std::size_t def) const
+    {
+        auto const& args = arg();
+        auto const pos = args.find(name + "=");
+        if (pos == std::string::npos)
+            return def;
+        return std::stoul(args.substr(pos + name.size() + 1));
+    }
+
+    void
+    testSubmitThroughput(
+        std::size_t const numAccounts,
+        std::size_t const txnsPerAccount,
+        std::size_t const numThreads)
+    {
+        using namespace jtx;
+        using namespace std::chrono;
+
+        testcase(
+            "Submit throughput: " + std::to_string(numAccounts) +
+            " accounts, " + std::to_string(txnsPerAccount) + " txns each, " +
+            std::to_string(numThreads) + " threads");
+
+        auto const total = numAccounts * txnsPerAccount;
+        Env env(*this, envconfig([&](std::unique_ptr<Config> cfg) {
+            auto& section = cfg->section("transaction_queue");
+            section.set("minimum_txn_in_ledger_standalone", "5");
+            section.set("target_txn_in_ledger", "10");
+            section.set("maximum_txn_in_ledger", "10");
+            section.set("minimum_queue_size", std::to_string(total));
+            section.set(
+                "maximum_txn_per_account", std::to_string(txnsPerAccount));
+            return cfg;
+        }));
+        auto& txq = env.app().getTxQ();
+
+        std::vector<Account> accounts;
+        accounts.reserve(numAccounts);
+        for (std::size_t i = 0; i < numAccounts; ++i)
+        {
+            accounts.emplace_back("stress" + std::to_string(i));
+            // Pay well over the escalated fee so funding is never queued.
+            env(pay(env.master, accounts.back(), XRP(10000)), fee(XRP(10)));
+            if (i % 50 == 49)
+                env.close();
+        }
+        env.close();
+
+        // Sign everything up front so the measurement is dominated by
+        // the queue rather than by the test harness.
+        std::vector<std::vector<std::shared_ptr<STTx const>>> txns(
+            numAccounts);
+        for (std::size_t i = 0; i < numAccounts; ++i)
+        {
+            auto const acctSeq = env.seq(accounts[i]);
+            for (std::size_t n = 0; n < txnsPerAccount; ++n)
+                txns[i].push_back(
+                    env.jt(noop(accounts[i]), seq(acctSeq + n), fee(10)).stx);
+        }
+
+        // Escalate the open ledger fee so base fee transactions queue.
+        auto const filler = txq.getMetrics(*env.current());
+        for (auto i = filler.txInLedger; i <= filler.txPerLedger; ++i)
+            env(noop(env.master), fee(XRP(10)));
+
+        std::atomic<bool> done{false};
+        std::atomic<std::size_t> queued{0};
+        std::size_t metricsReads = 0;
+        std::thread reader([&] {
+            while (!done.load())
+            {
+                auto const view = env.app().openLedger().current();
+                txq.getMetrics(*view);
+                ++metricsReads;
+            }
+        });
+
+        auto const start = steady_clock::now();
+        std::vector<std::thread> submitters;
+        for (std::size_t t = 0; t < numThreads; ++t)
+        {
+            submitters.emplace_back([&, t] {
+                for (auto i = t; i < numAccounts; i += numThreads)
+                {
+                    for (auto const& stx : txns[i])
+                    {
+                        env.app().openLedger().modify(
+                            [&](OpenView& view, beast::Journal j) {
+                                auto const result = txq.apply(
+                                    env.app(), view, stx, tapNONE, j);
+                                if (result.first == terQUEUED)
+                                    ++queued;
+                                return result.second;
+                            });
+                    }
+                }
+            });
+        }
+        for (auto& t : submitters)
+            t.join();
+        auto const elapsed = steady_clock::now() - start;
+        done = true;
+        reader.join();
+
+        auto const ms = std::max<std::int64_t>(
+            duration_cast<milliseconds>(elapsed).count(), 1);
+        log << "    " << total << " submissions in " << ms << "ms ("
+            << (total * 1000 / ms) << "/s), " << metricsReads
+            << " concurrent metrics reads (" << (metricsReads * 1000 / ms)
+            << "/s)" << std::endl;
+
+        BEAST_EXPECT(queued == total);
+        BEAST_EXPECT(txq.getMetrics(*env.current()).txCount == total);
+    }
+
+public:
+    void
+    run() override
+    {
+        testSubmitThroughput(
+            argOr("accounts", 1000), argOr("txns", 10), argOr("threads", 4));
+    }
+};
+
 BEAST_DEFINE_TESTSUITE_PRIO(TxQ1, app, ripple, 1);
 BEAST_DEFINE_TESTSUITE_PRIO(TxQ2, app, ripple, 1);
+BEAST_DEFINE_TESTSUITE_MANUAL(TxQStress, app, ripple);
 
 }  // namespace test
 }  // namespace ripple
@@ -0,0 +1,314 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/ReduceRelayCommon.h>
+#include <test/csf/BasicNetwork.h>
+#include <test/csf/Histogram.h>
+#include <test/csf/Scheduler.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+/** Simulate the relay of transactions through a random network of peers,
+    comparing flooding every transaction to every peer against
+    transaction reduce-relay, where a transaction is sent in full to a
+    random subset of the peers and only announced by hash to the rest,
+    who request it if they don't have it yet.
+
+    Reports the ratio of duplicate transactions received and the
+    propagation latency of each mode.
+*/
+class TxReduceRelaySim_test : public beast::unit_test::suite
+{
+    using Tx = int;
+
+    struct Params
+    {
+        bool reduceRelay = false;
+        std::size_t nodes = 200;
+        // Outbound connections opened by each node
+        std::size_t outbound = 40;
+        std::size_t txs = 40;
+        std::size_t minPeers = 20;
+        std::size_t percentage = 25;
+    };
+
+    struct Stats
+    {
+        // Transactions received in full, including duplicates
+        std::size_t received = 0;
+        std::size_t duplicates = 0;
+        // TMHaveTransactions and transaction requests
+        std::size_t announcements = 0;
+        std::size_t requests = 0;
+        // Nodes which got each transaction
+        std::size_t delivered = 0;
+        csf::Histogram<std::chrono::milliseconds> latency;
+
+        double
+        duplicateRatio() const
+        {
+            return received ? static_cast<double>(duplicates) / received : 0;
+        }
+    };
+
+    struct Node;
+    using Net = csf::BasicNetwork<Node*>;
+
+    struct Sim
+    {
+        Params const params;
+        csf::Scheduler scheduler;
+        Net net{scheduler};
+        std::mt19937_64 rng{42};
+        std::vector<std::unique_ptr<Node>> nodes;
+        std::map<Tx, csf::Scheduler::time_point> submitted;
+        Stats stats;
+
+        explicit Sim(Params const& p) : params(p)
+        {
+        }
+    };
+
+    struct Node
+    {
+        Sim& sim;
+        std::set<Tx> have;
+        std::set<Tx> requested;
+        // Hashes to announce to each peer with the next tick
+        std::map<Node*, std::set<Tx>> txQueue;
+
+        explicit Node(Sim& s) : sim(s)
+        {
+        }
+
+        std::vector<Node*>
+        peers()
+        {
+            std::vector<Node*> res;
+            for (auto const& link : sim.net.links(this))
+                res.push_back(link.target);
+            return res;
+        }
+
+        void
+        submit(Tx tx)
+        {
+            sim.submitted[tx] = sim.scheduler.now();
+            have.insert(tx);
+            ++sim.stats.delivered;
+            relay(tx, nullptr);
+        }
+
+        void
+        relay(Tx tx, Node* from)
+        {
+            std::vector<Node*> targets;
+            for (auto peer : peers())
+                if (peer != from)
+                    targets.push_back(peer);
+
+            std::size_t full = targets.size();
+            if (sim.params.reduceRelay)
+            {
+                full = reduce_relay::txRelayPeers(
+                    targets.size(),
+                    sim.params.minPeers,
+                    sim.params.percentage);
+                std::shuffle(targets.begin(), targets.end(), sim.rng);
+            }
+
+            for (std::size_t i = 0; i < targets.size(); ++i)
+            {
+                if (i < full)
+                    send(targets[i], tx);
+                else
+                    txQueue[targets[i]].insert(tx);
+            }
+        }
+
+        void
+        send(Node* to, Tx tx)
+        {
+            sim.net.send(this, to, [to, this, tx] { to->receive(this, tx); });
+        }
+
+        void
+        receive(Node* from, Tx tx)
+        {
+            ++sim.stats.received;
+            // The peer has the transaction, no need to announce it
+            if (auto it = txQueue.find(from); it != txQueue.end())
+                it->second.erase(tx);
+
+            if (!have.insert(tx).second)
+            {
+                ++sim.stats.duplicates;
+                return;
+            }
+
+            ++sim.stats.delivered;
+            sim.stats.latency.insert(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    sim.scheduler.now() - sim.submitted[tx]));
+            relay(tx, from);
+        }
+
+        void
+        tick()
+        {
+            for (auto& [peer, txs] : txQueue)
+            {
+                if (txs.empty())
+                    continue;
+                ++sim.stats.announcements;
+                sim.net.send(this, peer, [peer = peer, this, txs = txs] {
+                    peer->onHaveTransactions(this, txs);
+                });
+                txs.clear();
+            }
+        }
+
+        void
+        onHaveTransactions(Node* from, std::set<Tx> const& txs)
+        {
+            std::vector<Tx> missing;
+            for (auto tx : txs)
+                if (have.count(tx) == 0 && requested.insert(tx).second)
+                    missing.push_back(tx);
+            if (missing.empty())
+                return;
+            ++sim.stats.requests;
+            sim.net.send(this, from, [from, this, missing] {
+                for (auto tx : missing)
+                    from->send(this, tx);
+            });
+        }
+    };
+
+    Stats
+    simulate(Params const& params)
+    {
+        using namespace std::chrono_literals;
+
+        Sim sim{params};
+        for (std::size_t i = 0; i < params.nodes; ++i)
+            sim.nodes.emplace_back(std::make_unique<Node>(sim));
+
+        // Random graph with link latency from 10 to 150 ms
+        std::uniform_int_distribution<std::size_t> pick(0, params.nodes - 1);
+        std::uniform_int_distribution<int> delay(10, 150);
+        for (auto& node : sim.nodes)
+        {
+            std::size_t connected = 0;
+            while (connected < params.outbound)
+            {
+                auto& to = sim.nodes[pick(sim.rng)];
+                if (sim.net.connect(
+                        node.get(),
+                        to.get(),
+                        std::chrono::milliseconds(delay(sim.rng))))
+                    ++connected;
+            }
+        }
+
+        // Every node announces its queue once a second, as the overlay
+        // timer does, with a random phase
+        auto const end = sim.scheduler.now() + 60s;
+        std::uniform_int_distribution<int> phase(0, 999);
+        std::function<void(Node*)> tick = [&](Node* node) {
+            node->tick();
+            if (sim.scheduler.now() < end)
+                sim.scheduler.in(1s, [&, node] { tick(node); });
+        };
+        for (auto& node : sim.nodes)
+            sim.scheduler.in(
+                std::chrono::milliseconds(phase(sim.rng)),
+                [&, n = node.get()] { tick(n); });
+
+        // Submit a transaction to a random node every 100 ms
+        for (Tx tx = 0; tx < static_cast<Tx>(params.txs); ++tx)
+            sim.scheduler.in(100ms * tx, [&, tx] {
+                sim.nodes[pick(sim.rng)]->submit(tx);
+            });
+
+        sim.scheduler.step();
+        return sim.stats;
+    }
+
+    void
+    report(char const* name, Stats const& stats)
+    {
+        using namespace std::chrono;
+        log << name << ": received " << stats.received << ", duplicates "
+            << stats.duplicates << " (" << 100 * stats.duplicateRatio()
+            << "%), announcements " << stats.announcements << ", requests "
+            << stats.requests << ", latency avg "
+            << stats.latency.avg().count() << " ms, p50 "
+            << stats.latency.percentile(0.5f).count() << " ms, p90 "
+            << stats.latency.percentile(0.9f).count() << " ms, max "
+            << stats.latency.maxValue().count() << " ms" << std::endl;
+    }
+
+    void
+    testRelay()
+    {
+        testcase("Duplicates and latency");
+
+        Params params;
+        auto const flood = simulate(params);
+        params.reduceRelay = true;
+        auto const reduced = simulate(params);
+
+        report("flood", flood);
+        report("reduce-relay", reduced);
+
+        // Every node gets every transaction either way
+        BEAST_EXPECT(flood.delivered == params.nodes * params.txs);
+        BEAST_EXPECT(reduced.delivered == params.nodes * params.txs);
+        BEAST_EXPECT(flood.announcements == 0);
+        BEAST_EXPECT(reduced.announcements > 0);
+
+        // Far fewer transactions are sent with reduce-relay, at the cost
+        // of the transactions fetched on announcement arriving later
+        BEAST_EXPECT(reduced.received < flood.received / 2);
+        BEAST_EXPECT(reduced.duplicateRatio() < flood.duplicateRatio());
+        BEAST_EXPECT(
+            reduced.latency.percentile(0.9f) >= flood.latency.percentile(0.9f));
+    }
+
+    void
+    run() override
+    {
+        testRelay();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TxReduceRelaySim, consensus, ripple);
+
+}  // namespace test
+}  // namespace ripple
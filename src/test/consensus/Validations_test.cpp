@@ -403,6 +403,71 @@ class Validations_test : public beast::unit_test::suite
         }
     }
 
+    void
+    testAddBatch()
+    {
+        using namespace std::chrono_literals;
+
+        testcase("Add validation batch");
+        LedgerHistoryHelper h;
+        Ledger ledgerA = h["a"];
+        Ledger ledgerAB = h["ab"];
+
+        TestHarness harness(h.oracle);
+        Node a = harness.makeNode();
+        Node b = harness.makeNode();
+        Node c = harness.makeNode();
+        c.untrust();
+
+        auto const stale =
+            a.validate(ledgerA, -harness.parms().validationCURRENT_WALL, 0s);
+
+        std::vector<std::pair<PeerID, Validation>> batch;
+        for (auto const& v :
+             {a.validate(ledgerA),
+              b.validate(ledgerA),
+              c.validate(ledgerA),
+              // Same outcome as adding the two in turn
+              b.validate(ledgerA),
+              stale})
+            batch.emplace_back(v.nodeID(), v);
+
+        auto const outcomes = harness.vals().add(batch);
+        BEAST_EXPECT(
+            outcomes ==
+            std::vector<ValStatus>(
+                {ValStatus::current,
+                 ValStatus::current,
+                 ValStatus::current,
+                 ValStatus::badSeq,
+                 ValStatus::stale}));
+        BEAST_EXPECT(harness.vals().numTrustedForLedger(ledgerA.id()) == 2);
+
+        // An empty batch changes nothing
+        BEAST_EXPECT(harness.vals().add({}).empty());
+
+        harness.clock().advance(1s);
+        batch.clear();
+        batch.emplace_back(a.nodeID(), a.validate(ledgerAB));
+        BEAST_EXPECT(
+            harness.vals().add(batch) ==
+            std::vector<ValStatus>{ValStatus::current});
+        BEAST_EXPECT(harness.vals().numTrustedForLedger(ledgerAB.id()) == 1);
+
+        // Resuming a batch only adds the validations without an outcome
+        harness.clock().advance(1s);
+        Ledger ledgerABC = h["abc"];
+        batch.clear();
+        batch.emplace_back(a.nodeID(), a.validate(ledgerABC));
+        batch.emplace_back(b.nodeID(), b.validate(ledgerABC));
+        std::vector<ValStatus> resumed{ValStatus::stale};
+        harness.vals().add(batch, resumed);
+        BEAST_EXPECT(
+            resumed ==
+            std::vector<ValStatus>({ValStatus::stale, ValStatus::current}));
+        BEAST_EXPECT(harness.vals().numTrustedForLedger(ledgerABC.id()) == 1);
+    }
+
     void
     testOnStale()
     {
@@ -1094,6 +1159,7 @@ class Validations_test : public beast::unit_test::suite
     run() override
     {
         testAddValidation();
+        testAddBatch();
         testOnStale();
         testGetNodesAfter();
         testCurrentTrusted();
@@ -74,6 +74,22 @@ class PerfLogTest : public PerfLog
     {
     }
 
+    void
+    txApply(
+        uint256 const& txID,
+        TxType const type,
+        std::chrono::microseconds dur,
+        std::vector<uint256> reads,
+        std::vector<uint256> writes) override
+    {
+    }
+
+    bool
+    txProfiling() const override
+    {
+        return false;
+    }
+
     Json::Value
     countersJson() const override
     {
@@ -86,6 +102,12 @@ class PerfLogTest : public PerfLog
         return Json::Value();
     }
 
+    Json::Value
+    txJson(bool recent) const override
+    {
+        return Json::Value();
+    }
+
     void
     resizeJobs(int const resize) override
     {
@@ -0,0 +1,255 @@
+//------------------------------------------------------------------------------
+/*
+  This file is part of rippled: https://github.com/ripple/rippled
+  Copyright (c) 2021 Ripple Labs Inc.
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose  with  or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+  MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/ledger/ApplyViewImpl.h>
+#include <ripple/ledger/PaymentSandbox.h>
+#include <ripple/protocol/Feature.h>
+#include <ripple/protocol/Indexes.h>
+#include <test/jtx.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace ripple {
+namespace test {
+
+/** Measure the cost of the sandbox stacks built while applying payments
+    and crossing offers.
+
+    Run with:
+
+        --unittest=SandboxTiming
+*/
+class SandboxTiming_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    template <class F>
+    std::chrono::microseconds
+    measure(F&& f)
+    {
+        auto const start = clock_type::now();
+        f();
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            clock_type::now() - start);
+    }
+
+    void
+    report(
+        std::string const& what,
+        std::size_t iterations,
+        std::chrono::microseconds elapsed)
+    {
+        auto const each =
+            elapsed.count() / std::max<std::size_t>(iterations, 1);
+        log << what << ": " << iterations << " in " << elapsed.count()
+            << "us, " << each << "us each" << std::endl;
+    }
+
+    template <class View>
+    void
+    nest(View& parent, std::vector<Keylet> const& keys, std::size_t depth)
+    {
+        PaymentSandbox sb(&parent);
+        for (auto const& k : keys)
+        {
+            if (auto const sle = sb.peek(k))
+            {
+                (*sle)[sfSequence] = (*sle)[sfSequence] + 1;
+                sb.update(sle);
+            }
+        }
+        if (depth > 1)
+            nest(sb, keys, depth - 1);
+        sb.apply(parent);
+    }
+
+    // Stacks of sandboxes that each modify the same entries, the way
+    // flow() stacks a sandbox per strand and per step.
+    void
+    testNesting(std::size_t accounts, std::size_t depth, std::size_t rounds)
+    {
+        using namespace jtx;
+        Env env(*this);
+
+        std::vector<Keylet> keys;
+        keys.reserve(accounts);
+        for (std::size_t i = 0; i < accounts; ++i)
+        {
+            Account const a{"a" + std::to_string(i)};
+            env.fund(XRP(1000), a);
+            keys.push_back(keylet::account(a));
+            if (i % 64 == 63)
+                env.close();
+        }
+        env.close();
+
+        // Touch the entries in an order unrelated to their keys.
+        std::shuffle(keys.begin(), keys.end(), std::mt19937_64{accounts});
+
+        auto const elapsed = measure([&] {
+            for (std::size_t i = 0; i < rounds; ++i)
+            {
+                ApplyViewImpl view(&*env.current(), tapNONE);
+                nest(view, keys, depth);
+            }
+        });
+        report(
+            "nest " + std::to_string(accounts) + " entries, depth " +
+                std::to_string(depth),
+            rounds,
+            elapsed);
+    }
+
+    // A payment that crosses every offer in a chain of order books.
+    void
+    testPayment(std::size_t makers, std::size_t payments)
+    {
+        using namespace jtx;
+        Env env(*this);
+        env.disable_sigs();
+
+        auto const gw = Account("gateway");
+        auto const alice = Account("alice");
+        auto const bob = Account("bob");
+        auto const USD = gw["USD"];
+        auto const EUR = gw["EUR"];
+        auto const GBP = gw["GBP"];
+        auto const JPY = gw["JPY"];
+        auto const big = 1000000000;
+
+        env.fund(XRP(big), gw, alice, bob);
+        env.trust(USD(big), alice);
+        env.trust(JPY(big), bob);
+        env(pay(gw, alice, USD(big / 2)));
+        env.close();
+
+        for (std::size_t i = 0; i < makers; ++i)
+        {
+            Account const mm{"mm" + std::to_string(i)};
+            env.fund(XRP(100000), mm);
+            env.trust(USD(big), mm);
+            env.trust(EUR(big), mm);
+            env.trust(GBP(big), mm);
+            env.trust(JPY(big), mm);
+            env(pay(gw, mm, EUR(big / 2)));
+            env(pay(gw, mm, GBP(big / 2)));
+            env(pay(gw, mm, JPY(big / 2)));
+            env.close();
+        }
+
+        auto const elapsed = [&] {
+            std::chrono::microseconds total{0};
+            for (std::size_t p = 0; p < payments; ++p)
+            {
+                for (std::size_t i = 0; i < makers; ++i)
+                {
+                    Account const mm{"mm" + std::to_string(i)};
+                    env(offer(mm, USD(10), EUR(10)));
+                    env(offer(mm, EUR(10), GBP(10)));
+                    env(offer(mm, GBP(10), JPY(10)));
+                }
+                env.close();
+
+                total += measure([&] {
+                    env(pay(alice, bob, JPY(10 * makers)),
+                        sendmax(USD(10 * makers)),
+                        path(~EUR, ~GBP, ~JPY),
+                        txflags(tfNoRippleDirect));
+                });
+                env.close();
+            }
+            return total;
+        }();
+        report(
+            "payment crossing " + std::to_string(makers * 3) + " offers",
+            payments,
+            elapsed);
+    }
+
+    // An offer that crosses a deep book.
+    void
+    testCrossing(std::size_t makers, std::size_t crossings)
+    {
+        using namespace jtx;
+        Env env(*this);
+        env.disable_sigs();
+
+        auto const gw = Account("gateway");
+        auto const alice = Account("alice");
+        auto const USD = gw["USD"];
+        auto const big = 1000000000;
+
+        env.fund(XRP(big), gw, alice);
+        env.trust(USD(big), alice);
+        env(pay(gw, alice, USD(big / 2)));
+        env.close();
+
+        for (std::size_t i = 0; i < makers; ++i)
+        {
+            Account const mm{"mm" + std::to_string(i)};
+            env.fund(XRP(100000), mm);
+            env.trust(USD(big), mm);
+            if (i % 64 == 63)
+                env.close();
+        }
+        env.close();
+
+        auto const elapsed = [&] {
+            std::chrono::microseconds total{0};
+            for (std::size_t c = 0; c < crossings; ++c)
+            {
+                for (std::size_t i = 0; i < makers; ++i)
+                {
+                    Account const mm{"mm" + std::to_string(i)};
+                    env(offer(mm, USD(1 + i % 10), XRP(10)));
+                }
+                env.close();
+
+                total += measure(
+                    [&] { env(offer(alice, XRP(10 * makers), USD(big))); });
+                env.close();
+            }
+            return total;
+        }();
+        report(
+            "offer crossing " + std::to_string(makers) + " offers",
+            crossings,
+            elapsed);
+    }
+
+public:
+    void
+    run() override
+    {
+        testNesting(8, 8, 20000);
+        testNesting(64, 8, 2000);
+        testNesting(512, 4, 100);
+        testPayment(50, 10);
+        testPayment(200, 5);
+        testCrossing(100, 10);
+        testCrossing(500, 5);
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SandboxTiming, ledger, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,201 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Task.h>
+#include <ripple/nodestore/impl/BatchWriter.h>
+#include <test/nodestore/TestBase.h>
+#include <deque>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+class BatchWriter_test : public TestBase
+{
+    // Holds scheduled tasks until the test runs them
+    struct DeferredScheduler : public Scheduler
+    {
+        std::deque<Task*> tasks;
+        std::vector<BatchWriteReport> reports;
+
+        void
+        scheduleTask(Task& task) override
+        {
+            tasks.push_back(&task);
+        }
+
+        void
+        onFetch(FetchReport const&) override
+        {
+        }
+
+        void
+        onBatchWrite(BatchWriteReport const& report) override
+        {
+            reports.push_back(report);
+        }
+
+        void
+        runAll()
+        {
+            while (!tasks.empty())
+            {
+                auto task = tasks.front();
+                tasks.pop_front();
+                task->performScheduledTask();
+            }
+        }
+    };
+
+    struct Writer : public BatchWriter::Callback
+    {
+        std::vector<Batch> batches;
+
+        void
+        writeBatch(Batch const& batch) override
+        {
+            batches.push_back(batch);
+        }
+
+        std::size_t
+        written() const
+        {
+            std::size_t n = 0;
+            for (auto const& batch : batches)
+                n += batch.size();
+            return n;
+        }
+    };
+
+public:
+    void
+    testCoalesce()
+    {
+        testcase("coalesce");
+
+        auto const objects = createPredictableBatch(100, 1);
+
+        DeferredScheduler scheduler;
+        Writer writer;
+        BatchWriter bw(writer, scheduler);
+
+        for (auto const& object : objects)
+            bw.store(object);
+        for (auto const& object : objects)
+            bw.store(object);
+
+        // A single task is writing the queue
+        BEAST_EXPECT(scheduler.tasks.size() == 1);
+        BEAST_EXPECT(bw.getWriteLoad() == 100);
+
+        scheduler.runAll();
+        BEAST_EXPECT(writer.batches.size() == 1);
+        BEAST_EXPECT(writer.written() == 100);
+        BEAST_EXPECT(bw.getWriteLoad() == 0);
+
+        auto stats = bw.getStats();
+        BEAST_EXPECT(stats.requested == 200);
+        BEAST_EXPECT(stats.coalesced == 100);
+        BEAST_EXPECT(stats.written == 100);
+        BEAST_EXPECT(stats.batches == 1);
+
+        BEAST_EXPECT(scheduler.reports.size() == 1);
+        BEAST_EXPECT(scheduler.reports[0].writeCount == 100);
+        BEAST_EXPECT(scheduler.reports[0].coalesced == 100);
+        BEAST_EXPECT(scheduler.reports[0].queueDepth == 0);
+
+        // Once written, an object is stored again
+        bw.store(objects[0]);
+        scheduler.runAll();
+        stats = bw.getStats();
+        BEAST_EXPECT(stats.requested == 201);
+        BEAST_EXPECT(stats.coalesced == 100);
+        BEAST_EXPECT(stats.written == 101);
+        BEAST_EXPECT(scheduler.reports.back().coalesced == 0);
+    }
+
+    void
+    testBatchLimit()
+    {
+        testcase("batch limit");
+
+        DeferredScheduler scheduler;
+        Writer writer;
+        BatchWriter bw(writer, scheduler);
+
+        auto const limit = bw.getStats().batchLimit;
+        BEAST_EXPECT(limit >= batchWritePreallocationSize);
+        BEAST_EXPECT(limit <= batchWriteLimitSize);
+
+        auto const objects = createPredictableBatch(limit + 10, 2);
+        for (auto const& object : objects)
+            bw.store(object);
+
+        // A full batch is written alongside the one in flight
+        BEAST_EXPECT(scheduler.tasks.size() == BatchWriter::maxInFlight);
+
+        scheduler.runAll();
+        BEAST_EXPECT(writer.batches.size() == 2);
+        BEAST_EXPECT(writer.batches[0].size() == limit);
+        BEAST_EXPECT(writer.batches[1].size() == 10);
+        BEAST_EXPECT(writer.written() == objects.size());
+        BEAST_EXPECT(scheduler.reports[0].queueDepth == 10);
+
+        // Objects are written in the order they were stored
+        for (std::size_t i = 0; i < limit; ++i)
+            BEAST_EXPECT(writer.batches[0][i] == objects[i]);
+
+        // A full batch written well inside the target grows the limit
+        auto const stats = bw.getStats();
+        BEAST_EXPECT(stats.batchLimit > limit);
+        BEAST_EXPECT(stats.batchLimit <= batchWriteLimitSize);
+        BEAST_EXPECT(stats.batches == 2);
+    }
+
+    void
+    testFlush()
+    {
+        testcase("flush");
+
+        auto const objects = createPredictableBatch(50, 3);
+
+        DummyScheduler scheduler;
+        Writer writer;
+        {
+            BatchWriter bw(writer, scheduler);
+            for (auto const& object : objects)
+                bw.store(object);
+        }
+        BEAST_EXPECT(writer.written() == objects.size());
+    }
+
+    void
+    run() override
+    {
+        testCoalesce();
+        testBatchLimit();
+        testFlush();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(BatchWriter, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -1123,11 +1123,20 @@ class DatabaseShard_test : public TestBase
         std::string ripemd160Key("B2F9DB61F714A82889966F097CD615C36DB2B01D"),
             ripemd160Dat("6DB1D02CD019F09198FE80DB5A7D707F0C6BFF4C");
 
+        // Finalizing with one or many threads makes the same shard
         for (int i = 0; i < 2; i++)
         {
             beast::temp_dir shardDir;
+            auto config = [&]() {
+                auto cfg{testConfig(shardDir.path())};
+                cfg->overwrite(
+                    ConfigSection::shardDatabase(),
+                    "finalize_threads",
+                    i == 0 ? "1" : "16");
+                return cfg;
+            };
             {
-                Env env{*this, testConfig(shardDir.path())};
+                Env env{*this, config()};
                 DatabaseShard* db = env.app().getShardStore();
                 BEAST_EXPECT(db);
 
@@ -1139,7 +1148,7 @@ class DatabaseShard_test : public TestBase
                     return;
             }
             {
-                Env env{*this, testConfig(shardDir.path())};
+                Env env{*this, config()};
                 DatabaseShard* db = env.app().getShardStore();
                 BEAST_EXPECT(db);
 
@@ -1522,6 +1531,77 @@ class DatabaseShard_test : public TestBase
             data.ledgers_[index]->info().hash, ledgerSeq));
     }
 
+    void
+    testMemoryMappedShard(std::uint64_t const seedValue)
+    {
+        testcase("Memory mapped shard");
+
+        using namespace test::jtx;
+
+        beast::temp_dir shardDir;
+        auto mappedConfig = [&]() {
+            auto cfg{testConfig(shardDir.path())};
+            cfg->overwrite(ConfigSection::shardDatabase(), "memory_map", "1");
+            return cfg;
+        };
+        std::optional<int> shardIndex;
+        {
+            Env env{*this, mappedConfig()};
+            DatabaseShard* db = env.app().getShardStore();
+            BEAST_EXPECT(db);
+
+            TestData data(seedValue);
+            if (!BEAST_EXPECT(data.makeLedgers(env)))
+                return;
+
+            shardIndex = createShard(data, *db, 1);
+            if (!BEAST_EXPECT(shardIndex))
+                return;
+
+            // Finalizing wrote the map, and fetches are served from it
+            auto const path{
+                boost::filesystem::path(shardDir.path()) /
+                std::to_string(*shardIndex) / MappedShard::fileName};
+            BEAST_EXPECT(boost::filesystem::exists(path));
+            for (std::uint32_t i = 0; i < ledgersPerShard; ++i)
+                checkLedger(data, *db, *data.ledgers_[i]);
+
+            // Fetched objects point into the mapping and keep it open
+            std::shared_ptr<NodeObject> object;
+            Slice found;
+            {
+                auto const mapped{MappedShard::open(path, journal_)};
+                if (!BEAST_EXPECT(mapped))
+                    return;
+                auto const& hash{data.ledgers_[0]->info().hash};
+                object = mapped->fetch(hash);
+                if (auto const result = mapped->find(hash))
+                    found = result->second;
+            }
+            if (BEAST_EXPECT(object && !found.empty()))
+            {
+                BEAST_EXPECT(object->getData().data() == found.data());
+                BEAST_EXPECT(
+                    deserializePrefixedHeader(object->getData()).seq ==
+                    data.ledgers_[0]->info().seq);
+            }
+        }
+        {
+            // The map is opened again with the shard
+            Env env{*this, mappedConfig()};
+            DatabaseShard* db = env.app().getShardStore();
+            BEAST_EXPECT(db);
+
+            TestData data(seedValue);
+            if (!BEAST_EXPECT(data.makeLedgers(env)))
+                return;
+
+            waitShard(*db, *shardIndex);
+            for (std::uint32_t i = 0; i < ledgersPerShard; ++i)
+                checkLedger(data, *db, *data.ledgers_[i]);
+        }
+    }
+
 public:
     DatabaseShard_test() : journal_("DatabaseShard_test", *this)
     {
@@ -1545,6 +1625,7 @@ public:
         testImportWithHistoricalPaths(seedValue + 90);
         testPrepareWithHistoricalPaths(seedValue + 100);
         testOpenShardManagement(seedValue + 110);
+        testMemoryMappedShard(seedValue + 120);
     }
 };
 
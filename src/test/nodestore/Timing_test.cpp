@@ -25,6 +25,7 @@
 #include <ripple/beast/xor_shift_engine.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/protocol/HashPrefix.h>
 #include <ripple/unity/rocksdb.h>
 #include <boost/algorithm/string.hpp>
 #include <atomic>
@@ -138,6 +139,53 @@ public:
     }
 };
 
+// Like Sequence, but half of the tree nodes are inner nodes, so that
+// backends which store them apart from leaves get a realistic mix
+class TreeSequence
+{
+private:
+    enum { minSize = 250, maxSize = 1250, innerSize = 516 };
+
+    beast::xor_shift_engine gen_;
+    std::uint8_t prefix_;
+    std::discrete_distribution<std::uint32_t> d_type_;
+    std::uniform_int_distribution<std::uint32_t> d_size_;
+
+public:
+    explicit TreeSequence(std::uint8_t prefix)
+        : prefix_(prefix), d_type_({1, 1, 0, 1, 1}), d_size_(minSize, maxSize)
+    {
+    }
+
+    // Returns the n-th complete NodeObject
+    std::shared_ptr<NodeObject>
+    obj(std::size_t n)
+    {
+        gen_.seed(n + 1);
+        uint256 key;
+        auto const data = static_cast<std::uint8_t*>(&*key.begin());
+        *data = prefix_;
+        rngcpy(data + 1, key.size() - 1, gen_);
+        auto const type = safe_cast<NodeObjectType>(d_type_(gen_));
+        // An inner node is a prefix and 16 hashes
+        bool const inner =
+            (type == hotACCOUNT_NODE || type == hotTRANSACTION_NODE) &&
+            (gen_() & 1);
+        Blob value(inner ? innerSize : d_size_(gen_));
+        rngcpy(&value[0], value.size(), gen_);
+        if (inner)
+        {
+            auto const prefix =
+                static_cast<std::uint32_t>(HashPrefix::innerNode);
+            value[0] = static_cast<std::uint8_t>(prefix >> 24);
+            value[1] = static_cast<std::uint8_t>(prefix >> 16);
+            value[2] = static_cast<std::uint8_t>(prefix >> 8);
+            value[3] = static_cast<std::uint8_t>(prefix);
+        }
+        return NodeObject::createObject(type, std::move(value), key);
+    }
+};
+
 //----------------------------------------------------------------------------------
 
 class Timing_test : public beast::unit_test::suite
@@ -265,6 +313,7 @@ public:
     //--------------------------------------------------------------------------
 
     // Insert only
+    template <class Generator, std::uint8_t prefix>
     void
     do_insert(
         Section const& config,
@@ -281,11 +330,11 @@ public:
         private:
             suite& suite_;
             Backend& backend_;
-            Sequence seq_;
+            Generator seq_;
 
         public:
             explicit Body(suite& s, Backend& backend)
-                : suite_(s), backend_(backend), seq_(1)
+                : suite_(s), backend_(backend), seq_(prefix)
             {
             }
 
@@ -392,6 +441,97 @@ public:
         backend->close();
     }
 
+    // Fetch existing keys in batches, from the objects written by the
+    // InsertTree test
+    void
+    do_fetch_batch(
+        Section const& config,
+        Params const& params,
+        beast::Journal journal)
+    {
+        DummyScheduler scheduler;
+        auto backend = make_Backend(config, scheduler, journal);
+        BEAST_EXPECT(backend != nullptr);
+        backend->open();
+
+        class Body
+        {
+        private:
+            enum { batchSize = 64 };
+
+            suite& suite_;
+            Backend& backend_;
+            TreeSequence seq3_;
+            beast::xor_shift_engine gen_;
+            std::uniform_int_distribution<std::size_t> dist_;
+
+        public:
+            Body(
+                std::size_t id,
+                suite& s,
+                Params const& params,
+                Backend& backend)
+                : suite_(s)
+                , backend_(backend)
+                , seq3_(3)
+                , gen_(id + 1)
+                , dist_(0, params.items - 1)
+            {
+            }
+
+            void
+            operator()(std::size_t i)
+            {
+                // Each call covers a batch worth of the items
+                if (i % batchSize != 0)
+                    return;
+                try
+                {
+                    Batch objs;
+                    std::vector<uint256> hashes;
+                    std::vector<uint256 const*> pointers;
+                    objs.reserve(batchSize);
+                    hashes.reserve(batchSize);
+                    pointers.reserve(batchSize);
+                    for (std::size_t j = 0; j < batchSize; ++j)
+                    {
+                        objs.emplace_back(seq3_.obj(dist_(gen_)));
+                        hashes.push_back(objs.back()->getHash());
+                        pointers.push_back(&hashes.back());
+                    }
+                    auto const [results, status] =
+                        backend_.fetchBatch(pointers);
+                    suite_.expect(status == ok);
+                    suite_.expect(results.size() == objs.size());
+                    for (std::size_t j = 0; j < results.size(); ++j)
+                        suite_.expect(
+                            results[j] && isSame(results[j], objs[j]));
+                }
+                catch (std::exception const& e)
+                {
+                    suite_.fail(e.what());
+                }
+            }
+        };
+        try
+        {
+            parallel_for_id<Body>(
+                params.items,
+                params.threads,
+                std::ref(*this),
+                std::ref(params),
+                std::ref(*backend));
+        }
+        catch (std::exception const&)
+        {
+#if NODESTORE_TIMING_DO_VERIFY
+            backend->verify();
+#endif
+            Rethrow();
+        }
+        backend->close();
+    }
+
     // Perform lookups of non-existent keys
     void
     do_missing(
@@ -749,6 +889,8 @@ public:
 #if RIPPLE_ROCKSDB_AVAILABLE
             ";type=rocksdb,open_files=2000,filter_bits=12,cache_mb=256,"
             "file_size_mb=8,file_size_mult=2"
+            ";type=rocksdb,column_families=1,open_files=2000,cache_mb=256,"
+            "file_size_mb=8,file_size_mult=2"
 #endif
 #if 0
             ";type=memory|path=NodeStore"
@@ -756,8 +898,10 @@ public:
             ;
 
         test_list const tests = {
-            {"Insert", &Timing_test::do_insert},
+            {"Insert", &Timing_test::do_insert<Sequence, 1>},
             {"Fetch", &Timing_test::do_fetch},
+            {"InsertTree", &Timing_test::do_insert<TreeSequence, 3>},
+            {"FetchBatch", &Timing_test::do_fetch_batch},
             {"Missing", &Timing_test::do_missing},
             {"Mixed", &Timing_test::do_mixed},
             {"Work", &Timing_test::do_work}};
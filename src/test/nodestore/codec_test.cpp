@@ -0,0 +1,591 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/beast/rfc2616.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/DecodedBlob.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/ZstdDictionaries.h>
+#include <ripple/nodestore/impl/codec.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/protocol/Serializer.h>
+#include <ripple/protocol/digest.h>
+#include <ripple/shamap/SHAMapTreeNode.h>
+#include <test/nodestore/TestBase.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <array>
+#include <chrono>
+#include <nudb/detail/buffer.hpp>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+Blob
+encode(std::shared_ptr<NodeObject> const& object)
+{
+    EncodedBlob e;
+    e.prepare(object);
+    auto const p = static_cast<std::uint8_t const*>(e.getData());
+    return Blob(p, p + e.getSize());
+}
+
+bool
+isInner(Blob const& blob)
+{
+    return blob.size() == 525 &&
+        std::equal(blob.begin() + 9, blob.begin() + 13, "MIN\0");
+}
+
+}  // namespace
+
+// Tests compressing node objects with zstd dictionaries
+//
+class codec_test : public TestBase
+{
+    // Objects which, like real ones, share a layout and differ in a few
+    // fields.
+    static std::shared_ptr<NodeObject>
+    makeObject(NodeObjectType type, beast::xor_shift_engine& rng)
+    {
+        auto random = [&rng](Serializer& s, int bytes) {
+            while (bytes--)
+                s.add8(static_cast<unsigned char>(rng()));
+        };
+
+        Serializer s;
+        s.add32(
+            type == hotTRANSACTION_NODE ? HashPrefix::txNode
+                                        : HashPrefix::leafNode);
+        s.add16(type == hotTRANSACTION_NODE ? 0x1200 : 0x1100);
+        s.add16(0x0061);
+        s.add32(0x22000000);
+        s.add32(rng() % 100000);
+        s.add16(0x2400);
+        s.add64(0x4000000000000000ull | (rng() % 100000000000ull));
+        s.add16(0x8114);
+        random(s, 20);
+        if (type == hotTRANSACTION_NODE)
+        {
+            s.add32(0x201B0000);
+            s.add32(0x73210000);
+            random(s, 33);
+            s.add32(0x74473045);
+            random(s, 70);
+        }
+        random(s, 32);
+        auto const hash = sha512Half(s.slice());
+        return NodeObject::createObject(type, std::move(s.modData()), hash);
+    }
+
+    static std::vector<Blob>
+    makeSamples(std::size_t count, beast::xor_shift_engine& rng)
+    {
+        std::vector<Blob> samples;
+        samples.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto const type = (i % 2) ? hotTRANSACTION_NODE : hotACCOUNT_NODE;
+            samples.push_back(encode(makeObject(type, rng)));
+        }
+        return samples;
+    }
+
+    void
+    testDictionaries()
+    {
+        testcase("dictionaries");
+
+        beast::xor_shift_engine rng(71);
+        ZstdDictionaries const dictionaries(
+            ZstdDictionaries::train(makeSamples(4000, rng), 8192));
+        ZstdDictionaries const plain(ZstdDictionaries::train({}));
+        BEAST_EXPECT(dictionaries.id() != plain.id());
+
+        // Round trip with each codec and compare the sizes
+        std::size_t lz4Size = 0;
+        std::size_t plainSize = 0;
+        std::size_t zstdSize = 0;
+        for (auto const& sample : makeSamples(1000, rng))
+        {
+            auto check = [&](ZstdDictionaries const* dicts) {
+                nudb::detail::buffer bf;
+                auto const out = nodeobject_compress(
+                    sample.data(), sample.size(), bf, dicts);
+                BEAST_EXPECT(
+                    *static_cast<std::uint8_t const*>(out.first) ==
+                    (dicts ? 4 : 1));
+                nudb::detail::buffer bf2;
+                auto const in =
+                    nodeobject_decompress(out.first, out.second, bf2, dicts);
+                BEAST_EXPECT(
+                    in.second == sample.size() &&
+                    std::memcmp(in.first, sample.data(), in.second) == 0);
+                return out.second;
+            };
+            lz4Size += check(nullptr);
+            plainSize += check(&plain);
+            zstdSize += check(&dictionaries);
+        }
+        log << "lz4 " << lz4Size << " bytes, zstd " << plainSize
+            << " bytes, zstd with dictionaries " << zstdSize << " bytes"
+            << std::endl;
+        BEAST_EXPECT(zstdSize < plainSize);
+        BEAST_EXPECT(zstdSize < lz4Size);
+
+        // Inner nodes keep their compact encoding
+        {
+            Blob inner(525);
+            inner[8] = hotACCOUNT_NODE;
+            std::memcpy(inner.data() + 9, "MIN\0", 4);
+            std::fill(inner.begin() + 13, inner.begin() + 45, 0xAB);
+            nudb::detail::buffer bf;
+            auto const out = nodeobject_compress(
+                inner.data(), inner.size(), bf, &dictionaries);
+            BEAST_EXPECT(*static_cast<std::uint8_t const*>(out.first) == 2);
+        }
+
+        // zstd objects can't be read without the dictionaries
+        {
+            auto const sample = encode(makeObject(hotACCOUNT_NODE, rng));
+            nudb::detail::buffer bf;
+            auto const out = nodeobject_compress(
+                sample.data(), sample.size(), bf, &dictionaries);
+            nudb::detail::buffer bf2;
+            try
+            {
+                nodeobject_decompress(out.first, out.second, bf2);
+                fail();
+            }
+            catch (std::runtime_error const&)
+            {
+                pass();
+            }
+        }
+
+        // Malformed dictionaries are rejected
+        auto rejects = [this](std::string contents) {
+            try
+            {
+                ZstdDictionaries const d(std::move(contents));
+                fail();
+            }
+            catch (std::runtime_error const&)
+            {
+                pass();
+            }
+        };
+        rejects("");
+        rejects(dictionaries.contents().substr(1));
+        rejects(dictionaries.contents().substr(
+            0, dictionaries.contents().size() - 1));
+        rejects(dictionaries.contents() + '\0');
+    }
+
+    void
+    testNuDB()
+    {
+        testcase("NuDB with zstd");
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("codec_test", *this);
+        beast::temp_dir tempDir;
+        beast::xor_shift_engine rng(72);
+
+        ZstdDictionaries const dictionaries(
+            ZstdDictionaries::train(makeSamples(4000, rng), 8192));
+        dictionaries.save(tempDir.file("dictionaries"));
+
+        Section lz4;
+        lz4.set("type", "nudb");
+        Section zstd = lz4;
+        zstd.set("compression", "zstd");
+        zstd.set("dictionaries", tempDir.file("dictionaries"));
+
+        auto const check = [&](Section params,
+                               std::string const& path,
+                               Batch const& batch) {
+            params.set("path", path);
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open(false);
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        };
+
+        std::array<Batch, 2> batches;
+        for (auto& batch : batches)
+        {
+            batch = createPredictableBatch(100, rng());
+            for (int i = 0; i < 400; ++i)
+                batch.push_back(makeObject(
+                    i % 2 ? hotTRANSACTION_NODE : hotACCOUNT_NODE, rng));
+        }
+
+        // A new database uses the configured dictionaries and keeps a copy
+        auto const zstdPath = tempDir.file("zstd");
+        {
+            Section params = zstd;
+            params.set("path", zstdPath);
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, batches[0]);
+        }
+        BEAST_EXPECT(boost::filesystem::exists(
+            boost::filesystem::path(zstdPath) / "nudb.dict"));
+        check(lz4, zstdPath, batches[0]);
+        check(zstd, zstdPath, batches[0]);
+
+        // An existing database keeps the codec it was created with
+        auto const lz4Path = tempDir.file("lz4");
+        {
+            Section params = lz4;
+            params.set("path", lz4Path);
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, batches[1]);
+        }
+        check(zstd, lz4Path, batches[1]);
+        BEAST_EXPECT(!boost::filesystem::exists(
+            boost::filesystem::path(lz4Path) / "nudb.dict"));
+
+        // A database whose dictionaries are lost can't be opened
+        boost::filesystem::remove(
+            boost::filesystem::path(zstdPath) / "nudb.dict");
+        try
+        {
+            check(lz4, zstdPath, batches[0]);
+            fail();
+        }
+        catch (std::runtime_error const&)
+        {
+            pass();
+        }
+    }
+
+    void
+    testDecode()
+    {
+        testcase("decode in place");
+
+        beast::xor_shift_engine rng(73);
+        ZstdDictionaries const plain(ZstdDictionaries::train({}));
+
+        auto makeInner = [](int branches) {
+            Blob inner(525);
+            inner[8] = hotUNKNOWN;
+            std::memcpy(inner.data() + 9, "MIN\0", 4);
+            for (int i = 0; i < branches; ++i)
+                std::fill_n(inner.begin() + 13 + 32 * i, 32, 0x10 + i);
+            return inner;
+        };
+
+        // Decode the way a backend fetch does, counting the buffers the
+        // codec allocates, and check that the object takes over that
+        // buffer instead of copying it.
+        auto check = [&](Blob const& sample,
+                         ZstdDictionaries const* dicts,
+                         bool compressed) {
+            Blob stored;
+            if (compressed)
+            {
+                nudb::detail::buffer bf;
+                auto const out = nodeobject_compress(
+                    sample.data(), sample.size(), bf, dicts);
+                auto const p = static_cast<std::uint8_t const*>(out.first);
+                stored.assign(p, p + out.second);
+            }
+            else
+            {
+                stored.push_back(0);
+                stored.insert(stored.end(), sample.begin(), sample.end());
+            }
+
+            auto const key = sha512Half(makeSlice(sample));
+            Blob buffer;
+            int allocations = 0;
+            auto const result = nodeobject_decompress(
+                stored.data(),
+                stored.size(),
+                [&](std::size_t n) {
+                    ++allocations;
+                    buffer.resize(n);
+                    return buffer.data();
+                },
+                dicts);
+            BEAST_EXPECT(allocations == (compressed ? 1 : 0));
+
+            DecodedBlob decoded(key.data(), result.first, result.second);
+            if (!BEAST_EXPECT(decoded.wasOk()))
+                return;
+            auto const storage = buffer.data();
+            auto const object = decoded.createObject(std::move(buffer));
+            if (!BEAST_EXPECT(object))
+                return;
+            BEAST_EXPECT(
+                (object->getData().data() == storage + 9) == compressed);
+            BEAST_EXPECT(object->getHash() == key);
+            BEAST_EXPECT(makeSlice(sample) + 9 == object->getData());
+
+            auto const same = nodeobject_decode(
+                key.data(), stored.data(), stored.size(), dicts);
+            BEAST_EXPECT(
+                same && same->getType() == object->getType() &&
+                same->getData() == object->getData());
+
+            // Tree nodes parsed from the data serialize back to it
+            auto const node = SHAMapTreeNode::makeFromPrefix(
+                object->getData(), SHAMapHash{key});
+            Serializer s;
+            node->serializeWithPrefix(s);
+            BEAST_EXPECT(s.slice() == object->getData());
+        };
+
+        check(makeInner(3), nullptr, true);
+        check(makeInner(16), nullptr, true);
+        for (auto const type : {hotACCOUNT_NODE, hotTRANSACTION_NODE})
+        {
+            auto const sample = encode(makeObject(type, rng));
+            check(sample, nullptr, true);
+            check(sample, &plain, true);
+            check(sample, nullptr, false);
+        }
+
+        // Corrupt values decode to nothing
+        Blob corrupt{0, 1, 2, 3};
+        BEAST_EXPECT(!nodeobject_decode(
+            corrupt.data(), corrupt.data(), corrupt.size(), nullptr));
+    }
+
+public:
+    void
+    run() override
+    {
+        testDictionaries();
+        testNuDB();
+        testDecode();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Trains dictionaries on an existing database and compares the codecs
+//
+class codec_benchmark_test : public beast::unit_test::suite
+{
+    enum Kind { accountState, transaction, inner, other, kinds };
+
+    static constexpr char const* names[kinds] = {
+        "account state",
+        "transaction",
+        "inner node",
+        "other"};
+
+    struct Result
+    {
+        std::size_t count = 0;
+        std::size_t raw = 0;
+        std::size_t compressed = 0;
+        std::chrono::nanoseconds decode{};
+    };
+
+    static Kind
+    kind(Blob const& blob)
+    {
+        if (isInner(blob))
+            return inner;
+        switch (ZstdDictionaries::kind(blob.data(), blob.size()))
+        {
+            case ZstdDictionaries::accountState:
+                return accountState;
+            case ZstdDictionaries::transaction:
+                return transaction;
+            default:
+                return other;
+        }
+    }
+
+    std::array<Result, kinds>
+    measure(std::vector<Blob> const& objects, ZstdDictionaries const* dicts)
+    {
+        using clock_type = std::chrono::steady_clock;
+        std::array<Result, kinds> results;
+        nudb::detail::buffer bf;
+        nudb::detail::buffer bf2;
+        for (auto const& object : objects)
+        {
+            auto& result = results[kind(object)];
+            auto const out =
+                nodeobject_compress(object.data(), object.size(), bf, dicts);
+            auto const start = clock_type::now();
+            auto const in =
+                nodeobject_decompress(out.first, out.second, bf2, dicts);
+            result.decode += clock_type::now() - start;
+            if (in.second != object.size())
+                Throw<std::runtime_error>("codec benchmark: size mismatch");
+            ++result.count;
+            result.raw += object.size();
+            result.compressed += out.second;
+        }
+        return results;
+    }
+
+    void
+    report(std::string const& codec, std::array<Result, kinds> const& results)
+    {
+        Result total;
+        for (int k = 0; k < kinds; ++k)
+        {
+            auto const& r = results[k];
+            total.count += r.count;
+            total.raw += r.raw;
+            total.compressed += r.compressed;
+            total.decode += r.decode;
+            if (r.count == 0)
+                continue;
+            log << codec << ", " << names[k] << ": " << r.count
+                << " objects, " << r.raw << " bytes, " << r.compressed
+                << " compressed (" << (100.0 * r.compressed / r.raw)
+                << "%), " << (r.decode.count() / r.count)
+                << "ns per decode" << std::endl;
+        }
+        if (total.count == 0)
+            return;
+        log << codec << ", total: " << total.count << " objects, "
+            << total.raw << " bytes, " << total.compressed << " compressed ("
+            << (100.0 * total.compressed / total.raw) << "%), "
+            << (total.decode.count() / total.count) << "ns per decode"
+            << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        testcase(beast::unit_test::abort_on_fail) << arg();
+
+        std::map<std::string, std::string> args;
+        auto const& argument = arg();
+        for (auto const& kv :
+             beast::rfc2616::split(argument.begin(), argument.end(), ','))
+        {
+            auto const eq = kv.find('=');
+            if (eq != std::string::npos)
+                args[kv.substr(0, eq)] = kv.substr(eq + 1);
+        }
+
+        if (args.find("path") == args.end())
+        {
+            log << "Usage:\n"
+                << "--unittest-arg=path=<path>[,samples=<n>][,objects=<n>]"
+                   "[,size=<bytes>][,save=<file>]\n"
+                << "path:    NuDB database to read\n"
+                << "samples: Objects to train on (default 100000)\n"
+                << "objects: Other objects to measure (default 100000)\n"
+                << "size:    Largest size of each dictionary (default "
+                << ZstdDictionaries::defaultSize << ")\n"
+                << "save:    File to write the trained dictionaries to"
+                << std::endl;
+            pass();
+            return;
+        }
+
+        auto const number = [&args](std::string const& key, std::size_t dflt) {
+            auto const it = args.find(key);
+            return it == args.end() ? dflt : std::stoull(it->second);
+        };
+        auto const samples = number("samples", 100000);
+        auto const objects = number("objects", 100000);
+        auto const size = number("size", ZstdDictionaries::defaultSize);
+
+        // Draw a uniform sample of the database
+        std::vector<Blob> reservoir;
+        reservoir.reserve(samples + objects);
+        {
+            DummyScheduler scheduler;
+            test::SuiteJournal journal("codec_benchmark", *this);
+            Section params;
+            params.set("type", "nudb");
+            params.set("path", args["path"]);
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open(false);
+
+            beast::xor_shift_engine rng;
+            std::size_t seen = 0;
+            backend->for_each([&](std::shared_ptr<NodeObject> object) {
+                auto const i = rng() % (seen + 1);
+                if (reservoir.size() < samples + objects)
+                    reservoir.push_back(encode(object));
+                else if (i < reservoir.size())
+                    reservoir[i] = encode(object);
+                ++seen;
+            });
+            log << "Sampled " << reservoir.size() << " of " << seen
+                << " objects" << std::endl;
+        }
+        if (reservoir.size() <= samples)
+        {
+            log << "Not enough objects to measure" << std::endl;
+            fail();
+            return;
+        }
+
+        std::vector<Blob> const training(
+            reservoir.begin(), reservoir.begin() + samples);
+        std::vector<Blob> const measured(
+            reservoir.begin() + samples, reservoir.end());
+        reservoir.clear();
+
+        auto const start = std::chrono::steady_clock::now();
+        ZstdDictionaries const dictionaries(
+            ZstdDictionaries::train(training, size));
+        log << "Trained dictionaries in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count()
+            << "ms, " << dictionaries.contents().size() << " bytes"
+            << std::endl;
+
+        ZstdDictionaries const plain(ZstdDictionaries::train({}));
+        report("lz4", measure(measured, nullptr));
+        report("zstd", measure(measured, &plain));
+        report("zstd with dictionaries", measure(measured, &dictionaries));
+
+        if (auto const it = args.find("save"); it != args.end())
+        {
+            dictionaries.save(it->second);
+            log << "Saved dictionaries to " << it->second << std::endl;
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(codec, NodeStore, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(codec_benchmark, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/overlay/impl/IngestQueue.h>
+#include <ripple/overlay/impl/Tuning.h>
+#include <test/jtx.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class IngestQueue_test : public beast::unit_test::suite
+{
+    void
+    testBatches()
+    {
+        testcase("batches");
+
+        jtx::Env env(*this);
+        auto& jobQueue = env.app().getJobQueue();
+
+        std::mutex mutex;
+        std::vector<int> seen;
+        std::size_t largest = 0;
+        IngestQueue<int> queue(
+            jobQueue,
+            jtVALIDATION_ut,
+            "IngestQueue_test",
+            Tuning::ingestBatchSize,
+            [&](std::vector<int>& batch) {
+                std::lock_guard lock(mutex);
+                largest = std::max(largest, batch.size());
+                seen.insert(seen.end(), batch.begin(), batch.end());
+            });
+
+        int constexpr count = 1000;
+        for (int i = 0; i < count; ++i)
+            queue.push(int{i});
+        jobQueue.rendezvous();
+
+        BEAST_EXPECT(queue.size() == 0);
+        BEAST_EXPECT(seen.size() == count);
+        BEAST_EXPECT(largest <= Tuning::ingestBatchSize);
+        BEAST_EXPECT(std::set<int>(seen.begin(), seen.end()).size() == count);
+
+        // Items pushed after the queue drained are still handled
+        queue.push(int{count});
+        jobQueue.rendezvous();
+        BEAST_EXPECT(seen.size() == count + 1);
+    }
+
+    void
+    testConcurrentPush()
+    {
+        testcase("concurrent push");
+
+        jtx::Env env(*this);
+        auto& jobQueue = env.app().getJobQueue();
+
+        std::atomic<std::size_t> handled{0};
+        IngestQueue<int> queue(
+            jobQueue,
+            jtPROPOSAL_ut,
+            "IngestQueue_test",
+            4,
+            [&](std::vector<int>& batch) { handled += batch.size(); });
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&queue] {
+                for (int i = 0; i < 250; ++i)
+                    queue.push(int{i});
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+        jobQueue.rendezvous();
+
+        BEAST_EXPECT(handled == 1000);
+        BEAST_EXPECT(queue.size() == 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testBatches();
+        testConcurrentPush();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(IngestQueue, overlay, ripple);
+
+}  // namespace test
+}  // namespace ripple
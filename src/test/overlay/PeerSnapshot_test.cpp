@@ -0,0 +1,247 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/impl/PeerSnapshot.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class PeerSnapshot_test : public beast::unit_test::suite
+{
+protected:
+    struct TestPeer
+    {
+        std::uint32_t id_;
+        std::atomic<std::uint64_t> sent{0};
+
+        explicit TestPeer(std::uint32_t id) : id_(id)
+        {
+        }
+
+        std::uint32_t
+        id() const
+        {
+            return id_;
+        }
+
+        void
+        send()
+        {
+            sent.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    void
+    testInsertErase()
+    {
+        testcase("insert and erase");
+
+        PeerSnapshot<TestPeer> snapshot;
+        BEAST_EXPECT(snapshot.size() == 0);
+
+        auto const a = std::make_shared<TestPeer>(1);
+        auto const b = std::make_shared<TestPeer>(2);
+        snapshot.insert(a);
+        snapshot.insert(b);
+        snapshot.insert(a);
+        BEAST_EXPECT(snapshot.size() == 2);
+
+        snapshot.erase(std::uint32_t{1});
+        snapshot.erase(std::uint32_t{3});
+        BEAST_EXPECT(snapshot.size() == 1);
+        BEAST_EXPECT(snapshot.load()->front() == b);
+
+        // The snapshot no longer keeps the erased peer alive
+        BEAST_EXPECT(a.use_count() == 1);
+    }
+
+    void
+    testStability()
+    {
+        testcase("stability");
+
+        PeerSnapshot<TestPeer> snapshot;
+        std::weak_ptr<TestPeer> weak;
+        {
+            auto const peer = std::make_shared<TestPeer>(1);
+            weak = peer;
+            snapshot.insert(peer);
+        }
+
+        // A list loaded before a change is not affected by it, and keeps
+        // its peers alive until it is released.
+        auto const before = snapshot.load();
+        snapshot.erase(std::uint32_t{1});
+        snapshot.insert(std::make_shared<TestPeer>(2));
+        BEAST_EXPECT(before->size() == 1);
+        BEAST_EXPECT(before->front()->id() == 1);
+        BEAST_EXPECT(!weak.expired());
+        BEAST_EXPECT(snapshot.load()->front()->id() == 2);
+    }
+
+    void
+    testConcurrent()
+    {
+        testcase("concurrent");
+
+        PeerSnapshot<TestPeer> snapshot;
+        std::vector<std::shared_ptr<TestPeer>> peers;
+        for (std::uint32_t i = 0; i < 64; ++i)
+            peers.push_back(std::make_shared<TestPeer>(i));
+
+        std::atomic<bool> done{false};
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; ++i)
+        {
+            readers.emplace_back([&] {
+                while (!done)
+                    snapshot.for_each(
+                        [](std::shared_ptr<TestPeer> const& p) { p->send(); });
+            });
+        }
+
+        for (int round = 0; round < 100; ++round)
+        {
+            for (auto const& p : peers)
+                snapshot.insert(p);
+            for (auto const& p : peers)
+                snapshot.erase(p->id());
+        }
+        done = true;
+        for (auto& t : readers)
+            t.join();
+
+        BEAST_EXPECT(snapshot.size() == 0);
+        for (auto const& p : peers)
+            BEAST_EXPECT(p.use_count() == 1);
+    }
+
+public:
+    void
+    run() override
+    {
+        testInsertErase();
+        testStability();
+        testConcurrent();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Cost of relaying one message to every peer, by number of peers and of
+// threads relaying at once: the snapshot, against a locked map of weak_ptr
+// copied and promoted on every relay.
+class PeerSnapshot_benchmark_test : public PeerSnapshot_test
+{
+    struct LockedMap
+    {
+        mutable std::recursive_mutex mutex_;
+        hash_map<std::uint32_t, std::weak_ptr<TestPeer>> ids_;
+
+        template <class UnaryFunc>
+        void
+        for_each(UnaryFunc&& f) const
+        {
+            std::vector<std::weak_ptr<TestPeer>> wp;
+            {
+                std::lock_guard lock(mutex_);
+                wp.reserve(ids_.size());
+                for (auto& x : ids_)
+                    wp.push_back(x.second);
+            }
+            for (auto& w : wp)
+            {
+                if (auto p = w.lock())
+                    f(std::move(p));
+            }
+        }
+    };
+
+    template <class Peers>
+    std::chrono::nanoseconds
+    relay(Peers const& peers, int threads, int iterations)
+    {
+        std::vector<std::thread> workers;
+        auto const start = std::chrono::steady_clock::now();
+        for (int i = 0; i < threads; ++i)
+        {
+            workers.emplace_back([&] {
+                for (int n = 0; n < iterations; ++n)
+                    peers.for_each(
+                        [](std::shared_ptr<TestPeer> const& p) { p->send(); });
+            });
+        }
+        for (auto& t : workers)
+            t.join();
+        return std::chrono::steady_clock::now() - start;
+    }
+
+    void
+    measure(std::size_t count, int threads)
+    {
+        int constexpr iterations = 2000;
+
+        std::vector<std::shared_ptr<TestPeer>> peers;
+        PeerSnapshot<TestPeer> snapshot;
+        LockedMap locked;
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            peers.push_back(std::make_shared<TestPeer>(i));
+            snapshot.insert(peers.back());
+            locked.ids_.emplace(i, peers.back());
+        }
+
+        auto const a = relay(snapshot, threads, iterations);
+        auto const b = relay(locked, threads, iterations);
+
+        std::uint64_t sent = 0;
+        for (auto const& p : peers)
+            sent += p->sent;
+        BEAST_EXPECT(sent == 2ull * count * threads * iterations);
+
+        auto const relays = std::int64_t{threads} * iterations;
+        log << count << " peers, " << threads << " threads: "
+            << a.count() / relays << "ns snapshot, " << b.count() / relays
+            << "ns locked" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        for (int threads : {1, 4})
+            for (std::size_t count : {10, 50, 100, 200, 500})
+                measure(count, threads);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(PeerSnapshot, overlay, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(PeerSnapshot_benchmark, overlay, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,343 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/overlay/Message.h>
+#include <ripple/overlay/impl/ProtocolMessage.h>
+#include <boost/asio/buffer.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ripple.pb.h>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+namespace test {
+
+class ProtocolMessage_test : public beast::unit_test::suite
+{
+protected:
+    using Compressed = compression::Compressed;
+
+    static std::string
+    randomBytes(beast::xor_shift_engine& rng, std::size_t size)
+    {
+        std::string s(size, 0);
+        std::generate(s.begin(), s.end(), [&] { return char(rng()); });
+        return s;
+    }
+
+    static protocol::TMTransaction
+    makeTransaction(beast::xor_shift_engine& rng)
+    {
+        protocol::TMTransaction m;
+        m.set_rawtransaction(randomBytes(rng, 250));
+        m.set_status(protocol::tsNEW);
+        m.set_receivetimestamp(1);
+        return m;
+    }
+
+    static protocol::TMValidation
+    makeValidation(beast::xor_shift_engine& rng)
+    {
+        protocol::TMValidation m;
+        m.set_validation(randomBytes(rng, 300));
+        return m;
+    }
+
+    static protocol::TMProposeSet
+    makeProposal(beast::xor_shift_engine& rng)
+    {
+        protocol::TMProposeSet m;
+        m.set_proposeseq(1);
+        m.set_currenttxhash(randomBytes(rng, 32));
+        m.set_nodepubkey(randomBytes(rng, 33));
+        m.set_closetime(1);
+        m.set_signature(randomBytes(rng, 72));
+        m.set_previousledger(randomBytes(rng, 32));
+        return m;
+    }
+
+    // Ledger data of node IDs and nodes compresses well, as on the wire
+    static protocol::TMLedgerData
+    makeLedgerData(beast::xor_shift_engine& rng, int nodes)
+    {
+        protocol::TMLedgerData m;
+        m.set_ledgerhash(randomBytes(rng, 32));
+        m.set_ledgerseq(1);
+        m.set_type(protocol::liAS_NODE);
+        auto const node = randomBytes(rng, 200);
+        for (int i = 0; i < nodes; ++i)
+        {
+            auto n = m.add_nodes();
+            n->set_nodeid(std::string(33, char(i)));
+            n->set_nodedata(node);
+        }
+        return m;
+    }
+
+    // The wire bytes of a message, followed by the start of another one
+    static std::vector<std::uint8_t>
+    wire(
+        ::google::protobuf::Message const& m,
+        protocol::MessageType type,
+        Compressed compressed)
+    {
+        Message msg(m, type);
+        auto bytes = msg.getBuffer(compressed);
+        bytes.insert(bytes.end(), 16, 0x01);
+        return bytes;
+    }
+
+    // Split bytes into a sequence of small buffers
+    static std::vector<boost::asio::const_buffer>
+    fragment(std::vector<std::uint8_t> const& bytes, std::size_t size)
+    {
+        std::vector<boost::asio::const_buffer> buffers;
+        for (std::size_t i = 0; i < bytes.size(); i += size)
+            buffers.emplace_back(
+                bytes.data() + i, std::min(size, bytes.size() - i));
+        return buffers;
+    }
+
+    template <class T, class Buffers>
+    std::shared_ptr<T>
+    parse(Buffers const& buffers, bool compressed)
+    {
+        boost::system::error_code ec;
+        auto const header = detail::parseMessageHeader(
+            ec, buffers, boost::asio::buffer_size(buffers));
+        if (!BEAST_EXPECT(header))
+            return {};
+        BEAST_EXPECT(
+            (header->algorithm != compression::Algorithm::None) ==
+            compressed);
+        return detail::parseMessageContent<T>(*header, buffers);
+    }
+
+    template <class T>
+    void
+    check(T const& m, protocol::MessageType type, bool compress)
+    {
+        auto const bytes = wire(m, type, compress ? Compressed::On
+                                                  : Compressed::Off);
+        auto const expected = m.SerializeAsString();
+
+        // Contiguous
+        {
+            std::vector<boost::asio::const_buffer> buffers{
+                boost::asio::buffer(bytes)};
+            auto const p = parse<T>(buffers, compress);
+            if (BEAST_EXPECT(p))
+            {
+                BEAST_EXPECT(p->GetArena() != nullptr);
+                BEAST_EXPECT(p->SerializeAsString() == expected);
+            }
+        }
+
+        // Split across buffers, as in a multi_buffer
+        for (std::size_t size : {7, 64, 1000})
+        {
+            auto const p = parse<T>(fragment(bytes, size), compress);
+            if (BEAST_EXPECT(p))
+                BEAST_EXPECT(p->SerializeAsString() == expected);
+        }
+    }
+
+private:
+    void
+    testParse()
+    {
+        testcase("parse");
+
+        beast::xor_shift_engine rng(42);
+
+        check(makeTransaction(rng), protocol::mtTRANSACTION, false);
+        check(makeValidation(rng), protocol::mtVALIDATION, false);
+        check(makeProposal(rng), protocol::mtPROPOSE_LEDGER, false);
+        check(makeLedgerData(rng, 10), protocol::mtLEDGER_DATA, false);
+        check(makeLedgerData(rng, 500), protocol::mtLEDGER_DATA, true);
+    }
+
+    void
+    testLifetime()
+    {
+        testcase("lifetime");
+
+        beast::xor_shift_engine rng(7);
+        auto const m = makeLedgerData(rng, 100);
+
+        std::shared_ptr<protocol::TMLedgerData> p;
+        {
+            auto const bytes =
+                wire(m, protocol::mtLEDGER_DATA, Compressed::Off);
+            std::vector<boost::asio::const_buffer> buffers{
+                boost::asio::buffer(bytes)};
+            p = parse<protocol::TMLedgerData>(buffers, false);
+        }
+
+        // The message owns its arena, and outlives the received bytes
+        if (BEAST_EXPECT(p))
+        {
+            BEAST_EXPECT(p->nodes_size() == 100);
+            BEAST_EXPECT(p->SerializeAsString() == m.SerializeAsString());
+            std::weak_ptr<protocol::TMLedgerData> weak = p;
+            p.reset();
+            BEAST_EXPECT(weak.expired());
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        testParse();
+        testLifetime();
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Allocations and time to parse each message type, with and without an arena
+class ProtocolMessage_benchmark_test : public ProtocolMessage_test
+{
+    static inline std::atomic<std::size_t> blocks_{0};
+
+    static void*
+    countingAlloc(std::size_t size)
+    {
+        ++blocks_;
+        return std::malloc(size);
+    }
+
+    static void
+    countingDealloc(void* p, std::size_t)
+    {
+        std::free(p);
+    }
+
+    template <class T>
+    void
+    measure(
+        char const* name,
+        T const& m,
+        protocol::MessageType type,
+        Compressed compressed)
+    {
+        using namespace std::chrono;
+        int constexpr iterations = 10000;
+
+        auto const bytes = wire(m, type, compressed);
+        std::vector<boost::asio::const_buffer> buffers{
+            boost::asio::buffer(bytes)};
+
+        boost::system::error_code ec;
+        auto const header =
+            detail::parseMessageHeader(ec, buffers, bytes.size());
+        if (!BEAST_EXPECT(header))
+            return;
+
+        auto options = detail::arenaOptions(header->uncompressed_size);
+        options.block_alloc = &countingAlloc;
+        options.block_dealloc = &countingDealloc;
+
+        blocks_ = 0;
+        auto const start = steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+            BEAST_EXPECT(
+                detail::parseMessageContent<T>(*header, buffers, options));
+        auto const arena = steady_clock::now() - start;
+
+        // Without an arena, every object and string is a heap allocation
+        auto const heapStart = steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto const p = std::make_shared<T>();
+            ZeroCopyInputStream<decltype(buffers)> stream(buffers);
+            stream.Skip(header->header_size);
+            if (compressed == Compressed::On)
+            {
+                std::vector<std::uint8_t> payload(header->uncompressed_size);
+                auto const size = compression::decompress(
+                    stream,
+                    header->payload_wire_size,
+                    payload.data(),
+                    header->uncompressed_size);
+                BEAST_EXPECT(p->ParseFromArray(payload.data(), size));
+            }
+            else
+            {
+                BEAST_EXPECT(p->ParseFromBoundedZeroCopyStream(
+                    &stream, header->payload_wire_size));
+            }
+        }
+        auto const heap = steady_clock::now() - heapStart;
+
+        log << name << ": " << header->uncompressed_size << " bytes, "
+            << double(blocks_) / iterations << " blocks allocated, "
+            << duration_cast<nanoseconds>(arena).count() / iterations
+            << "ns arena, "
+            << duration_cast<nanoseconds>(heap).count() / iterations
+            << "ns heap" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        beast::xor_shift_engine rng(1);
+
+        measure(
+            "transaction",
+            makeTransaction(rng),
+            protocol::mtTRANSACTION,
+            Compressed::Off);
+        measure(
+            "validation",
+            makeValidation(rng),
+            protocol::mtVALIDATION,
+            Compressed::Off);
+        measure(
+            "proposal",
+            makeProposal(rng),
+            protocol::mtPROPOSE_LEDGER,
+            Compressed::Off);
+        measure(
+            "ledger data",
+            makeLedgerData(rng, 256),
+            protocol::mtLEDGER_DATA,
+            Compressed::Off);
+        measure(
+            "ledger data (lz4)",
+            makeLedgerData(rng, 256),
+            protocol::mtLEDGER_DATA,
+            Compressed::On);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ProtocolMessage, overlay, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(ProtocolMessage_benchmark, overlay, ripple);
+
+}  // namespace test
+
+}  // namespace ripple
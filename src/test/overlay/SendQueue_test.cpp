@@ -0,0 +1,483 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/make_SSLContext.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/Message.h>
+#include <ripple/overlay/impl/SendQueue.h>
+#include <ripple/overlay/impl/Tuning.h>
+#include <test/jtx/envconfig.h>
+
+#include <boost/asio.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/ssl/ssl_stream.hpp>
+
+#include <functional>
+#include <memory>
+#include <chrono>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+namespace test {
+
+class SendQueue_test : public beast::unit_test::suite
+{
+    using Compressed = compression::Compressed;
+    using stream_type = boost::beast::ssl_stream<boost::beast::tcp_stream>;
+    using endpoint_type = boost::asio::ip::tcp::endpoint;
+    using error_code = boost::system::error_code;
+
+    static std::shared_ptr<Message>
+    makeMessage(std::size_t payloadBytes, char fill)
+    {
+        protocol::TMValidation v;
+        v.set_validation(std::string(payloadBytes, fill));
+        return std::make_shared<Message>(v, protocol::mtVALIDATION);
+    }
+
+    static std::shared_ptr<Message>
+    makeProposal()
+    {
+        protocol::TMProposeSet p;
+        p.set_proposeseq(1);
+        p.set_currenttxhash(std::string(32, 'p'));
+        p.set_nodepubkey(std::string(33, 'k'));
+        p.set_closetime(1);
+        p.set_signature(std::string(72, 's'));
+        p.set_previousledger(std::string(32, 'l'));
+        return std::make_shared<Message>(p, protocol::mtPROPOSE_LEDGER);
+    }
+
+    static std::shared_ptr<Message>
+    makeTransaction(std::size_t payloadBytes)
+    {
+        protocol::TMTransaction tx;
+        tx.set_rawtransaction(std::string(payloadBytes, 't'));
+        tx.set_status(protocol::tsNEW);
+        return std::make_shared<Message>(tx, protocol::mtTRANSACTION);
+    }
+
+    static std::shared_ptr<Message>
+    makeLedgerData(std::size_t payloadBytes)
+    {
+        protocol::TMLedgerData ld;
+        ld.set_ledgerhash(std::string(32, 'h'));
+        ld.set_ledgerseq(1);
+        ld.set_type(protocol::liAS_NODE);
+        auto node = ld.add_nodes();
+        node->set_nodedata(std::string(payloadBytes, 'n'));
+        return std::make_shared<Message>(ld, protocol::mtLEDGER_DATA);
+    }
+
+    static SendQueue::Priority
+    priorityOf(std::shared_ptr<Message> const& m)
+    {
+        return SendQueue::priorityOf(
+            static_cast<TrafficCount::category>(m->getCategory()));
+    }
+
+    // Whether a buffer of a write is the given message
+    static bool
+    isMessage(
+        boost::asio::const_buffer const& buffer,
+        std::shared_ptr<Message> const& m)
+    {
+        return buffer.data() == m->getBuffer(Compressed::Off).data();
+    }
+
+    static std::size_t
+    bytesOf(SendQueue::buffers_type const& buffers)
+    {
+        return std::accumulate(
+            buffers.begin(),
+            buffers.end(),
+            std::size_t{0},
+            [](std::size_t n, auto const& b) { return n + b.size(); });
+    }
+
+    void
+    testGather()
+    {
+        testcase("gather");
+
+        std::size_t const limit = 1000;
+        SendQueue q(limit);
+
+        // Messages of about 300 bytes fit three to a write
+        for (int i = 0; i < 4; ++i)
+            q.push(makeMessage(300, 'a' + i));
+        BEAST_EXPECT(q.size() == 4);
+
+        auto const& first = q.prepare(Compressed::Off);
+        BEAST_EXPECT(first.size() == 3);
+        BEAST_EXPECT(bytesOf(first) <= limit);
+        q.consume();
+        BEAST_EXPECT(q.size() == 1);
+
+        // A message larger than the limit is written by itself
+        q.push(makeMessage(2 * limit, 'z'));
+        q.push(makeMessage(10, 'y'));
+        BEAST_EXPECT(q.prepare(Compressed::Off).size() == 1);
+        q.consume();
+        auto const& big = q.prepare(Compressed::Off);
+        BEAST_EXPECT(big.size() == 1);
+        BEAST_EXPECT(bytesOf(big) > limit);
+        q.consume();
+        BEAST_EXPECT(q.prepare(Compressed::Off).size() == 1);
+        q.consume();
+        BEAST_EXPECT(q.empty());
+
+        BEAST_EXPECT(q.writes() == 4);
+        BEAST_EXPECT(q.messagesWritten() == 6);
+        BEAST_EXPECT(q.messagesPerWrite() == 1.5);
+    }
+
+    void
+    testPriority()
+    {
+        testcase("priority");
+
+        using Priority = SendQueue::Priority;
+
+        auto const proposal = makeProposal();
+        auto const validation = makeMessage(200, 'v');
+        BEAST_EXPECT(priorityOf(proposal) == Priority::consensus);
+        BEAST_EXPECT(priorityOf(validation) == Priority::validation);
+        BEAST_EXPECT(priorityOf(makeLedgerData(10)) == Priority::ledger);
+        BEAST_EXPECT(priorityOf(makeTransaction(10)) == Priority::transaction);
+
+        SendQueue q(Tuning::sendBatchBytes);
+
+        // Consensus messages and validations queued behind a large ledger
+        // data reply and many transactions go out first
+        q.push(makeLedgerData(100000));
+        for (int i = 0; i < 100; ++i)
+            q.push(makeTransaction(200));
+        q.push(validation);
+        q.push(proposal);
+
+        auto const& buffers = q.prepare(Compressed::Off);
+        BEAST_EXPECT(buffers.size() > 2);
+        BEAST_EXPECT(isMessage(buffers[0], proposal));
+        BEAST_EXPECT(isMessage(buffers[1], validation));
+        BEAST_EXPECT(bytesOf(buffers) <= Tuning::sendBatchBytes);
+        q.consume();
+
+        // The transactions are not starved by the ledger data, and the
+        // ledger data is written once it has saved up enough allowance
+        while (!q.empty())
+        {
+            q.prepare(Compressed::Off);
+            q.consume();
+        }
+        auto const ledger = q.stats(Priority::ledger);
+        auto const txs = q.stats(Priority::transaction);
+        BEAST_EXPECT(ledger.sent == 1 && ledger.queued == 0);
+        BEAST_EXPECT(txs.sent == 100 && txs.queued == 0);
+        BEAST_EXPECT(q.stats(Priority::consensus).sent == 1);
+    }
+
+    void
+    testFairness()
+    {
+        testcase("fairness");
+
+        using Priority = SendQueue::Priority;
+
+        SendQueue q(Tuning::sendBatchBytes);
+
+        // Higher classes that could fill every write get their share
+        for (int i = 0; i < 100; ++i)
+        {
+            q.push(makeLedgerData(1000));
+            q.push(makeTransaction(1000));
+        }
+
+        auto const& buffers = q.prepare(Compressed::Off);
+        std::uint64_t ledger = 0;
+        std::uint64_t txs = 0;
+        for (auto const& b : buffers)
+            (b.size() > 1040 ? ledger : txs) += 1;
+        q.consume();
+
+        // Ledger data has twice the weight of transactions
+        BEAST_EXPECT(ledger > 0 && txs > 0);
+        BEAST_EXPECT(ledger >= txs);
+        BEAST_EXPECT(q.stats(Priority::ledger).sent == ledger);
+        BEAST_EXPECT(q.stats(Priority::transaction).sent == txs);
+    }
+
+    void
+    testDrop()
+    {
+        testcase("drop");
+
+        using Priority = SendQueue::Priority;
+
+        SendQueue q(Tuning::sendBatchBytes);
+
+        // Validations drop the oldest when full
+        std::vector<std::shared_ptr<Message>> validations;
+        int refused = 0;
+        for (int i = 0; i < 300; ++i)
+        {
+            validations.push_back(makeMessage(100, 'v'));
+            if (!q.push(validations.back()))
+                ++refused;
+        }
+        auto stats = q.stats(Priority::validation);
+        BEAST_EXPECT(stats.queued == 256);
+        BEAST_EXPECT(stats.dropped == 44);
+        BEAST_EXPECT(refused == 44);
+        BEAST_EXPECT(q.dropped() == 44);
+        BEAST_EXPECT(q.full(Priority::validation));
+        BEAST_EXPECT(!q.full(Priority::ledger));
+        BEAST_EXPECT(isMessage(q.prepare(Compressed::Off)[0], validations[44]));
+        q.consume();
+        while (!q.empty())
+        {
+            q.prepare(Compressed::Off);
+            q.consume();
+        }
+
+        // Consensus messages drop the new message when full, since a newer
+        // proposal need not replace an older one
+        std::vector<std::shared_ptr<Message>> proposals;
+        for (int i = 0; i < 300; ++i)
+        {
+            proposals.push_back(makeProposal());
+            q.push(proposals.back());
+        }
+        stats = q.stats(Priority::consensus);
+        BEAST_EXPECT(stats.queued == 256);
+        BEAST_EXPECT(stats.dropped == 44);
+        BEAST_EXPECT(isMessage(q.prepare(Compressed::Off)[0], proposals[0]));
+        q.consume();
+        while (!q.empty())
+        {
+            q.prepare(Compressed::Off);
+            q.consume();
+        }
+
+        // Transactions drop the new message when full
+        std::vector<std::shared_ptr<Message>> txs;
+        for (int i = 0; i < 300; ++i)
+        {
+            txs.push_back(makeTransaction(100));
+            q.push(txs.back());
+        }
+        stats = q.stats(Priority::transaction);
+        BEAST_EXPECT(stats.queued == 256);
+        BEAST_EXPECT(stats.dropped == 44);
+
+        bool found = false;
+        while (!q.empty())
+        {
+            for (auto const& b : q.prepare(Compressed::Off))
+            {
+                found = found || isMessage(b, txs[0]);
+                BEAST_EXPECT(!isMessage(b, txs[299]));
+            }
+            q.consume();
+        }
+        BEAST_EXPECT(found);
+        BEAST_EXPECT(q.stats(Priority::transaction).sent == 256);
+        BEAST_EXPECT(!q.full(Priority::transaction));
+        BEAST_EXPECT(q.dropped() == 3 * 44);
+    }
+
+    void
+    testLargeMessage()
+    {
+        testcase("large message");
+
+        using Priority = SendQueue::Priority;
+
+        SendQueue q(Tuning::sendBatchBytes);
+
+        // Steady traffic of higher classes does not hold back ledger data
+        // that cannot share a write with it
+        for (auto const payload :
+             {Tuning::sendBatchBytes - 100, 4 * Tuning::sendBatchBytes})
+        {
+            auto const ledgerData = makeLedgerData(payload);
+            q.push(ledgerData);
+
+            int writes = 0;
+            bool sent = false;
+            while (!sent && writes < 100)
+            {
+                for (int i = 0; i < 4; ++i)
+                {
+                    q.push(makeProposal());
+                    q.push(makeMessage(200, 'v'));
+                    q.push(makeTransaction(200));
+                }
+
+                auto const& buffers = q.prepare(Compressed::Off);
+                for (auto const& b : buffers)
+                {
+                    if (isMessage(b, ledgerData))
+                    {
+                        sent = true;
+                        // It starts the write it is in
+                        BEAST_EXPECT(isMessage(buffers.front(), ledgerData));
+                    }
+                }
+                q.consume();
+                ++writes;
+            }
+            BEAST_EXPECT(sent);
+            BEAST_EXPECT(writes < 10);
+        }
+        BEAST_EXPECT(q.stats(Priority::ledger).sent == 2);
+    }
+
+    void
+    testQueueWait()
+    {
+        testcase("queue wait");
+
+        TrafficCount traffic;
+        SendQueue q(Tuning::sendBatchBytes, &traffic);
+
+        for (int i = 0; i < 10; ++i)
+            q.push(makeMessage(100, 'v'));
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        while (!q.empty())
+        {
+            q.prepare(Compressed::Off);
+            q.consume();
+        }
+
+        auto const wait = traffic
+                              .histogram(
+                                  TrafficCount::category::validation,
+                                  TrafficCount::Metric::sendQueue)
+                              .snapshot();
+        BEAST_EXPECT(wait.count == 10);
+        BEAST_EXPECT(wait.sum >= 10 * 2000);
+        BEAST_EXPECT(
+            traffic
+                .histogram(
+                    TrafficCount::category::transaction,
+                    TrafficCount::Metric::sendQueue)
+                .snapshot()
+                .count == 0);
+    }
+
+    // Write bursts of messages over TLS the way PeerImp does, and check
+    // that the far side receives them intact and in order.
+    void
+    testLoopback()
+    {
+        testcase("loopback");
+
+        auto context = make_SSLContext("");
+        boost::asio::io_context ioc;
+
+        boost::asio::ip::tcp::acceptor acceptor(
+            ioc,
+            endpoint_type(
+                boost::asio::ip::make_address(getEnvLocalhostAddr()), 0));
+
+        // Bursts of small messages, like validations and proposals
+        std::vector<std::shared_ptr<Message>> messages;
+        for (int burst = 0; burst < 10; ++burst)
+            for (int i = 0; i < 50; ++i)
+                messages.push_back(makeMessage(100 + burst * 10 + i, 'a' + i));
+
+        std::vector<std::uint8_t> expected;
+        for (auto const& m : messages)
+        {
+            auto const& b = m->getBuffer(Compressed::Off);
+            expected.insert(expected.end(), b.begin(), b.end());
+        }
+
+        std::vector<std::uint8_t> received(expected.size());
+        std::thread server([&] {
+            boost::asio::io_context sioc;
+            stream_type stream(sioc, *context);
+            acceptor.accept(boost::beast::get_lowest_layer(stream).socket());
+            stream.handshake(boost::asio::ssl::stream_base::server);
+            boost::asio::read(stream, boost::asio::buffer(received));
+        });
+
+        stream_type stream(ioc, *context);
+        boost::beast::get_lowest_layer(stream).connect(
+            acceptor.local_endpoint());
+        stream.handshake(boost::asio::ssl::stream_base::client);
+
+        SendQueue q(Tuning::sendBatchBytes);
+        std::function<void(error_code, std::size_t)> onWrite =
+            [&](error_code ec, std::size_t) {
+                if (!BEAST_EXPECT(!ec))
+                    return;
+                q.consume();
+                if (!q.empty())
+                    boost::asio::async_write(
+                        stream, q.prepare(Compressed::Off), onWrite);
+            };
+
+        // Each burst is queued while the previous one is being written
+        for (std::size_t i = 0; i < messages.size(); ++i)
+        {
+            bool const idle = q.empty();
+            q.push(messages[i]);
+            if (idle)
+                boost::asio::async_write(
+                    stream, q.prepare(Compressed::Off), onWrite);
+            if (i % 50 == 49)
+            {
+                ioc.poll();
+                ioc.restart();
+            }
+        }
+        ioc.run();
+        server.join();
+
+        BEAST_EXPECT(q.empty());
+        BEAST_EXPECT(received == expected);
+        BEAST_EXPECT(q.messagesWritten() == messages.size());
+        BEAST_EXPECT(q.writes() < messages.size());
+        log << "messages per write: " << q.messagesPerWrite() << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        testGather();
+        testPriority();
+        testFairness();
+        testDrop();
+        testLargeMessage();
+        testQueueWait();
+        testLoopback();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SendQueue, overlay, ripple);
+
+}  // namespace test
+
+}  // namespace ripple
@@ -0,0 +1,145 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/overlay/impl/TrafficCount.h>
+
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+namespace test {
+
+class TrafficCount_test : public beast::unit_test::suite
+{
+    using Histogram = TrafficCount::Histogram;
+
+    void
+    testBuckets()
+    {
+        testcase("buckets");
+
+        BEAST_EXPECT(Histogram::bucket(0) == 0);
+        BEAST_EXPECT(Histogram::bucket(1) == 1);
+        BEAST_EXPECT(Histogram::bucket(2) == 2);
+        BEAST_EXPECT(Histogram::bucket(3) == 2);
+        BEAST_EXPECT(Histogram::bucket(4) == 3);
+        BEAST_EXPECT(Histogram::bucket(1023) == 10);
+        BEAST_EXPECT(Histogram::bucket(1024) == 11);
+        BEAST_EXPECT(
+            Histogram::bucket(std::uint64_t{1} << 40) ==
+            Histogram::buckets - 1);
+
+        Histogram h;
+        BEAST_EXPECT(h.snapshot().count == 0);
+        BEAST_EXPECT(h.snapshot().used() == 0);
+        BEAST_EXPECT(h.snapshot().percentile(0.5) == 0);
+
+        for (std::uint64_t i = 0; i < 100; ++i)
+            h.insert(i);
+        auto const s = h.snapshot();
+        BEAST_EXPECT(s.count == 100);
+        BEAST_EXPECT(s.sum == 4950);
+        BEAST_EXPECT(s.used() == 8);
+        BEAST_EXPECT(s.counts[7] == 36);
+        BEAST_EXPECT(s.percentile(0.5) == 64);
+        BEAST_EXPECT(s.percentile(0.99) == 128);
+
+        h.insert(5000);
+        auto const since = h.snapshot().since(s);
+        BEAST_EXPECT(since.count == 1);
+        BEAST_EXPECT(since.sum == 5000);
+        BEAST_EXPECT(since.used() == 14);
+        BEAST_EXPECT(since.percentile(0.5) == 8192);
+    }
+
+    void
+    testThreads()
+    {
+        testcase("threads");
+
+        // Samples added from many threads, and so to different shards,
+        // are all counted once merged
+        Histogram h;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 16; ++t)
+            threads.emplace_back([&h] {
+                for (std::uint64_t i = 0; i < 10000; ++i)
+                    h.insert(i % 1000);
+            });
+        for (auto& t : threads)
+            t.join();
+
+        auto const s = h.snapshot();
+        BEAST_EXPECT(s.count == 160000);
+        BEAST_EXPECT(s.sum == 16 * 10 * 499500);
+    }
+
+    void
+    testCategories()
+    {
+        testcase("categories");
+
+        TrafficCount traffic;
+        traffic.addCount(TrafficCount::category::validation, true, 150);
+        traffic.addCount(TrafficCount::category::validation, false, 300);
+        traffic.addSample(
+            TrafficCount::category::proposal,
+            TrafficCount::Metric::handler,
+            20);
+
+        auto const size = traffic
+                              .histogram(
+                                  TrafficCount::category::validation,
+                                  TrafficCount::Metric::size)
+                              .snapshot();
+        BEAST_EXPECT(size.count == 2);
+        BEAST_EXPECT(size.sum == 450);
+        BEAST_EXPECT(
+            traffic
+                .histogram(
+                    TrafficCount::category::proposal,
+                    TrafficCount::Metric::handler)
+                .snapshot()
+                .sum == 20);
+        BEAST_EXPECT(
+            traffic
+                .histogram(
+                    TrafficCount::category::proposal,
+                    TrafficCount::Metric::jobDelay)
+                .snapshot()
+                .count == 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testBuckets();
+        testThreads();
+        testCategories();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TrafficCount, overlay, ripple);
+
+}  // namespace test
+
+}  // namespace ripple
@@ -489,6 +489,7 @@ public:
                 true,
                 env->app().config().COMPRESSION,
                 env->app().config().VP_REDUCE_RELAY_ENABLE,
+                false,
                 false);
             http_request_type http_request;
             http_request.version(request.version());
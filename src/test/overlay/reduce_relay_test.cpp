@@ -1329,6 +1329,52 @@ vp_squelched=1
             c2.loadFromString(toLoad);
             BEAST_EXPECT(c2.VP_REDUCE_RELAY_ENABLE == false);
             BEAST_EXPECT(c2.VP_REDUCE_RELAY_SQUELCH == false);
+            BEAST_EXPECT(c2.TX_REDUCE_RELAY_ENABLE == false);
+            BEAST_EXPECT(c2.TX_REDUCE_RELAY_MIN_PEERS == 20);
+            BEAST_EXPECT(c2.TX_RELAY_PERCENTAGE == 25);
+
+            Config c3;
+
+            toLoad = R"rippleConfig(
+[reduce_relay]
+tx_enable=1
+tx_min_peers=30
+tx_relay_percentage=50
+)rippleConfig";
+
+            c3.loadFromString(toLoad);
+            BEAST_EXPECT(c3.TX_REDUCE_RELAY_ENABLE == true);
+            BEAST_EXPECT(c3.TX_REDUCE_RELAY_MIN_PEERS == 30);
+            BEAST_EXPECT(c3.TX_RELAY_PERCENTAGE == 50);
+
+            auto const invalid = [&](std::string const& toLoad) {
+                Config c;
+                try
+                {
+                    c.loadFromString(toLoad);
+                    return false;
+                }
+                catch (std::runtime_error const&)
+                {
+                    return true;
+                }
+            };
+            BEAST_EXPECT(invalid(R"rippleConfig(
+[reduce_relay]
+tx_relay_percentage=5
+)rippleConfig"));
+            BEAST_EXPECT(invalid(R"rippleConfig(
+[reduce_relay]
+tx_relay_percentage=101
+)rippleConfig"));
+            BEAST_EXPECT(invalid(R"rippleConfig(
+[reduce_relay]
+tx_min_peers=9
+)rippleConfig"));
+
+            BEAST_EXPECT(reduce_relay::txRelayPeers(15, 20, 25) == 15);
+            BEAST_EXPECT(reduce_relay::txRelayPeers(40, 20, 25) == 20);
+            BEAST_EXPECT(reduce_relay::txRelayPeers(200, 20, 25) == 50);
         });
     }
 
@@ -1500,6 +1546,7 @@ vp_squelched=1
                     true,
                     env_.app().config().COMPRESSION,
                     env_.app().config().VP_REDUCE_RELAY_ENABLE,
+                    false,
                     false);
                 http_request_type http_request;
                 http_request.version(request.version());
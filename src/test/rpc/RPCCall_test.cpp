@@ -6073,6 +6073,64 @@ static RPCCallTestData const rpcCallTestArray[] = {
         R"()",
     },
 
+    // tx_profile
+    // ------------------------------------------------------------------
+    {"tx_profile: minimal.",
+     __LINE__,
+     {
+         "tx_profile",
+     },
+     RPCCallTestData::no_exception,
+     R"({
+    "method" : "tx_profile",
+    "params" : [
+      {
+        "api_version" : %MAX_API_VER%,
+      }
+    ]
+    })"},
+    {"tx_profile: recent.",
+     __LINE__,
+     {"tx_profile", "recent"},
+     RPCCallTestData::no_exception,
+     R"({
+    "method" : "tx_profile",
+    "params" : [
+      {
+        "api_version" : %MAX_API_VER%,
+        "recent" : true
+      }
+    ]
+    })"},
+    {"tx_profile: invalid argument.",
+     __LINE__,
+     {"tx_profile", "all"},
+     RPCCallTestData::no_exception,
+     R"({
+    "method" : "tx_profile",
+    "params" : [
+      {
+         "error" : "invalidParams",
+         "error_code" : 31,
+         "error_message" : "Invalid parameters."
+      }
+    ]
+    })"},
+    {"tx_profile: too many arguments.",
+     __LINE__,
+     {"tx_profile", "recent", "extra"},
+     RPCCallTestData::no_exception,
+     R"({
+    "method" : "tx_profile",
+    "params" : [
+      {
+         "error" : "badSyntax",
+         "error_code" : 1,
+         "error_message" : "Syntax error."
+      }
+    ]
+    })"},
+
     // unl_list
     // --------------------------------------------------------------------
     {"unl_list: minimal.",
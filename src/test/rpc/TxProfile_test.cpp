@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/protocol/jss.h>
+#include <test/jtx.h>
+
+namespace ripple {
+
+class TxProfile_test : public beast::unit_test::suite
+{
+    void
+    testTxProfile()
+    {
+        using namespace test::jtx;
+        beast::temp_dir logDir;
+        Env env{*this, envconfig([&logDir](std::unique_ptr<Config> cfg) {
+                    cfg->section("perf").set(
+                        "perf_log", logDir.file("perf.log"));
+                    return cfg;
+                })};
+
+        Account const alice{"alice"};
+        Account const bob{"bob"};
+        env.fund(XRP(10000), alice, bob);
+        env.close();
+
+        env(pay(alice, bob, XRP(100)));
+        env.close();
+
+        {
+            // Only the aggregate counters without recent key sets.
+            auto const result = env.rpc("tx_profile")[jss::result];
+            BEAST_EXPECT(result[jss::status] == "success");
+            BEAST_EXPECT(result.isMember(jss::SLE_hit_rate));
+            auto const& txs = result[jss::transactions];
+            BEAST_EXPECT(!txs.isMember(jss::recent));
+            BEAST_EXPECT(txs.isMember("Payment"));
+            BEAST_EXPECT(txs.isMember(jss::total));
+
+            auto const& payment = txs["Payment"];
+            auto const applied = std::stoull(payment[jss::applied].asString());
+            // Only the applies to closed ledgers are counted
+            BEAST_EXPECT(applied == 3);
+            BEAST_EXPECT(std::stoull(payment[jss::writes].asString()) > 0);
+
+            std::uint64_t count = 0;
+            for (auto const& bucket : payment[jss::histogram_us])
+                count += std::stoull(bucket.asString());
+            BEAST_EXPECT(count == applied);
+        }
+
+        {
+            // The most recent payment touched both accounts.
+            Json::Value params;
+            params[jss::recent] = true;
+            auto const result =
+                env.rpc("json", "tx_profile", to_string(params))[jss::result];
+            BEAST_EXPECT(result[jss::status] == "success");
+            auto const& recent = result[jss::transactions][jss::recent];
+            BEAST_EXPECT(recent.isArray() && recent.size() > 0);
+
+            auto const& last = recent[recent.size() - 1];
+            BEAST_EXPECT(last[jss::type] == "Payment");
+            auto const& writes = last[jss::writes];
+            auto const touched = [&writes](Account const& account) {
+                auto const key = to_string(keylet::account(account).key);
+                for (auto const& w : writes)
+                    if (w.asString() == key)
+                        return true;
+                return false;
+            };
+            BEAST_EXPECT(touched(alice));
+            BEAST_EXPECT(touched(bob));
+        }
+    }
+
+    void
+    testDisabled()
+    {
+        using namespace test::jtx;
+        // Without a performance log nothing is profiled.
+        Env env(*this);
+
+        Account const alice{"alice"};
+        Account const bob{"bob"};
+        env.fund(XRP(10000), alice, bob);
+        env.close();
+
+        env(pay(alice, bob, XRP(100)));
+        env.close();
+
+        auto const result = env.rpc("tx_profile")[jss::result];
+        BEAST_EXPECT(result[jss::status] == "success");
+        BEAST_EXPECT(!result[jss::transactions].isMember("Payment"));
+        BEAST_EXPECT(!result[jss::transactions].isMember(jss::total));
+    }
+
+public:
+    void
+    run() override
+    {
+        testTxProfile();
+        testDisabled();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TxProfile, rpc, ripple);
+
+}  // namespace ripple
@@ -23,6 +23,7 @@
 #include <ripple/beast/xor_shift_engine.h>
 #include <ripple/shamap/SHAMap.h>
 #include <ripple/shamap/SHAMapItem.h>
+#include <test/jtx.h>
 #include <test/shamap/common.h>
 #include <test/unit_test/SuiteJournal.h>
 
@@ -85,8 +86,10 @@ public:
     }
 
     void
-    run() override
+    testSync()
     {
+        testcase("sync");
+
         using namespace beast::severities;
         test::SuiteJournal journal("SHAMapSync_test", *this);
 
@@ -199,6 +202,142 @@ public:
         log << "Checking destination invariants..." << std::endl;
         destination.invariants();
     }
+
+    struct SyncStats
+    {
+        std::size_t rounds = 0;
+        std::size_t fetched = 0;
+        std::chrono::microseconds scan{0};
+    };
+
+    // Sync a map from the source, looking for missing nodes with the
+    // given number of threads
+    SyncStats
+    sync(
+        SHAMap const& source,
+        SHAMap& destination,
+        JobQueue& jobQueue,
+        int threads)
+    {
+        using namespace std::chrono;
+
+        SyncStats stats;
+        destination.setSynching();
+
+        {
+            std::vector<SHAMapNodeID> nodeIDs;
+            std::vector<Blob> nodes;
+            BEAST_EXPECT(source.getNodeFat(
+                SHAMapNodeID(), nodeIDs, nodes, false, 0));
+            BEAST_EXPECT(
+                destination
+                    .addRootNode(source.getHash(), makeSlice(nodes[0]), nullptr)
+                    .isGood());
+        }
+
+        while (true)
+        {
+            auto const start = steady_clock::now();
+            auto const missing = (threads > 1)
+                ? destination.getMissingNodes(2048, nullptr, jobQueue, threads)
+                : destination.getMissingNodes(2048, nullptr);
+            stats.scan +=
+                duration_cast<microseconds>(steady_clock::now() - start);
+
+            if (missing.empty())
+                break;
+            ++stats.rounds;
+
+            std::vector<SHAMapNodeID> nodeIDs;
+            std::vector<Blob> nodes;
+            for (auto const& [nodeID, hash] : missing)
+            {
+                if (!source.getNodeFat(nodeID, nodeIDs, nodes, false, 0))
+                    fail("", __FILE__, __LINE__);
+            }
+
+            for (std::size_t i = 0; i < nodeIDs.size(); ++i)
+            {
+                if (!destination
+                         .addKnownNode(nodeIDs[i], makeSlice(nodes[i]), nullptr)
+                         .isUseful())
+                    fail("", __FILE__, __LINE__);
+            }
+            stats.fetched += nodeIDs.size();
+        }
+
+        destination.clearSynching();
+        return stats;
+    }
+
+    void
+    testParallelSync()
+    {
+        testcase("parallel missing node scan");
+
+        test::SuiteJournal journal("SHAMapSync_test", *this);
+
+        // The source has changed a tenth of the items of an older map
+        // which the destination has in its database
+        int const items = 30000;
+        std::vector<std::shared_ptr<SHAMapItem>> older;
+        for (int i = 0; i < items; ++i)
+            older.push_back(makeRandomAS());
+
+        TestNodeFamily f(journal);
+        SHAMap source(SHAMapType::STATE, f);
+        for (int i = 0; i < items; ++i)
+        {
+            auto item = (i % 10 == 0) ? makeRandomAS() : older[i];
+            source.addItem(SHAMapNodeType::tnACCOUNT_STATE, SHAMapItem{*item});
+        }
+        source.setImmutable();
+
+        auto makeDestination = [&](TestNodeFamily& family) {
+            {
+                SHAMap map(SHAMapType::STATE, family);
+                for (auto const& item : older)
+                    map.addItem(
+                        SHAMapNodeType::tnACCOUNT_STATE, SHAMapItem{*item});
+                map.flushDirty(hotACCOUNT_NODE);
+            }
+            family.reset();
+            return std::make_unique<SHAMap>(SHAMapType::FREE, family);
+        };
+
+        TestNodeFamily serialFamily(journal);
+        TestNodeFamily parallelFamily(journal);
+        auto serial = makeDestination(serialFamily);
+        auto parallel = makeDestination(parallelFamily);
+
+        test::jtx::Env env(*this);
+        auto& jobQueue = env.app().getJobQueue();
+        jobQueue.setThreadCount(4, false);
+
+        auto const serialStats = sync(source, *serial, jobQueue, 1);
+        auto const parallelStats = sync(source, *parallel, jobQueue, 4);
+
+        log << "serial: " << serialStats.rounds << " rounds, "
+            << serialStats.fetched << " nodes fetched, "
+            << serialStats.scan.count() << " us scanning; parallel: "
+            << parallelStats.rounds << " rounds, " << parallelStats.fetched
+            << " nodes fetched, " << parallelStats.scan.count()
+            << " us scanning" << std::endl;
+
+        // Only the nodes the destination lacks are fetched either way
+        BEAST_EXPECT(serialStats.fetched > 0);
+        BEAST_EXPECT(serialStats.fetched == parallelStats.fetched);
+        BEAST_EXPECT(serialStats.fetched < items / 2);
+        BEAST_EXPECT(source.deepCompare(*serial));
+        BEAST_EXPECT(source.deepCompare(*parallel));
+    }
+
+    void
+    run() override
+    {
+        testSync();
+        testParallelSync();
+    }
 };
 
 BEAST_DEFINE_TESTSUITE(SHAMapSync, shamap, ripple);
@@ -21,8 +21,10 @@
 #include <ripple/basics/Buffer.h>
 #include <ripple/beast/unit_test.h>
 #include <ripple/beast/utility/Journal.h>
+#include <ripple/protocol/digest.h>
 #include <ripple/shamap/SHAMap.h>
 #include <algorithm>
+#include <set>
 #include <test/shamap/common.h>
 #include <test/unit_test/SuiteJournal.h>
 
@@ -398,7 +400,202 @@ class SHAMapPathProof_test : public beast::unit_test::suite
     }
 };
 
+class SHAMapVisitedSet_test : public beast::unit_test::suite
+{
+    // Walk the map, returning the number of subtrees found complete
+    std::size_t
+    walk(SHAMap const& map, SHAMapVisitedSet& complete)
+    {
+        auto const before = complete.size();
+        std::vector<SHAMapMissingNode> missing;
+        map.walkMap(missing, 32, &complete);
+        BEAST_EXPECT(missing.empty());
+        return complete.size() - before;
+    }
+
+    void
+    testDelta(beast::Journal const& journal)
+    {
+        testcase("walk only the delta");
+
+        tests::TestNodeFamily f(journal);
+        SHAMap map(SHAMapType::FREE, f);
+        map.setUnbacked();
+
+        std::uint32_t const items = 16384;
+        std::uint32_t const changes = 16;
+        for (std::uint32_t i = 0; i < items; ++i)
+        {
+            auto const key = sha512Half(i);
+            map.addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                SHAMapItem{key, Slice{key.data(), key.size()}});
+        }
+        map.getHash();
+
+        auto next = map.snapShot(true);
+        for (std::uint32_t i = 0; i < changes; ++i)
+        {
+            BEAST_EXPECT(next->delItem(sha512Half(i * 1000)));
+            auto const key = sha512Half(items + i);
+            next->addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                SHAMapItem{key, Slice{key.data(), key.size()}});
+        }
+        next->getHash();
+
+        std::size_t inner = 0;
+        map.visitNodes([&inner](SHAMapTreeNode& node) {
+            if (node.isInner())
+                ++inner;
+            return true;
+        });
+
+        // Every inner node of the first map is found complete once
+        SHAMapVisitedSet complete;
+        BEAST_EXPECT(walk(map, complete) == inner);
+        BEAST_EXPECT(walk(map, complete) == 0);
+
+        // The next map only walks the inner nodes that differ
+        std::size_t changed = 0;
+        next->visitDifferences(&map, [&changed](SHAMapTreeNode const& node) {
+            if (node.isInner())
+                ++changed;
+            return true;
+        });
+        BEAST_EXPECT(changed > 0);
+        BEAST_EXPECT(walk(*next, complete) == changed);
+        BEAST_EXPECT(changed < inner / 20);
+        log << "walked " << inner << " inner nodes for the first map, "
+            << changed << " for the next one" << std::endl;
+    }
+
+    void
+    testVisitBranch(beast::Journal const& journal)
+    {
+        testcase("visit branches only once");
+
+        tests::TestNodeFamily f(journal);
+        SHAMap map(SHAMapType::FREE, f);
+        map.setUnbacked();
+
+        std::uint32_t const items = 4096;
+        for (std::uint32_t i = 0; i < items; ++i)
+        {
+            auto const key = sha512Half(i);
+            map.addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                SHAMapItem{key, Slice{key.data(), key.size()}});
+        }
+        map.getHash();
+
+        auto next = map.snapShot(true);
+        for (std::uint32_t i = 0; i < 8; ++i)
+        {
+            auto const key = sha512Half(items + i);
+            next->addItem(
+                SHAMapNodeType::tnACCOUNT_STATE,
+                SHAMapItem{key, Slice{key.data(), key.size()}});
+        }
+        next->getHash();
+
+        // Visit every branch, stopping after `limit` nodes. Returns the
+        // number of inner nodes visited.
+        auto const visit = [](SHAMap const& m,
+                              SHAMapVisitedSet& visited,
+                              hash_set<uint256>& leaves,
+                              std::size_t limit = 0) {
+            std::size_t inner = 0;
+            std::size_t nodes = 0;
+            for (int branch = 0; branch < SHAMap::branchFactor; ++branch)
+            {
+                m.visitBranch(
+                    branch,
+                    [&](SHAMapTreeNode const& node, bool) {
+                        if (node.isInner())
+                            ++inner;
+                        else
+                            leaves.insert(static_cast<SHAMapLeafNode const&>(
+                                              node)
+                                              .peekItem()
+                                              ->key());
+                        return ++nodes != limit;
+                    },
+                    &visited);
+            }
+            return inner;
+        };
+
+        std::size_t inner = 0;
+        map.visitNodes([&inner](SHAMapTreeNode& node) {
+            if (node.isInner())
+                ++inner;
+            return true;
+        });
+
+        // Every inner node below the root is visited once
+        {
+            SHAMapVisitedSet visited;
+            hash_set<uint256> leaves;
+            BEAST_EXPECT(visit(map, visited, leaves) == inner - 1);
+            BEAST_EXPECT(leaves.size() == items);
+            BEAST_EXPECT(visit(map, visited, leaves) == 0);
+        }
+
+        // A walk cut short marks no subtree it did not finish
+        SHAMapVisitedSet visited;
+        hash_set<uint256> leaves;
+        visit(map, visited, leaves, 1000);
+        BEAST_EXPECT(leaves.size() < items);
+        visit(map, visited, leaves);
+        BEAST_EXPECT(leaves.size() == items);
+        BEAST_EXPECT(visit(map, visited, leaves) == 0);
+
+        // The next map only visits the inner nodes that differ
+        std::size_t changed = 0;
+        next->visitDifferences(&map, [&changed](SHAMapTreeNode const& node) {
+            if (node.isInner())
+                ++changed;
+            return true;
+        });
+        BEAST_EXPECT(changed > 1);
+        BEAST_EXPECT(visit(*next, visited, leaves) == changed - 1);
+        BEAST_EXPECT(leaves.size() == items + 8);
+    }
+
+    void
+    testBounded()
+    {
+        testcase("bounded");
+
+        SHAMapVisitedSet visited(64);
+        for (std::uint32_t i = 0; i < 1000; ++i)
+        {
+            visited.insert(sha512Half(i));
+            BEAST_EXPECT(visited.size() <= 64);
+        }
+        BEAST_EXPECT(visited.contains(sha512Half(999)));
+        BEAST_EXPECT(!visited.contains(sha512Half(0)));
+
+        visited.clear();
+        BEAST_EXPECT(visited.size() == 0);
+        BEAST_EXPECT(!visited.contains(sha512Half(999)));
+    }
+
+public:
+    void
+    run() override
+    {
+        test::SuiteJournal journal("SHAMapVisitedSet_test", *this);
+
+        testDelta(journal);
+        testVisitBranch(journal);
+        testBounded();
+    }
+};
+
 BEAST_DEFINE_TESTSUITE(SHAMap, ripple_app, ripple);
 BEAST_DEFINE_TESTSUITE(SHAMapPathProof, ripple_app, ripple);
+BEAST_DEFINE_TESTSUITE(SHAMapVisitedSet, ripple_app, ripple);
 }  // namespace tests
 }  // namespace ripple
@@ -0,0 +1,205 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2021 Ripple Labs Inc.
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/chrono.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/shamap/SHAMapAccountStateLeafNode.h>
+#include <ripple/shamap/SHAMapInnerNode.h>
+#include <ripple/shamap/TreeNodeCache.h>
+#include <test/unit_test/SuiteJournal.h>
+
+namespace ripple {
+namespace tests {
+
+class TreeNodeCache_test : public beast::unit_test::suite
+{
+    using Tier = TreeNodeCache::Tier;
+
+    static uint256
+    key(int i)
+    {
+        return uint256(i + 1);
+    }
+
+    static std::shared_ptr<SHAMapTreeNode>
+    makeLeaf(int i)
+    {
+        std::vector<std::uint8_t> data(64, static_cast<std::uint8_t>(i));
+        return std::make_shared<SHAMapAccountStateLeafNode>(
+            std::make_shared<SHAMapItem const>(key(i), makeSlice(data)), 0);
+    }
+
+    static std::shared_ptr<SHAMapTreeNode>
+    makeInner(int branches)
+    {
+        auto inner = std::make_shared<SHAMapInnerNode>(1);
+        for (int i = 0; i < branches; ++i)
+            inner->setChild(i, makeLeaf(i));
+        inner->updateHash();
+        return inner;
+    }
+
+    void
+    testTiers()
+    {
+        testcase("tiers");
+
+        BEAST_EXPECT(TreeNodeCache::tierOf(*makeLeaf(0)) == Tier::leaf);
+        BEAST_EXPECT(TreeNodeCache::tierOf(*makeInner(3)) == Tier::inner);
+        BEAST_EXPECT(
+            TreeNodeCache::tierOf(*makeInner(SHAMapInnerNode::branchFactor)) ==
+            Tier::upper);
+
+        // A fuller inner node is charged more than a sparse one
+        BEAST_EXPECT(
+            TreeNodeCache::bytesOf(*makeInner(16)) >
+            TreeNodeCache::bytesOf(*makeInner(2)));
+    }
+
+    void
+    testHitRates(beast::Journal journal)
+    {
+        testcase("hit rates");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        TreeNodeCache c("test", 0, 1h, clock, journal);
+
+        // Nodes written locally are not charged as misses
+        auto leaf = makeLeaf(1);
+        BEAST_EXPECT(!c.canonicalize_written(key(1), leaf));
+        BEAST_EXPECT(c.getHitRate(Tier::leaf) == 0);
+        BEAST_EXPECT(c.getCacheBytes() == TreeNodeCache::bytesOf(*leaf));
+
+        BEAST_EXPECT(c.fetch(key(1)) == leaf);
+        BEAST_EXPECT(c.getHitRate(Tier::leaf) == 100);
+
+        // A fetched node that missed is charged to its tier
+        BEAST_EXPECT(!c.fetch(key(2)));
+        auto inner = makeInner(4);
+        BEAST_EXPECT(!c.canonicalize_replace_client(key(2), inner));
+        BEAST_EXPECT(c.getHitRate(Tier::inner) == 0);
+        BEAST_EXPECT(c.fetch(key(2)) == inner);
+        BEAST_EXPECT(c.getHitRate(Tier::inner) == 50);
+        BEAST_EXPECT(c.getHitRate(Tier::upper) == 0);
+
+        // Aliases canonicalize to the cached node
+        auto alias = makeLeaf(1);
+        BEAST_EXPECT(c.canonicalize_replace_client(key(1), alias));
+        BEAST_EXPECT(alias == leaf);
+
+        c.reset();
+        BEAST_EXPECT(c.getCacheSize() == 0);
+        BEAST_EXPECT(c.getCacheBytes() == 0);
+        BEAST_EXPECT(c.getHitRate(Tier::leaf) == 0);
+    }
+
+    void
+    testBudget(beast::Journal journal)
+    {
+        testcase("budget");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        TreeNodeCache c("test", 0, 1h, clock, journal);
+
+        auto const upperBytes = [&] {
+            auto upper = makeInner(SHAMapInnerNode::branchFactor);
+            c.canonicalize_replace_client(key(1000), upper);
+            return TreeNodeCache::bytesOf(*upper);
+        }();
+
+        auto const innerBytes = [&] {
+            auto inner = makeInner(2);
+            c.canonicalize_replace_client(key(1001), inner);
+            return TreeNodeCache::bytesOf(*inner);
+        }();
+
+        int const leaves = 100;
+        std::uint64_t leafBytes = 0;
+        for (int i = 0; i < leaves; ++i)
+        {
+            ++clock;
+            auto leaf = makeLeaf(i);
+            leafBytes = TreeNodeCache::bytesOf(*leaf);
+            c.canonicalize_replace_client(key(i), leaf);
+        }
+
+        BEAST_EXPECT(c.getCacheSize() == leaves + 2);
+        BEAST_EXPECT(
+            c.getCacheBytes() == upperBytes + innerBytes + leaves * leafBytes);
+
+        // Without a budget only age evicts
+        c.sweep();
+        BEAST_EXPECT(c.getCacheSize() == leaves + 2);
+
+        // Leaves are evicted oldest first, before any inner node
+        c.setTargetBytes(upperBytes + innerBytes + 10 * leafBytes);
+        c.sweep();
+        BEAST_EXPECT(c.getCacheBytes() <= c.getTargetBytes());
+        BEAST_EXPECT(c.getCacheSize() == 12);
+        BEAST_EXPECT(c.getTrackSize() == 12);
+        BEAST_EXPECT(c.fetch(key(1000)));
+        BEAST_EXPECT(!c.fetch(key(0)));
+        BEAST_EXPECT(c.fetch(key(leaves - 1)));
+
+        // A leaf fetched since the last sweep outlives a colder inner node
+        c.setTargetBytes(upperBytes + leafBytes);
+        c.sweep();
+        BEAST_EXPECT(c.getCacheBytes() <= c.getTargetBytes());
+        BEAST_EXPECT(c.fetch(key(1000)));
+        BEAST_EXPECT(c.fetch(key(leaves - 1)));
+        BEAST_EXPECT(!c.fetch(key(1001)));
+        BEAST_EXPECT(!c.fetch(key(leaves - 2)));
+
+        // Insertions keep the cache within its budget
+        for (int i = 0; i < leaves; ++i)
+        {
+            auto leaf = makeLeaf(i);
+            c.canonicalize_replace_client(key(i), leaf);
+            BEAST_EXPECT(c.getCacheBytes() <= c.getTargetBytes());
+        }
+        BEAST_EXPECT(c.fetch(key(1000)));
+
+        // Nodes referenced elsewhere remain tracked weakly
+        auto held = makeLeaf(5000);
+        c.canonicalize_replace_client(key(5000), held);
+        c.setTargetBytes(1);
+        c.sweep();
+        BEAST_EXPECT(c.getCacheBytes() == 0);
+        BEAST_EXPECT(c.getTrackSize() == 1);
+        BEAST_EXPECT(c.fetch(key(5000)) == held);
+    }
+
+public:
+    void
+    run() override
+    {
+        test::SuiteJournal journal("TreeNodeCache_test", *this);
+
+        testTiers();
+        testHitRates(journal);
+        testBudget(journal);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TreeNodeCache, shamap, ripple);
+
+}  // namespace tests
+}  // namespace ripple